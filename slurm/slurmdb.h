@@ -297,10 +297,15 @@ typedef struct {
 typedef struct {
 	List acct_list;		/* list of char * */
 	List associd_list;	/* list of char */
+	uint32_t chunk_size;	/* return about this many jobs at a time, see
+				 * slurmdb_jobs_get_next(), 0 for all */
 	List cluster_list;	/* list of char * */
 	List constraint_list; 	/* list of char * */
 	uint32_t cpus_max;      /* number of cpus high range */
 	uint32_t cpus_min;      /* number of cpus low range */
+	char *cursor_cluster;	/* with chunk_size, return the jobs after
+				 * cursor_jobid of this cluster */
+	uint32_t cursor_jobid;
 	uint32_t db_flags;      /* flags sent from the slurmctld on the job */
 	int32_t exitcode;       /* exit code of job */
 	uint32_t flags;         /* Reporting flags*/
@@ -1278,6 +1283,7 @@ typedef struct {
 #define ROLLUP_MONTH	2
 #define ROLLUP_COUNT	3
 typedef struct rollup_stats {
+	uint32_t rollup_periods[ROLLUP_COUNT];	/* hours, days or months */
 	uint32_t rollup_time[ROLLUP_COUNT];
 } rollup_stats_t;
 
@@ -1285,6 +1291,8 @@ typedef struct {
 	uint16_t *rollup_count;		/* Length should be ROLLUP_COUNT */
 	uint64_t *rollup_time;		/* Length should be ROLLUP_COUNT */
 	uint64_t *rollup_max_time;	/* Length should be ROLLUP_COUNT */
+	uint64_t *rollup_periods;	/* periods rolled up, length should be
+					 * ROLLUP_COUNT */
 
 	uint32_t type_cnt;		/* Length of rpc_type arrays */
 	uint16_t *rpc_type_id;		/* RPC type */
@@ -1294,6 +1302,13 @@ typedef struct {
 	uint32_t *rpc_user_id;		/* User ID issuing RPC */
 	uint32_t *rpc_user_cnt;		/* count of RPCs processed */
 	uint64_t *rpc_user_time;	/* total usecs this user's RPCs */
+
+	uint32_t batch_cnt;		/* DBD_SEND_MULT_MSG committed as one
+					 * transaction */
+	uint32_t batch_fail_cnt;	/* batches whose commit failed */
+	uint64_t batch_max_time;	/* longest usecs of a batch */
+	uint64_t batch_rec_cnt;		/* messages in the batches */
+	uint64_t batch_time;		/* total usecs of the batches */
 } slurmdb_stats_rec_t;
 
 
@@ -1602,6 +1617,14 @@ extern List slurmdb_job_modify(void *db_conn,
  */
 extern List slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond);
 
+/*
+ * get the next chunk of at most job_cond->chunk_size jobs from the storage,
+ * moving the cursor of job_cond past them
+ * returns List of slurmdb_job_rec_t *, empty once all jobs were returned
+ * note List needs to be freed with slurm_list_destroy() when called
+ */
+extern List slurmdb_jobs_get_next(void *db_conn, slurmdb_job_cond_t *job_cond);
+
 /*
  * Fix runaway jobs
  * IN: jobs, a list of all the runaway jobs
@@ -1281,6 +1281,7 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 		/* In federation. Need full info from all clusters */
 		update_time = (time_t) 0;
 		show_flags &= (~SHOW_LOCAL);
+		show_flags &= (~SHOW_DELTA);
 	} else {
 		/* Report local cluster info only */
 		show_flags |= SHOW_LOCAL;
@@ -1309,6 +1310,107 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	return rc;
 }
 
+static int _cmp_job_id(const void *x, const void *y)
+{
+	uint32_t id1 = *(uint32_t *) x;
+	uint32_t id2 = *(uint32_t *) y;
+
+	if (id1 < id2)
+		return -1;
+	if (id1 > id2)
+		return 1;
+	return 0;
+}
+
+/*
+ * Merge the unchanged records of old_msg into delta_msg, which then holds
+ * the complete job information. Records of old_msg which were changed or
+ * removed are freed and old_msg is left without any records.
+ */
+static void _merge_delta_jobs(job_info_msg_t *old_msg,
+			      job_info_msg_t *delta_msg)
+{
+	slurm_job_info_t *job_array;
+	uint32_t *changed_job_id = NULL;
+	uint32_t i, job_cnt = 0;
+
+	if (delta_msg->record_count) {
+		changed_job_id = xmalloc(sizeof(uint32_t) *
+					 delta_msg->record_count);
+		for (i = 0; i < delta_msg->record_count; i++)
+			changed_job_id[i] = delta_msg->job_array[i].job_id;
+		qsort(changed_job_id, delta_msg->record_count,
+		      sizeof(uint32_t), _cmp_job_id);
+	}
+	if (delta_msg->removed_cnt) {
+		qsort(delta_msg->removed_job_id, delta_msg->removed_cnt,
+		      sizeof(uint32_t), _cmp_job_id);
+	}
+
+	job_array = xmalloc(sizeof(slurm_job_info_t) *
+			    (old_msg->record_count + delta_msg->record_count));
+	for (i = 0; i < old_msg->record_count; i++) {
+		slurm_job_info_t *job_ptr = &old_msg->job_array[i];
+
+		if ((changed_job_id &&
+		     bsearch(&job_ptr->job_id, changed_job_id,
+			     delta_msg->record_count, sizeof(uint32_t),
+			     _cmp_job_id)) ||
+		    (delta_msg->removed_job_id &&
+		     bsearch(&job_ptr->job_id, delta_msg->removed_job_id,
+			     delta_msg->removed_cnt, sizeof(uint32_t),
+			     _cmp_job_id))) {
+			slurm_free_job_info_members(job_ptr);
+			continue;
+		}
+		memcpy(&job_array[job_cnt++], job_ptr,
+		       sizeof(slurm_job_info_t));
+	}
+	if (delta_msg->record_count) {
+		memcpy(&job_array[job_cnt], delta_msg->job_array,
+		       sizeof(slurm_job_info_t) * delta_msg->record_count);
+		job_cnt += delta_msg->record_count;
+	}
+	xfree(changed_job_id);
+
+	xfree(old_msg->job_array);
+	old_msg->record_count = 0;
+
+	xfree(delta_msg->job_array);
+	delta_msg->job_array = job_array;
+	delta_msg->record_count = job_cnt;
+	delta_msg->delta = 0;
+	xfree(delta_msg->removed_job_id);
+	delta_msg->removed_cnt = 0;
+}
+
+/*
+ * slurm_load_jobs_delta - issue RPC to get only the job information changed
+ *	since old_job_ptr was loaded and merge it with old_job_ptr
+ * IN old_job_ptr - previously loaded job information or NULL. On success
+ *	its unchanged records are moved into the new message
+ * OUT job_info_msg_pptr - place to store the merged job information
+ * IN show_flags - job filtering options
+ * RET 0 or -1 on error (SLURM_NO_CHANGE_IN_DATA if nothing changed)
+ * NOTE: free both old_job_ptr and the response using slurm_free_job_info_msg
+ */
+extern int slurm_load_jobs_delta(job_info_msg_t *old_job_ptr,
+				 job_info_msg_t **job_info_msg_pptr,
+				 uint16_t show_flags)
+{
+	time_t update_time = (time_t) 0;
+	int rc;
+
+	if (old_job_ptr)
+		update_time = old_job_ptr->last_update;
+	rc = slurm_load_jobs(update_time, job_info_msg_pptr,
+			     show_flags | SHOW_DELTA);
+	if ((rc == SLURM_SUCCESS) && old_job_ptr && (*job_info_msg_pptr)->delta)
+		_merge_delta_jobs(old_job_ptr, *job_info_msg_pptr);
+
+	return rc;
+}
+
 /*
  * slurm_load_job_user - issue RPC to get slurm information about all jobs
  *	to be run as the specified user
@@ -0,0 +1,322 @@
+/*****************************************************************************\
+ *  arena.c - region allocator for short lived xmalloc() memory
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/arena.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+/* Alignment of the memory returned, as malloc() gives on x86_64 */
+#define ARENA_ALIGN	16
+#define ARENA_ROUND(_x)	(((_x) + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1))
+
+/*
+ * Each allocation is preceded by three words: the owning arena, then the
+ * magic cookie and size that xmalloc() also uses.
+ */
+#define ARENA_HDR	(3 * sizeof(size_t))
+/* Offset of the first header in a block, so that the memory is aligned */
+#define ARENA_HDR_PAD	(ARENA_ROUND(ARENA_HDR) - ARENA_HDR)
+
+typedef struct arena_block {
+	struct arena_block *next;
+	size_t size;			/* usable bytes following the block */
+	size_t pad[2];			/* keep the data aligned */
+} arena_block_t;
+
+struct arena {
+	pthread_mutex_t mutex;		/* protects frees and released */
+	arena_block_t *blocks;		/* current block first */
+	char *pos;			/* next free byte of current block */
+	char *end;			/* end of current block */
+	size_t block_size;
+	bool released;			/* owner called arena_destroy() */
+	arena_stats_t stats;
+};
+
+/*
+ * Regular blocks of released arenas are kept for reuse, so that an arena
+ * made for each message or scheduling pass does not have to fault in fresh
+ * memory from the system every time.
+ */
+#define ARENA_FREE_MAX	32
+static pthread_mutex_t arena_free_lock = PTHREAD_MUTEX_INITIALIZER;
+static arena_block_t *arena_free_blocks = NULL;
+static int arena_free_cnt = 0;
+
+__thread arena_t *arena_current = NULL;
+
+static void _free_blocks(arena_block_t *block, size_t block_size)
+{
+	arena_block_t *next;
+
+	for ( ; block; block = next) {
+		next = block->next;
+		if ((block->size == block_size) &&
+		    (arena_free_cnt < ARENA_FREE_MAX)) {
+			slurm_mutex_lock(&arena_free_lock);
+			if (arena_free_cnt < ARENA_FREE_MAX) {
+				block->next = arena_free_blocks;
+				arena_free_blocks = block;
+				arena_free_cnt++;
+				block = NULL;
+			}
+			slurm_mutex_unlock(&arena_free_lock);
+		}
+		free(block);
+	}
+}
+
+static void _arena_free(arena_t *arena)
+{
+	_free_blocks(arena->blocks, arena->block_size);
+	slurm_mutex_destroy(&arena->mutex);
+	xfree(arena);
+}
+
+static arena_block_t *_block_alloc(arena_t *arena, size_t size)
+{
+	arena_block_t *block = NULL, **pp;
+
+	if ((size == arena->block_size) && arena_free_cnt) {
+		slurm_mutex_lock(&arena_free_lock);
+		for (pp = &arena_free_blocks; *pp; pp = &(*pp)->next) {
+			if ((*pp)->size == size) {
+				block = *pp;
+				*pp = block->next;
+				arena_free_cnt--;
+				break;
+			}
+		}
+		slurm_mutex_unlock(&arena_free_lock);
+	}
+	if (!block && !(block = malloc(sizeof(arena_block_t) + size))) {
+		log_oom(__FILE__, __LINE__, __func__);
+		abort();
+	}
+	block->size = size;
+	arena->stats.blocks++;
+	arena->stats.block_bytes += size;
+
+	return block;
+}
+
+/*
+ * Return room for an allocation of need bytes (header included). Large
+ * allocations get a block of their own, linked behind the current one so
+ * that its free space is not lost.
+ */
+static char *_arena_grow(arena_t *arena, size_t need)
+{
+	arena_block_t *block;
+
+	if ((need + ARENA_HDR_PAD) > (arena->block_size / 4)) {
+		block = _block_alloc(arena, need + ARENA_HDR_PAD);
+		if (arena->blocks) {
+			block->next = arena->blocks->next;
+			arena->blocks->next = block;
+		} else {
+			block->next = NULL;
+			arena->blocks = block;
+			arena->pos = arena->end = (char *) (block + 1) +
+						  block->size;
+		}
+		return (char *) (block + 1) + ARENA_HDR_PAD;
+	}
+
+	block = _block_alloc(arena, arena->block_size);
+	block->next = arena->blocks;
+	arena->blocks = block;
+	arena->pos = (char *) (block + 1) + ARENA_HDR_PAD;
+	arena->end = (char *) (block + 1) + block->size;
+	arena->pos += need;
+
+	return arena->pos - need;
+}
+
+extern arena_t *arena_create(size_t block_size)
+{
+	arena_t *arena = xmalloc(sizeof(arena_t));
+
+	if (!block_size)
+		block_size = ARENA_BLOCK_SIZE;
+	arena->block_size = ARENA_ROUND(block_size);
+	slurm_mutex_init(&arena->mutex);
+
+	return arena;
+}
+
+extern void arena_destroy(arena_t *arena)
+{
+	bool done;
+
+	if (!arena)
+		return;
+
+	slurm_mutex_lock(&arena->mutex);
+	xassert(!arena->released);
+	arena->released = true;
+	done = (arena->stats.frees == arena->stats.allocs);
+	slurm_mutex_unlock(&arena->mutex);
+
+	if (done)
+		_arena_free(arena);
+}
+
+extern void *arena_alloc(arena_t *arena, size_t size, bool clear)
+{
+#ifdef MEMORY_LEAK_DEBUG
+	return slurm_xmalloc(size, clear, __FILE__, __LINE__, __func__);
+#else
+	size_t need, *p;
+
+	if (!arena)
+		return slurm_xmalloc(size, clear, __FILE__, __LINE__,
+				     __func__);
+	if (size == 0)
+		return NULL;
+
+	xassert(!arena->released);
+
+	/*
+	 * Only the allocating thread touches pos, end and allocs, so no lock
+	 * is needed here. arena_free_item() compares allocs only once the
+	 * arena is released, after which allocs no longer changes.
+	 */
+	need = ARENA_ROUND(ARENA_HDR + size);
+	if ((size_t) (arena->end - arena->pos) >= need) {
+		p = (size_t *) arena->pos;
+		arena->pos += need;
+	} else
+		p = (size_t *) _arena_grow(arena, need);
+	arena->stats.allocs++;
+	arena->stats.bytes += size;
+
+	p[0] = (size_t) arena;
+	p[1] = XMALLOC_ARENA_MAGIC;
+	p[2] = size;
+	if (clear)
+		memset(&p[3], 0, size);
+
+	return &p[3];
+#endif
+}
+
+extern bool arena_reset(arena_t *arena)
+{
+	arena_block_t *block, *next, *keep = NULL;
+	bool rc = false;
+
+	slurm_mutex_lock(&arena->mutex);
+	if (arena->stats.frees == arena->stats.allocs) {
+		/* Keep one regular block, not one for a large allocation */
+		for (block = arena->blocks; block; block = next) {
+			next = block->next;
+			if (!keep && (block->size == arena->block_size)) {
+				keep = block;
+			} else {
+				block->next = NULL;
+				_free_blocks(block, arena->block_size);
+			}
+		}
+		arena->blocks = keep;
+		if (keep) {
+			keep->next = NULL;
+			arena->pos = (char *) (keep + 1) + ARENA_HDR_PAD;
+			arena->end = (char *) (keep + 1) + keep->size;
+			arena->stats.block_bytes = keep->size;
+		} else {
+			arena->pos = arena->end = NULL;
+			arena->stats.block_bytes = 0;
+		}
+		arena->stats.resets++;
+		rc = true;
+	}
+	slurm_mutex_unlock(&arena->mutex);
+
+	return rc;
+}
+
+extern void arena_stats(arena_t *arena, arena_stats_t *stats)
+{
+	slurm_mutex_lock(&arena->mutex);
+	memcpy(stats, &arena->stats, sizeof(arena_stats_t));
+	slurm_mutex_unlock(&arena->mutex);
+}
+
+extern arena_t *arena_push(arena_t *arena)
+{
+	arena_t *prev = arena_current;
+
+#ifndef MEMORY_LEAK_DEBUG
+	arena_current = arena;
+#endif
+	return prev;
+}
+
+extern void arena_pop(arena_t *prev)
+{
+#ifndef MEMORY_LEAK_DEBUG
+	arena_current = prev;
+#endif
+}
+
+extern bool arena_owned(void *ptr)
+{
+	return (ptr && (((size_t *) ptr)[-2] == XMALLOC_ARENA_MAGIC));
+}
+
+extern void arena_free_item(void *item)
+{
+	size_t *p = (size_t *) item - 3;
+	arena_t *arena = (arena_t *) p[0];
+	bool done;
+
+	xassert(p[1] == XMALLOC_ARENA_MAGIC);
+	p[1] = 0;	/* make sure xfree isn't called twice */
+
+	slurm_mutex_lock(&arena->mutex);
+	arena->stats.frees++;
+	done = arena->released && (arena->stats.frees == arena->stats.allocs);
+	slurm_mutex_unlock(&arena->mutex);
+
+	if (done)
+		_arena_free(arena);
+}
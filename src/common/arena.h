@@ -0,0 +1,121 @@
+/*****************************************************************************\
+ *  arena.h - region allocator for short lived xmalloc() memory
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+ *****************************************************************************
+ * An arena hands out memory by bumping a pointer through large blocks, and
+ * releases all of its blocks at once. It suits the many small allocations
+ * made while unpacking a message or building a scheduler queue, which all
+ * die together moments later.
+ *
+ * Arena memory carries an xmalloc() style header, so code handed such memory
+ * needs no changes: xsize() works, xrealloc() moves the data to a new
+ * allocation and xfree() only marks the memory as unused. The blocks are
+ * released once the owner has called arena_destroy() and every allocation
+ * has been passed to xfree(). An allocation kept beyond the life of the rest
+ * (a string stolen from an RPC into a job record, say) is therefore safe,
+ * but keeps all of the arena's blocks alive; copy such memory instead when
+ * arena_owned() is true.
+ *
+ * Only one thread may allocate from an arena at a time, either with
+ * arena_alloc() or by making it the thread's current arena with arena_push().
+ * Any thread may xfree() arena memory.
+ *
+ * Building with --enable-memory-leak-debug makes every arena allocation a
+ * plain xmalloc(), so that valgrind reports leaked memory as usual.
+\*****************************************************************************/
+
+#ifndef _ARENA_H
+#define _ARENA_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define ARENA_BLOCK_SIZE	(64 * 1024)
+
+typedef struct arena arena_t;
+
+typedef struct {
+	uint64_t allocs;	/* allocations made */
+	uint64_t frees;		/* allocations passed to xfree() */
+	uint64_t bytes;		/* bytes requested */
+	uint64_t blocks;	/* blocks taken, new or reused */
+	uint64_t block_bytes;	/* bytes held in blocks */
+	uint64_t resets;	/* successful arena_reset() calls */
+} arena_stats_t;
+
+/* The arena xmalloc() allocates from in this thread, NULL for the heap */
+extern __thread arena_t *arena_current;
+
+/*
+ * Create an arena whose blocks hold block_size bytes, ARENA_BLOCK_SIZE if 0.
+ * Allocations larger than a quarter of a block get a block of their own.
+ */
+extern arena_t *arena_create(size_t block_size);
+
+/*
+ * Give up the caller's reference to the arena. Its blocks are freed now if
+ * all of its memory has been passed to xfree(), otherwise when the last
+ * allocation is.
+ */
+extern void arena_destroy(arena_t *arena);
+
+/*
+ * Allocate size bytes from the arena, zeroed if clear is set. Falls back
+ * to xmalloc() if arena is NULL.
+ */
+extern void *arena_alloc(arena_t *arena, size_t size, bool clear);
+
+/*
+ * Rewind the arena to the start of its first block, freeing the others.
+ * RET false, without changing anything, if some arena memory is still in
+ * use
+ */
+extern bool arena_reset(arena_t *arena);
+
+/* Copy the arena's counters into stats */
+extern void arena_stats(arena_t *arena, arena_stats_t *stats);
+
+/*
+ * Make arena (NULL for the heap) the one xmalloc() and friends allocate from
+ * in the calling thread.
+ * RET the previous current arena, to be passed to arena_pop()
+ */
+extern arena_t *arena_push(arena_t *arena);
+extern void arena_pop(arena_t *prev);
+
+/* Return true if ptr is xmalloc() memory which came from an arena */
+extern bool arena_owned(void *ptr);
+
+/* Called by xfree() and xrealloc() for memory from an arena */
+extern void arena_free_item(void *item);
+
+#endif /* !_ARENA_H */
@@ -144,6 +144,7 @@ strong_alias(bit_fls,		slurm_bit_fls);
 strong_alias(bit_fill_gaps,	slurm_bit_fill_gaps);
 strong_alias(bit_super_set,	slurm_bit_super_set);
 strong_alias(bit_overlap,	slurm_bit_overlap);
+strong_alias(bit_overlap_any,	slurm_bit_overlap_any);
 strong_alias(bit_equal,		slurm_bit_equal);
 strong_alias(bit_copy,		slurm_bit_copy);
 strong_alias(bit_pick_cnt,	slurm_bit_pick_cnt);
@@ -154,6 +155,196 @@ strong_alias(bit_copybits,	slurm_bit_copybits);
 strong_alias(bit_get_bit_num,	slurm_bit_get_bit_num);
 strong_alias(bit_get_pos_num,	slurm_bit_get_pos_num);
 
+#ifdef HAVE___BUILTIN_POPCOUNTLL
+#define hweight __builtin_popcountll
+#else
+/*
+ * Returns the hamming weight (i.e. the number of bits set) in a word.
+ * NOTE: This routine borrowed from Linux 4.9 <tools/lib/hweight.c>.
+ */
+static uint64_t
+hweight(uint64_t w)
+{
+        w -= (w >> 1) & 0x5555555555555555ul;
+        w =  (w & 0x3333333333333333ul) + ((w >> 2) & 0x3333333333333333ul);
+        w =  (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0ful;
+        return (w * 0x0101010101010101ul) >> 56;
+}
+#endif
+
+/*
+ * Kernels for operations over whole bitstrings. They take the data words of
+ * the bitstrings (past the BITSTR_OVERHEAD words) and a word count, and
+ * work BITSTR_VEC_WORDS words at a time with GCC vector extensions.
+ *
+ * On x86-64 with glibc each kernel is built for AVX-512, AVX2, SSE4.2 (which
+ * brings the popcnt instruction) and the base instruction set, and the
+ * dynamic loader picks the best one for the CPU on first call.
+ */
+#if defined(__x86_64__) && defined(__GLIBC__) && \
+    !defined(__clang__) && (__GNUC__ >= 6)
+#define BITSTR_CLONES __attribute__((target_clones("avx512f", "avx2", \
+						   "sse4.2", "default")))
+#else
+#define BITSTR_CLONES
+#endif
+
+#define BITSTR_VEC_WORDS	4
+typedef bitstr_t bitstr_vec_t
+	__attribute__((vector_size(BITSTR_VEC_WORDS * sizeof(bitstr_t)),
+		       aligned(sizeof(bitstr_t)), may_alias));
+
+/* first data word of a bitstring */
+#define _bitstr_data(name)	((name) + BITSTR_OVERHEAD)
+
+/* data words of a bitstring, including any partial last word */
+#define _bitstr_nwords(name)	\
+	(_bitstr_words(_bitstr_bits(name)) - BITSTR_OVERHEAD)
+
+/* mask for the valid bits of the partial last word of nbits bits */
+#ifdef SLURM_BIGENDIAN
+#define _bit_tail_mask(nbits)	\
+	((bitstr_t) ~(UINT64_MAX >> ((nbits) & BITSTR_MAXPOS)))
+#else
+#define _bit_tail_mask(nbits)	\
+	((bitstr_t) (((uint64_t) 1 << ((nbits) & BITSTR_MAXPOS)) - 1))
+#endif
+
+static inline int _vec_any(bitstr_vec_t v)
+{
+	return ((v[0] | v[1] | v[2] | v[3]) != 0);
+}
+
+/* a &= b */
+static BITSTR_CLONES void _words_and(bitstr_t *a, const bitstr_t *b, int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS)
+		*(bitstr_vec_t *) (a + i) &= *(const bitstr_vec_t *) (b + i);
+	for ( ; i < n; i++)
+		a[i] &= b[i];
+}
+
+/* a &= ~b */
+static BITSTR_CLONES void _words_and_not(bitstr_t *a, const bitstr_t *b,
+					 int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS)
+		*(bitstr_vec_t *) (a + i) &= ~*(const bitstr_vec_t *) (b + i);
+	for ( ; i < n; i++)
+		a[i] &= ~b[i];
+}
+
+/* a |= b */
+static BITSTR_CLONES void _words_or(bitstr_t *a, const bitstr_t *b, int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS)
+		*(bitstr_vec_t *) (a + i) |= *(const bitstr_vec_t *) (b + i);
+	for ( ; i < n; i++)
+		a[i] |= b[i];
+}
+
+/* a |= ~b */
+static BITSTR_CLONES void _words_or_not(bitstr_t *a, const bitstr_t *b,
+					int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS)
+		*(bitstr_vec_t *) (a + i) |= ~*(const bitstr_vec_t *) (b + i);
+	for ( ; i < n; i++)
+		a[i] |= ~b[i];
+}
+
+/* a = ~a */
+static BITSTR_CLONES void _words_not(bitstr_t *a, int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS)
+		*(bitstr_vec_t *) (a + i) = ~*(bitstr_vec_t *) (a + i);
+	for ( ; i < n; i++)
+		a[i] = ~a[i];
+}
+
+/* number of bits set in a */
+static BITSTR_CLONES int64_t _words_count(const bitstr_t *a, int64_t n)
+{
+	int64_t i, count = 0;
+
+	for (i = 0; i < n; i++)
+		count += hweight(a[i]);
+	return count;
+}
+
+/* number of bits set in both a and b */
+static BITSTR_CLONES int64_t _words_and_count(const bitstr_t *a,
+					      const bitstr_t *b, int64_t n)
+{
+	int64_t i, count = 0;
+
+	for (i = 0; i < n; i++)
+		count += hweight(a[i] & b[i]);
+	return count;
+}
+
+/* 1 if any bit is set in both a and b */
+static BITSTR_CLONES int _words_and_any(const bitstr_t *a, const bitstr_t *b,
+					int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS) {
+		if (_vec_any(*(const bitstr_vec_t *) (a + i) &
+			     *(const bitstr_vec_t *) (b + i)))
+			return 1;
+	}
+	for ( ; i < n; i++) {
+		if (a[i] & b[i])
+			return 1;
+	}
+	return 0;
+}
+
+/* 1 if any bit is set in a but not in b */
+static BITSTR_CLONES int _words_and_not_any(const bitstr_t *a,
+					    const bitstr_t *b, int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS) {
+		if (_vec_any(*(const bitstr_vec_t *) (a + i) &
+			     ~*(const bitstr_vec_t *) (b + i)))
+			return 1;
+	}
+	for ( ; i < n; i++) {
+		if (a[i] & ~b[i])
+			return 1;
+	}
+	return 0;
+}
+
+/* index of the first non-zero word of a, -1 if none */
+static BITSTR_CLONES int64_t _words_first_set(const bitstr_t *a, int64_t n)
+{
+	int64_t i;
+
+	for (i = 0; (i + BITSTR_VEC_WORDS) <= n; i += BITSTR_VEC_WORDS) {
+		if (_vec_any(*(const bitstr_vec_t *) (a + i)))
+			break;
+	}
+	for ( ; i < n; i++) {
+		if (a[i])
+			return i;
+	}
+	return -1;
+}
+
 /*
  * Allocate a bitstring.
  *   nbits (IN)		valid bits in new bitstring, initialized to all clear
@@ -470,31 +661,29 @@ bit_nffs(bitstr_t *b, int32_t n)
 bitoff_t
 bit_ffs(bitstr_t *b)
 {
-	bitoff_t bit = 0, value = -1;
+	bitoff_t bit, value = -1;
+	int64_t word;
 
 	_assert_bitstr_valid(b);
 
-	while (bit < _bitstr_bits(b) && value == -1) {
-		int32_t word = _bit_word(bit);
-
-		if (b[word] == 0) {
-			bit += sizeof(bitstr_t)*8;
-			continue;
-		}
+	word = _words_first_set(_bitstr_data(b), _bitstr_nwords(b));
+	if (word == -1)
+		return -1;
+	bit = word * sizeof(bitstr_t) * 8;
+	word += BITSTR_OVERHEAD;
 #if HAVE___BUILTIN_CLZLL && (defined SLURM_BIGENDIAN)
-		value = bit + __builtin_clzll(b[word]);
+	value = bit + __builtin_clzll(b[word]);
 #elif HAVE___BUILTIN_CTZLL && (!defined SLURM_BIGENDIAN)
-		value = bit + __builtin_ctzll(b[word]);
+	value = bit + __builtin_ctzll(b[word]);
 #else
-		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
-			if (bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit++;
+	while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
+		if (bit_test(b, bit)) {
+			value = bit;
+			break;
 		}
-#endif
+		bit++;
 	}
+#endif
 	if (value < _bitstr_bits(b))
 		return value;
 	else
@@ -577,19 +766,12 @@ bit_fill_gaps(bitstr_t *b)
 int
 bit_super_set(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
-
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
-		if (b1[_bit_word(bit)] != (b1[_bit_word(bit)] &
-		                           b2[_bit_word(bit)]))
-			return 0;
-	}
-
-	return 1;
+	return !_words_and_not_any(_bitstr_data(b1), _bitstr_data(b2),
+				   _bitstr_nwords(b1));
 }
 
 /*
@@ -624,14 +806,11 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
 void
 bit_and(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
-
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] &= b2[_bit_word(bit)];
+	_words_and(_bitstr_data(b1), _bitstr_data(b2), _bitstr_nwords(b1));
 }
 
 /*
@@ -641,14 +820,11 @@ bit_and(bitstr_t *b1, bitstr_t *b2)
  */
 void bit_and_not(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
-
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] &= ~b2[_bit_word(bit)];
+	_words_and_not(_bitstr_data(b1), _bitstr_data(b2), _bitstr_nwords(b1));
 }
 
 /*
@@ -658,12 +834,9 @@ void bit_and_not(bitstr_t *b1, bitstr_t *b2)
 void
 bit_not(bitstr_t *b)
 {
-	bitoff_t bit;
-
 	_assert_bitstr_valid(b);
 
-	for (bit = 0; bit < _bitstr_bits(b); bit += sizeof(bitstr_t)*8)
-		b[_bit_word(bit)] = ~b[_bit_word(bit)];
+	_words_not(_bitstr_data(b), _bitstr_nwords(b));
 }
 
 /*
@@ -674,14 +847,11 @@ bit_not(bitstr_t *b)
 void
 bit_or(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
-
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] |= b2[_bit_word(bit)];
+	_words_or(_bitstr_data(b1), _bitstr_data(b2), _bitstr_nwords(b1));
 }
 
 /*
@@ -691,14 +861,11 @@ bit_or(bitstr_t *b1, bitstr_t *b2)
  */
 void bit_or_not(bitstr_t *b1, bitstr_t *b2)
 {
-	bitoff_t bit;
-
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] |= ~b2[_bit_word(bit)];
+	_words_or_not(_bitstr_data(b1), _bitstr_data(b2), _bitstr_nwords(b1));
 }
 
 /*
@@ -735,23 +902,6 @@ bit_copybits(bitstr_t *dest, bitstr_t *src)
 	memcpy(&dest[BITSTR_OVERHEAD], &src[BITSTR_OVERHEAD], len);
 }
 
-#ifdef HAVE___BUILTIN_POPCOUNTLL
-#define hweight __builtin_popcountll
-#else
-/*
- * Returns the hamming weight (i.e. the number of bits set) in a word.
- * NOTE: This routine borrowed from Linux 4.9 <tools/lib/hweight.c>.
- */
-static uint64_t
-hweight(uint64_t w)
-{
-        w -= (w >> 1) & 0x5555555555555555ul;
-        w =  (w & 0x3333333333333333ul) + ((w >> 2) & 0x3333333333333333ul);
-        w =  (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0ful;
-        return (w * 0x0101010101010101ul) >> 56;
-}
-#endif
-
 /*
  * Count the number of bits set in bitstring.
  *   b (IN)		bitstring to check
@@ -760,20 +910,16 @@ hweight(uint64_t w)
 int32_t
 bit_set_count(bitstr_t *b)
 {
-	int32_t count = 0;
-	bitoff_t bit, bit_cnt;
-	int32_t word_size = sizeof(bitstr_t) * 8;
+	int32_t count;
+	bitoff_t bit_cnt;
 
 	_assert_bitstr_valid(b);
 
 	bit_cnt = _bitstr_bits(b);
-	for (bit = 0; (bit + word_size) <= bit_cnt; bit += word_size) {
-		count += hweight(b[_bit_word(bit)]);
-	}
-	for ( ; bit < bit_cnt; bit++) {
-		if (bit_test(b, bit))
-			count++;
-	}
+	count = _words_count(_bitstr_data(b), bit_cnt >> BITSTR_SHIFT);
+	if (bit_cnt & BITSTR_MAXPOS)
+		count += hweight(b[_bit_word(bit_cnt)] &
+				 _bit_tail_mask(bit_cnt));
 	return count;
 }
 
@@ -817,28 +963,49 @@ bit_set_count_range(bitstr_t *b, int32_t start, int32_t end)
 extern int32_t
 bit_overlap(bitstr_t *b1, bitstr_t *b2)
 {
-	int32_t count = 0;
-	bitoff_t bit, bit_cnt;
-	int32_t word_size = sizeof(bitstr_t) * 8;
+	int32_t count;
+	bitoff_t bit_cnt;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
 	bit_cnt = _bitstr_bits(b1);
-	for (bit = 0; bit < bit_cnt; bit += word_size) {
-		if ((bit + word_size - 1) >= bit_cnt)
-			break;
-		count += hweight(b1[_bit_word(bit)] & b2[_bit_word(bit)]);
-	}
-	for ( ; bit < bit_cnt; bit++) {
-		if (bit_test(b1, bit) && bit_test(b2, bit))
-			count++;
-	}
+	count = _words_and_count(_bitstr_data(b1), _bitstr_data(b2),
+				 bit_cnt >> BITSTR_SHIFT);
+	if (bit_cnt & BITSTR_MAXPOS)
+		count += hweight(b1[_bit_word(bit_cnt)] &
+				 b2[_bit_word(bit_cnt)] &
+				 _bit_tail_mask(bit_cnt));
 
 	return count;
 }
 
+/*
+ * return 1 if any bit set in b1 is also set in b2, 0 otherwise. Unlike
+ * bit_overlap() this stops at the first common bit.
+ */
+extern int
+bit_overlap_any(bitstr_t *b1, bitstr_t *b2)
+{
+	bitoff_t bit_cnt;
+
+	_assert_bitstr_valid(b1);
+	_assert_bitstr_valid(b2);
+	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
+
+	bit_cnt = _bitstr_bits(b1);
+	if (_words_and_any(_bitstr_data(b1), _bitstr_data(b2),
+			   bit_cnt >> BITSTR_SHIFT))
+		return 1;
+	if ((bit_cnt & BITSTR_MAXPOS) &&
+	    (b1[_bit_word(bit_cnt)] & b2[_bit_word(bit_cnt)] &
+	     _bit_tail_mask(bit_cnt)))
+		return 1;
+
+	return 0;
+}
+
 /*
  * Count the number of bits clear in bitstring.
  *   b (IN)		bitstring to check
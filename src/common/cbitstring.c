@@ -0,0 +1,666 @@
+/*****************************************************************************\
+ *  cbitstring.c - run-length compressed bitmap functions
+ *****************************************************************************
+ *  See comments about the representation and its costs in cbitstring.h.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "slurm/slurm.h"
+
+#include "src/common/cbitstring.h"
+#include "src/common/macros.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+#define CBITSTR_MAGIC	0x43424954
+
+struct cbitstr {
+	uint32_t magic;
+	int32_t nbits;		/* valid bits, as bit_size() */
+	int32_t run_cnt;	/* runs of set bits */
+	int32_t run_max;	/* runs allocated in inx */
+	int32_t *inx;		/* first and last bit of each run, then -1,
+				 * allocated even when there are no runs */
+};
+
+/* first and last bit of run i */
+#define _first(b, i)	((b)->inx[(i) * 2])
+#define _last(b, i)	((b)->inx[(i) * 2 + 1])
+
+#define _assert_cbitstr_valid(b) do {		\
+	xassert(b);				\
+	xassert((b)->magic == CBITSTR_MAGIC);	\
+} while (0)
+
+#define _assert_cbit_valid(b, bit) do {		\
+	xassert((bit) >= 0);			\
+	xassert((bit) < (b)->nbits);		\
+} while (0)
+
+/* index of the first run ending at or after bit, run_cnt if none */
+static int32_t _run_ending_from(cbitstr_t *b, bitoff_t bit)
+{
+	int32_t lo = 0, hi = b->run_cnt, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (_last(b, mid) < bit)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* index of the first run starting after bit, run_cnt if none */
+static int32_t _run_starting_after(cbitstr_t *b, bitoff_t bit)
+{
+	int32_t lo = 0, hi = b->run_cnt, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (_first(b, mid) <= bit)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Make room for run_cnt runs plus the terminating -1 */
+static void _run_reserve(cbitstr_t *b, int32_t run_cnt)
+{
+	if (run_cnt <= b->run_max)
+		return;
+	b->run_max = MAX(run_cnt, b->run_max * 2);
+	xrealloc_nz(b->inx, (b->run_max * 2 + 1) * sizeof(int32_t));
+}
+
+/* Replace runs i through j - 1 with the cnt runs in new_inx */
+static void _run_replace(cbitstr_t *b, int32_t i, int32_t j,
+			 int32_t *new_inx, int32_t cnt)
+{
+	int32_t tail = b->run_cnt - j;
+
+	_run_reserve(b, b->run_cnt - (j - i) + cnt);
+	if (tail && (cnt != (j - i)))
+		memmove(&b->inx[(i + cnt) * 2], &b->inx[j * 2],
+			tail * 2 * sizeof(int32_t));
+	if (cnt)
+		memcpy(&b->inx[i * 2], new_inx, cnt * 2 * sizeof(int32_t));
+	b->run_cnt += cnt - (j - i);
+	b->inx[b->run_cnt * 2] = -1;
+}
+
+/* Add a run at the end of b, merging it with the last run if they touch */
+static void _run_append(cbitstr_t *b, int32_t first, int32_t last)
+{
+	int32_t i = b->run_cnt - 1;
+
+	if ((i >= 0) && (first <= (_last(b, i) + 1))) {
+		if (last > _last(b, i))
+			_last(b, i) = last;
+		return;
+	}
+	_run_reserve(b, b->run_cnt + 1);
+	_first(b, b->run_cnt) = first;
+	_last(b, b->run_cnt) = last;
+	b->run_cnt++;
+	b->inx[b->run_cnt * 2] = -1;
+}
+
+/* Set b to no runs, with inx holding just the terminating -1 */
+static void _run_init(cbitstr_t *b)
+{
+	b->inx = xmalloc(sizeof(int32_t));
+	b->inx[0] = -1;
+	b->run_cnt = b->run_max = 0;
+}
+
+/* Move the runs of src into dest, freeing those of dest */
+static void _run_move(cbitstr_t *dest, cbitstr_t *src)
+{
+	xfree(dest->inx);
+	dest->inx = src->inx;
+	dest->run_cnt = src->run_cnt;
+	dest->run_max = src->run_max;
+	_run_init(src);
+}
+
+/*
+ * Allocate a compressed bitmap.
+ *   nbits (IN)		valid bits in new bitmap, initialized to all clear
+ *   RETURN		new bitmap
+ */
+cbitstr_t *cbit_alloc(bitoff_t nbits)
+{
+	cbitstr_t *b;
+
+	xassert((nbits >= 0) && (nbits <= 0x40000000));
+	b = xmalloc(sizeof(cbitstr_t));
+	b->magic = CBITSTR_MAGIC;
+	b->nbits = nbits;
+	_run_init(b);
+	return b;
+}
+
+void cbit_free(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	b->magic = 0;
+	xfree(b->inx);
+	xfree(b);
+}
+
+cbitstr_t *cbit_copy(cbitstr_t *b)
+{
+	cbitstr_t *new;
+
+	_assert_cbitstr_valid(b);
+	new = cbit_alloc(b->nbits);
+	if (b->run_cnt) {
+		_run_reserve(new, b->run_cnt);
+		memcpy(new->inx, b->inx,
+		       (b->run_cnt * 2 + 1) * sizeof(int32_t));
+		new->run_cnt = b->run_cnt;
+	}
+	return new;
+}
+
+bitoff_t cbit_size(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	return b->nbits;
+}
+
+/* Bytes of memory used by the bitmap, excluding malloc overhead */
+size_t cbit_mem_size(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	return sizeof(cbitstr_t) + (b->run_max * 2 + 1) * sizeof(int32_t);
+}
+
+/*
+ * Is bit N of b set?
+ *   RETURN		1 if bit set, 0 if clear
+ */
+int cbit_test(cbitstr_t *b, bitoff_t bit)
+{
+	int32_t i;
+
+	_assert_cbitstr_valid(b);
+	_assert_cbit_valid(b, bit);
+	i = _run_ending_from(b, bit);
+	return ((i < b->run_cnt) && (_first(b, i) <= bit)) ? 1 : 0;
+}
+
+void cbit_set(cbitstr_t *b, bitoff_t bit)
+{
+	cbit_nset(b, bit, bit);
+}
+
+void cbit_clear(cbitstr_t *b, bitoff_t bit)
+{
+	cbit_nclear(b, bit, bit);
+}
+
+/*
+ * Set bits start through stop in b, merging the runs they touch
+ */
+void cbit_nset(cbitstr_t *b, bitoff_t start, bitoff_t stop)
+{
+	int32_t i, j, run[2];
+
+	_assert_cbitstr_valid(b);
+	_assert_cbit_valid(b, start);
+	_assert_cbit_valid(b, stop);
+	xassert(start <= stop);
+
+	i = _run_ending_from(b, start - 1);
+	j = _run_starting_after(b, stop + 1);
+	run[0] = start;
+	run[1] = stop;
+	if (i < j) {
+		run[0] = MIN(start, _first(b, i));
+		run[1] = MAX(stop, _last(b, j - 1));
+	}
+	_run_replace(b, i, j, run, 1);
+}
+
+/*
+ * Clear bits start through stop in b, splitting the runs they cut
+ */
+void cbit_nclear(cbitstr_t *b, bitoff_t start, bitoff_t stop)
+{
+	int32_t i, j, cnt = 0, run[4];
+
+	_assert_cbitstr_valid(b);
+	_assert_cbit_valid(b, start);
+	_assert_cbit_valid(b, stop);
+	xassert(start <= stop);
+
+	i = _run_ending_from(b, start);
+	j = _run_starting_after(b, stop);
+	if (i >= j)
+		return;
+	if (_first(b, i) < start) {
+		run[cnt * 2] = _first(b, i);
+		run[cnt * 2 + 1] = start - 1;
+		cnt++;
+	}
+	if (_last(b, j - 1) > stop) {
+		run[cnt * 2] = stop + 1;
+		run[cnt * 2 + 1] = _last(b, j - 1);
+		cnt++;
+	}
+	_run_replace(b, i, j, run, cnt);
+}
+
+void cbit_clear_all(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	if (b->run_cnt) {
+		b->run_cnt = 0;
+		b->inx[0] = -1;
+	}
+}
+
+/*
+ * Find first bit set in b.
+ *   RETURN		resulting bit position (-1 if none found)
+ */
+bitoff_t cbit_ffs(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	return b->run_cnt ? _first(b, 0) : -1;
+}
+
+/*
+ * Find last bit set in b.
+ *   RETURN		resulting bit position (-1 if none found)
+ */
+bitoff_t cbit_fls(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	return b->run_cnt ? _last(b, b->run_cnt - 1) : -1;
+}
+
+int32_t cbit_set_count(cbitstr_t *b)
+{
+	int32_t i, count = 0;
+
+	_assert_cbitstr_valid(b);
+	for (i = 0; i < b->run_cnt; i++)
+		count += _last(b, i) - _first(b, i) + 1;
+	return count;
+}
+
+/* Number of runs of set bits, which sets the size of b */
+int32_t cbit_run_count(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	return b->run_cnt;
+}
+
+/*
+ * b1 &= b2
+ */
+void cbit_and(cbitstr_t *b1, cbitstr_t *b2)
+{
+	cbitstr_t r = { 0 };
+	int32_t i = 0, j = 0, first, last;
+
+	_assert_cbitstr_valid(b1);
+	_assert_cbitstr_valid(b2);
+	xassert(b1->nbits == b2->nbits);
+
+	while ((i < b1->run_cnt) && (j < b2->run_cnt)) {
+		first = MAX(_first(b1, i), _first(b2, j));
+		last = MIN(_last(b1, i), _last(b2, j));
+		if (first <= last)
+			_run_append(&r, first, last);
+		if (_last(b1, i) < _last(b2, j))
+			i++;
+		else
+			j++;
+	}
+	_run_move(b1, &r);
+}
+
+/*
+ * b1 &= ~b2
+ */
+void cbit_and_not(cbitstr_t *b1, cbitstr_t *b2)
+{
+	cbitstr_t r = { 0 };
+	int32_t i, j = 0, k, next;
+
+	_assert_cbitstr_valid(b1);
+	_assert_cbitstr_valid(b2);
+	xassert(b1->nbits == b2->nbits);
+
+	for (i = 0; i < b1->run_cnt; i++) {
+		next = _first(b1, i);
+		while ((j < b2->run_cnt) && (_last(b2, j) < next))
+			j++;
+		for (k = j; (k < b2->run_cnt) &&
+			    (_first(b2, k) <= _last(b1, i)); k++) {
+			if (_first(b2, k) > next)
+				_run_append(&r, next, _first(b2, k) - 1);
+			next = _last(b2, k) + 1;
+		}
+		if (next <= _last(b1, i))
+			_run_append(&r, next, _last(b1, i));
+	}
+	_run_move(b1, &r);
+}
+
+/*
+ * b1 |= b2
+ */
+void cbit_or(cbitstr_t *b1, cbitstr_t *b2)
+{
+	cbitstr_t r = { 0 };
+	int32_t i = 0, j = 0;
+
+	_assert_cbitstr_valid(b1);
+	_assert_cbitstr_valid(b2);
+	xassert(b1->nbits == b2->nbits);
+
+	while ((i < b1->run_cnt) || (j < b2->run_cnt)) {
+		if ((j >= b2->run_cnt) ||
+		    ((i < b1->run_cnt) && (_first(b1, i) <= _first(b2, j)))) {
+			_run_append(&r, _first(b1, i), _last(b1, i));
+			i++;
+		} else {
+			_run_append(&r, _first(b2, j), _last(b2, j));
+			j++;
+		}
+	}
+	_run_move(b1, &r);
+}
+
+/*
+ * return 1 if b1 and b2 are identical, 0 otherwise
+ */
+int cbit_equal(cbitstr_t *b1, cbitstr_t *b2)
+{
+	_assert_cbitstr_valid(b1);
+	_assert_cbitstr_valid(b2);
+
+	if ((b1->nbits != b2->nbits) || (b1->run_cnt != b2->run_cnt))
+		return 0;
+	if (!b1->run_cnt)
+		return 1;
+	return !memcmp(b1->inx, b2->inx, b1->run_cnt * 2 * sizeof(int32_t));
+}
+
+/*
+ * return 1 if all bits set in b1 are also set in b2, 0 otherwise
+ */
+int cbit_super_set(cbitstr_t *b1, cbitstr_t *b2)
+{
+	int32_t i, j;
+
+	_assert_cbitstr_valid(b1);
+	_assert_cbitstr_valid(b2);
+	xassert(b1->nbits == b2->nbits);
+
+	/* Runs are maximal, so each run of b1 must lie in one run of b2 */
+	for (i = 0; i < b1->run_cnt; i++) {
+		j = _run_ending_from(b2, _last(b1, i));
+		if ((j >= b2->run_cnt) || (_first(b2, j) > _first(b1, i)))
+			return 0;
+	}
+	return 1;
+}
+
+/*
+ * return number of bits set in b1 that are also set in b2, 0 if no overlap
+ */
+int32_t cbit_overlap(cbitstr_t *b1, cbitstr_t *b2)
+{
+	int32_t i = 0, j = 0, first, last, count = 0;
+
+	_assert_cbitstr_valid(b1);
+	_assert_cbitstr_valid(b2);
+	xassert(b1->nbits == b2->nbits);
+
+	while ((i < b1->run_cnt) && (j < b2->run_cnt)) {
+		first = MAX(_first(b1, i), _first(b2, j));
+		last = MIN(_last(b1, i), _last(b2, j));
+		if (first <= last)
+			count += last - first + 1;
+		if (_last(b1, i) < _last(b2, j))
+			i++;
+		else
+			j++;
+	}
+	return count;
+}
+
+/*
+ * Clear from the dense bitmap b1 the bits set in b2, touching only the words
+ * of b1 covered by the runs of b2
+ */
+void bit_and_not_cbit(bitstr_t *b1, cbitstr_t *b2)
+{
+	int32_t i;
+
+	_assert_cbitstr_valid(b2);
+	xassert(bit_size(b1) == b2->nbits);
+
+	for (i = 0; i < b2->run_cnt; i++)
+		bit_nclear(b1, _first(b2, i), _last(b2, i));
+}
+
+/*
+ * return 1 if any bit set in the dense bitmap b1 is also set in b2
+ */
+int bit_overlap_any_cbit(bitstr_t *b1, cbitstr_t *b2)
+{
+	int32_t i;
+
+	_assert_cbitstr_valid(b2);
+	xassert(bit_size(b1) == b2->nbits);
+
+	for (i = 0; i < b2->run_cnt; i++) {
+		if (bit_set_count_range(b1, _first(b2, i), _last(b2, i) + 1))
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * Convert to range string format, e.g. 0-5,42, as bit_fmt()
+ */
+char *cbit_fmt(char *str, int32_t len, cbitstr_t *b)
+{
+	int32_t i, size = 0, ret;
+
+	_assert_cbitstr_valid(b);
+	xassert(len > 0);
+	*str = '\0';
+	for (i = 0; (i < b->run_cnt) && (size < len); i++) {
+		if (_first(b, i) == _last(b, i))
+			ret = snprintf(str + size, len - size, "%s%d",
+				       i ? "," : "", _first(b, i));
+		else
+			ret = snprintf(str + size, len - size, "%s%d-%d",
+				       i ? "," : "", _first(b, i),
+				       _last(b, i));
+		xassert(ret != -1);
+		size += ret;
+	}
+	return str;
+}
+
+/*
+ * Build a compressed bitmap with the same bits as a bitstr_t
+ */
+cbitstr_t *cbit_from_bitstr(bitstr_t *b)
+{
+	cbitstr_t *new;
+	int32_t *inx, cnt;
+
+	new = cbit_alloc(bit_size(b));
+	inx = bitstr2inx(b);
+	for (cnt = 0; inx[cnt * 2] != -1; cnt++)
+		;
+	if (cnt) {
+		_run_reserve(new, cnt);
+		memcpy(new->inx, inx, (cnt * 2 + 1) * sizeof(int32_t));
+		new->run_cnt = cnt;
+	}
+	xfree(inx);
+	return new;
+}
+
+/*
+ * Build a bitstr_t with the same bits as a compressed bitmap
+ */
+bitstr_t *cbit_to_bitstr(cbitstr_t *b)
+{
+	bitstr_t *new;
+	int32_t i;
+
+	_assert_cbitstr_valid(b);
+	new = bit_alloc(b->nbits);
+	for (i = 0; i < b->run_cnt; i++)
+		bit_nset(new, _first(b, i), _last(b, i));
+	return new;
+}
+
+/*
+ * Runs of set bits in the "inx" format of bitstr2inx(), valid until b is
+ * next modified
+ */
+const int32_t *cbit_inx(cbitstr_t *b)
+{
+	_assert_cbitstr_valid(b);
+	return b->inx;
+}
+
+void pack_cbitstr(cbitstr_t *b, Buf buffer)
+{
+	if (!b) {
+		pack32(NO_VAL, buffer);
+		return;
+	}
+
+	_assert_cbitstr_valid(b);
+	pack32(b->nbits, buffer);
+	pack32_array((uint32_t *) b->inx, b->run_cnt * 2, buffer);
+}
+
+int unpack_cbitstr(cbitstr_t **b_ptr, Buf buffer)
+{
+	uint32_t nbits, cnt = 0, i;
+	uint32_t *inx = NULL;
+	cbitstr_t *b;
+
+	xassert(b_ptr);
+	*b_ptr = NULL;
+
+	safe_unpack32(&nbits, buffer);
+	if (nbits == NO_VAL)
+		return SLURM_SUCCESS;
+	if (nbits > 0x40000000)
+		goto unpack_error;
+	safe_unpack32_array(&inx, &cnt, buffer);
+
+	/* Only accept sorted, separate runs within the bitmap */
+	if (cnt % 2)
+		goto unpack_error;
+	for (i = 0; i < cnt; i += 2) {
+		if ((inx[i] > inx[i + 1]) || (inx[i + 1] >= nbits) ||
+		    (i && (inx[i] <= (inx[i - 1] + 1))))
+			goto unpack_error;
+	}
+
+	b = cbit_alloc(nbits);
+	if (cnt) {
+		b->run_cnt = b->run_max = cnt / 2;
+		xrealloc(inx, (cnt + 1) * sizeof(int32_t));
+		xfree(b->inx);
+		b->inx = (int32_t *) inx;
+		b->inx[cnt] = -1;
+	} else
+		xfree(inx);
+	*b_ptr = b;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(inx);
+	return SLURM_ERROR;
+}
+
+void pack_bitstr_as_cbitstr(bitstr_t *b, Buf buffer)
+{
+	int32_t *inx, cnt;
+
+	if (!b) {
+		pack32(NO_VAL, buffer);
+		return;
+	}
+
+	inx = bitstr2inx(b);
+	for (cnt = 0; inx[cnt] != -1; cnt++)
+		;
+	pack32(bit_size(b), buffer);
+	pack32_array((uint32_t *) inx, cnt, buffer);
+	xfree(inx);
+}
+
+int unpack_cbitstr_as_inx(int32_t **inx, Buf buffer)
+{
+	cbitstr_t *b = NULL;
+
+	xassert(inx);
+	*inx = NULL;
+
+	if (unpack_cbitstr(&b, buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+	if (!b) {
+		*inx = xmalloc(sizeof(int32_t));
+		(*inx)[0] = -1;
+		return SLURM_SUCCESS;
+	}
+
+	/* Take over the runs, which are already -1 terminated */
+	*inx = b->inx;
+	b->inx = NULL;
+	cbit_free(b);
+	return SLURM_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************\
+ *  cbitstring.h - definitions for cbitstring.c, compressed bitmap functions
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * A cbitstr_t is a run-length compressed bitmap. It holds the same zero
+ * origin bit positions as a bitstr_t of the same size, but stores only the
+ * first and last bit of each run of set bits, so its size depends on how
+ * fragmented the set bits are rather than on the number of bits. A job
+ * allocated two nodes of a 20000 node cluster needs a few dozen bytes rather
+ * than the 2.5 KB of a bitstr_t.
+ *
+ * The runs are kept sorted, with no two runs overlapping or adjacent, in the
+ * "inx" format of bitstr2inx() and inx2bitstr(): pairs of first and last bit
+ * terminated by -1.
+ *
+ * Operations on two cbitstr_t are linear in their run counts. Single bit
+ * operations use a binary search of the runs, except that setting or
+ * clearing a bit may also move later runs. Convert to a bitstr_t with
+ * cbit_to_bitstr() for bit by bit scheduling work.
+ *
+ * NOTE: This is currently only a wire format: job information RPCs send a
+ * job's node bitmap with pack_bitstr_as_cbitstr() and clients unpack it with
+ * unpack_cbitstr_as_inx(). Job and step records, including those of completed
+ * jobs, still hold bitstr_t node bitmaps.
+ */
+
+#ifndef _CBITSTRING_H_
+#define	_CBITSTRING_H_
+
+#include <inttypes.h>
+
+#include "src/common/bitstring.h"
+#include "src/common/pack.h"
+
+typedef struct cbitstr cbitstr_t;
+
+cbitstr_t *cbit_alloc(bitoff_t nbits);
+void	cbit_free(cbitstr_t *b);
+cbitstr_t *cbit_copy(cbitstr_t *b);
+bitoff_t cbit_size(cbitstr_t *b);
+size_t	cbit_mem_size(cbitstr_t *b);
+
+int	cbit_test(cbitstr_t *b, bitoff_t bit);
+void	cbit_set(cbitstr_t *b, bitoff_t bit);
+void	cbit_clear(cbitstr_t *b, bitoff_t bit);
+void	cbit_nset(cbitstr_t *b, bitoff_t start, bitoff_t stop);
+void	cbit_nclear(cbitstr_t *b, bitoff_t start, bitoff_t stop);
+void	cbit_clear_all(cbitstr_t *b);
+
+bitoff_t cbit_ffs(cbitstr_t *b);
+bitoff_t cbit_fls(cbitstr_t *b);
+int32_t	cbit_set_count(cbitstr_t *b);
+int32_t	cbit_run_count(cbitstr_t *b);
+
+void	cbit_and(cbitstr_t *b1, cbitstr_t *b2);
+void	cbit_and_not(cbitstr_t *b1, cbitstr_t *b2);
+void	cbit_or(cbitstr_t *b1, cbitstr_t *b2);
+int	cbit_equal(cbitstr_t *b1, cbitstr_t *b2);
+int	cbit_super_set(cbitstr_t *b1, cbitstr_t *b2);
+int32_t	cbit_overlap(cbitstr_t *b1, cbitstr_t *b2);
+
+char	*cbit_fmt(char *str, int32_t len, cbitstr_t *b);
+
+/* Operations on a dense bitstr_t with a cbitstr_t of the same size */
+void	bit_and_not_cbit(bitstr_t *b1, cbitstr_t *b2);
+int	bit_overlap_any_cbit(bitstr_t *b1, cbitstr_t *b2);
+
+/* Conversions to and from the dense bitstr_t */
+cbitstr_t *cbit_from_bitstr(bitstr_t *b);
+bitstr_t *cbit_to_bitstr(cbitstr_t *b);
+const int32_t *cbit_inx(cbitstr_t *b);
+
+void	pack_cbitstr(cbitstr_t *b, Buf buffer);
+int	unpack_cbitstr(cbitstr_t **b, Buf buffer);
+
+/*
+ * Pack a bitstr_t as pack_cbitstr() would pack it once converted, and unpack
+ * such a bitmap straight into the "inx" format of bitstr2inx(). A NULL bitmap
+ * unpacks as an inx holding only -1, as with unpack_bit_str_hex_as_inx().
+ */
+void	pack_bitstr_as_cbitstr(bitstr_t *b, Buf buffer);
+int	unpack_cbitstr_as_inx(int32_t **inx, Buf buffer);
+
+#define FREE_NULL_CBITMAP(_X)		\
+	do {				\
+		if (_X) cbit_free (_X);	\
+		_X	= NULL; 	\
+	} while (0)
+
+#endif /* !_CBITSTRING_H_ */
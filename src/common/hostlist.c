@@ -241,6 +241,11 @@ struct hostlist {
 	/* list of iterators */
 	struct hostlist_iterator *ilist;
 
+	/* lookup index of the ranges, see _hostlist_find_hn() */
+	struct hostlist_index *index;
+
+	/* number of searches since the hostlist was last changed */
+	int find_cnt;
 };
 
 
@@ -274,6 +279,34 @@ struct _range {
 	int width;
 };
 
+/* index entry for one range of a hostlist */
+struct hostlist_index_ent {
+	hostrange_t hr;
+	int inx;	/* position of hr in hl->hr[] */
+	int pos;	/* position of the first host of hr in the hostlist */
+};
+
+/* the index entries of ranges sharing one prefix, sorted by lo */
+struct hostlist_index_grp {
+	char *prefix;	/* points into the first range of the group */
+	unsigned singlehost:1;
+	int first;	/* first entry of the group in ent[] */
+	int cnt;
+};
+
+/* Index of the ranges of a hostlist: a hash of range prefixes, each
+ * pointing at that prefix's ranges sorted by their lowest suffix */
+struct hostlist_index {
+	/* false if the ranges overlap or have a prefix ending in a digit */
+	bool usable;
+	int nent;
+	struct hostlist_index_ent *ent;
+	int ngrp;
+	struct hostlist_index_grp *grp;
+	int hash_size;	/* a power of 2 */
+	int *hash;	/* grp[] offset + 1, 0 if empty */
+};
+
 /* ---- ---- */
 
 /* Multi-dimension system stuff here */
@@ -370,11 +403,13 @@ static int         hostlist_push_hr(hostlist_t, char *, unsigned long,
                                     unsigned long, int);
 static int         hostlist_insert_range(hostlist_t, hostrange_t, int);
 static void        hostlist_delete_range(hostlist_t, int n);
+static void        _hostlist_index_drop(hostlist_t hl);
+static int         _hostlist_find_hn(hostlist_t, hostname_t, int, int *);
+static void        _hostlist_join_sorted(hostlist_t hl);
 static void        hostlist_coalesce(hostlist_t hl);
 static void        hostlist_collapse(hostlist_t hl);
 static hostlist_t _hostlist_create(const char *, char *, char *, int);
 static void        hostlist_shift_iterators(hostlist_t, int, int, int);
-static int        _attempt_range_join(hostlist_t, int);
 static int        _is_bracket_needed(hostlist_t, int);
 
 static hostlist_iterator_t hostlist_iterator_new(void);
@@ -1286,6 +1321,8 @@ static hostlist_t hostlist_new(void)
 	new->nranges = 0;
 	new->nhosts = 0;
 	new->ilist = NULL;
+	new->index = NULL;
+	new->find_cnt = 0;
 	return new;
 
 fail2:
@@ -1320,12 +1357,13 @@ static int hostlist_resize(hostlist_t hl, size_t newsize)
 	return 1;
 }
 
-/* Resize hostlist by one HOSTLIST_CHUNK
+/* Grow hostlist by at least one HOSTLIST_CHUNK, doubling the size of a
+ * large list so pushing many ranges does not copy the array each time
  * Assumes that hostlist hl is locked by caller
  */
 static int hostlist_expand(hostlist_t hl)
 {
-	if (!hostlist_resize(hl, hl->size + HOSTLIST_CHUNK))
+	if (!hostlist_resize(hl, MAX(hl->size + HOSTLIST_CHUNK, hl->size * 2)))
 		return 0;
 	else
 		return 1;
@@ -1342,6 +1380,7 @@ static int hostlist_push_range(hostlist_t hl, hostrange_t hr)
 
 	assert(hr != NULL);
 	LOCK_HOSTLIST(hl);
+	_hostlist_index_drop(hl);
 
 	tail = (hl->nranges > 0) ? hl->hr[hl->nranges-1] : hl->hr[0];
 
@@ -1404,6 +1443,7 @@ static int hostlist_insert_range(hostlist_t hl, hostrange_t hr, int n)
 
 	if (hl->size == hl->nranges && !hostlist_expand(hl))
 		return 0;
+	_hostlist_index_drop(hl);
 
 	/* copy new hostrange into slot "n" in array */
 	tmp = hl->hr[n];
@@ -1437,6 +1477,7 @@ static void hostlist_delete_range(hostlist_t hl, int n)
 	assert(hl != NULL);
 	assert(hl->magic == HOSTLIST_MAGIC);
 	assert((n < hl->nranges) && (n >= 0));
+	_hostlist_index_drop(hl);
 
 	old = hl->hr[n];
 	for (i = n; i < hl->nranges - 1; i++)
@@ -1451,6 +1492,237 @@ static void hostlist_delete_range(hostlist_t hl, int n)
 	hostrange_destroy(old);
 }
 
+/* ----[ hostlist index ]---- */
+
+/*
+ * Searching a hostlist of many ranges one range at a time is slow, so once
+ * a hostlist has been searched more than once without being changed, the
+ * search builds an index of its ranges. A lookup is then one hash probe
+ * for the hostname prefix and a binary search of that prefix's ranges.
+ * Any change to the hostlist drops the index, so alternating searches and
+ * deletions (e.g. hostlist_delete()) never pay for building it.
+ */
+
+/* hostlists with fewer ranges than this are always searched linearly */
+#define HOSTLIST_INDEX_MIN_RANGES 8
+
+static uint32_t _index_hash(const char *prefix, bool singlehost)
+{
+	uint32_t hash = singlehost ? 2166136261U : 2166136261U ^ 0xff;
+
+	while (*prefix) {
+		hash ^= (unsigned char) *prefix++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/* sort index entries by prefix, then lowest suffix, then list position */
+static int _index_ent_cmp(const void *a, const void *b)
+{
+	const struct hostlist_index_ent *e1 = a, *e2 = b;
+	int rc;
+
+	if (e1->hr->singlehost != e2->hr->singlehost)
+		return e1->hr->singlehost - e2->hr->singlehost;
+	if ((rc = strcmp(e1->hr->prefix, e2->hr->prefix)))
+		return rc;
+	if (e1->hr->lo != e2->hr->lo)
+		return (e1->hr->lo < e2->hr->lo) ? -1 : 1;
+	return e1->pos - e2->pos;
+}
+
+/* Build an index of the ranges of hostlist hl
+ * Assumes that the hostlist lock is already held.
+ */
+static struct hostlist_index *_hostlist_index_build(hostlist_t hl)
+{
+	struct hostlist_index *idx = xmalloc(sizeof(*idx));
+	struct hostlist_index_ent *ent, *prev = NULL;
+	struct hostlist_index_grp *grp = NULL;
+	int i, len, n = 0, pos = 0;
+	uint32_t hash;
+
+	/* Hostnames can match such a range with some of the prefix digits
+	 * moved into their suffix, see hostrange_hn_within() */
+	for (i = 0; i < hl->nranges; i++) {
+		len = strlen(hl->hr[i]->prefix);
+		if (!hl->hr[i]->singlehost && len &&
+		    isdigit((int) hl->hr[i]->prefix[len - 1]))
+			return idx;
+	}
+
+	idx->ent = ent = xmalloc(sizeof(*ent) * hl->nranges);
+	for (i = 0; i < hl->nranges; i++) {
+		ent[i].hr = hl->hr[i];
+		ent[i].inx = i;
+		ent[i].pos = pos;
+		pos += hostrange_count(hl->hr[i]);
+	}
+	qsort(ent, hl->nranges, sizeof(*ent), _index_ent_cmp);
+
+	idx->grp = xmalloc(sizeof(*grp) * hl->nranges);
+	for (i = 0; i < hl->nranges; i++) {
+		if (prev && (prev->hr->singlehost == ent[i].hr->singlehost) &&
+		    !strcmp(prev->hr->prefix, ent[i].hr->prefix)) {
+			/* a duplicate host is found at its first position */
+			if (ent[i].hr->singlehost)
+				continue;
+			/* overlapping ranges need the linear search */
+			if (ent[i].hr->lo <= prev->hr->hi)
+				return idx;
+			grp->cnt++;
+		} else {
+			grp = &idx->grp[idx->ngrp++];
+			grp->prefix = ent[i].hr->prefix;
+			grp->singlehost = ent[i].hr->singlehost;
+			grp->first = n;
+			grp->cnt = 1;
+		}
+		ent[n++] = ent[i];
+		prev = &ent[n - 1];
+	}
+	idx->nent = n;
+
+	idx->hash_size = HOSTLIST_CHUNK;
+	while (idx->hash_size < (idx->ngrp * 2))
+		idx->hash_size *= 2;
+	idx->hash = xmalloc(sizeof(int) * idx->hash_size);
+	for (i = 0; i < idx->ngrp; i++) {
+		hash = _index_hash(idx->grp[i].prefix, idx->grp[i].singlehost);
+		while (idx->hash[hash & (idx->hash_size - 1)])
+			hash++;
+		idx->hash[hash & (idx->hash_size - 1)] = i + 1;
+	}
+	idx->usable = true;
+
+	return idx;
+}
+
+static struct hostlist_index_grp *_index_grp_find(struct hostlist_index *idx,
+						  const char *prefix,
+						  bool singlehost)
+{
+	struct hostlist_index_grp *grp;
+	uint32_t hash = _index_hash(prefix, singlehost);
+	int g;
+
+	while ((g = idx->hash[hash & (idx->hash_size - 1)])) {
+		grp = &idx->grp[g - 1];
+		if ((grp->singlehost == singlehost) &&
+		    !strcmp(grp->prefix, prefix))
+			return grp;
+		hash++;
+	}
+	return NULL;
+}
+
+/* Return the position of hostname hn in the hostlist indexed by idx
+ * or -1 if not found, set *inx to the offset of its range in hl->hr[]
+ */
+static int _hostlist_index_find(struct hostlist_index *idx, hostname_t hn,
+				int *inx)
+{
+	struct hostlist_index_grp *grp;
+	struct hostlist_index_ent *ent;
+	int lo, hi, mid, pos = -1, hn_pos;
+
+	if ((grp = _index_grp_find(idx, hn->hostname, true))) {
+		pos = idx->ent[grp->first].pos;
+		*inx = idx->ent[grp->first].inx;
+	}
+
+	if (!hostname_suffix_is_valid(hn) ||
+	    !(grp = _index_grp_find(idx, hn->prefix, false)))
+		return pos;
+
+	/* find the last range of the prefix starting at or below hn */
+	lo = grp->first;
+	hi = grp->first + grp->cnt - 1;
+	while (lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if (idx->ent[mid].hr->lo <= hn->num)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	ent = &idx->ent[lo];
+	if ((ent->hr->lo > hn->num) || !hostrange_hn_within(ent->hr, hn, 1))
+		return pos;
+	hn_pos = ent->pos + hn->num - ent->hr->lo;
+	if ((pos < 0) || (hn_pos < pos)) {
+		pos = hn_pos;
+		*inx = ent->inx;
+	}
+	return pos;
+}
+
+/* Free the index of hostlist hl, called whenever hl is changed
+ * Assumes that the hostlist lock is already held.
+ */
+static void _hostlist_index_drop(hostlist_t hl)
+{
+	hl->find_cnt = 0;
+	if (!hl->index)
+		return;
+	xfree(hl->index->ent);
+	xfree(hl->index->grp);
+	xfree(hl->index->hash);
+	xfree(hl->index);
+}
+
+/* Return the position of the first host of hostlist hl matching hn or -1
+ * if not found, set *inx to the offset of its range in hl->hr[]
+ * Assumes that the hostlist lock is already held.
+ */
+static int _hostlist_find_hn(hostlist_t hl, hostname_t hn, int dims, int *inx)
+{
+	int i, count;
+
+	if ((dims == 1) && !hl->index &&
+	    (hl->nranges >= HOSTLIST_INDEX_MIN_RANGES) &&
+	    (++hl->find_cnt > 1))
+		hl->index = _hostlist_index_build(hl);
+	if ((dims == 1) && hl->index && hl->index->usable)
+		return _hostlist_index_find(hl->index, hn, inx);
+
+	for (i = 0, count = 0; i < hl->nranges; i++) {
+		if (hostrange_hn_within(hl->hr[i], hn, dims)) {
+			*inx = i;
+			if (hostname_suffix_is_valid(hn))
+				return count + hn->num - hl->hr[i]->lo;
+			return count;
+		}
+		count += hostrange_count(hl->hr[i]);
+	}
+	return -1;
+}
+
+/* Join neighbouring ranges of the sorted hostlist hl and remove duplicate
+ * hosts in a single pass over the ranges
+ * Assumes that the hostlist lock is already held.
+ */
+static void _hostlist_join_sorted(hostlist_t hl)
+{
+	int i, j = 0, ndup;
+
+	if (hl->nranges <= 1)
+		return;
+	_hostlist_index_drop(hl);
+
+	for (i = 1; i < hl->nranges; i++) {
+		if ((ndup = hostrange_join(hl->hr[j], hl->hr[i])) >= 0) {
+			hostrange_destroy(hl->hr[i]);
+			hl->nhosts -= ndup;
+		} else
+			hl->hr[++j] = hl->hr[i];
+	}
+	for (i = j + 1; i < hl->nranges; i++)
+		hl->hr[i] = NULL;
+	hl->nranges = j + 1;
+}
+
 #if WANT_RECKLESS_HOSTRANGE_EXPANSION
 
 /* The reckless hostrange expansion function.
@@ -1992,6 +2264,7 @@ void hostlist_destroy(hostlist_t hl)
 	for (i = 0; i < hl->nranges; i++)
 		hostrange_destroy(hl->hr[i]);
 	free(hl->hr);
+	_hostlist_index_drop(hl);
 	assert((hl->magic = 0x1));
 	UNLOCK_HOSTLIST(hl);
 	slurm_mutex_destroy(&hl->mutex);
@@ -2078,6 +2351,7 @@ char *hostlist_pop(hostlist_t hl)
 	LOCK_HOSTLIST(hl);
 	if (hl->nhosts > 0) {
 		hostrange_t hr = hl->hr[hl->nranges - 1];
+		_hostlist_index_drop(hl);
 		host = hostrange_pop(hr);
 		hl->nhosts--;
 		if (hostrange_empty(hr)) {
@@ -2131,6 +2405,7 @@ char *hostlist_shift_dims(hostlist_t hl, int dims)
 	if (hl->nhosts > 0) {
 		hostrange_t hr = hl->hr[0];
 
+		_hostlist_index_drop(hl);
 		host = hostrange_shift(hr, dims);
 		hl->nhosts--;
 
@@ -2167,6 +2442,7 @@ char *hostlist_pop_range(hostlist_t hl)
 		return NULL;
 	}
 
+	_hostlist_index_drop(hl);
 	i = hl->nranges - 2;
 	tail = hl->hr[hl->nranges - 1];
 	while (i >= 0 && hostrange_within_range(tail, hl->hr[i]))
@@ -2207,6 +2483,7 @@ int hostlist_pop_range_values(
 	tail = hl->hr[i];
 
 	if (tail && i < hl->nranges) {
+		_hostlist_index_drop(hl);
 		*lo = tail->lo;
 		*hi = tail->hi;
 		hl->nhosts -= hostrange_count(tail);
@@ -2239,6 +2516,7 @@ char *hostlist_shift_range(hostlist_t hl)
 		return NULL;
 	}
 
+	_hostlist_index_drop(hl);
 	i = 0;
 	do {
 		hostlist_push_range(hltmp, hl->hr[i]);
@@ -2286,17 +2564,45 @@ int hostlist_delete(hostlist_t hl, const char *hosts)
 }
 
 
-/* XXX watch out! poor implementation follows! (fix it at some point) */
+/* Delete host number num from the range at position i of hostlist hl
+ * Assumes that the hostlist lock is already held.
+ */
+static void _hostlist_delete_in_range(hostlist_t hl, int i, unsigned long num)
+{
+	hostrange_t hr = hl->hr[i];
+	hostrange_t new;
+
+	_hostlist_index_drop(hl);
+	if (hr->singlehost) { /* this wasn't a range */
+		hostlist_delete_range(hl, i);
+	} else if ((new = hostrange_delete_host(hr, num))) {
+		hostlist_insert_range(hl, new, i + 1);
+		hostrange_destroy(new);
+	} else if (hostrange_empty(hr))
+		hostlist_delete_range(hl, i);
+}
+
 int hostlist_delete_host(hostlist_t hl, const char *hostname)
 {
-	int n;
+	int dims = slurmdb_setup_cluster_name_dims();
+	int inx, n;
+	hostname_t hn;
 
 	if (!hl)
 		return -1;
-	n = hostlist_find(hl, hostname);
+	if (!hostname)
+		return 0;
+
+	hn = hostname_create_dims(hostname, dims);
+	LOCK_HOSTLIST(hl);
+	n = _hostlist_find_hn(hl, hn, dims, &inx);
+	if (n >= 0) {
+		_hostlist_delete_in_range(hl, inx, hn->num);
+		hl->nhosts--;
+	}
+	UNLOCK_HOSTLIST(hl);
+	hostname_destroy(hn);
 
-	if (n >= 0)
-		hostlist_delete_nth(hl, n);
 	return n >= 0 ? 1 : 0;
 }
 
@@ -2374,17 +2680,7 @@ int hostlist_delete_nth(hostlist_t hl, int n)
 		hostrange_t hr = hl->hr[i];
 
 		if (n <= (num_in_range - 1 + count)) {
-			unsigned long num = hr->lo + n - count;
-			hostrange_t new;
-
-			if (hr->singlehost) { /* this wasn't a range */
-				hostlist_delete_range(hl, i);
-			} else if ((new = hostrange_delete_host(hr, num))) {
-				hostlist_insert_range(hl, new, i + 1);
-				hostrange_destroy(new);
-			} else if (hostrange_empty(hr))
-				hostlist_delete_range(hl, i);
-
+			_hostlist_delete_in_range(hl, i, hr->lo + n - count);
 			goto done;
 		} else
 			count += num_in_range;
@@ -2411,7 +2707,7 @@ int hostlist_count(hostlist_t hl)
 
 int hostlist_find_dims(hostlist_t hl, const char *hostname, int dims)
 {
-	int i, count, ret = -1;
+	int inx, ret;
 	hostname_t hn;
 
 	if (!hostname || !hl)
@@ -2423,19 +2719,7 @@ int hostlist_find_dims(hostlist_t hl, const char *hostname, int dims)
 	hn = hostname_create_dims(hostname, dims);
 
 	LOCK_HOSTLIST(hl);
-
-	for (i = 0, count = 0; i < hl->nranges; i++) {
-		if (hostrange_hn_within(hl->hr[i], hn, dims)) {
-			if (hostname_suffix_is_valid(hn))
-				ret = count + hn->num - hl->hr[i]->lo;
-			else
-				ret = count;
-			goto done;
-		} else
-			count += hostrange_count(hl->hr[i]);
-	}
-
-done:
+	ret = _hostlist_find_hn(hl, hn, dims, &inx);
 	UNLOCK_HOSTLIST(hl);
 	hostname_destroy(hn);
 	return ret;
@@ -2468,6 +2752,7 @@ void hostlist_sort(hostlist_t hl)
 		return;
 	}
 
+	_hostlist_index_drop(hl);
 	qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
 
 	/* reset all iterators */
@@ -2489,6 +2774,7 @@ static void hostlist_collapse(hostlist_t hl)
 	int i;
 
 	LOCK_HOSTLIST(hl);
+	_hostlist_index_drop(hl);
 	for (i = hl->nranges - 1; i > 0; i--) {
 		hostrange_t hprev = hl->hr[i - 1];
 		hostrange_t hnext = hl->hr[i];
@@ -2512,6 +2798,7 @@ static void hostlist_coalesce(hostlist_t hl)
 	hostrange_t new;
 
 	LOCK_HOSTLIST(hl);
+	_hostlist_index_drop(hl);
 
 	for (i = hl->nranges - 1; i > 0; i--) {
 
@@ -2556,28 +2843,8 @@ static void hostlist_coalesce(hostlist_t hl)
 
 }
 
-/* attempt to join ranges at loc and loc-1 in a hostlist  */
-/* delete duplicates, return the number of hosts deleted  */
-/* assumes that the hostlist hl has been locked by caller */
-/* returns -1 if no range join occured */
-static int _attempt_range_join(hostlist_t hl, int loc)
-{
-	int ndup;
-	assert(hl != NULL);
-	assert(hl->magic == HOSTLIST_MAGIC);
-	assert(loc > 0);
-	assert(loc < hl->nranges);
-	ndup = hostrange_join(hl->hr[loc - 1], hl->hr[loc]);
-	if (ndup >= 0) {
-		hostlist_delete_range(hl, loc);
-		hl->nhosts -= ndup;
-	}
-	return ndup;
-}
-
 void hostlist_uniq(hostlist_t hl)
 {
-	int i = 1;
 	hostlist_iterator_t hli;
 	LOCK_HOSTLIST(hl);
 	if (hl->nranges <= 1) {
@@ -2585,11 +2852,7 @@ void hostlist_uniq(hostlist_t hl)
 		return;
 	}
 	qsort(hl->hr, hl->nranges, sizeof(hostrange_t), &_cmp);
-
-	while (i < hl->nranges) {
-		if (_attempt_range_join(hl, i) < 0) /* No range join occurred */
-			i++;
-	}
+	_hostlist_join_sorted(hl);
 
 	/* reset all iterators */
 	for (hli = hl->ilist; hli; hli = hli->next)
@@ -3419,10 +3682,13 @@ static void _iterator_advance_range(hostlist_iterator_t i)
 	}
 }
 
-char *hostlist_next_dims(hostlist_iterator_t i, int dims)
+/* Advance iterator i and copy the name of the host it is on into buf of
+ * the given size, returns the length of the name or -1 at the end of the
+ * list or if the name does not fit in buf
+ */
+static int _iterator_next_name(hostlist_iterator_t i, int dims,
+			       char *buf, size_t size)
 {
-	char buf[MAXHOSTNAMELEN + 16];
-	const int size = sizeof(buf);
 	int len = 0;
 
 	assert(i != NULL);
@@ -3451,17 +3717,28 @@ char *hostlist_next_dims(hostlist_iterator_t i, int dims)
 				buf[len++] = alpha_num[coord[i2++]];
 			buf[len] = '\0';
 		} else {
-			len = snprintf(buf + len, size - len, "%0*lu",
-				       i->hr->width, i->hr->lo + i->depth);
-			if (len < 0 || len >= size)
+			int len2 = snprintf(buf + len, size - len, "%0*lu",
+					    i->hr->width,
+					    i->hr->lo + i->depth);
+			if (len2 < 0 || len + len2 >= size)
 				goto no_next;
+			len += len2;
 		}
 	}
 	UNLOCK_HOSTLIST(i->hl);
-	return strdup(buf);
+	return len;
 no_next:
 	UNLOCK_HOSTLIST(i->hl);
-	return NULL;
+	return -1;
+}
+
+char *hostlist_next_dims(hostlist_iterator_t i, int dims)
+{
+	char buf[MAXHOSTNAMELEN + 16];
+
+	if (_iterator_next_name(i, dims, buf, sizeof(buf)) < 0)
+		return NULL;
+	return strdup(buf);
 }
 
 char *hostlist_next(hostlist_iterator_t i)
@@ -3471,6 +3748,13 @@ char *hostlist_next(hostlist_iterator_t i)
 	return hostlist_next_dims(i, dims);
 }
 
+int hostlist_next_buf(hostlist_iterator_t i, char *buf, size_t n)
+{
+	int dims = slurmdb_setup_cluster_name_dims();
+
+	return _iterator_next_name(i, dims, buf, n);
+}
+
 char *hostlist_next_range(hostlist_iterator_t i)
 {
 	int j, buf_size;
@@ -3508,6 +3792,7 @@ int hostlist_remove(hostlist_iterator_t i)
 	assert(i != NULL);
 	assert(i->magic == HOSTLIST_MAGIC);
 	LOCK_HOSTLIST(i->hl);
+	_hostlist_index_drop(i->hl);
 	new = hostrange_delete_host(i->hr, i->hr->lo + i->depth);
 	if (new) {
 		hostlist_insert_range(i->hl, new, i->idx + 1);
@@ -3572,100 +3857,72 @@ void hostset_destroy(hostset_t set)
 	free(set);
 }
 
-/* inserts a single range object into a hostset
+/* Merge the ranges of the sorted, duplicate free hostlist src into the
+ * hostset, in one pass over the ranges of both
  * Assumes that the set->hl lock is already held
- * Updates hl->nhosts
+ * Returns the number of hosts added to the hostset
  */
-static int hostset_insert_range(hostset_t set, hostrange_t hr)
+static int _hostset_merge(hostset_t set, hostlist_t src)
 {
-	int i = 0;
-	int inserted = 0;
-	int nhosts = 0;
-	int ndups = 0;
-	hostlist_t hl;
-
-	hl = set->hl;
+	hostlist_t hl = set->hl;
+	int i, j, k, nhosts = hl->nhosts;
+	hostlist_iterator_t hli;
 
-	if (hl->size == hl->nranges && !hostlist_expand(hl))
+	k = hl->nranges + src->nranges;
+	if ((k > hl->size) && !hostlist_resize(hl, k))
 		return 0;
 
-	nhosts = hostrange_count(hr);
-
-	for (i = 0; i < hl->nranges; i++) {
-		if (hostrange_cmp(hr, hl->hr[i]) <= 0) {
-
-			if ((ndups = hostrange_join(hr, hl->hr[i])) >= 0)
-				hostlist_delete_range(hl, i);
-			else if (ndups < 0)
-				ndups = 0;
-
-			hostlist_insert_range(hl, hr, i);
-
-			/* now attempt to join hr[i] and hr[i-1] */
-			if (i > 0) {
-				int m;
-				if ((m = _attempt_range_join(hl, i)) > 0)
-					ndups += m;
-			}
-			hl->nhosts += nhosts - ndups;
-			inserted = 1;
-			break;
-		}
+	/* merge from the end so no range is overwritten before it moves */
+	i = hl->nranges - 1;
+	j = src->nranges - 1;
+	while (j >= 0) {
+		if ((i >= 0) && (hostrange_cmp(hl->hr[i], src->hr[j]) > 0))
+			hl->hr[--k] = hl->hr[i--];
+		else
+			hl->hr[--k] = hostrange_copy(src->hr[j--]);
 	}
+	hl->nranges += src->nranges;
+	hl->nhosts += src->nhosts;
+	_hostlist_join_sorted(hl);
 
-	if (inserted == 0) {
-		hl->hr[hl->nranges++] = hostrange_copy(hr);
-		hl->nhosts += nhosts;
-		if (hl->nranges > 1) {
-			if ((ndups = _attempt_range_join(hl, hl->nranges - 1)) <= 0)
-				ndups = 0;
-		}
-	}
+	for (hli = hl->ilist; hli; hli = hli->next)
+		hostlist_iterator_reset(hli);
 
-	/*
-	 *  Return the number of unique hosts inserted
-	 */
-	return nhosts - ndups;
+	return hl->nhosts - nhosts;
 }
 
 int hostset_insert(hostset_t set, const char *hosts)
 {
-	int i, n = 0;
+	int n;
 	hostlist_t hl = hostlist_create(hosts);
 	if (!hl)
 		return 0;
 
 	hostlist_uniq(hl);
 	LOCK_HOSTLIST(set->hl);
-	for (i = 0; i < hl->nranges; i++)
-		n += hostset_insert_range(set, hl->hr[i]);
+	n = _hostset_merge(set, hl);
 	UNLOCK_HOSTLIST(set->hl);
 	hostlist_destroy(hl);
 	return n;
 }
 
 
-/* linear search through N ranges for hostname "host"
+/* search through N ranges for hostname "host"
  * */
 static int hostset_find_host(hostset_t set, const char *host)
 {
-	int i;
-	int retval = 0;
+	int inx, retval;
 	hostname_t hn;
+	/*
+	 * FIXME: THIS WILL NOT ALWAYS WORK CORRECTLY IF CALLED FROM A
+	 * LOCATION THAT COULD HAVE DIFFERENT DIMENSIONS
+	 * (i.e. slurmdbd).
+	 */
+	int dims = slurmdb_setup_cluster_name_dims();
+
 	LOCK_HOSTLIST(set->hl);
 	hn = hostname_create(host);
-	for (i = 0; i < set->hl->nranges; i++) {
-		/*
-		 * FIXME: THIS WILL NOT ALWAYS WORK CORRECTLY IF CALLED FROM A
-		 * LOCATION THAT COULD HAVE DIFFERENT DIMENSIONS
-		 * (i.e. slurmdbd).
-		 */
-		if (hostrange_hn_within(set->hl->hr[i], hn, 0)) {
-			retval = 1;
-			goto done;
-		}
-	}
-done:
+	retval = (_hostlist_find_hn(set->hl, hn, dims, &inx) >= 0);
 	UNLOCK_HOSTLIST(set->hl);
 	hostname_destroy(hn);
 	return retval;
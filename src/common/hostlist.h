@@ -61,6 +61,9 @@
 #endif
 #define HIGHEST_BASE 36
 
+/* size of a buffer for any hostname, see hostlist_next_buf() */
+#define HOSTLIST_NAME_SIZE 256
+
 #define FREE_NULL_HOSTLIST(_X)			\
 	do {					\
 		if (_X) hostlist_destroy (_X);	\
@@ -279,6 +282,8 @@ char * hostlist_shift_range(hostlist_t hl);
  *
  * Returns -1 if host is not found.
  *
+ * A hostlist searched repeatedly without being changed in between is
+ * indexed, making further searches independent of the number of ranges.
  */
 int hostlist_find_dims(hostlist_t hl, const char *hostname, int dims);
 int hostlist_find(hostlist_t hl, const char *hostname);
@@ -334,7 +339,7 @@ void hostlist_sort(hostlist_t hl);
 /* hostlist_uniq():
  *
  * Sort the hostlist hl and remove duplicate entries.
- *
+ * Apart from the sort this takes time linear in the number of ranges.
  */
 void hostlist_uniq(hostlist_t hl);
 
@@ -455,6 +460,17 @@ void hostlist_iterator_reset(hostlist_iterator_t i);
 char * hostlist_next_dims(hostlist_iterator_t i, int dims);
 char * hostlist_next(hostlist_iterator_t i);
 
+/* hostlist_next_buf():
+ *
+ * Copies the next hostname on the hostlist into buf, which is n bytes
+ * long, rather than allocating memory for it. A buffer of
+ * HOSTLIST_NAME_SIZE bytes holds any hostname.
+ *
+ * Returns the length of the hostname, or -1 at the end of the list or if
+ * the hostname does not fit in buf.
+ */
+int hostlist_next_buf(hostlist_iterator_t i, char *buf, size_t n);
+
 
 /* hostlist_next_range():
  *
@@ -634,7 +634,7 @@ extern int unpack_job_resources(job_resources_t **job_resrcs_pptr,
 {
 	char *bit_fmt = NULL;
 	uint32_t empty, tmp32;
-	job_resources_t *job_resrcs;
+	job_resources_t *job_resrcs = NULL;
 
 	xassert(job_resrcs_pptr);
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
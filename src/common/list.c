@@ -40,10 +40,12 @@
 #include <assert.h>
 #include <errno.h>
 #include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "list.h"
 #include "log.h"
 #include "macros.h"
@@ -101,13 +103,19 @@ strong_alias(list_install_fork_handlers, slurm_list_install_fork_handlers);
  * valgrind can identify where exactly any leak associated with the use
  * of the list functions originates.
 \**************************************************************************/
-#ifdef MEMORY_LEAK_DEBUG
-#  define LIST_ALLOC 1
-#else
-#  define LIST_ALLOC 128
-#endif
+#define LIST_ALLOC 128
 #define LIST_MAGIC 0xDEADBEEF
 
+/*
+ * Each thread keeps a cache of free objects of each type, so that threads
+ * churning through temporary lists rarely touch list_free_lock. Objects
+ * move between a thread's cache and the shared freelists LIST_CACHE_BATCH
+ * at a time, and the cache is returned to the shared freelists when the
+ * thread exits.
+ */
+#define LIST_CACHE_BATCH 64
+#define LIST_CACHE_MAX (LIST_ALLOC + LIST_CACHE_BATCH)
+
 
 /****************
  *  Data Types  *
@@ -134,6 +142,7 @@ struct xlist {
 	struct listIterator  *iNext;        /* iterator chain for list_destroy() */
 	ListDelF              fDel;         /* function to delete node data      */
 	int                   count;        /* number of nodes in list           */
+	bool                  locked;       /* false if mutex is not used        */
 	pthread_mutex_t       mutex;        /* mutex to protect access to list   */
 #ifndef NDEBUG
 	unsigned int          magic;        /* sentinel for asserting validity   */
@@ -142,6 +151,18 @@ struct xlist {
 
 typedef struct listNode * ListNode;
 
+typedef enum {
+	LIST_OBJ_LIST,
+	LIST_OBJ_NODE,
+	LIST_OBJ_ITERATOR,
+	LIST_OBJ_CNT
+} list_obj_t;
+
+typedef struct {
+	void                 *head;         /* chain of free objects             */
+	int                   count;        /* number of objects in chain        */
+} list_cache_t;
+
 
 /****************
  *  Prototypes  *
@@ -155,8 +176,8 @@ static ListNode list_node_alloc (void);
 static void list_node_free (ListNode p);
 static ListIterator list_iterator_alloc (void);
 static void list_iterator_free (ListIterator i);
-static void * list_alloc_aux (int size, void *pfreelist);
-static void list_free_aux (void *x, void *pfreelist);
+static void * list_alloc_aux (list_obj_t type);
+static void list_free_aux (void *x, list_obj_t type);
 static void *_list_pop_locked(List l);
 static void *_list_append_locked(List l, void *x);
 
@@ -168,20 +189,40 @@ static int _list_mutex_is_locked (pthread_mutex_t *mutex);
  *  Variables  *
  ***************/
 
-static List list_free_lists = NULL;
-static ListNode list_free_nodes = NULL;
-static ListIterator list_free_iterators = NULL;
+static const int list_obj_size[LIST_OBJ_CNT] = {
+	sizeof(struct xlist),
+	sizeof(struct listNode),
+	sizeof(struct listIterator)
+};
 
 static pthread_mutex_t list_free_lock = PTHREAD_MUTEX_INITIALIZER;
 
+#ifndef MEMORY_LEAK_DEBUG
+static void *list_free_objs[LIST_OBJ_CNT];	/* shared freelists */
+static __thread list_cache_t list_cache[LIST_OBJ_CNT];
+static __thread bool list_cache_registered = false;
+static pthread_key_t list_cache_key;
+static pthread_once_t list_cache_once = PTHREAD_ONCE_INIT;
+#endif
+
+static inline void _list_lock(List l)
+{
+	if (l->locked)
+		slurm_mutex_lock(&l->mutex);
+}
+
+static inline void _list_unlock(List l)
+{
+	if (l->locked)
+		slurm_mutex_unlock(&l->mutex);
+}
+
 /***************
  *  Functions  *
  ***************/
 
-/* list_create()
- */
-List
-list_create (ListDelF f)
+static List
+_list_create (ListDelF f, bool locked)
 {
 	List l = list_alloc();
 
@@ -190,12 +231,30 @@ list_create (ListDelF f)
 	l->iNext = NULL;
 	l->fDel = f;
 	l->count = 0;
-	slurm_mutex_init(&l->mutex);
+	l->locked = locked;
+	if (locked)
+		slurm_mutex_init(&l->mutex);
 	assert((l->magic = LIST_MAGIC));      /* set magic via assert abuse */
 
 	return l;
 }
 
+/* list_create()
+ */
+List
+list_create (ListDelF f)
+{
+	return _list_create(f, true);
+}
+
+/* list_create_unlocked()
+ */
+List
+list_create_unlocked (ListDelF f)
+{
+	return _list_create(f, false);
+}
+
 /* list_destroy()
  */
 void
@@ -205,7 +264,7 @@ list_destroy (List l)
 	ListNode p, pTmp;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	i = l->iNext;
@@ -225,8 +284,9 @@ list_destroy (List l)
 		p = pTmp;
 	}
 	assert((l->magic = ~LIST_MAGIC));     /* clear magic via assert abuse */
-	slurm_mutex_unlock(&l->mutex);
-	slurm_mutex_destroy(&l->mutex);
+	_list_unlock(l);
+	if (l->locked)
+		slurm_mutex_destroy(&l->mutex);
 	list_free(l);
 }
 
@@ -238,10 +298,10 @@ list_is_empty (List l)
 	int n;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 	n = l->count;
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return (n == 0);
 }
@@ -254,10 +314,10 @@ list_count (List l)
 	int n;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 	n = l->count;
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -271,10 +331,10 @@ list_append (List l, void *x)
 
 	assert(l != NULL);
 	assert(x != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 	v = _list_append_locked(l, x);
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -336,11 +396,11 @@ list_prepend (List l, void *x)
 
 	assert(l != NULL);
 	assert(x != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	v = list_node_create(l, &l->head, x);
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -356,7 +416,7 @@ list_find_first (List l, ListFindF f, void *key)
 	assert(l != NULL);
 	assert(f != NULL);
 	assert(key != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	for (p = l->head; p; p = p->next) {
@@ -365,7 +425,7 @@ list_find_first (List l, ListFindF f, void *key)
 			break;
 		}
 	}
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -381,7 +441,7 @@ list_delete_all (List l, ListFindF f, void *key)
 
 	assert(l != NULL);
 	assert(f != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	pp = &l->head;
@@ -397,7 +457,7 @@ list_delete_all (List l, ListFindF f, void *key)
 			pp = &(*pp)->next;
 		}
 	}
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -412,7 +472,7 @@ list_for_each (List l, ListForF f, void *arg)
 
 	assert(l != NULL);
 	assert(f != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	for (p = l->head; p; p = p->next) {
@@ -422,7 +482,7 @@ list_for_each (List l, ListForF f, void *arg)
 			break;
 		}
 	}
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -437,7 +497,7 @@ list_flush (List l)
 	int n = 0;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	pp = &l->head;
@@ -448,7 +508,7 @@ list_flush (List l)
 			n++;
 		}
 	}
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -462,11 +522,11 @@ list_push (List l, void *x)
 
 	assert(l != NULL);
 	assert(x != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	v = list_node_create(l, &l->head, x);
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -488,10 +548,10 @@ list_sort(List l, ListCmpF f)
 	assert(l != NULL);
 	assert(f != NULL);
 	assert(l->magic == LIST_MAGIC);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 
 	if (l->count <= 1) {
-		slurm_mutex_unlock(&l->mutex);
+		_list_unlock(l);
 		return;
 	}
 
@@ -521,7 +581,7 @@ list_sort(List l, ListCmpF f)
 		i->prev = &i->list->head;
 	}
 
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 }
 
 /* list_pop()
@@ -532,11 +592,11 @@ list_pop (List l)
 	void *v;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	v = _list_pop_locked(l);
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -549,11 +609,11 @@ list_peek (List l)
 	void *v;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	v = (l->head) ? l->head->data : NULL;
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -567,11 +627,11 @@ list_enqueue (List l, void *x)
 
 	assert(l != NULL);
 	assert(x != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	v = list_node_create(l, l->tail, x);
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -584,11 +644,11 @@ list_dequeue (List l)
 	void *v;
 
 	assert(l != NULL);
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	v = list_node_destroy(l, &l->head);
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -604,7 +664,7 @@ list_iterator_create (List l)
 	i = list_iterator_alloc();
 
 	i->list = l;
-	slurm_mutex_lock(&l->mutex);
+	_list_lock(l);
 	assert(l->magic == LIST_MAGIC);
 
 	i->pos = l->head;
@@ -613,7 +673,7 @@ list_iterator_create (List l)
 	l->iNext = i;
 	assert((i->magic = LIST_MAGIC));      /* set magic via assert abuse */
 
-	slurm_mutex_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return i;
 }
@@ -625,13 +685,13 @@ list_iterator_reset (ListIterator i)
 {
 	assert(i != NULL);
 	assert(i->magic == LIST_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
+	_list_lock(i->list);
 	assert(i->list->magic == LIST_MAGIC);
 
 	i->pos = i->list->head;
 	i->prev = &i->list->head;
 
-	slurm_mutex_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 }
 
 /* list_iterator_destroy()
@@ -643,7 +703,7 @@ list_iterator_destroy (ListIterator i)
 
 	assert(i != NULL);
 	assert(i->magic == LIST_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
+	_list_lock(i->list);
 	assert(i->list->magic == LIST_MAGIC);
 
 	for (pi = &i->list->iNext; *pi; pi = &(*pi)->iNext) {
@@ -653,7 +713,7 @@ list_iterator_destroy (ListIterator i)
 			break;
 		}
 	}
-	slurm_mutex_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	assert((i->magic = ~LIST_MAGIC));     /* clear magic via assert abuse */
 	list_iterator_free(i);
@@ -668,7 +728,7 @@ list_next (ListIterator i)
 
 	assert(i != NULL);
 	assert(i->magic == LIST_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
+	_list_lock(i->list);
 	assert(i->list->magic == LIST_MAGIC);
 
 	if ((p = i->pos))
@@ -676,7 +736,7 @@ list_next (ListIterator i)
 	if (*i->prev != p)
 		i->prev = &(*i->prev)->next;
 
-	slurm_mutex_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return (p ? p->data : NULL);
 }
@@ -690,12 +750,12 @@ list_peek_next (ListIterator i)
 
 	assert(i != NULL);
 	assert(i->magic == LIST_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
+	_list_lock(i->list);
 	assert(i->list->magic == LIST_MAGIC);
 
 	p = i->pos;
 
-	slurm_mutex_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return (p ? p->data : NULL);
 }
@@ -710,11 +770,11 @@ list_insert (ListIterator i, void *x)
 	assert(i != NULL);
 	assert(x != NULL);
 	assert(i->magic == LIST_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
+	_list_lock(i->list);
 	assert(i->list->magic == LIST_MAGIC);
 
 	v = list_node_create(i->list, i->prev, x);
-	slurm_mutex_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return v;
 }
@@ -745,12 +805,12 @@ list_remove (ListIterator i)
 
 	assert(i != NULL);
 	assert(i->magic == LIST_MAGIC);
-	slurm_mutex_lock(&i->list->mutex);
+	_list_lock(i->list);
 	assert(i->list->magic == LIST_MAGIC);
 
 	if (*i->prev != i->pos)
 		v = list_node_destroy(i->list, i->prev);
-	slurm_mutex_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return v;
 }
@@ -789,7 +849,7 @@ list_node_create (List l, ListNode *pp, void *x)
 
 	assert(l != NULL);
 	assert(l->magic == LIST_MAGIC);
-	assert(_list_mutex_is_locked(&l->mutex));
+	assert(!l->locked || _list_mutex_is_locked(&l->mutex));
 	assert(pp != NULL);
 	assert(x != NULL);
 
@@ -831,7 +891,7 @@ list_node_destroy (List l, ListNode *pp)
 
 	assert(l != NULL);
 	assert(l->magic == LIST_MAGIC);
-	assert(_list_mutex_is_locked(&l->mutex));
+	assert(!l->locked || _list_mutex_is_locked(&l->mutex));
 	assert(pp != NULL);
 
 	if (!(p = *pp))
@@ -861,7 +921,7 @@ list_node_destroy (List l, ListNode *pp)
 static List
 list_alloc (void)
 {
-	return(list_alloc_aux(sizeof(struct xlist), &list_free_lists));
+	return(list_alloc_aux(LIST_OBJ_LIST));
 }
 
 /* list_free()
@@ -869,7 +929,7 @@ list_alloc (void)
 static void
 list_free (List l)
 {
-	list_free_aux(l, &list_free_lists);
+	list_free_aux(l, LIST_OBJ_LIST);
 }
 
 /* list_node_alloc()
@@ -877,7 +937,7 @@ list_free (List l)
 static ListNode
 list_node_alloc (void)
 {
-	return(list_alloc_aux(sizeof(struct listNode), &list_free_nodes));
+	return(list_alloc_aux(LIST_OBJ_NODE));
 }
 
 /* list_node_free()
@@ -885,7 +945,7 @@ list_node_alloc (void)
 static void
 list_node_free (ListNode p)
 {
-	list_free_aux(p, &list_free_nodes);
+	list_free_aux(p, LIST_OBJ_NODE);
 }
 
 /* list_iterator_alloc()
@@ -893,7 +953,7 @@ list_node_free (ListNode p)
 static ListIterator
 list_iterator_alloc (void)
 {
-	return(list_alloc_aux(sizeof(struct listIterator), &list_free_iterators));
+	return(list_alloc_aux(LIST_OBJ_ITERATOR));
 }
 
 /* list_iterator_free()
@@ -901,67 +961,150 @@ list_iterator_alloc (void)
 static void
 list_iterator_free (ListIterator i)
 {
-	list_free_aux(i, &list_free_iterators);
+	list_free_aux(i, LIST_OBJ_ITERATOR);
 }
 
-/* list_alloc_aux()
+#ifndef MEMORY_LEAK_DEBUG
+/* _list_cache_drain()
  */
-static void *
-list_alloc_aux (int size, void *pfreelist)
+static void
+_list_cache_drain (list_cache_t *cache, list_obj_t type, int cnt)
 {
-/*  Allocates an object of [size] bytes from the freelist [*pfreelist].
- *  Memory is added to the freelist in chunks of size LIST_ALLOC.
- *  Returns a ptr to the object, or NULL if the memory request fails.
+/*  Returns the first [cnt] objects of [cache] to the shared freelist.
  */
-	void **px;
-	void **pfree = pfreelist;
-	void **plast;
+	void **px, **plast;
+	int n;
+
+	if (!(px = cache->head) || (cnt <= 0))
+		return;
+	for (plast = px, n = 1; (n < cnt) && *plast; n++)
+		plast = *plast;
+	cache->head = *plast;
+	cache->count -= n;
 
-	assert(sizeof(char) == 1);
-	assert(size >= sizeof(void *));
-	assert(pfreelist != NULL);
-	assert(LIST_ALLOC > 0);
 	slurm_mutex_lock(&list_free_lock);
+	*plast = list_free_objs[type];
+	list_free_objs[type] = px;
+	slurm_mutex_unlock(&list_free_lock);
+}
 
-	if (!*pfree) {
-		if ((*pfree = xmalloc(LIST_ALLOC * size))) {
-			px = *pfree;
-			plast = (void **) ((char *) *pfree + ((LIST_ALLOC - 1) * size));
-			while (px < plast)
-				*px = (char *) px + size, px = *px;
-			*plast = NULL;
-		}
+/* _list_cache_destroy()
+ */
+static void
+_list_cache_destroy (void *arg)
+{
+/*  Returns the cache of an exiting thread to the shared freelists.
+ */
+	int type;
+
+	for (type = 0; type < LIST_OBJ_CNT; type++)
+		_list_cache_drain(&list_cache[type], type,
+				  list_cache[type].count);
+	list_cache_registered = false;
+}
+
+static void
+_list_cache_key_create (void)
+{
+	if (pthread_key_create(&list_cache_key, _list_cache_destroy))
+		fatal("cannot create list cache key");
+}
+
+/* _list_cache_fill()
+ */
+static void
+_list_cache_fill (list_cache_t *cache, list_obj_t type)
+{
+/*  Moves up to LIST_CACHE_BATCH objects from the shared freelist to the
+ *  empty [cache], or carves a new chunk of LIST_ALLOC objects into it if
+ *  the shared freelist is empty.
+ */
+	void **px, **plast;
+	int size = list_obj_size[type];
+	int n;
+	arena_t *arena;
+
+	if (!list_cache_registered) {
+		pthread_once(&list_cache_once, _list_cache_key_create);
+		pthread_setspecific(list_cache_key, cache);
+		list_cache_registered = true;
+	}
+
+	slurm_mutex_lock(&list_free_lock);
+	if ((px = list_free_objs[type])) {
+		for (plast = px, n = 1; (n < LIST_CACHE_BATCH) && *plast; n++)
+			plast = *plast;
+		list_free_objs[type] = *plast;
+		*plast = NULL;
+		cache->head = px;
+		cache->count = n;
 	}
-	if ((px = *pfree))
-		*pfree = *px;
-	else
-		errno = ENOMEM;
 	slurm_mutex_unlock(&list_free_lock);
+	if (px)
+		return;
+
+	/* Cached objects live forever, so never carve them from an arena */
+	arena = arena_push(NULL);
+	px = xmalloc(LIST_ALLOC * size);
+	arena_pop(arena);
+	plast = (void **) ((char *) px + ((LIST_ALLOC - 1) * size));
+	cache->head = px;
+	cache->count = LIST_ALLOC;
+	while (px < plast)
+		*px = (char *) px + size, px = *px;
+	*plast = NULL;
+}
+#endif
+
+/* list_alloc_aux()
+ */
+static void *
+list_alloc_aux (list_obj_t type)
+{
+/*  Allocates an object of [type] from the calling thread's cache, refilling
+ *  it from the shared freelist as needed.
+ *  Returns a ptr to the object.
+ */
+#ifdef MEMORY_LEAK_DEBUG
+	return xmalloc(list_obj_size[type]);
+#else
+	list_cache_t *cache = &list_cache[type];
+	void **px;
+
+	assert(list_obj_size[type] >= sizeof(void *));
+	assert(LIST_ALLOC > LIST_CACHE_BATCH);
+
+	if (!cache->head)
+		_list_cache_fill(cache, type);
+	px = cache->head;
+	cache->head = *px;
+	cache->count--;
 
 	return px;
+#endif
 }
 
 /* list_free_aux()
  */
 static void
-list_free_aux (void *x, void *pfreelist)
+list_free_aux (void *x, list_obj_t type)
 {
-/*  Frees the object [x], returning it to the freelist [*pfreelist].
+/*  Frees the object [x], returning it to the calling thread's cache.
+ *  A cache grown past LIST_CACHE_MAX gives LIST_CACHE_BATCH objects back
+ *  to the shared freelist.
  */
 #ifdef MEMORY_LEAK_DEBUG
 	xfree(x);
 #else
+	list_cache_t *cache = &list_cache[type];
 	void **px = x;
-	void **pfree = pfreelist;
 
 	assert(x != NULL);
-	assert(pfreelist != NULL);
-	slurm_mutex_lock(&list_free_lock);
 
-	*px = *pfree;
-	*pfree = px;
-
-	slurm_mutex_unlock(&list_free_lock);
+	*px = cache->head;
+	cache->head = px;
+	if (++cache->count > LIST_CACHE_MAX)
+		_list_cache_drain(cache, type, LIST_CACHE_BATCH);
 #endif
 }
 
@@ -109,6 +109,14 @@ List list_create (ListDelF f);
  *    in a memory leak.
  */
 
+List list_create_unlocked (ListDelF f);
+/*
+ *  Same as list_create(), but the list does no locking of its own.
+ *  Use it for lists that only one thread at a time can reach, such as
+ *    temporary lists built and consumed by a single function, to avoid
+ *    the cost of a mutex operation on every list call.
+ */
+
 void list_destroy (List l);
 /*
  *  Destroys list [l], freeing memory used for list iterators and the
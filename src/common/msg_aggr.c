@@ -64,6 +64,7 @@ typedef struct {
 	pthread_mutex_t	mutex;
 	slurm_addr_t    node_addr;
 	bool            running;
+	uint64_t        start_usec;
 	pthread_t       thread_id;
 	uint64_t        window;
 } msg_collection_type_t;
@@ -231,6 +232,7 @@ static void * _msg_aggregation_sender(void *arg)
 
 		memcpy(&cmp.sender, &msg_collection.node_addr,
 		       sizeof(slurm_addr_t));
+		cmp.start_usec = msg_collection.start_usec;
 		cmp.msg_list = msg_collection.msg_list;
 
 		msg_collection.msg_list =
@@ -350,8 +352,14 @@ extern void msg_aggr_add_msg(slurm_msg_t *msg, bool wait,
 
 
 	/* First msg in collection; initiate new window */
-	if (count == 1)
+	if (count == 1) {
+		struct timeval now;
+
+		gettimeofday(&now, NULL);
+		msg_collection.start_usec = (uint64_t) now.tv_sec * 1000000 +
+					    now.tv_usec;
 		slurm_cond_signal(&msg_collection.cond);
+	}
 
 	/* Max msgs reached; terminate window */
 	if (count >= msg_collection.max_msg_cnt) {
@@ -835,9 +835,10 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 			     bitstr_t **bitmap)
 {
 	int rc = SLURM_SUCCESS;
-	char *this_node_name;
+	char this_node_name[HOSTLIST_NAME_SIZE];
 	bitstr_t *my_bitmap;
 	hostlist_t host_list;
+	hostlist_iterator_t hi;
 
 	my_bitmap = (bitstr_t *) bit_alloc (node_record_count);
 	*bitmap = my_bitmap;
@@ -855,7 +856,9 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 		return rc;
 	}
 
-	while ( (this_node_name = hostlist_shift (host_list)) ) {
+	hi = hostlist_iterator_create(host_list);
+	while (hostlist_next_buf(hi, this_node_name,
+				 sizeof(this_node_name)) >= 0) {
 		struct node_record *node_ptr;
 		node_ptr = _find_node_record(this_node_name, best_effort, true);
 		if (node_ptr) {
@@ -867,8 +870,8 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 			if (!best_effort)
 				rc = EINVAL;
 		}
-		free (this_node_name);
 	}
+	hostlist_iterator_destroy(hi);
 	hostlist_destroy (host_list);
 
 	return rc;
@@ -885,7 +888,7 @@ extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 {
 	int rc = SLURM_SUCCESS;
 	bitstr_t *my_bitmap;
-	char *name;
+	char name[HOSTLIST_NAME_SIZE];
 	hostlist_iterator_t hi;
 
 	FREE_NULL_BITMAP(*bitmap);
@@ -893,7 +896,7 @@ extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 	*bitmap = my_bitmap;
 
 	hi = hostlist_iterator_create(hl);
-	while ((name = hostlist_next(hi)) != NULL) {
+	while (hostlist_next_buf(hi, name, sizeof(name)) >= 0) {
 		struct node_record *node_ptr;
 		node_ptr = _find_node_record(name, best_effort, true);
 		if (node_ptr) {
@@ -905,7 +908,6 @@ extern int hostlist2bitmap (hostlist_t hl, bool best_effort, bitstr_t **bitmap)
 			if (!best_effort)
 				rc = EINVAL;
 		}
-		free (name);
 	}
 
 	hostlist_iterator_destroy(hi);
@@ -104,6 +104,7 @@ strong_alias(run_in_daemon, slurm_run_in_daemon);
  */
 slurm_ctl_conf_t slurmctld_conf;
 bool ignore_state_errors = false;
+uint32_t compress_msg_size = 0;
 
 #ifndef NDEBUG
 uint16_t drop_priv_flag = 0;
@@ -3485,7 +3486,7 @@ static uint16_t _health_node_state(char *state_str)
 static int
 _validate_and_set_defaults(slurm_ctl_conf_t *conf, s_p_hashtbl_t *hashtbl)
 {
-	char *temp_str = NULL;
+	char *temp_str = NULL, *size_str;
 	long long_suspend_time;
 	bool truth;
 	char *default_storage_type = NULL, *default_storage_host = NULL;
@@ -3585,6 +3586,10 @@ _validate_and_set_defaults(slurm_ctl_conf_t *conf, s_p_hashtbl_t *hashtbl)
 
 	(void) s_p_get_string(&conf->comm_params, "CommunicationParameters",
 			      hashtbl);
+	if ((size_str = xstrcasestr(conf->comm_params, "CompressMsgSize=")))
+		compress_msg_size = strtoul(size_str + 16, NULL, 10);
+	else
+		compress_msg_size = 0;
 
 	if (!s_p_get_string(&conf->core_spec_plugin, "CoreSpecPlugin",
 	    hashtbl)) {
@@ -55,6 +55,12 @@ extern char *default_slurm_config_file;
 extern char *default_plugin_path;
 extern char *default_plugstack;
 
+/*
+ * CommunicationParameters=CompressMsgSize, the smallest message body to
+ * compress, 0 if compression is disabled. Set when slurm.conf is (re)read.
+ */
+extern uint32_t compress_msg_size;
+
 #ifndef NDEBUG
 extern uint16_t drop_priv_flag;
 #endif
@@ -52,7 +52,10 @@
 
 typedef enum {
 	ACCT_STORAGE_INFO_CONN_ACTIVE,
-	ACCT_STORAGE_INFO_AGENT_COUNT
+	ACCT_STORAGE_INFO_AGENT_COUNT,
+	ACCT_STORAGE_INFO_AGENT_BYTES,
+	ACCT_STORAGE_INFO_AGENT_SPOOL_COUNT,
+	ACCT_STORAGE_INFO_AGENT_SPOOL_BYTES
 } acct_storage_info_t;
 
 extern int with_slurmdbd;
@@ -93,6 +96,16 @@ extern int acct_storage_g_close_connection(void **db_conn);
  */
 extern int acct_storage_g_commit(void *db_conn, bool commit);
 
+/*
+ * allow or stop deferring statements until the next commit. Errors of
+ * deferred statements are only reported by acct_storage_g_commit(), so only
+ * allow it when the caller checks the commit before acknowledging anything.
+ * IN: void * pointer returned from acct_storage_g_get_connection()
+ * IN: bool - true to allow deferring statements
+ * RET: SLURM_SUCCESS on success SLURM_ERROR else
+ */
+extern int acct_storage_g_batch(void *db_conn, bool batch);
+
 /*
  * add users to accounting system
  * IN:  user_list List of slurmdb_user_rec_t *
@@ -55,7 +55,12 @@
 #include <time.h>
 #include <unistd.h>
 
+#if HAVE_LZ4
+#  include <lz4.h>
+#endif
+
 /* PROJECT INCLUDES */
+#include "src/common/arena.h"
 #include "src/common/assoc_mgr.h"
 #include "src/common/fd.h"
 #include "src/common/forward.h"
@@ -88,6 +93,7 @@ strong_alias(get_unit_type, slurm_get_unit_type);
 /* #DEFINES */
 #define _DEBUG	0
 #define MAX_SHUTDOWN_RETRY 5
+#define MSG_ARENA_BLOCK_SIZE (16 * 1024)	/* see _unpack_msg_body() */
 
 /* STATIC VARIABLES */
 /* static pthread_mutex_t config_lock = PTHREAD_MUTEX_INITIALIZER; */
@@ -99,6 +105,8 @@ static char *_global_auth_key(void);
 static void  _remap_slurmctld_errno(void);
 static int   _unpack_msg_uid(Buf buffer, uint16_t protocol_version);
 static bool  _is_port_ok(int, uint16_t, bool);
+static int   _uncompress_msg_body(header_t *header, Buf buffer);
+static int   _unpack_msg_body(slurm_msg_t *msg, Buf buffer, bool use_arena);
 
 #if _DEBUG
 static void _print_data(char *data, int len);
@@ -3237,6 +3245,7 @@ extern int slurm_unpack_received_msg(slurm_msg_t *msg, int fd, Buf buffer)
 	header_t header;
 	int rc;
 	void *auth_cred = NULL;
+	bool use_arena = (msg->flags & SLURM_MSG_USE_ARENA);
 
 	if (unpack_header(&header, buffer) == SLURM_ERROR) {
 		rc = SLURM_COMMUNICATIONS_RECEIVE_ERROR;
@@ -3300,6 +3309,11 @@ extern int slurm_unpack_received_msg(slurm_msg_t *msg, int fd, Buf buffer)
 		goto total_return;
 	}
 
+	if ((rc = _uncompress_msg_body(&header, buffer))) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		goto total_return;
+	}
+
 	/*
 	 * Unpack message body
 	 */
@@ -3310,7 +3324,7 @@ extern int slurm_unpack_received_msg(slurm_msg_t *msg, int fd, Buf buffer)
 	msg->body_offset =  get_buf_offset(buffer);
 
 	if ((header.body_length > remaining_buf(buffer)) ||
-	    (unpack_msg(msg, buffer) != SLURM_SUCCESS)) {
+	    (_unpack_msg_body(msg, buffer, use_arena) != SLURM_SUCCESS)) {
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
 		(void) g_slurm_auth_destroy(auth_cred);
 		goto total_return;
@@ -3572,6 +3586,12 @@ List slurm_receive_msgs(int fd, int steps, int timeout)
 		goto total_return;
 	}
 
+	if ((rc = _uncompress_msg_body(&header, buffer))) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		free_buf(buffer);
+		goto total_return;
+	}
+
 	/*
 	 * Unpack message body
 	 */
@@ -3806,6 +3826,12 @@ int slurm_receive_msg_and_forward(int fd, slurm_addr_t *orig_addr,
 		goto total_return;
 	}
 
+	if ((rc = _uncompress_msg_body(&header, buffer))) {
+		(void) g_slurm_auth_destroy(auth_cred);
+		free_buf(buffer);
+		goto total_return;
+	}
+
 	/*
 	 * Unpack message body
 	 */
@@ -3852,18 +3878,126 @@ total_return:
  * send message functions
 \**********************************************************************/
 
+/*
+ * LZ4 compress the message body if the receiver can read it back and it is
+ * at least CommunicationParameters=CompressMsgSize bytes. The compressed body
+ * is the uncompressed size followed by a single LZ4 block, and the header in
+ * buffer is repacked with SLURM_MSG_COMPRESSED and the new body length.
+ * IN/OUT body - message body to send, replaced by the compressed body
+ * RET compressed body for the caller to xfree(), NULL if not compressed
+ */
+static char *_compress_msg_body(slurm_msg_t *msg, header_t *hdr, Buf buffer,
+				struct iovec *body)
+{
+#if HAVE_LZ4
+	uint32_t min_size, out_size, tmplen;
+	int rc;
+	char *out;
+
+	if (!(msg->flags & SLURM_MSG_ACCEPT_COMPRESS) ||
+	    (hdr->version < SLURM_19_05_PROTOCOL_VERSION) ||
+	    (body->iov_len > LZ4_MAX_INPUT_SIZE))
+		return NULL;
+	if (slurmdbd_conf || !(min_size = compress_msg_size) ||
+	    (body->iov_len < min_size))
+		return NULL;
+
+	out_size = LZ4_compressBound(body->iov_len) + sizeof(uint32_t);
+	out = xmalloc_nz(out_size);
+	rc = LZ4_compress_default(body->iov_base, out + sizeof(uint32_t),
+				  body->iov_len, out_size - sizeof(uint32_t));
+	if ((rc <= 0) || ((rc + sizeof(uint32_t)) >= body->iov_len)) {
+		xfree(out);
+		return NULL;
+	}
+	debug3("%s: %s body %zu bytes compressed to %d", __func__,
+	       rpc_num2string(msg->msg_type), body->iov_len, rc);
+
+	tmplen = htonl(body->iov_len);
+	memcpy(out, &tmplen, sizeof(uint32_t));
+	body->iov_base = out;
+	body->iov_len = rc + sizeof(uint32_t);
+
+	hdr->flags |= SLURM_MSG_COMPRESSED;
+	update_header(hdr, body->iov_len);
+	tmplen = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	pack_header(hdr, buffer);
+	set_buf_offset(buffer, tmplen);
+
+	return out;
+#else
+	return NULL;
+#endif
+}
+
+/*
+ * Replace a compressed message body at the current offset of buffer (see
+ * _compress_msg_body()) with its uncompressed contents. The data before the
+ * body is kept so that the offsets into buffer remain valid.
+ * RET SLURM_SUCCESS or ESLURM_PROTOCOL_INCOMPLETE_PACKET
+ */
+static int _uncompress_msg_body(header_t *header, Buf buffer)
+{
+#if HAVE_LZ4
+	uint32_t offset = get_buf_offset(buffer), size;
+	char *data;
+	int rc;
+#endif
+
+	if (!(header->flags & SLURM_MSG_COMPRESSED))
+		return SLURM_SUCCESS;
+	header->flags &= ~SLURM_MSG_COMPRESSED;
+
+#if HAVE_LZ4
+	if ((header->body_length > remaining_buf(buffer)) ||
+	    (header->body_length < sizeof(uint32_t)))
+		return ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+	memcpy(&size, &buffer->head[offset], sizeof(uint32_t));
+	size = ntohl(size);
+	if ((size > LZ4_MAX_INPUT_SIZE) || (size > (MAX_BUF_SIZE - offset)))
+		return ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+
+	data = xmalloc_nz(offset + size);
+	memcpy(data, buffer->head, offset);
+	rc = LZ4_decompress_safe(&buffer->head[offset + sizeof(uint32_t)],
+				 &data[offset],
+				 header->body_length - sizeof(uint32_t), size);
+	if (rc != size) {
+		error("%s: lz4 decompression error", __func__);
+		xfree(data);
+		return ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+	}
+
+	xfree(buffer->head);
+	buffer->head = data;
+	buffer->size = offset + size;
+	header->body_length = size;
+	return SLURM_SUCCESS;
+#else
+	error("%s: received lz4 compressed message, but lz4 is not supported",
+	      __func__);
+	return ESLURM_PROTOCOL_INCOMPLETE_PACKET;
+#endif
+}
+
 /*
  *  Do the wonderful stuff that needs be done to pack msg
  *  and hdr into buffer
  */
 static void
-_pack_msg(slurm_msg_t *msg, header_t *hdr, Buf buffer)
+_pack_msg(slurm_msg_t *msg, header_t *hdr, Buf buffer, bool prepacked)
 {
 	unsigned int tmplen, msglen;
 
-	tmplen = get_buf_offset(buffer);
-	pack_msg(msg, buffer);
-	msglen = get_buf_offset(buffer) - tmplen;
+	if (prepacked) {
+		/* Body is sent from msg->data, see slurm_send_node_msg() */
+		msglen = msg->data_size;
+	} else {
+		tmplen = get_buf_offset(buffer);
+		pack_msg(msg, buffer);
+		msglen = get_buf_offset(buffer) - tmplen;
+	}
 
 	/* update header with correct cred and msg lengths */
 	update_header(hdr, msglen);
@@ -3886,6 +4020,10 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 	int      rc;
 	void *   auth_cred;
 	time_t   start_time = time(NULL);
+	bool     prepacked;
+	uint32_t body_offset;
+	char    *compressed;
+	struct iovec iov[2];
 
 	if (msg->conn) {
 		persist_msg_t persist_msg;
@@ -3963,6 +4101,11 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 	}
 
 	init_header(&header, msg, msg->flags);
+#if HAVE_LZ4
+	/* Let the receiver compress its response to this message */
+	if (header.version >= SLURM_19_05_PROTOCOL_VERSION)
+		header.flags |= SLURM_MSG_ACCEPT_COMPRESS;
+#endif
 
 	/*
 	 * Pack header into buffer for transmission
@@ -3983,18 +4126,33 @@ int slurm_send_node_msg(int fd, slurm_msg_t * msg)
 	}
 
 	/*
-	 * Pack message into buffer
+	 * Pack message into buffer. A body packed ahead of time, such as the
+	 * job or node information dumps that can reach hundreds of MB, is not
+	 * copied into the buffer but sent from msg->data right after it.
 	 */
-	_pack_msg(msg, &header, buffer);
+	body_offset = get_buf_offset(buffer);
+	prepacked = pack_msg_is_prepacked(msg);
+	_pack_msg(msg, &header, buffer, prepacked);
 
 #if	_DEBUG
 	_print_data (get_buf_data(buffer),get_buf_offset(buffer));
 #endif
+	iov[0].iov_base = get_buf_data(buffer);
+	iov[0].iov_len = body_offset;
+	if (prepacked) {
+		iov[1].iov_base = msg->data;
+		iov[1].iov_len = msg->data_size;
+	} else {
+		iov[1].iov_base = get_buf_data(buffer) + body_offset;
+		iov[1].iov_len = get_buf_offset(buffer) - body_offset;
+	}
+	compressed = _compress_msg_body(msg, &header, buffer, &iov[1]);
+
 	/*
 	 * Send message
 	 */
-	rc = slurm_msg_sendto(fd, get_buf_data(buffer),
-			      get_buf_offset(buffer));
+	rc = slurm_msg_sendv(fd, iov, 2);
+	xfree(compressed);
 
 	if ((rc < 0) && (errno == ENOTCONN)) {
 		debug3("slurm_msg_sendto: peer has disappeared for msg_type=%u",
@@ -5382,3 +5540,38 @@ extern int slurm_char_to_hex(int c)
 	else
 		return -1;
 }
+
+/*
+ * Message types unpacked into an arena when the receiver sets
+ * SLURM_MSG_USE_ARENA. Their bodies are hundreds of small allocations, and
+ * the handlers copy what they keep, so the arena is freed with the message.
+ */
+static bool _arena_msg_type(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_JOB_WILL_RUN:
+	case REQUEST_RESOURCE_ALLOCATION:
+	case REQUEST_SUBMIT_BATCH_JOB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static int _unpack_msg_body(slurm_msg_t *msg, Buf buffer, bool use_arena)
+{
+	arena_t *arena, *prev;
+	int rc;
+
+	if (!use_arena || !_arena_msg_type(msg->msg_type))
+		return unpack_msg(msg, buffer);
+
+	arena = arena_create(MSG_ARENA_BLOCK_SIZE);
+	prev = arena_push(arena);
+	rc = unpack_msg(msg, buffer);
+	arena_pop(prev);
+	/* The blocks are freed once slurm_free_msg_data() has run */
+	arena_destroy(arena);
+
+	return rc;
+}
@@ -109,6 +109,9 @@
 #define SLURMDBD_CONNECTION     0x0002
 #define SLURM_MSG_KEEP_BUFFER   0x0004
 #define SLURM_DROP_PRIV		0x0008
+#define SLURM_MSG_ACCEPT_COMPRESS 0x0010 /* sender can read compressed body */
+#define SLURM_MSG_COMPRESSED	0x0020	/* body is LZ4 compressed */
+#define SLURM_MSG_USE_ARENA	0x0040	/* receiver may unpack into an arena */
 
 #include "src/common/slurm_protocol_socket_common.h"
 
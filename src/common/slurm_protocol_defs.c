@@ -998,8 +998,7 @@ extern void slurm_free_job_info_members(job_info_t * job)
 	if (job) {
 		xfree(job->account);
 		xfree(job->alloc_node);
-		if (job->array_bitmap)
-			bit_free((bitstr_t *) job->array_bitmap);
+		FREE_NULL_BITMAP(job->array_bitmap);
 		xfree(job->array_task_str);
 		xfree(job->batch_features);
 		xfree(job->batch_host);
@@ -1547,9 +1546,15 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 		xfree(msg->rpc_type_id);
 		xfree(msg->rpc_type_cnt);
 		xfree(msg->rpc_type_time);
+		xfree(msg->rpc_type_max);
+		xfree(msg->rpc_type_p50);
+		xfree(msg->rpc_type_p99);
 		xfree(msg->rpc_user_id);
 		xfree(msg->rpc_user_cnt);
 		xfree(msg->rpc_user_time);
+		xfree(msg->rpc_user_max);
+		xfree(msg->rpc_user_p50);
+		xfree(msg->rpc_user_p99);
 		xfree(msg->rpc_queue_type_id);
 		xfree(msg->rpc_queue_count);
 		xfree(msg->rpc_dump_types);
@@ -1557,6 +1562,26 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 			xfree(msg->rpc_dump_hostlist[i]);
 		}
 		xfree(msg->rpc_dump_hostlist);
+		for (i = 0; i < msg->lock_stat_size; i++) {
+			xfree(msg->lock_stat_name[i]);
+		}
+		xfree(msg->lock_stat_name);
+		xfree(msg->lock_acquire_cnt);
+		xfree(msg->lock_wait_time);
+		xfree(msg->lock_wait_max);
+		xfree(msg->lock_hold_time);
+		xfree(msg->lock_hold_max);
+		xfree(msg->lock_hold_hist);
+		for (i = 0; i < msg->rpc_class_size; i++) {
+			xfree(msg->rpc_class_name[i]);
+		}
+		xfree(msg->rpc_class_name);
+		xfree(msg->rpc_class_depth);
+		xfree(msg->rpc_class_depth_max);
+		xfree(msg->rpc_class_active);
+		xfree(msg->rpc_class_cnt);
+		xfree(msg->rpc_class_wait_time);
+		xfree(msg->rpc_class_wait_max);
 		xfree(msg);
 	}
 }
@@ -3941,6 +3966,7 @@ extern void slurm_free_job_info_msg(job_info_msg_t * job_buffer_ptr)
 			_free_all_job_info(job_buffer_ptr);
 			xfree(job_buffer_ptr->job_array);
 		}
+		xfree(job_buffer_ptr->removed_job_id);
 		xfree(job_buffer_ptr);
 	}
 }
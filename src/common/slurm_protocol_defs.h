@@ -919,6 +919,8 @@ typedef struct network_callerid_resp {
 
 typedef struct composite_msg {
 	slurm_addr_t sender;	/* address of sending node/port */
+	uint64_t start_usec;	/* time the first message was collected,
+				 * microseconds since the epoch */
 	List	 msg_list;
 } composite_msg_t;
 
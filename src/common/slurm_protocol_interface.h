@@ -48,6 +48,7 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include "src/common/macros.h"
@@ -104,6 +105,22 @@ extern ssize_t slurm_msg_sendto_timeout(int open_fd,
 					size_t size,
 					int timeout);
 
+/* slurm_msg_sendv
+ * Send one message made of several buffers over the given connection with a
+ * single length header and without first copying them together, default
+ * timeout value
+ * IN open_fd - an open file descriptor
+ * IN iov - buffers to transmit, in order
+ * IN iovcnt - number of buffers, at most SLURM_MSG_IOV_MAX
+ * RET number of bytes written
+ */
+#define SLURM_MSG_IOV_MAX 4
+extern ssize_t slurm_msg_sendv(int open_fd, struct iovec *iov, int iovcnt);
+/* slurm_msg_sendv_timeout is identical to slurm_msg_sendv except
+ * IN timeout - maximum time to wait for a message in milliseconds */
+extern ssize_t slurm_msg_sendv_timeout(int open_fd, struct iovec *iov,
+				       int iovcnt, int timeout);
+
 /********************/
 /* stream functions */
 /********************/
@@ -141,6 +158,10 @@ extern int slurm_get_stream_addr(int open_fd, slurm_addr_t *address);
 
 extern int slurm_send_timeout(int open_fd, char *buffer, size_t size,
 			      uint32_t flags, int timeout);
+/* As slurm_send_timeout() for the buffers in iov, which is advanced past the
+ * data sent */
+extern int slurm_sendv_timeout(int open_fd, struct iovec *iov, int iovcnt,
+			       uint32_t flags, int timeout);
 extern int slurm_recv_timeout(int open_fd, char *buffer, size_t size,
 			      uint32_t flags, int timeout);
 
@@ -45,6 +45,7 @@
 
 #include "src/common/assoc_mgr.h"
 #include "src/common/bitstring.h"
+#include "src/common/cbitstring.h"
 #include "src/common/forward.h"
 #include "src/common/job_options.h"
 #include "src/common/log.h"
@@ -1579,6 +1580,26 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 	return SLURM_SUCCESS;
 }
 
+extern bool pack_msg_is_prepacked(slurm_msg_t const *msg)
+{
+	switch (msg->msg_type) {
+	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_STEP_INFO:
+	case RESPONSE_BURST_BUFFER_INFO:
+	case RESPONSE_FRONT_END_INFO:
+	case RESPONSE_NODE_INFO:
+	case RESPONSE_PARTITION_INFO:
+	case RESPONSE_STATS_INFO:
+	case RESPONSE_RESERVATION_INFO:
+	case RESPONSE_LAYOUT_INFO:
+	case RESPONSE_ASSOC_MGR_INFO:
+	case RESPONSE_LICENSE_INFO:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /* unpack_msg
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
@@ -4776,6 +4797,8 @@ _pack_composite_msg(composite_msg_t *msg, Buf buffer, uint16_t protocol_version)
 	pack32(count, buffer);
 
 	slurm_pack_slurm_addr(&msg->sender, buffer);
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION)
+		pack64(msg->start_usec, buffer);
 	if (count && count != NO_VAL) {
 		itr = list_iterator_create(msg->msg_list);
 		while ((tmp_info = list_next(itr))) {
@@ -4840,6 +4863,8 @@ _unpack_composite_msg(composite_msg_t **msg, Buf buffer,
 	*msg = object_ptr;
 	safe_unpack32(&count, buffer);
 	slurm_unpack_slurm_addr_no_alloc(&object_ptr->sender, buffer);
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION)
+		safe_unpack64(&object_ptr->start_usec, buffer);
 
 	if (count > NO_VAL)
 		goto unpack_error;
@@ -5562,6 +5587,11 @@ _unpack_job_info_msg(job_info_msg_t ** msg, Buf buffer,
 						     protocol_version))
 				goto unpack_error;
 		}
+		if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+			safe_unpack16(&(*msg)->delta, buffer);
+			safe_unpack32_array(&(*msg)->removed_job_id,
+					    &(*msg)->removed_cnt, buffer);
+		}
 	} else {
 		error("_unpack_job_info_msg: protocol_version "
 		      "%hu not supported", protocol_version);
@@ -5757,7 +5787,11 @@ _unpack_job_info_members(job_info_t * job, Buf buffer,
 
 		safe_unpackstr_xmalloc(&job->alloc_node, &uint32_tmp, buffer);
 
-		unpack_bit_str_hex_as_inx(&job->node_inx, buffer);
+		if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+			if (unpack_cbitstr_as_inx(&job->node_inx, buffer))
+				goto unpack_error;
+		} else
+			unpack_bit_str_hex_as_inx(&job->node_inx, buffer);
 
 		if (select_g_select_jobinfo_unpack(&job->select_jobinfo,
 						   buffer, protocol_version))
@@ -13546,7 +13580,159 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 	msg = xmalloc ( sizeof (stats_info_response_msg_t) );
 	*msg_ptr = msg ;
 
-	if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+		safe_unpack32(&msg->parts_packed,	buffer);
+		if (msg->parts_packed) {
+			safe_unpack_time(&msg->req_time,	buffer);
+			safe_unpack_time(&msg->req_time_start,	buffer);
+			safe_unpack32(&msg->server_thread_count,buffer);
+			safe_unpack32(&msg->agent_queue_size,	buffer);
+			safe_unpack32(&msg->agent_count,	buffer);
+			safe_unpack32(&msg->dbd_agent_queue_size, buffer);
+			safe_unpack32(&msg->gettimeofday_latency, buffer);
+			safe_unpack32(&msg->jobs_submitted,	buffer);
+			safe_unpack32(&msg->jobs_started,	buffer);
+			safe_unpack32(&msg->jobs_completed,	buffer);
+			safe_unpack32(&msg->jobs_canceled,	buffer);
+			safe_unpack32(&msg->jobs_failed,	buffer);
+
+			safe_unpack32(&msg->jobs_pending,	buffer);
+			safe_unpack32(&msg->jobs_running,	buffer);
+			safe_unpack_time(&msg->job_states_ts,	buffer);
+
+			safe_unpack32(&msg->schedule_cycle_max,	buffer);
+			safe_unpack32(&msg->schedule_cycle_last,buffer);
+			safe_unpack32(&msg->schedule_cycle_sum,	buffer);
+			safe_unpack32(&msg->schedule_cycle_counter, buffer);
+			safe_unpack32(&msg->schedule_cycle_depth, buffer);
+			safe_unpack32(&msg->schedule_queue_len,	buffer);
+
+			safe_unpack32(&msg->bf_backfilled_jobs,	buffer);
+			safe_unpack32(&msg->bf_last_backfilled_jobs, buffer);
+			safe_unpack32(&msg->bf_cycle_counter,	buffer);
+			safe_unpack64(&msg->bf_cycle_sum,	buffer);
+			safe_unpack32(&msg->bf_cycle_last,	buffer);
+			safe_unpack32(&msg->bf_last_depth,	buffer);
+			safe_unpack32(&msg->bf_last_depth_try,	buffer);
+
+			safe_unpack32(&msg->bf_queue_len,	buffer);
+			safe_unpack32(&msg->bf_cycle_max,	buffer);
+			safe_unpack_time(&msg->bf_when_last_cycle, buffer);
+			safe_unpack32(&msg->bf_depth_sum,	buffer);
+			safe_unpack32(&msg->bf_depth_try_sum,	buffer);
+			safe_unpack32(&msg->bf_queue_len_sum,	buffer);
+
+			safe_unpack32(&msg->bf_active,		buffer);
+			safe_unpack32(&msg->bf_backfilled_pack_jobs, buffer);
+
+			safe_unpack32(&msg->comp_batch_cnt,	buffer);
+			safe_unpack32(&msg->comp_batch_msgs,	buffer);
+			safe_unpack32(&msg->comp_batch_max,	buffer);
+
+			safe_unpack32(&msg->msg_aggr_cnt,	buffer);
+			safe_unpack32(&msg->msg_aggr_msgs,	buffer);
+			safe_unpack32(&msg->msg_aggr_fanin_max,	buffer);
+			safe_unpack32(&msg->msg_aggr_depth_max,	buffer);
+			safe_unpack64(&msg->msg_aggr_latency_sum, buffer);
+			safe_unpack64(&msg->msg_aggr_latency_max, buffer);
+
+			safe_unpack64(&msg->dbd_agent_queue_bytes, buffer);
+			safe_unpack32(&msg->dbd_agent_spool_cnt, buffer);
+			safe_unpack64(&msg->dbd_agent_spool_bytes, buffer);
+		}
+
+		safe_unpack32(&msg->rpc_type_size,		buffer);
+		safe_unpack16_array(&msg->rpc_type_id,   &uint32_tmp, buffer);
+		safe_unpack32_array(&msg->rpc_type_cnt,  &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_type_time, &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_type_max,  &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_type_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_type_p50,  &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_type_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_type_p99,  &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_type_size)
+			goto unpack_error;
+
+		safe_unpack32(&msg->rpc_user_size,		buffer);
+		safe_unpack32_array(&msg->rpc_user_id,   &uint32_tmp, buffer);
+		safe_unpack32_array(&msg->rpc_user_cnt,  &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_user_time, &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_user_max,  &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_user_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_user_p50,  &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_user_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_user_p99,  &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_user_size)
+			goto unpack_error;
+
+		safe_unpack32_array(&msg->rpc_queue_type_id,
+				    &msg->rpc_queue_type_count,
+				    buffer);
+		safe_unpack32_array(&msg->rpc_queue_count,
+				    &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_queue_type_count)
+			goto unpack_error;
+
+		safe_unpack32_array(&msg->rpc_dump_types,
+				    &msg->rpc_dump_count,
+				    buffer);
+		safe_unpackstr_array(&msg->rpc_dump_hostlist,
+				     &uint32_tmp,
+				     buffer);
+		if (uint32_tmp != msg->rpc_dump_count)
+			goto unpack_error;
+
+		safe_unpackstr_array(&msg->lock_stat_name,
+				     &msg->lock_stat_size, buffer);
+		safe_unpack64_array(&msg->lock_acquire_cnt, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->lock_stat_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_wait_time, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->lock_stat_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_wait_max, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->lock_stat_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_hold_time, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->lock_stat_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_hold_max, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->lock_stat_size)
+			goto unpack_error;
+		safe_unpack32(&msg->lock_hist_size,		buffer);
+		safe_unpack64_array(&msg->lock_hold_hist, &uint32_tmp, buffer);
+		if (uint32_tmp != (msg->lock_stat_size * msg->lock_hist_size))
+			goto unpack_error;
+
+		safe_unpack32(&msg->rpc_worker_cnt,		buffer);
+		safe_unpackstr_array(&msg->rpc_class_name,
+				     &msg->rpc_class_size, buffer);
+		safe_unpack32_array(&msg->rpc_class_depth, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_class_size)
+			goto unpack_error;
+		safe_unpack32_array(&msg->rpc_class_depth_max, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->rpc_class_size)
+			goto unpack_error;
+		safe_unpack32_array(&msg->rpc_class_active, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_class_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_class_cnt, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_class_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_class_wait_time, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->rpc_class_size)
+			goto unpack_error;
+		safe_unpack64_array(&msg->rpc_class_wait_max, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->rpc_class_size)
+			goto unpack_error;
+	} else if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
 		safe_unpack32(&msg->parts_packed,	buffer);
 		if (msg->parts_packed) {
 			safe_unpack_time(&msg->req_time,	buffer);
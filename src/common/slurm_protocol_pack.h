@@ -80,6 +80,14 @@ extern int unpack_header ( header_t * header , Buf buffer );
  */
 extern int pack_msg ( slurm_msg_t const * msg , Buf buffer );
 
+/* pack_msg_is_prepacked
+ * IN msg - message to be packed
+ * RET true if the body of msg was packed by the sender ahead of time (e.g.
+ *	the job information dump in msg->data), in which case pack_msg()
+ *	copies the msg->data_size bytes of msg->data unchanged
+ */
+extern bool pack_msg_is_prepacked(slurm_msg_t const *msg);
+
 /* unpack_msg
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
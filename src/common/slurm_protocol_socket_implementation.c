@@ -61,6 +61,7 @@
 #include "src/common/log.h"
 #include "src/common/fd.h"
 #include "src/common/strlcpy.h"
+#include "src/common/xassert.h"
 #include "src/common/xsignal.h"
 #include "src/common/xstring.h"
 #include "src/common/xmalloc.h"
@@ -171,28 +172,49 @@ extern ssize_t slurm_msg_sendto(int fd, char *buffer, size_t size)
 ssize_t slurm_msg_sendto_timeout(int fd, char *buffer,
 				 size_t size, int timeout)
 {
-	int   len;
+	struct iovec iov;
+
+	iov.iov_base = buffer;
+	iov.iov_len = size;
+	return slurm_msg_sendv_timeout(fd, &iov, 1, timeout);
+}
+
+extern ssize_t slurm_msg_sendv(int fd, struct iovec *iov, int iovcnt)
+{
+	return slurm_msg_sendv_timeout(fd, iov, iovcnt,
+				       (slurm_get_msg_timeout() * 1000));
+}
+
+ssize_t slurm_msg_sendv_timeout(int fd, struct iovec *iov, int iovcnt,
+				int timeout)
+{
+	int   len, i;
 	uint32_t usize;
+	size_t size = 0;
+	struct iovec msg_iov[SLURM_MSG_IOV_MAX + 1];
 	SigFunc *ohandler;
 
+	xassert((iovcnt > 0) && (iovcnt <= SLURM_MSG_IOV_MAX));
+
+	/* Send the length header and all buffers with the same calls */
+	for (i = 0; i < iovcnt; i++) {
+		size += iov[i].iov_len;
+		msg_iov[i + 1] = iov[i];
+	}
+	usize = htonl(size);
+	msg_iov[0].iov_base = &usize;
+	msg_iov[0].iov_len = sizeof(usize);
+
 	/*
 	 *  Ignore SIGPIPE so that send can return a error code if the
 	 *    other side closes the socket
 	 */
 	ohandler = xsignal(SIGPIPE, SIG_IGN);
 
-	usize = htonl(size);
-
-	if ((len = slurm_send_timeout(
-				fd, (char *)&usize, sizeof(usize), 0,
-				timeout)) < 0)
-		goto done;
-
-	if ((len = slurm_send_timeout(fd, buffer, size, 0, timeout)) < 0)
-		goto done;
+	len = slurm_sendv_timeout(fd, msg_iov, iovcnt + 1, 0, timeout);
+	if (len >= 0)
+		len -= sizeof(usize);
 
-
-     done:
 	xsignal(SIGPIPE, ohandler);
 	return len;
 }
@@ -202,14 +224,32 @@ ssize_t slurm_msg_sendto_timeout(int fd, char *buffer,
 extern int slurm_send_timeout(int fd, char *buf, size_t size,
 			      uint32_t flags, int timeout)
 {
-	int rc;
+	struct iovec iov;
+
+	iov.iov_base = buf;
+	iov.iov_len = size;
+	return slurm_sendv_timeout(fd, &iov, 1, flags, timeout);
+}
+
+/* Send the buffers of a slurm message with timeout, using a single sendmsg()
+ * for as many of them as the socket will take
+ * RET total size of the buffers or SLURM_ERROR on error */
+extern int slurm_sendv_timeout(int fd, struct iovec *iov, int iovcnt,
+			       uint32_t flags, int timeout)
+{
+	int rc, i;
 	int sent = 0;
+	size_t size = 0;
 	int fd_flags;
 	struct pollfd ufds;
 	struct timeval tstart;
+	struct msghdr msg;
 	int timeleft = timeout;
 	char temp[2];
 
+	for (i = 0; i < iovcnt; i++)
+		size += iov[i].iov_len;
+
 	ufds.fd     = fd;
 	ufds.events = POLLOUT;
 
@@ -221,8 +261,8 @@ extern int slurm_send_timeout(int fd, char *buf, size_t size,
 	while (sent < size) {
 		timeleft = timeout - _tot_wait(&tstart);
 		if (timeleft <= 0) {
-			debug("slurm_send_timeout at %d of %zu, timeout",
-				sent, size);
+			debug("%s at %d of %zu, timeout",
+			      __func__, sent, size);
 			slurm_seterrno(SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT);
 			sent = SLURM_ERROR;
 			goto done;
@@ -232,9 +272,8 @@ extern int slurm_send_timeout(int fd, char *buf, size_t size,
 			if ((rc == 0) || (errno == EINTR) || (errno == EAGAIN))
  				continue;
 			else {
-				debug("slurm_send_timeout at %d of %zu, "
-					"poll error: %s",
-					sent, size, strerror(errno));
+				debug("%s at %d of %zu, poll error: %s",
+				      __func__, sent, size, strerror(errno));
 				slurm_seterrno(SLURM_COMMUNICATIONS_SEND_ERROR);
 				sent = SLURM_ERROR;
 				goto done;
@@ -249,30 +288,32 @@ extern int slurm_send_timeout(int fd, char *buf, size_t size,
 		 * nonblocking read means just that.
 		 */
 		if (ufds.revents & POLLERR) {
-			debug("slurm_send_timeout: Socket POLLERR");
+			debug("%s: Socket POLLERR", __func__);
 			slurm_seterrno(ENOTCONN);
 			sent = SLURM_ERROR;
 			goto done;
 		}
 		if ((ufds.revents & POLLHUP) || (ufds.revents & POLLNVAL) ||
 		    (recv(fd, &temp, 1, flags) == 0)) {
-			debug2("slurm_send_timeout: Socket no longer there");
+			debug2("%s: Socket no longer there", __func__);
 			slurm_seterrno(ENOTCONN);
 			sent = SLURM_ERROR;
 			goto done;
 		}
 		if ((ufds.revents & POLLOUT) != POLLOUT) {
-			error("slurm_send_timeout: Poll failure, revents:%d",
-			      ufds.revents);
+			error("%s: Poll failure, revents:%d",
+			      __func__, ufds.revents);
 		}
 
-		rc = send(fd, &buf[sent], (size - sent), flags);
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iovcnt;
+		rc = sendmsg(fd, &msg, flags);
 		if (rc < 0) {
  			if (errno == EINTR)
 				continue;
-			debug("slurm_send_timeout at %d of %zu, "
-				"send error: %s",
-				sent, size, strerror(errno));
+			debug("%s at %d of %zu, send error: %s",
+			      __func__, sent, size, strerror(errno));
  			if (errno == EAGAIN) {	/* poll() lied to us */
 				usleep(10000);
 				continue;
@@ -282,14 +323,25 @@ extern int slurm_send_timeout(int fd, char *buf, size_t size,
 			goto done;
 		}
 		if (rc == 0) {
-			debug("slurm_send_timeout at %d of %zu, "
-				"sent zero bytes", sent, size);
+			debug("%s at %d of %zu, sent zero bytes",
+			      __func__, sent, size);
 			slurm_seterrno(SLURM_PROTOCOL_SOCKET_ZERO_BYTES_SENT);
 			sent = SLURM_ERROR;
 			goto done;
 		}
 
 		sent += rc;
+
+		/* Skip the buffers sent, and the part sent of the next one */
+		while ((iovcnt > 0) && (rc >= iov->iov_len)) {
+			rc -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (rc) {
+			iov->iov_base = (char *) iov->iov_base + rc;
+			iov->iov_len -= rc;
+		}
 	}
 
     done:
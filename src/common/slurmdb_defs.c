@@ -1154,6 +1154,7 @@ extern void slurmdb_destroy_job_cond(void *object)
 		FREE_NULL_LIST(job_cond->associd_list);
 		FREE_NULL_LIST(job_cond->cluster_list);
 		FREE_NULL_LIST(job_cond->constraint_list);
+		xfree(job_cond->cursor_cluster);
 		FREE_NULL_LIST(job_cond->groupid_list);
 		FREE_NULL_LIST(job_cond->jobname_list);
 		FREE_NULL_LIST(job_cond->partition_list);
@@ -4372,6 +4373,7 @@ extern void slurmdb_destroy_stats_rec(void *object)
 		xfree(rpc_stats->rollup_count);
 		xfree(rpc_stats->rollup_time);
 		xfree(rpc_stats->rollup_max_time);
+		xfree(rpc_stats->rollup_periods);
 
 		xfree(rpc_stats->rpc_type_id);
 		xfree(rpc_stats->rpc_type_cnt);
@@ -4552,10 +4552,13 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 		if (!object) {
 			pack32(NO_VAL, buffer);	/* count(acct_list) */
 			pack32(NO_VAL, buffer);	/* count(associd_list) */
+			pack32(0, buffer);	/* chunk_size */
 			pack32(NO_VAL, buffer);	/* count(cluster_list) */
 			pack32(NO_VAL, buffer);	/* count(constraint_list) */
 			pack32(0, buffer);	/* cpus_max */
 			pack32(0, buffer);	/* cpus_min */
+			packnull(buffer);	/* cursor_cluster */
+			pack32(0, buffer);	/* cursor_jobid */
 			pack32(SLURMDB_JOB_FLAG_NOTSET, buffer); /* db_flags */
 			pack32(0, buffer);	/* exitcode */
 			pack32(0, buffer);	/* job cond flags */
@@ -4606,6 +4609,8 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 			}
 		}
 
+		pack32(object->chunk_size, buffer);
+
 		if (object->cluster_list)
 			count = list_count(object->cluster_list);
 		else
@@ -4631,6 +4636,8 @@ extern void slurmdb_pack_job_cond(void *in, uint16_t protocol_version,
 
 		pack32(object->cpus_max, buffer);
 		pack32(object->cpus_min, buffer);
+		packstr(object->cursor_cluster, buffer);
+		pack32(object->cursor_jobid, buffer);
 		pack32(object->db_flags, buffer);
 		pack32((uint32_t)object->exitcode, buffer);
 		pack32(object->flags, buffer);
@@ -5303,6 +5310,8 @@ extern int slurmdb_unpack_job_cond(void **object, uint16_t protocol_version,
 			}
 		}
 
+		safe_unpack32(&object_ptr->chunk_size, buffer);
+
 		safe_unpack32(&count, buffer);
 		if (count > NO_VAL)
 			goto unpack_error;
@@ -5332,6 +5341,9 @@ extern int slurmdb_unpack_job_cond(void **object, uint16_t protocol_version,
 
 		safe_unpack32(&object_ptr->cpus_max, buffer);
 		safe_unpack32(&object_ptr->cpus_min, buffer);
+		safe_unpackstr_xmalloc(&object_ptr->cursor_cluster, &uint32_tmp,
+				       buffer);
+		safe_unpack32(&object_ptr->cursor_jobid, buffer);
 		safe_unpack32(&object_ptr->db_flags, buffer);
 		safe_unpack32(&uint32_tmp, buffer);
 		object_ptr->exitcode = (int32_t)uint32_tmp;
@@ -7892,6 +7904,18 @@ extern void slurmdb_pack_stats_msg(void *object, uint16_t protocol_version,
 		pack32_array(stats_ptr->rpc_user_id,   i, buffer);
 		pack32_array(stats_ptr->rpc_user_cnt,  i, buffer);
 		pack64_array(stats_ptr->rpc_user_time, i, buffer);
+
+		/* Batched message statistics */
+		if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+			pack32(stats_ptr->batch_cnt, buffer);
+			pack32(stats_ptr->batch_fail_cnt, buffer);
+			pack64(stats_ptr->batch_max_time, buffer);
+			pack64(stats_ptr->batch_rec_cnt, buffer);
+			pack64(stats_ptr->batch_time, buffer);
+
+			pack64_array(stats_ptr->rollup_periods,
+				     ROLLUP_COUNT, buffer);
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -7953,6 +7977,20 @@ extern int slurmdb_unpack_stats_msg(void **object, uint16_t protocol_version,
 				    buffer);
 		if (uint32_tmp != stats_ptr->user_cnt)
 			goto unpack_error;
+
+		/* Batched message statistics */
+		if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+			safe_unpack32(&stats_ptr->batch_cnt, buffer);
+			safe_unpack32(&stats_ptr->batch_fail_cnt, buffer);
+			safe_unpack64(&stats_ptr->batch_max_time, buffer);
+			safe_unpack64(&stats_ptr->batch_rec_cnt, buffer);
+			safe_unpack64(&stats_ptr->batch_time, buffer);
+
+			safe_unpack64_array(&stats_ptr->rollup_periods,
+					    &uint32_tmp, buffer);
+			if (uint32_tmp != ROLLUP_COUNT)
+				goto unpack_error;
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -33,113 +33,305 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <stdbool.h>
+#include <string.h>
+
+#include "src/common/xassert.h"
 #include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
-#include "src/common/xstring.h"
-#include "src/common/uthash/uthash.h"
-
-#if 0
-/* undefine default allocators */
-#undef uthash_malloc
-#undef uthash_free
-
-/* re-define them using slurm's ones */
-#define uthash_malloc(sz) xmalloc(sz)
-#define uthash_free(ptr, sz) xfree(ptr)
-#endif
 
 /*
- * FIXME:
- * A pre-malloced array of xhash_item_t could be associated to
- * the xhash_table in order to speed up the xhash_add function.
- * The default array size could be something like 10% of the
- * provided table_size (hash table are commonly defined larger
- * than necessary to avoid shared keys and usage of linked list)
+ * The table is an array of slots addressed with linear probing. Each slot
+ * caches the full 64-bit hash of its item's key next to the item pointer,
+ * so a probe sequence normally touches one or two cache lines and only
+ * calls the user's identify function on a true hash match. For integer
+ * keyed tables the hash is a bijective mix of the key, so a hash match is
+ * a key match and the item is never dereferenced at all.
+ *
+ * Growing the table does not rehash everything at once. A table twice the
+ * size is allocated and the old one is drained a fixed number of slots at a
+ * time by each following add or pop. Until it is empty, lookups check both
+ * tables. Lookups never modify the table, so concurrent readers are safe as
+ * long as writers are serialized.
  */
 
-typedef struct xhash_item_st {
-	void*		item;    /* user item                               */
-	const char*	key;     /* cached key calculated by user function, */
-                                 /* needed by uthash                        */
-	uint32_t	keysize; /* cached key size                         */
-	UT_hash_handle	hh;      /* make this structure hashable by uthash  */
-} xhash_item_t;
+#define XHASH_MIN_SIZE		16	/* must be a power of two */
+#define XHASH_MIGRATE_STEP	128	/* old slots moved per add or pop */
+
+typedef struct {
+	uint64_t	hash;	/* cached hash of the item's key */
+	void		*item;	/* user item, NULL if empty */
+} xhash_slot_t;
 
 struct xhash_st {
 	uint32_t		count;    /* user items count                */
 	xhash_freefunc_t	freefunc; /* function used to free items     */
-	xhash_item_t*		ht;       /* hash table                      */
 	xhash_idfunc_t		identify; /* function returning a unique str
 					     key */
+	xhash_idfunc_int_t	identify_int; /* same, for integer keys    */
+	xhash_slot_t		*slots;   /* current table                   */
+	uint32_t		mask;     /* slot count - 1                  */
+	xhash_slot_t		*old;     /* table being drained, or NULL    */
+	uint32_t		old_mask;
+	uint32_t		old_pos;  /* next old slot to move           */
 };
 
-xhash_t *xhash_init(xhash_idfunc_t idfunc, xhash_freefunc_t freefunc)
+/* Marks a slot of the old table whose item was moved or removed */
+static char tombstone;
+#define XHASH_TOMBSTONE ((void *) &tombstone)
+
+/* MurmurHash3 finalizer, a bijection of 64-bit values */
+static inline uint64_t _mix64(uint64_t h)
 {
-	xhash_t* table = NULL;
-	if (!idfunc)
-		return NULL;
-	table = (xhash_t*)xmalloc(sizeof(xhash_t));
-	table->ht = NULL; /* required by uthash */
-	table->count = 0;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+/* Hash strings a word at a time, the final mix spreads them to the low bits */
+static inline uint64_t _hash_str(const char *key)
+{
+	size_t len = strlen(key);
+	uint64_t h = len * 0x9e3779b97f4a7c15ULL, w;
+
+	for ( ; len >= sizeof(w); len -= sizeof(w), key += sizeof(w)) {
+		memcpy(&w, key, sizeof(w));
+		h ^= w * 0x87c37b91114253d5ULL;
+		h = ((h << 31) | (h >> 33)) * 0x4cf5ad432745937fULL;
+	}
+	w = 0;
+	memcpy(&w, key, len);
+	return _mix64(h ^ w);
+}
+
+static inline uint64_t _hash_item(xhash_t *table, void *item)
+{
+	if (table->identify_int)
+		return _mix64(table->identify_int(item));
+	return _hash_str(table->identify(item));
+}
+
+static xhash_t *_xhash_alloc(xhash_idfunc_t idfunc,
+			     xhash_idfunc_int_t idfunc_int,
+			     xhash_freefunc_t freefunc)
+{
+	xhash_t *table = xmalloc(sizeof(xhash_t));
+
 	table->identify = idfunc;
+	table->identify_int = idfunc_int;
 	table->freefunc = freefunc;
+	table->mask = XHASH_MIN_SIZE - 1;
+	table->slots = xmalloc(sizeof(xhash_slot_t) * XHASH_MIN_SIZE);
 	return table;
 }
 
-static xhash_item_t* xhash_find(xhash_t* table, const char* key)
+xhash_t *xhash_init(xhash_idfunc_t idfunc, xhash_freefunc_t freefunc)
 {
-	xhash_item_t* hash_item = NULL;
-	uint32_t      key_size  = 0;
+	if (!idfunc)
+		return NULL;
+	return _xhash_alloc(idfunc, NULL, freefunc);
+}
 
-	if (!table || !key)
+xhash_t *xhash_init_int(xhash_idfunc_int_t idfunc, xhash_freefunc_t freefunc)
+{
+	if (!idfunc)
 		return NULL;
-	key_size = strlen(key);
-	HASH_FIND(hh, table->ht, key, key_size, hash_item);
-	return hash_item;
+	return _xhash_alloc(NULL, idfunc, freefunc);
+}
+
+/*
+ * Return the slot holding the item with the given hash (and string key,
+ * for string keyed tables) in one table, NULL if not found.
+ */
+static xhash_slot_t *_find_slot(xhash_t *table, xhash_slot_t *slots,
+				uint32_t mask, uint64_t hash, const char *key)
+{
+	uint32_t inx = hash & mask;
+
+	while (slots[inx].item) {
+		if ((slots[inx].hash == hash) &&
+		    (slots[inx].item != XHASH_TOMBSTONE) &&
+		    (!key || !strcmp(table->identify(slots[inx].item), key)))
+			return &slots[inx];
+		inx = (inx + 1) & mask;
+	}
+	return NULL;
+}
+
+static xhash_slot_t *_find(xhash_t *table, uint64_t hash, const char *key,
+			   bool *in_old)
+{
+	xhash_slot_t *slot;
+
+	*in_old = false;
+	if ((slot = _find_slot(table, table->slots, table->mask, hash, key)))
+		return slot;
+	if (table->old &&
+	    (slot = _find_slot(table, table->old, table->old_mask, hash,
+			       key))) {
+		*in_old = true;
+		return slot;
+	}
+	return NULL;
+}
+
+/* Put an item into the first free slot of its probe sequence */
+static void _insert(xhash_t *table, uint64_t hash, void *item)
+{
+	uint32_t inx = hash & table->mask;
+
+	while (table->slots[inx].item)
+		inx = (inx + 1) & table->mask;
+	table->slots[inx].hash = hash;
+	table->slots[inx].item = item;
+}
+
+/*
+ * Empty a slot of the current table. Later members of the same probe run
+ * are shifted back so that no tombstones are needed (Knuth's Algorithm R).
+ */
+static void _remove_slot(xhash_t *table, xhash_slot_t *slot)
+{
+	uint32_t mask = table->mask;
+	uint32_t i = slot - table->slots, j = i, home;
+
+	while (1) {
+		j = (j + 1) & mask;
+		if (!table->slots[j].item)
+			break;
+		home = table->slots[j].hash & mask;
+		/* Move j back into the hole unless its home lies in (i, j] */
+		if ((i <= j) ? ((i < home) && (home <= j)) :
+			       ((i < home) || (home <= j)))
+			continue;
+		table->slots[i] = table->slots[j];
+		i = j;
+	}
+	table->slots[i].item = NULL;
+}
+
+/* Move up to cnt slots of the old table into the current one */
+static void _migrate(xhash_t *table, uint32_t cnt)
+{
+	xhash_slot_t *slot;
+
+	while (table->old && cnt--) {
+		slot = &table->old[table->old_pos];
+		if (slot->item && (slot->item != XHASH_TOMBSTONE)) {
+			_insert(table, slot->hash, slot->item);
+			slot->item = XHASH_TOMBSTONE;
+		}
+		if (table->old_pos++ == table->old_mask)
+			xfree(table->old);
+	}
+}
+
+/* Start moving everything to a table twice the size */
+static void _grow(xhash_t *table)
+{
+	if (table->old)		/* Only one resize in flight */
+		_migrate(table, table->old_mask + 1 - table->old_pos);
+
+	table->old = table->slots;
+	table->old_mask = table->mask;
+	table->old_pos = 0;
+	table->mask = (table->mask << 1) | 1;
+	table->slots = xmalloc(sizeof(xhash_slot_t) * (table->mask + 1));
 }
 
 void* xhash_get(xhash_t* table, const char* key)
 {
-	xhash_item_t* item = xhash_find(table, key);
-	if (!item)
+	xhash_slot_t *slot;
+	bool in_old;
+
+	if (!table || !key)
 		return NULL;
-	return item->item;
+	xassert(table->identify);
+	slot = _find(table, _hash_str(key), key, &in_old);
+	return slot ? slot->item : NULL;
+}
+
+void *xhash_get_int(xhash_t *table, uint64_t key)
+{
+	xhash_slot_t *slot;
+	bool in_old;
+
+	if (!table)
+		return NULL;
+	xassert(table->identify_int);
+	slot = _find(table, _mix64(key), NULL, &in_old);
+	return slot ? slot->item : NULL;
 }
 
 void* xhash_add(xhash_t* table, void* item)
 {
-	xhash_item_t* hash_item = NULL;
 	if (!table || !item)
 		return NULL;
-	hash_item          = (xhash_item_t*)xmalloc(sizeof(xhash_item_t));
-	hash_item->item    = item;
-	hash_item->key     = table->identify(item);
-	hash_item->keysize = strlen(hash_item->key);
-	HASH_ADD_KEYPTR(hh, table->ht, hash_item->key,
-			hash_item->keysize, hash_item);
+	/* Keep the load factor under 3/4 */
+	if ((table->count + 1) > (((table->mask + 1) >> 2) * 3))
+		_grow(table);
+	_insert(table, _hash_item(table, item), item);
 	++table->count;
-	return hash_item->item;
+	_migrate(table, XHASH_MIGRATE_STEP);
+	return item;
 }
 
-void* xhash_pop(xhash_t* table, const char* key)
+static void *_pop(xhash_t *table, uint64_t hash, const char *key)
 {
-	void* item_item;
-	xhash_item_t* item = xhash_find(table, key);
-	if (!item)
+	xhash_slot_t *slot;
+	void *item;
+	bool in_old;
+
+	if (!(slot = _find(table, hash, key, &in_old)))
 		return NULL;
-	item_item = item->item;
-	HASH_DELETE(hh, table->ht, item);
-	xfree(item);
+	item = slot->item;
+	if (in_old)
+		slot->item = XHASH_TOMBSTONE;
+	else
+		_remove_slot(table, slot);
 	--table->count;
-	return item_item;
+	_migrate(table, XHASH_MIGRATE_STEP);
+	return item;
+}
+
+void* xhash_pop(xhash_t* table, const char* key)
+{
+	if (!table || !key)
+		return NULL;
+	xassert(table->identify);
+	return _pop(table, _hash_str(key), key);
+}
+
+void *xhash_pop_int(xhash_t *table, uint64_t key)
+{
+	if (!table)
+		return NULL;
+	xassert(table->identify_int);
+	return _pop(table, _mix64(key), NULL);
 }
 
 void xhash_delete(xhash_t* table, const char* key)
 {
+	void *item_item;
+
 	if (!table || !key)
 		return;
-	void* item_item = xhash_pop(table, key);
-	if (table->freefunc)
+	item_item = xhash_pop(table, key);
+	if (item_item && table->freefunc)
+		table->freefunc(item_item);
+}
+
+void xhash_delete_int(xhash_t *table, uint64_t key)
+{
+	void *item_item;
+
+	if (!table)
+		return;
+	item_item = xhash_pop_int(table, key);
+	if (item_item && table->freefunc)
 		table->freefunc(item_item);
 }
 
@@ -150,33 +342,51 @@ uint32_t xhash_count(xhash_t* table)
 	return table->count;
 }
 
+static void _walk_slots(xhash_slot_t *slots, uint32_t size,
+			void (*callback)(void* item, void* arg), void* arg)
+{
+	uint32_t i;
+
+	for (i = 0; i < size; i++) {
+		if (slots[i].item && (slots[i].item != XHASH_TOMBSTONE))
+			callback(slots[i].item, arg);
+	}
+}
+
 void xhash_walk(xhash_t* table,
 		void (*callback)(void* item, void* arg),
 		void* arg)
 {
-	xhash_item_t* current_item = NULL;
-	xhash_item_t* tmp = NULL;
 	if (!table || !callback)
 		return;
-	HASH_ITER(hh, table->ht, current_item, tmp) {
-		  callback(current_item->item, arg);
+	_walk_slots(table->slots, table->mask + 1, callback, arg);
+	if (table->old)
+		_walk_slots(table->old, table->old_mask + 1, callback, arg);
+}
+
+static void _free_slots(xhash_slot_t *slots, uint32_t size,
+			xhash_freefunc_t freefunc)
+{
+	uint32_t i;
+
+	for (i = 0; i < size; i++) {
+		if (slots[i].item && (slots[i].item != XHASH_TOMBSTONE))
+			freefunc(slots[i].item);
 	}
 }
 
 void xhash_clear(xhash_t* table)
 {
-	xhash_item_t* current_item = NULL;
-	xhash_item_t* tmp = NULL;
-
 	if (!table)
 		return;
-	HASH_ITER(hh, table->ht, current_item, tmp) {
-		  HASH_DEL(table->ht, current_item);
-		  if (table->freefunc)
-			  table->freefunc(current_item->item);
-		  xfree(current_item);
+	if (table->freefunc) {
+		_free_slots(table->slots, table->mask + 1, table->freefunc);
+		if (table->old)
+			_free_slots(table->old, table->old_mask + 1,
+				    table->freefunc);
 	}
-
+	xfree(table->old);
+	memset(table->slots, 0, sizeof(xhash_slot_t) * (table->mask + 1));
 	table->count = 0;
 }
 
@@ -185,5 +395,6 @@ void xhash_free_ptr(xhash_t** table)
 	if (!table || !*table)
 		return;
 	xhash_clear(*table);
+	xfree((*table)->slots);
 	xfree(*table);
 }
@@ -56,6 +56,12 @@ typedef struct xhash_st xhash_t;
   */
 typedef const char* (*xhash_idfunc_t)(void* item);
 
+/**
+  * Same as xhash_idfunc_t for tables keyed by integers, see xhash_init_int.
+  * Item identifiers are the 64-bit integers returned by this function.
+  */
+typedef uint64_t (*xhash_idfunc_int_t)(void* item);
+
 /**
   * @param id is the unique identifier an item can be identified with.
   * @param hashes_count is the number of hashes contained in the hash
@@ -65,7 +71,7 @@ typedef const char* (*xhash_idfunc_t)(void* item);
   *          the given id.
   */
 
-/* Currently not implementable with uthash */
+/* Currently not implementable, the table always uses its own hash */
 typedef unsigned (*xhash_hashfunc_t)(unsigned hashes_count, const char* id);
 
 /** This type of function is used to free data inserted into xhash table */
@@ -82,16 +88,27 @@ typedef void (*xhash_freefunc_t)(void* item);
  */
 xhash_t *xhash_init(xhash_idfunc_t idfunc, xhash_freefunc_t freefunc);
 
+/** Initialize a hash table whose items are identified by integers.
+ *
+ * Only the *_int() functions below can be used to look items up in the
+ * returned table, xhash_add and the functions taking no key work with both
+ * kinds of table. Integer keys avoid the string formatting and comparison
+ * and are the faster choice for numerical identifiers such as job IDs.
+ */
+xhash_t *xhash_init_int(xhash_idfunc_int_t idfunc, xhash_freefunc_t freefunc);
+
 /** @returns an item from a key searching through the hash table. NULL if not
  * found.
  */
 void* xhash_get(xhash_t* table, const char* key);
+void* xhash_get_int(xhash_t* table, uint64_t key);
 
 /** Add an item to the hash table.
  * @param table is the hash table you want to add the item to.
  * @param item is the user item to add. It has to be initialized in order for
  *             the idfunc function to be able to calculate the final unique
- *             key string associated with it.
+ *             key string associated with it. The key must not change
+ *             while the item is in the table.
  * @returns item or NULL in case of error.
  */
 void* xhash_add(xhash_t* table, void* item);
@@ -101,16 +118,20 @@ void* xhash_add(xhash_t* table, void* item);
  * @returns the removed item value.
  */
 void* xhash_pop(xhash_t* table, const char* key);
+void* xhash_pop_int(xhash_t* table, uint64_t key);
 
 /** Remove an item associated with a key from the hash table.
  * If found and freefunc at init time was not null, free the item's memory.
  */
 void xhash_delete(xhash_t* table, const char* key);
+void xhash_delete_int(xhash_t* table, uint64_t key);
 
 /** @returns the number of items stored in the hash table */
 uint32_t xhash_count(xhash_t* table);
 
-/** apply callback to each item contained in the hash table */
+/** apply callback to each item contained in the hash table, in no particular
+ * order. The callback must not add or remove items.
+ */
 void xhash_walk(xhash_t* table,
         void (*callback)(void* item, void* arg),
         void* arg);
@@ -47,6 +47,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "src/common/arena.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
 #include "src/common/xmalloc.h"
@@ -80,6 +81,9 @@ void *slurm_xmalloc(size_t size, bool clear,
 	if (size <= 0)
 		return NULL;
 
+	if (arena_current)
+		return arena_alloc(arena_current, size, clear);
+
 	if (clear)
 		p = calloc(1, total_size);
 	else
@@ -120,6 +124,26 @@ void *slurm_try_xmalloc(size_t size, const char *file, int line,
 	return new;
 }
 
+/*
+ * xrealloc() of arena memory: move it to a new allocation from the current
+ * arena or the heap, and leave the old memory to the arena.
+ */
+static void *_arena_xrealloc(void **item, size_t newsize, bool clear,
+			     const char *file, int line, const char *func)
+{
+	size_t old_size = ((size_t *)*item)[-1];
+	void *new = NULL;
+
+	slurm_xrealloc(&new, newsize, false, file, line, func);
+	memcpy(new, *item, MIN(old_size, newsize));
+	if (clear && (newsize > old_size))
+		memset((char *)new + old_size, 0, newsize - old_size);
+	arena_free_item(*item);
+	*item = new;
+
+	return new;
+}
+
 /*
  * "Safe" version of realloc().  Args are different: pass in a pointer to
  * the object to be realloced instead of the object itself.
@@ -136,6 +160,10 @@ extern void * slurm_xrealloc(void **item, size_t newsize, bool clear,
 		size_t old_size;
 		p = (size_t *)*item - 2;
 
+		if (p[0] == XMALLOC_ARENA_MAGIC)
+			return _arena_xrealloc(item, newsize, clear,
+					       file, line, func);
+
 		/* magic cookie still there? */
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
 		old_size = p[1];
@@ -151,6 +179,9 @@ extern void * slurm_xrealloc(void **item, size_t newsize, bool clear,
 		}
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
 
+	} else if (arena_current && newsize) {
+		*item = arena_alloc(arena_current, newsize, clear);
+		return *item;
 	} else {
 		size_t total_size = newsize + 2 * sizeof(size_t);
 		/* Initalize new memory */
@@ -185,6 +216,11 @@ int slurm_try_xrealloc(void **item, size_t newsize,
 		size_t old_size;
 		p = (size_t *)*item - 2;
 
+		if (p[0] == XMALLOC_ARENA_MAGIC) {
+			_arena_xrealloc(item, newsize, true, file, line, func);
+			return 1;
+		}
+
 		/* magic cookie still there? */
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
 		old_size = p[1];
@@ -222,7 +258,8 @@ size_t slurm_xsize(void *item, const char *file, int line, const char *func)
 {
 	size_t *p = (size_t *)item - 2;
 	xmalloc_assert(item != NULL);
-	xmalloc_assert(p[0] == XMALLOC_MAGIC); /* CLANG false positive here */
+	xmalloc_assert((p[0] == XMALLOC_MAGIC) ||
+		       (p[0] == XMALLOC_ARENA_MAGIC)); /* CLANG false positive */
 	return p[1];
 }
 
@@ -235,6 +272,11 @@ void slurm_xfree(void **item, const char *file, int line, const char *func)
 {
 	if (*item != NULL) {
 		size_t *p = (size_t *)*item - 2;
+		if (p[0] == XMALLOC_ARENA_MAGIC) {
+			arena_free_item(*item);
+			*item = NULL;
+			return;
+		}
 		/* magic cookie still there? */
 		xmalloc_assert(p[0] == XMALLOC_MAGIC);
 		p[0] = 0;	/* make sure xfree isn't called twice */
@@ -71,6 +71,10 @@
  * p. The memory must have been allocated with [try_]xmalloc() or
  * [try_]xrealloc().
  *
+ * While a thread has an arena pushed with arena_push(), xmalloc() and
+ * xrealloc() of a NULL pointer allocate from it rather than from the heap,
+ * see arena.h. try_xmalloc() always uses the heap.
+ *
 \*****************************************************************************/
 
 #ifndef _XMALLOC_H
@@ -115,5 +119,6 @@ int  slurm_try_xrealloc(void **, size_t, const char *, int, const char *);
 size_t slurm_xsize(void *, const char *, int, const char *);
 
 #define XMALLOC_MAGIC 0x42
+#define XMALLOC_ARENA_MAGIC 0x43	/* memory from an arena, see arena.h */
 
 #endif /* !_XMALLOC_H */
@@ -181,6 +181,142 @@ end_it:
 	return rc;
 }
 
+/* Seconds to wait before using a replica again after it failed */
+#define REPLICA_RETRY	60
+
+/*
+ * NOTE: Ensure that mysql_conn->lock is set on function entry
+ * RET seconds the replica is behind its primary, -1 if unknown
+ */
+static int _replica_lag(MYSQL *db_conn)
+{
+	MYSQL_RES *result;
+	MYSQL_ROW row;
+	MYSQL_FIELD *fields;
+	unsigned int i, num_fields;
+	int lag = -1;
+
+	if (_mysql_query_internal(db_conn, "show slave status;") ==
+	    SLURM_ERROR)
+		return -1;
+	if (!(result = mysql_store_result(db_conn)))
+		return -1;
+
+	if (!(row = mysql_fetch_row(result))) {
+		/* Not a replica, e.g. a node of a multi-master cluster */
+		lag = 0;
+	} else {
+		num_fields = mysql_num_fields(result);
+		fields = mysql_fetch_fields(result);
+		for (i = 0; i < num_fields; i++) {
+			if (xstrcasecmp(fields[i].name,
+					"Seconds_Behind_Master"))
+				continue;
+			/* NULL when replication isn't running */
+			if (row[i])
+				lag = atoi(row[i]);
+			break;
+		}
+	}
+	mysql_free_result(result);
+
+	return lag;
+}
+
+/* Batches are flushed once they grow past this many bytes */
+#define MAX_BATCH_SIZE	(512 * 1024)
+
+/*
+ * Append str to *buf holding *len bytes. Unlike xstrcat() this doesn't scan
+ * *buf and doubles its size, as batches grow one short row at a time.
+ */
+static void _batch_cat(char **buf, uint32_t *len, const char *str)
+{
+	size_t str_len = strlen(str);
+	size_t need = *len + str_len + 1;
+
+	if (!*buf)
+		*buf = xmalloc(MAX(need, 1024));
+	else if (need > xsize(*buf))
+		xrealloc(*buf, MAX(need, 2 * xsize(*buf)));
+	memcpy(*buf + *len, str, str_len + 1);
+	*len += str_len;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _batch_close_insert(mysql_conn_t *mysql_conn)
+{
+	if (!mysql_conn->batch_values)
+		return;
+
+	_batch_cat(&mysql_conn->batch_query, &mysql_conn->batch_query_len,
+		   mysql_conn->batch_insert);
+	_batch_cat(&mysql_conn->batch_query, &mysql_conn->batch_query_len,
+		   " ");
+	_batch_cat(&mysql_conn->batch_query, &mysql_conn->batch_query_len,
+		   mysql_conn->batch_values);
+	if (mysql_conn->batch_update) {
+		_batch_cat(&mysql_conn->batch_query,
+			   &mysql_conn->batch_query_len, " ");
+		_batch_cat(&mysql_conn->batch_query,
+			   &mysql_conn->batch_query_len,
+			   mysql_conn->batch_update);
+	}
+	_batch_cat(&mysql_conn->batch_query, &mysql_conn->batch_query_len,
+		   ";");
+	xfree(mysql_conn->batch_insert);
+	xfree(mysql_conn->batch_update);
+	xfree(mysql_conn->batch_values);
+	mysql_conn->batch_values_len = 0;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _batch_discard(mysql_conn_t *mysql_conn)
+{
+	xfree(mysql_conn->batch_insert);
+	xfree(mysql_conn->batch_last);
+	xfree(mysql_conn->batch_query);
+	xfree(mysql_conn->batch_update);
+	xfree(mysql_conn->batch_values);
+	mysql_conn->batch_query_len = 0;
+	mysql_conn->batch_rec_cnt = 0;
+	mysql_conn->batch_values_len = 0;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static int _batch_flush(mysql_conn_t *mysql_conn)
+{
+	int rc;
+
+	_batch_close_insert(mysql_conn);
+	if (!mysql_conn->batch_query)
+		return SLURM_SUCCESS;
+
+	/* Check every statement, not only the first one */
+	if ((rc = _mysql_query_internal(mysql_conn->db_conn,
+					mysql_conn->batch_query))
+	    != SLURM_ERROR)
+		rc = _clear_results(mysql_conn->db_conn);
+	if (rc != SLURM_SUCCESS) {
+		error("%s: %u deferred records failed",
+		      __func__, mysql_conn->batch_rec_cnt);
+		mysql_conn->batch_failed = true;
+	}
+	_batch_discard(mysql_conn);
+
+	return rc;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static int _batch_check_size(mysql_conn_t *mysql_conn)
+{
+	if ((mysql_conn->batch_query_len + mysql_conn->batch_values_len) <
+	    MAX_BATCH_SIZE)
+		return SLURM_SUCCESS;
+
+	return _batch_flush(mysql_conn);
+}
+
 /* NOTE: Ensure that mysql_conn->lock is NOT set on function entry */
 static int _mysql_make_table_current(mysql_conn_t *mysql_conn, char *table_name,
 				     storage_field_t *fields, char *ending)
@@ -616,7 +752,11 @@ extern mysql_conn_t *create_mysql_conn(int conn_num, bool rollback,
 extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 {
 	if (mysql_conn) {
+		mysql_db_replica_end(mysql_conn);
 		mysql_db_close_db_connection(mysql_conn);
+		if (mysql_conn->replica_conn)
+			mysql_close(mysql_conn->replica_conn);
+		_batch_discard(mysql_conn);
 		xfree(mysql_conn->pre_commit_query);
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
@@ -754,11 +894,126 @@ extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 			mysql_thread_end();
 		mysql_close(mysql_conn->db_conn);
 		mysql_conn->db_conn = NULL;
+		if (mysql_conn->replica_active) {
+			/*
+			 * The replica went away, the connection made in its
+			 * place is to the primary and is closed by
+			 * mysql_db_replica_end().
+			 */
+			mysql_conn->replica_active = false;
+			mysql_conn->replica_retry = time(NULL) + REPLICA_RETRY;
+		}
 	}
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return SLURM_SUCCESS;
 }
 
+extern int mysql_db_get_replica_connection(mysql_conn_t *mysql_conn,
+					   char *db_name,
+					   mysql_db_info_t *db_info)
+{
+	unsigned int my_timeout = 30;
+	MYSQL *db_conn;
+	int rc = SLURM_SUCCESS;
+
+	xassert(mysql_conn);
+
+	if (!(db_conn = mysql_init(NULL)))
+		fatal("mysql_init failed: %s", mysql_error(db_conn));
+	mysql_options(db_conn, MYSQL_OPT_CONNECT_TIMEOUT, (char *)&my_timeout);
+	/*
+	 * Leave autocommit on so every query sees what the replica has
+	 * applied by then, not a snapshot from the first one.
+	 */
+	if (!mysql_real_connect(db_conn, db_info->host, db_info->user,
+				db_info->pass, db_name, db_info->port, NULL,
+				CLIENT_MULTI_STATEMENTS)) {
+		error("mysql_real_connect failed for replica %s: %d %s",
+		      db_info->host, mysql_errno(db_conn),
+		      mysql_error(db_conn));
+		mysql_close(db_conn);
+		db_conn = NULL;
+		rc = ESLURM_DB_CONNECTION;
+	} else if (_mysql_query_internal(
+			   db_conn,
+			   "SET session sql_mode='ANSI_QUOTES,"
+			   "NO_ENGINE_SUBSTITUTION';") != SLURM_SUCCESS) {
+		mysql_close(db_conn);
+		db_conn = NULL;
+		rc = ESLURM_DB_CONNECTION;
+	}
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (mysql_conn->replica_conn)
+		mysql_close(mysql_conn->replica_conn);
+	mysql_conn->replica_conn = db_conn;
+	if (!db_conn)
+		mysql_conn->replica_retry = time(NULL) + REPLICA_RETRY;
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern bool mysql_db_replica_begin(mysql_conn_t *mysql_conn, uint16_t max_lag)
+{
+	int lag;
+	bool used = false;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	/* Without a primary connection there is nothing to swap back */
+	if (!mysql_conn->db_conn || !mysql_conn->replica_conn ||
+	    mysql_conn->replica_swapped ||
+	    (mysql_conn->replica_retry > time(NULL)))
+		goto end_it;
+	/*
+	 * Uncommitted changes are only seen on the primary, and deferred
+	 * statements would be flushed to the replica.
+	 */
+	if (mysql_conn->batch_query || mysql_conn->batch_values ||
+	    (mysql_conn->update_list && list_count(mysql_conn->update_list)))
+		goto end_it;
+
+	if ((lag = _replica_lag(mysql_conn->replica_conn)) < 0) {
+		error("Unable to get the lag of the replica, not using it for %d seconds",
+		      REPLICA_RETRY);
+		/* Connect again when retrying, in case it was lost */
+		mysql_close(mysql_conn->replica_conn);
+		mysql_conn->replica_conn = NULL;
+		mysql_conn->replica_retry = time(NULL) + REPLICA_RETRY;
+		goto end_it;
+	} else if (lag > max_lag) {
+		debug("Replica is %d seconds behind, querying the primary",
+		      lag);
+		goto end_it;
+	}
+
+	mysql_conn->primary_conn = mysql_conn->db_conn;
+	mysql_conn->db_conn = mysql_conn->replica_conn;
+	mysql_conn->replica_conn = NULL;
+	mysql_conn->replica_active = true;
+	mysql_conn->replica_swapped = true;
+	used = true;
+end_it:
+	slurm_mutex_unlock(&mysql_conn->lock);
+	return used;
+}
+
+extern void mysql_db_replica_end(mysql_conn_t *mysql_conn)
+{
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (mysql_conn->replica_swapped) {
+		if (mysql_conn->replica_active)
+			mysql_conn->replica_conn = mysql_conn->db_conn;
+		else if (mysql_conn->db_conn)
+			mysql_close(mysql_conn->db_conn);
+		mysql_conn->db_conn = mysql_conn->primary_conn;
+		mysql_conn->primary_conn = NULL;
+		mysql_conn->replica_active = false;
+		mysql_conn->replica_swapped = false;
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+}
+
 extern int mysql_db_cleanup()
 {
 	debug3("starting mysql cleaning up");
@@ -781,6 +1036,7 @@ extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	_batch_flush(mysql_conn);
 	rc = _mysql_query_internal(mysql_conn->db_conn, query);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
@@ -799,6 +1055,7 @@ extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	_batch_flush(mysql_conn);
 	if (!(rc = _mysql_query_internal(mysql_conn->db_conn, query)))
 		rc = mysql_affected_rows(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
@@ -834,6 +1091,15 @@ extern int mysql_db_commit(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	if ((_batch_flush(mysql_conn) != SLURM_SUCCESS) ||
+	    mysql_conn->batch_failed) {
+		/* Part of the transaction is missing, don't commit the rest */
+		mysql_conn->batch_failed = false;
+		(void) mysql_rollback(mysql_conn->db_conn);
+		slurm_mutex_unlock(&mysql_conn->lock);
+		errno = ER_UNKNOWN_ERROR;
+		return SLURM_ERROR;
+	}
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_commit(mysql_conn->db_conn)) {
@@ -855,6 +1121,8 @@ extern int mysql_db_rollback(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_batch_discard(mysql_conn);
+	mysql_conn->batch_failed = false;
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_rollback(mysql_conn->db_conn)) {
@@ -881,6 +1149,7 @@ extern MYSQL_RES *mysql_db_query_ret(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_batch_flush(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		if (mysql_errno(mysql_conn->db_conn) == ER_NO_SUCH_TABLE)
 			goto fini;
@@ -910,6 +1179,7 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query)
 	int rc = SLURM_SUCCESS;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_batch_flush(mysql_conn);
 	if ((rc = _mysql_query_internal(
 		     mysql_conn->db_conn, query)) != SLURM_ERROR)
 		rc = _clear_results(mysql_conn->db_conn);
@@ -922,6 +1192,7 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 	uint64_t new_id = 0;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_batch_flush(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		new_id = mysql_insert_id(mysql_conn->db_conn);
 		if (!new_id) {
@@ -935,6 +1206,95 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 
 }
 
+extern int mysql_db_batch_insert(mysql_conn_t *mysql_conn, char *insert,
+				 char *values, char *update)
+{
+	int rc;
+	char *query = NULL;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return 0;	/* For CLANG false positive */
+	}
+
+	if (!mysql_conn->batch || !mysql_conn->rollback) {
+		query = xstrdup_printf("%s %s%s%s", insert, values,
+				       update ? " " : "", update ? update : "");
+		rc = mysql_db_query(mysql_conn, query);
+		xfree(query);
+		return rc;
+	}
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (mysql_conn->batch_values &&
+	    (xstrcmp(mysql_conn->batch_insert, insert) ||
+	     xstrcmp(mysql_conn->batch_update, update)))
+		_batch_close_insert(mysql_conn);
+
+	if (!mysql_conn->batch_values) {
+		mysql_conn->batch_insert = xstrdup(insert);
+		mysql_conn->batch_update = xstrdup(update);
+	} else
+		_batch_cat(&mysql_conn->batch_values,
+			   &mysql_conn->batch_values_len, ", ");
+	_batch_cat(&mysql_conn->batch_values, &mysql_conn->batch_values_len,
+		   values);
+	mysql_conn->batch_rec_cnt++;
+	xfree(mysql_conn->batch_last);
+
+	rc = _batch_check_size(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern int mysql_db_batch_query(mysql_conn_t *mysql_conn, char *query)
+{
+	int rc = SLURM_SUCCESS;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return 0;	/* For CLANG false positive */
+	}
+
+	if (!mysql_conn->batch || !mysql_conn->rollback)
+		return mysql_db_query(mysql_conn, query);
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (xstrcmp(mysql_conn->batch_last, query)) {
+		_batch_close_insert(mysql_conn);
+		_batch_cat(&mysql_conn->batch_query,
+			   &mysql_conn->batch_query_len, query);
+		if (mysql_conn->batch_query[mysql_conn->batch_query_len - 1]
+		    != ';')
+			_batch_cat(&mysql_conn->batch_query,
+				   &mysql_conn->batch_query_len, ";");
+		mysql_conn->batch_rec_cnt++;
+		xfree(mysql_conn->batch_last);
+		mysql_conn->batch_last = xstrdup(query);
+		rc = _batch_check_size(mysql_conn);
+	}
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern int mysql_db_batch_flush(mysql_conn_t *mysql_conn)
+{
+	int rc;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return 0;	/* For CLANG false positive */
+	}
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	rc = _batch_flush(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
 extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 				 storage_field_t *fields, char *ending)
 {
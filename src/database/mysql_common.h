@@ -59,11 +59,27 @@ typedef enum {
 } slurm_mysql_plugin_type_t;
 
 typedef struct {
+	bool batch;		/* mysql_db_batch_*() may defer statements */
+	char *batch_insert;	/* insert clause of the open multi-row insert */
+	bool batch_failed;	/* a flush failed, the commit must roll back */
+	char *batch_last;	/* last statement deferred, to drop repeats */
+	char *batch_query;	/* statements deferred by mysql_db_batch_*() */
+	uint32_t batch_query_len;
+	uint32_t batch_rec_cnt;	/* records deferred since the last flush */
+	char *batch_update;	/* update clause of the open multi-row insert */
+	char *batch_values;	/* rows of the open multi-row insert */
+	uint32_t batch_values_len;
 	bool cluster_deleted;
 	char *cluster_name;
 	MYSQL *db_conn;
 	pthread_mutex_t lock;
 	char *pre_commit_query;
+	MYSQL *primary_conn;	/* db_conn while queries go to the replica */
+	bool replica_active;	/* db_conn is replica_conn */
+	MYSQL *replica_conn;	/* see mysql_db_replica_begin() */
+	time_t replica_retry;	/* don't use the replica before this */
+	bool replica_swapped;	/* primary_conn holds db_conn until
+				 * mysql_db_replica_end() */
 	bool rollback;
 	List update_list;
 	int conn;
@@ -91,6 +107,22 @@ extern int destroy_mysql_db_info(mysql_db_info_t *db_info);
 extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 				   mysql_db_info_t *db_info);
 extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn);
+
+/*
+ * Connect mysql_conn to a read-only replica of the database. Queries are
+ * sent to it between mysql_db_replica_begin() and mysql_db_replica_end().
+ */
+extern int mysql_db_get_replica_connection(mysql_conn_t *mysql_conn,
+					   char *db_name,
+					   mysql_db_info_t *db_info);
+/*
+ * Send the queries of mysql_conn to its replica until
+ * mysql_db_replica_end(), unless the connection has writes outstanding
+ * or the replica is more than max_lag seconds behind.
+ * RET true if the replica is used
+ */
+extern bool mysql_db_replica_begin(mysql_conn_t *mysql_conn, uint16_t max_lag);
+extern void mysql_db_replica_end(mysql_conn_t *mysql_conn);
 extern int mysql_db_cleanup();
 extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query);
 extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query);
@@ -104,6 +136,38 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query);
 
 extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query);
 
+/*
+ * Defer a row of an "insert into ... values" statement until the next flush.
+ * Rows deferred one after the other with the same insert and update clauses
+ * are sent as one multi-row insert.
+ * IN insert - "insert into <table> (<columns>) values"
+ * IN values - "(<values>)" of one row
+ * IN update - "on duplicate key update ..." or NULL, typically written in
+ *	       terms of VALUES(<column>) so it applies to every row
+ * NOTE: Unless batch and rollback are set the statement is run right away.
+ * RET SLURM_SUCCESS or error of running the statement
+ */
+extern int mysql_db_batch_insert(mysql_conn_t *mysql_conn, char *insert,
+				 char *values, char *update);
+
+/*
+ * Defer a statement whose result is not needed until the next flush. A
+ * statement identical to the one deferred right before it is dropped.
+ * NOTE: Unless batch and rollback are set the statement is run right away.
+ * RET SLURM_SUCCESS or error of running the statement
+ */
+extern int mysql_db_batch_query(mysql_conn_t *mysql_conn, char *query);
+
+/*
+ * Send the statements deferred by mysql_db_batch_*() as a single
+ * multi-statement query. Every other query, mysql_db_commit() and a batch
+ * growing past a size limit flush it first, so calling this is only needed
+ * to see the error of the batch right away. A failed flush makes the next
+ * mysql_db_commit() roll back instead.
+ * RET SLURM_SUCCESS or SLURM_ERROR
+ */
+extern int mysql_db_batch_flush(mysql_conn_t *mysql_conn);
+
 extern int mysql_db_create_table(mysql_conn_t *mysql_conn, char *table_name,
 				 storage_field_t *fields, char *ending);
 
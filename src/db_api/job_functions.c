@@ -40,6 +40,8 @@
 
 #include "src/common/slurm_accounting_storage.h"
 #include "src/common/slurm_jobcomp.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
 
 /*
  * modify existing job in the accounting system
@@ -70,6 +72,58 @@ extern List slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond)
 	return jobacct_storage_g_get_jobs_cond(db_conn, db_api_uid, job_cond);
 }
 
+static int _find_cursor_job(void *x, void *key)
+{
+	slurmdb_job_rec_t *job = (slurmdb_job_rec_t *)x;
+	slurmdb_job_cond_t *job_cond = (slurmdb_job_cond_t *)key;
+
+	if ((job->jobid == job_cond->cursor_jobid) &&
+	    !xstrcmp(job->cluster, job_cond->cursor_cluster))
+		return 1;
+	return 0;
+}
+
+/*
+ * get the next chunk of jobs from the storage
+ * returns List of slurmdb_job_rec_t *, empty once all jobs were returned
+ * note List needs to be freed when called
+ */
+extern List slurmdb_jobs_get_next(void *db_conn, slurmdb_job_cond_t *job_cond)
+{
+	List job_list;
+	ListIterator itr;
+	slurmdb_job_rec_t *job, *last_job = NULL;
+
+	if (db_api_uid == -1)
+		db_api_uid = getuid();
+
+	job_list = jobacct_storage_g_get_jobs_cond(db_conn, db_api_uid,
+						   job_cond);
+	if (!job_list || !list_count(job_list))
+		return job_list;
+
+	/*
+	 * A storage not knowing about chunks sends all of the jobs each
+	 * time, including the one of the cursor.
+	 */
+	if (job_cond->cursor_cluster &&
+	    list_find_first(job_list, _find_cursor_job, job_cond)) {
+		list_flush(job_list);
+		return job_list;
+	}
+
+	itr = list_iterator_create(job_list);
+	while ((job = list_next(itr)))
+		last_job = job;
+	list_iterator_destroy(itr);
+
+	xfree(job_cond->cursor_cluster);
+	job_cond->cursor_cluster = xstrdup(last_job->cluster);
+	job_cond->cursor_jobid = last_job->jobid;
+
+	return job_list;
+}
+
 /*
  * Fix runaway jobs
  * IN: jobs, a list of all the runaway jobs
@@ -104,6 +104,7 @@ const char plugin_type[] = "accounting_storage/as_mysql";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 static mysql_db_info_t *mysql_db_info = NULL;
+static mysql_db_info_t *replica_db_info = NULL;
 static char *mysql_db_name = NULL;
 
 #define DELETE_SEC_BACK 86400
@@ -1096,11 +1097,37 @@ static int _as_mysql_acct_check_tables(mysql_conn_t *mysql_conn)
 	return rc;
 }
 
+/*
+ * Send the queries of an RPC to the StorageReadHost replica, if there is
+ * one. Controllers, running as SlurmUser, load their caches with these
+ * queries and always get them from the primary.
+ * RET true if mysql_db_replica_end() is to be called after the queries
+ */
+static bool _use_replica(mysql_conn_t *mysql_conn, uid_t uid)
+{
+	if (!replica_db_info || !mysql_conn || !mysql_conn->cluster_name ||
+	    (uid == slurmdbd_conf->slurm_user_id))
+		return false;
+
+	if (!mysql_conn->replica_conn &&
+	    (mysql_conn->replica_retry <= time(NULL)))
+		(void) mysql_db_get_replica_connection(
+			mysql_conn, mysql_db_name, replica_db_info);
+
+	return mysql_db_replica_begin(mysql_conn,
+				      slurmdbd_conf->storage_read_max_lag);
+}
+
 /* This should be added to the beginning of each function to make sure
  * we have a connection to the database before we try to use it.
  */
 extern int check_connection(mysql_conn_t *mysql_conn)
 {
+	unsigned long thread_id = 0;
+
+	if (mysql_conn && mysql_conn->db_conn)
+		thread_id = mysql_thread_id(mysql_conn->db_conn);
+
 	if (!mysql_conn) {
 		error("We need a connection to run this");
 		errno = ESLURM_DB_CONNECTION;
@@ -1108,6 +1135,7 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 	} else if (mysql_db_ping(mysql_conn) != 0) {
 		/* avoid memory leak and end thread */
 		mysql_db_close_db_connection(mysql_conn);
+		as_mysql_job_clear_db_index_cache(mysql_conn);
 		if (mysql_db_get_db_connection(
 			    mysql_conn, mysql_db_name, mysql_db_info)
 		    != SLURM_SUCCESS) {
@@ -1115,6 +1143,12 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 			errno = ESLURM_DB_CONNECTION;
 			return ESLURM_DB_CONNECTION;
 		}
+	} else if (mysql_thread_id(mysql_conn->db_conn) != thread_id) {
+		/*
+		 * mysql_ping() reconnected on its own (MYSQL_OPT_RECONNECT),
+		 * rolling back whatever the old session had not committed.
+		 */
+		as_mysql_job_clear_db_index_cache(mysql_conn);
 	}
 
 	if (mysql_conn->cluster_deleted) {
@@ -2590,6 +2624,18 @@ extern int init(void)
 	mysql_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
 	mysql_db_name = acct_get_db_name();
 
+	if (slurmdbd_conf->storage_read_host) {
+		replica_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
+		xfree(replica_db_info->backup);
+		xfree(replica_db_info->host);
+		replica_db_info->host =
+			xstrdup(slurmdbd_conf->storage_read_host);
+		replica_db_info->port = slurmdbd_conf->storage_read_port;
+		verbose("Queries go to the replica at %s:%u when it is at most %u seconds behind",
+			replica_db_info->host, replica_db_info->port,
+			slurmdbd_conf->storage_read_max_lag);
+	}
+
 	debug2("mysql_connect() called for db %s", mysql_db_name);
 	mysql_conn = create_mysql_conn(0, 1, NULL);
 	while (mysql_db_get_db_connection(
@@ -2658,6 +2704,7 @@ extern int fini ( void )
 	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
 	slurm_mutex_destroy(&as_mysql_cluster_list_lock);
 	destroy_mysql_db_info(mysql_db_info);
+	destroy_mysql_db_info(replica_db_info);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
 
@@ -2698,6 +2745,7 @@ extern int acct_storage_p_close_connection(mysql_conn_t **mysql_conn)
 		return SLURM_SUCCESS;
 
 	acct_storage_p_commit((*mysql_conn), 0);
+	as_mysql_job_clear_db_index_cache(*mysql_conn);
 	rc = destroy_mysql_conn(*mysql_conn);
 	*mysql_conn = NULL;
 
@@ -2720,6 +2768,7 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	 * understand that. CID 44841.
 	 */
 	xassert(mysql_conn);
+	rc = SLURM_SUCCESS;
 
 	debug4("got %d commits", list_count(mysql_conn->update_list));
 
@@ -2728,7 +2777,6 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			if (mysql_db_rollback(mysql_conn))
 				error("rollback failed");
 		} else {
-			int rc = SLURM_SUCCESS;
 			/*
 			 * Handle anything here we were unable to do
 			 * because of rollback issues.
@@ -2745,13 +2793,25 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			if (rc != SLURM_SUCCESS) {
 				if (mysql_db_rollback(mysql_conn))
 					error("rollback failed");
-			} else {
-				if (mysql_db_commit(mysql_conn))
-					error("commit failed");
+			} else if ((rc = mysql_db_commit(mysql_conn))) {
+				error("commit failed");
+			}
+
+			/*
+			 * Statements deferred by mysql_db_batch_*() may have
+			 * failed, so tell the caller nothing was stored and
+			 * don't send out updates which were rolled back.
+			 */
+			if (rc != SLURM_SUCCESS) {
+				commit = false;
+				rc = SLURM_ERROR;
 			}
 		}
 	}
 
+	if (!commit)
+		as_mysql_job_clear_db_index_cache(mysql_conn);
+
 	if (commit && list_count(mysql_conn->update_list)) {
 		char *query = NULL;
 		MYSQL_RES *result = NULL;
@@ -2815,6 +2875,18 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	xfree(mysql_conn->pre_commit_query);
 	list_flush(mysql_conn->update_list);
 
+	return rc;
+}
+
+extern int acct_storage_p_batch(mysql_conn_t *mysql_conn, bool batch)
+{
+	if (!mysql_conn)
+		return SLURM_ERROR;
+
+	mysql_conn->batch = batch;
+	if (!batch && mysql_conn->db_conn)
+		return mysql_db_batch_flush(mysql_conn);
+
 	return SLURM_SUCCESS;
 }
 
@@ -3061,13 +3133,27 @@ extern List acct_storage_p_get_assocs(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_assoc_cond_t *assoc_cond)
 {
-	return as_mysql_get_assocs(mysql_conn, uid, assoc_cond);
+	List ret_list;
+	bool replica = _use_replica(mysql_conn, uid);
+
+	ret_list = as_mysql_get_assocs(mysql_conn, uid, assoc_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return ret_list;
 }
 
 extern List acct_storage_p_get_events(mysql_conn_t *mysql_conn, uint32_t uid,
 				      slurmdb_event_cond_t *event_cond)
 {
-	return as_mysql_get_cluster_events(mysql_conn, uid, event_cond);
+	List ret_list;
+	bool replica = _use_replica(mysql_conn, uid);
+
+	ret_list = as_mysql_get_cluster_events(mysql_conn, uid, event_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return ret_list;
 }
 
 extern List acct_storage_p_get_problems(mysql_conn_t *mysql_conn, uint32_t uid,
@@ -3129,20 +3215,41 @@ extern List acct_storage_p_get_reservations(
 	mysql_conn_t *mysql_conn, uid_t uid,
 	slurmdb_reservation_cond_t *resv_cond)
 {
-	return as_mysql_get_resvs(mysql_conn, uid, resv_cond);
+	List ret_list;
+	bool replica = _use_replica(mysql_conn, uid);
+
+	ret_list = as_mysql_get_resvs(mysql_conn, uid, resv_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return ret_list;
 }
 
 extern List acct_storage_p_get_txn(mysql_conn_t *mysql_conn, uid_t uid,
 				   slurmdb_txn_cond_t *txn_cond)
 {
-	return as_mysql_get_txn(mysql_conn, uid, txn_cond);
+	List ret_list;
+	bool replica = _use_replica(mysql_conn, uid);
+
+	ret_list = as_mysql_get_txn(mysql_conn, uid, txn_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return ret_list;
 }
 
 extern int acct_storage_p_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 				    void *in, slurmdbd_msg_type_t type,
 				    time_t start, time_t end)
 {
-	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	int rc;
+	bool replica = _use_replica(mysql_conn, uid);
+
+	rc = as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
+
+	return rc;
 }
 
 extern int acct_storage_p_roll_usage(mysql_conn_t *mysql_conn,
@@ -3324,11 +3431,15 @@ extern List jobacct_storage_p_get_jobs_cond(mysql_conn_t *mysql_conn,
 					    slurmdb_job_cond_t *job_cond)
 {
 	List job_list = NULL;
+	bool replica;
 
 	if (check_connection(mysql_conn) != SLURM_SUCCESS) {
 		return NULL;
 	}
+	replica = _use_replica(mysql_conn, uid);
 	job_list = as_mysql_jobacct_process_get_jobs(mysql_conn, uid, job_cond);
+	if (replica)
+		mysql_db_replica_end(mysql_conn);
 
 	return job_list;
 }
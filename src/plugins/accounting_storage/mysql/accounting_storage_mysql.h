@@ -170,6 +170,7 @@ extern void mod_tres_str(char **out, char *mod, char *cur,
 
 /*local api functions */
 extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit);
+extern int acct_storage_p_batch(mysql_conn_t *mysql_conn, bool batch);
 
 extern int acct_storage_p_add_assocs(mysql_conn_t *mysql_conn,
 					   uint32_t uid,
@@ -76,6 +76,62 @@ static char *_average_tres_usage(uint32_t *tres_ids, uint64_t *tres_cnts,
 	return ret_str;
 }
 
+/* Update clause of the step start insert, only using the values inserted */
+static char *step_start_update =
+	"on duplicate key update "
+	"nodes_alloc=VALUES(nodes_alloc), task_cnt=VALUES(task_cnt), "
+	"time_end=0, state=VALUES(state), nodelist=VALUES(nodelist), "
+	"node_inx=VALUES(node_inx), task_dist=VALUES(task_dist), "
+	"req_cpufreq=VALUES(req_cpufreq), "
+	"req_cpufreq_min=VALUES(req_cpufreq_min), "
+	"req_cpufreq_gov=VALUES(req_cpufreq_gov), "
+	"tres_alloc=VALUES(tres_alloc)";
+
+/*
+ * Database indexes of jobs recently started or looked up. Steps of a job the
+ * slurmctld has no db_index for yet follow its start, often in the same
+ * DBD_SEND_MULT_MSG, so this saves _get_db_index() a select and the
+ * statements deferred so far an early flush.
+ */
+#define DB_INDEX_CACHE_SIZE 256
+typedef struct {
+	uint64_t db_index;
+	uint32_t jobid;
+	mysql_conn_t *mysql_conn;
+	time_t submit;
+} db_index_cache_t;
+
+static db_index_cache_t db_index_cache[DB_INDEX_CACHE_SIZE];
+static pthread_mutex_t db_index_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _set_db_index_cache(mysql_conn_t *mysql_conn, time_t submit,
+				uint32_t jobid, uint64_t db_index)
+{
+	db_index_cache_t *entry = &db_index_cache[jobid % DB_INDEX_CACHE_SIZE];
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	entry->db_index = db_index;
+	entry->jobid = jobid;
+	entry->mysql_conn = mysql_conn;
+	entry->submit = submit;
+	slurm_mutex_unlock(&db_index_cache_lock);
+}
+
+static uint64_t _get_db_index_cache(mysql_conn_t *mysql_conn, time_t submit,
+				    uint32_t jobid)
+{
+	db_index_cache_t *entry = &db_index_cache[jobid % DB_INDEX_CACHE_SIZE];
+	uint64_t db_index = 0;
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	if ((entry->mysql_conn == mysql_conn) && (entry->jobid == jobid) &&
+	    (entry->submit == submit))
+		db_index = entry->db_index;
+	slurm_mutex_unlock(&db_index_cache_lock);
+
+	return db_index;
+}
+
 /* Used in job functions for getting the database index based off the
  * submit time and job.  0 is returned if none is found
  */
@@ -84,8 +140,13 @@ static uint64_t _get_db_index(mysql_conn_t *mysql_conn,
 {
 	MYSQL_RES *result = NULL;
 	MYSQL_ROW row;
-	uint64_t db_index = 0;
-	char *query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
+	uint64_t db_index;
+	char *query;
+
+	if ((db_index = _get_db_index_cache(mysql_conn, submit, jobid)))
+		return db_index;
+
+	query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
 				     "time_submit=%d and id_job=%u",
 				     mysql_conn->cluster_name, job_table,
 				     (int)submit, jobid);
@@ -108,6 +169,7 @@ static uint64_t _get_db_index(mysql_conn_t *mysql_conn,
 	}
 	db_index = slurm_atoull(row[0]);
 	mysql_free_result(result);
+	_set_db_index_cache(mysql_conn, submit, jobid, db_index);
 
 	return db_index;
 }
@@ -264,6 +326,18 @@ no_wckeyid:
 
 /* extern functions */
 
+extern void as_mysql_job_clear_db_index_cache(mysql_conn_t *mysql_conn)
+{
+	int i;
+
+	slurm_mutex_lock(&db_index_cache_lock);
+	for (i = 0; i < DB_INDEX_CACHE_SIZE; i++) {
+		if (db_index_cache[i].mysql_conn == mysql_conn)
+			memset(&db_index_cache[i], 0, sizeof(db_index_cache_t));
+	}
+	slurm_mutex_unlock(&db_index_cache_lock);
+}
+
 extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			      struct job_record *job_ptr)
 {
@@ -635,7 +709,10 @@ no_rollup_change:
 				goto try_again;
 			} else
 				rc = SLURM_ERROR;
-		}
+		} else
+			_set_db_index_cache(mysql_conn, submit_time,
+					    job_ptr->job_id,
+					    job_ptr->db_index);
 	} else {
 		query = xstrdup_printf("update \"%s_%s\" set nodelist='%s', ",
 				       mysql_conn->cluster_name,
@@ -708,7 +785,7 @@ no_rollup_change:
 
 		if (debug_flags & DEBUG_FLAG_DB_JOB)
 			DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
+		rc = mysql_db_batch_query(mysql_conn, query);
 	}
 
 	/* now we will reset all the steps */
@@ -979,13 +1056,13 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 	}
 
 	xstrfmtcat(query,
-		   ", exit_code=%d, kill_requid=%d where job_db_inx=%"PRIu64";",
+		   ", exit_code=%d, kill_requid=%d where job_db_inx=%"PRIu64,
 		   exit_code, job_ptr->requid,
 		   job_ptr->db_index);
 
 	if (debug_flags & DEBUG_FLAG_DB_JOB)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+	rc = mysql_db_batch_query(mysql_conn, query);
 	xfree(query);
 
 	xfree(tres_alloc_str);
@@ -1001,7 +1078,7 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 	char node_list[BUFFER_SIZE];
 	char *node_inx = NULL;
 	time_t start_time, submit_time;
-	char *query = NULL;
+	char *query = NULL, *insert = NULL;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -1105,35 +1182,36 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		}
 	}
 
-	/* we want to print a -1 for the requid so leave it a
-	   %d */
-	/* The stepid could be -2 so use %d not %u */
-	query = xstrdup_printf(
+	/*
+	 * The update clause only refers to the row being inserted, so the
+	 * steps started in a row are sent as one multi-row insert.
+	 */
+	insert = xstrdup_printf(
 		"insert into \"%s_%s\" (job_db_inx, id_step, time_start, "
 		"step_name, state, tres_alloc, "
 		"nodes_alloc, task_cnt, nodelist, node_inx, "
 		"task_dist, req_cpufreq, req_cpufreq_min, req_cpufreq_gov) "
-		"values (%"PRIu64", %d, %d, '%s', %d, '%s', %d, %d, "
-		"'%s', '%s', %d, %u, %u, %u) "
-		"on duplicate key update "
-		"nodes_alloc=%d, task_cnt=%d, time_end=0, state=%d, "
-		"nodelist='%s', node_inx='%s', task_dist=%d, "
-		"req_cpufreq=%u, req_cpufreq_min=%u, req_cpufreq_gov=%u,"
-		"tres_alloc='%s';",
-		mysql_conn->cluster_name, step_table,
+		"values",
+		mysql_conn->cluster_name, step_table);
+	/* we want to print a -1 for the requid so leave it a
+	   %d */
+	/* The stepid could be -2 so use %d not %u */
+	query = xstrdup_printf(
+		"(%"PRIu64", %d, %d, '%s', %d, '%s', %d, %d, "
+		"'%s', '%s', %d, %u, %u, %u)",
 		step_ptr->job_ptr->db_index,
 		step_ptr->step_id,
 		(int)start_time, step_ptr->name,
 		JOB_RUNNING, step_ptr->tres_alloc_str,
 		nodes, tasks, node_list, node_inx, task_dist,
 		step_ptr->cpu_freq_max, step_ptr->cpu_freq_min,
-		step_ptr->cpu_freq_gov, nodes, tasks, JOB_RUNNING,
-		node_list, node_inx, task_dist, step_ptr->cpu_freq_max,
-		step_ptr->cpu_freq_min, step_ptr->cpu_freq_gov,
-		step_ptr->tres_alloc_str);
+		step_ptr->cpu_freq_gov);
 	if (debug_flags & DEBUG_FLAG_DB_STEP)
-		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+		DB_DEBUG(mysql_conn->conn, "query\n%s %s %s",
+			 insert, query, step_start_update);
+	rc = mysql_db_batch_insert(mysql_conn, insert, query,
+				   step_start_update);
+	xfree(insert);
 	xfree(query);
 
 	return rc;
@@ -1382,7 +1460,7 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		   step_ptr->job_ptr->db_index, step_ptr->step_id);
 	if (debug_flags & DEBUG_FLAG_DB_STEP)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+	rc = mysql_db_batch_query(mysql_conn, query);
 	xfree(query);
 
 	/* set the energy for the entire job. */
@@ -1395,7 +1473,7 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 			step_ptr->job_ptr->db_index);
 		if (debug_flags & DEBUG_FLAG_DB_STEP)
 			DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
+		rc = mysql_db_batch_query(mysql_conn, query);
 		xfree(query);
 	}
 
@@ -42,6 +42,13 @@
 
 #include "accounting_storage_mysql.h"
 
+/*
+ * Forget the database indexes of jobs cached for mysql_conn, as the
+ * transaction which created them was rolled back, the connection to the
+ * database was lost or mysql_conn is about to be freed.
+ */
+extern void as_mysql_job_clear_db_index_cache(mysql_conn_t *mysql_conn);
+
 extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			   struct job_record *job_ptr);
 
@@ -473,13 +473,22 @@ static void _destroy_local_cluster(void *object)
 	}
 }
 
+/*
+ * Get the jobs of cluster_name matching job_cond into sent_list.
+ *
+ * With job_cond->chunk_size only the jobs after *cursor_jobid are looked
+ * at, up to chunk_size records of them, or all of the records of the first
+ * job if it has more. *cursor_jobid is then set to the last job looked at,
+ * or to 0 if there are no more jobs.
+ */
 static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			     slurmdb_user_rec_t *user,
 			     slurmdb_job_cond_t *job_cond,
 			     char *cluster_name,
 			     char *job_fields, char *step_fields,
 			     char *sent_extra,
-			     bool is_admin, int only_pending, List sent_list)
+			     bool is_admin, int only_pending, List sent_list,
+			     uint32_t *cursor_jobid)
 {
 	char *query = NULL;
 	char *extra = xstrdup(sent_extra);
@@ -498,6 +507,15 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	int rc = SLURM_SUCCESS;
 	int last_id = -1, curr_id = -1;
 	local_cluster_t *curr_cluster = NULL;
+	uint32_t chunk_cursor = 0, chunk_end = 0, limit = 0;
+	char *chunk_query = NULL;
+	bool where_set;
+
+	if (job_cond->chunk_size) {
+		chunk_cursor = *cursor_jobid;
+		*cursor_jobid = 0;
+		limit = job_cond->chunk_size;
+	}
 
 	/* This is here to make sure we are looking at only this user
 	 * if this flag is set.  We also include any accounts they may be
@@ -590,26 +608,73 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			xstrcat(extra, " where (t1.time_end=0)");
 	}
 
+	if (chunk_cursor) {
+		if (extra)
+			xstrfmtcat(extra, " && (t1.id_job>%u)", chunk_cursor);
+		else
+			xstrfmtcat(extra, " where (t1.id_job>%u)",
+				   chunk_cursor);
+	}
+
+	where_set = (extra != NULL);
 	if (extra) {
 		xstrcat(query, extra);
 		xfree(extra);
 	}
+	if (limit)
+		chunk_query = xstrdup(query);
 
 	/* Here we want to order them this way in such a way so it is
 	   easy to look for duplicates, it is also easy to sort the
 	   resized jobs.
 	*/
 	xstrcat(query, " group by id_job, time_submit desc");
+	if (limit)
+		xstrfmtcat(query, " order by id_job, time_submit desc limit %u",
+			   limit);
 
 	if (debug_flags & DEBUG_FLAG_DB_JOB)
 		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
 	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		xfree(chunk_query);
 		xfree(query);
 		rc = SLURM_ERROR;
 		goto end_it;
 	}
 	xfree(query);
 
+	/*
+	 * A full chunk may end in the middle of the records of a job, leave
+	 * that job for the next chunk. If it is the only one here it has
+	 * chunk_size records or more, so get all of them in this chunk.
+	 */
+	if (limit && (mysql_num_rows(result) >= limit)) {
+		mysql_data_seek(result, mysql_num_rows(result) - 1);
+		row = mysql_fetch_row(result);
+		chunk_end = slurm_atoul(row[JOB_REQ_JOBID]);
+		mysql_data_seek(result, 0);
+		row = mysql_fetch_row(result);
+		if (chunk_end == slurm_atoul(row[JOB_REQ_JOBID])) {
+			*cursor_jobid = chunk_end;
+			chunk_end = 0;
+			mysql_free_result(result);
+			xstrfmtcat(chunk_query, "%s(t1.id_job=%u) "
+				   "group by id_job, time_submit desc",
+				   where_set ? " && " : " where ",
+				   *cursor_jobid);
+			if (debug_flags & DEBUG_FLAG_DB_JOB)
+				DB_DEBUG(mysql_conn->conn, "query\n%s",
+					 chunk_query);
+			if (!(result = mysql_db_query_ret(
+				      mysql_conn, chunk_query, 0))) {
+				xfree(chunk_query);
+				rc = SLURM_ERROR;
+				goto end_it;
+			}
+		} else
+			mysql_data_seek(result, 0);
+	}
+	xfree(chunk_query);
 
 	/* Here we set up environment to check used nodes of jobs.
 	   Since we store the bitmap of the entire cluster we can use
@@ -634,6 +699,12 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 
 		curr_id = slurm_atoul(row[JOB_REQ_JOBID]);
 
+		if (chunk_end) {
+			if (curr_id == chunk_end)
+				break;
+			*cursor_jobid = curr_id;
+		}
+
 		if (job_cond && !(job_cond->flags & JOBCOND_FLAG_DUP)
 		    && (curr_id == last_id)
 		    && (slurm_atoul(row[JOB_REQ_STATE]) != JOB_RESIZING))
@@ -1718,6 +1789,8 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	int only_pending = 0;
 	List use_cluster_list = as_mysql_cluster_list;
 	char *cluster_name;
+	uint32_t cursor_jobid = 0;
+	bool after_cursor = true;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
 
@@ -1768,17 +1841,45 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 
 	assoc_mgr_lock(&locks);
 
+	/*
+	 * With a chunk_size the clusters are looked at in order, starting
+	 * with the jobs after the cursor. A chunk ends with the last job of
+	 * a cluster, so the next one is always asked for chunk_size records.
+	 */
+	if (job_cond && job_cond->chunk_size && job_cond->cursor_cluster)
+		after_cursor = false;
+
 	job_list = list_create(slurmdb_destroy_job_rec);
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
+
+		if (!after_cursor) {
+			if (xstrcmp(cluster_name, job_cond->cursor_cluster))
+				continue;
+			after_cursor = true;
+			cursor_jobid = job_cond->cursor_jobid;
+		}
+
 		_setup_job_cond_selected_steps(job_cond, cluster_name, &extra);
-		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
-					    cluster_name, tmp, tmp2, extra,
-					    is_admin, only_pending, job_list))
-		    != SLURM_SUCCESS)
+		/*
+		 * Keep going while no job of a chunk was kept, so an empty
+		 * list is only returned once all of them were.
+		 */
+		do {
+			rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
+					       cluster_name, tmp, tmp2, extra,
+					       is_admin, only_pending, job_list,
+					       &cursor_jobid);
+		} while ((rc == SLURM_SUCCESS) && cursor_jobid &&
+			 !list_count(job_list));
+		if (rc != SLURM_SUCCESS)
 			error("Problem getting jobs for cluster %s",
 			      cluster_name);
+		else if (cursor_jobid ||
+			 (job_cond && job_cond->chunk_size &&
+			  list_count(job_list)))
+			break;
 	}
 	list_iterator_destroy(itr);
 
@@ -42,6 +42,7 @@
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xhash.h"
 
 enum {
 	TIME_ALLOC,
@@ -90,6 +91,31 @@ typedef struct {
 	double unused_wall;
 } local_resv_usage_t;
 
+typedef struct {
+	int id;
+	time_t orig_start;
+	bool relative;		/* unused_wall is to be added to the one of
+				 * the previous slice */
+	double unused_wall;
+} local_resv_unused_t;
+
+/*
+ * Consecutive periods (hours, days or months) of a cluster's rollup done on
+ * one connection, see _run_slices().
+ */
+typedef struct rollup_slice {
+	char *cluster_name;
+	int conn;		/* of the parent connection, for debug */
+	time_t end;
+	bool first;		/* slice starting where the rollup starts */
+	pthread_t id;
+	int rc;
+	List resv_unused_list;	/* hourly only, of local_resv_unused_t */
+	int (*rollup) (mysql_conn_t *mysql_conn, struct rollup_slice *slice);
+	bool run_month;		/* non-hourly only */
+	time_t start;
+} rollup_slice_t;
+
 static void _destroy_local_tres_usage(void *object)
 {
 	local_tres_usage_t *a_usage = (local_tres_usage_t *)object;
@@ -126,6 +152,11 @@ static void _destroy_local_resv_usage(void *object)
 	}
 }
 
+static void _destroy_local_resv_unused(void *object)
+{
+	xfree(object);
+}
+
 static int _find_loc_tres(void *x, void *key)
 {
 	local_tres_usage_t *loc_tres = (local_tres_usage_t *)x;
@@ -136,16 +167,43 @@ static int _find_loc_tres(void *x, void *key)
 	return 0;
 }
 
-static int _find_id_usage(void *x, void *key)
+static uint64_t _id_usage_key(void *x)
+{
+	return ((local_id_usage_t *)x)->id;
+}
+
+static int _find_resv_unused(void *x, void *key)
 {
-	local_id_usage_t *loc = (local_id_usage_t *)x;
-	uint32_t id = *(uint32_t *)key;
+	local_resv_unused_t *r_unused = (local_resv_unused_t *)x;
+	local_resv_unused_t *r_key = (local_resv_unused_t *)key;
 
-	if (loc->id == id)
+	if ((r_unused->id == r_key->id) &&
+	    (r_unused->orig_start == r_key->orig_start))
 		return 1;
 	return 0;
 }
 
+/*
+ * Find the usage of id through usage_hash, adding a new one to usage_list
+ * and usage_hash if there is none yet.
+ */
+static local_id_usage_t *_get_id_usage(List usage_list, xhash_t *usage_hash,
+				       uint32_t id, bool make_tres)
+{
+	local_id_usage_t *usage = xhash_get_int(usage_hash, id);
+
+	if (!usage) {
+		usage = xmalloc(sizeof(local_id_usage_t));
+		usage->id = id;
+		list_append(usage_list, usage);
+		xhash_add(usage_hash, usage);
+	}
+	if (make_tres && !usage->loc_tres)
+		usage->loc_tres = list_create(_destroy_local_tres_usage);
+
+	return usage;
+}
+
 static void _remove_job_tres_time_from_cluster(List c_tres, List j_tres,
 					       int seconds)
 {
@@ -945,16 +1003,17 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 	return c_usage;
 }
 
-extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
-				  char *cluster_name,
-				  time_t start, time_t end,
-				  uint16_t archive_data)
+/* Roll up the hours from slice->start to slice->end, without committing */
+static int _hourly_rollup_slice(mysql_conn_t *mysql_conn,
+				rollup_slice_t *slice)
 {
 	int rc = SLURM_SUCCESS;
 	int add_sec = 3600;
 	int i=0;
+	char *cluster_name = slice->cluster_name;
+	time_t end = slice->end;
 	time_t now = time(NULL);
-	time_t curr_start = start;
+	time_t curr_start = slice->start;
 	time_t curr_end = curr_start + add_sec;
 	char *query = NULL;
 	MYSQL_RES *result = NULL;
@@ -967,6 +1026,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	List cluster_down_list = list_create(_destroy_local_cluster_usage);
 	List wckey_usage_list = list_create(_destroy_local_id_usage);
 	List resv_usage_list = list_create(_destroy_local_resv_usage);
+	xhash_t *assoc_usage_hash = xhash_init_int(_id_usage_key, NULL);
+	xhash_t *wckey_usage_hash = xhash_init_int(_id_usage_key, NULL);
+	local_resv_unused_t *r_unused = NULL, r_key;
 	uint16_t track_wckey = slurm_get_track_wckey();
 	local_cluster_usage_t *loc_c_usage = NULL;
 	local_cluster_usage_t *c_usage = NULL;
@@ -1119,10 +1181,12 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			time_t row_start = slurm_atoul(row[RESV_REQ_START]);
 			time_t row_end = slurm_atoul(row[RESV_REQ_END]);
 			uint32_t row_flags = slurm_atoul(row[RESV_REQ_FLAGS]);
-			int unused;
+			double unused;
 			int resv_seconds;
 			time_t orig_start = row_start;
 
+			r_key.id = slurm_atoul(row[RESV_REQ_ID]);
+			r_key.orig_start = orig_start;
 			if (row_start >= curr_start) {
 				/*
 				 * This is the first time we are seeing this
@@ -1131,8 +1195,21 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				 * rerolling set it back to 0.
 				 */
 				unused = 0;
-			} else
+			} else if ((r_unused = list_find_first(
+					    slice->resv_unused_list,
+					    _find_resv_unused, &r_key))) {
+				/* Carried over from the previous hour */
+				unused = r_unused->unused_wall;
+			} else if (slice->first) {
 				unused = slurm_atoul(row[RESV_REQ_UNUSED]);
+			} else {
+				/*
+				 * The previous slice is being rolled up in
+				 * parallel, this one's unused time is added
+				 * to it afterwards.
+				 */
+				unused = 0;
+			}
 
 			if (row_start <= curr_start)
 				row_start = curr_start;
@@ -1304,13 +1381,13 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			}
 
 			if (last_id != assoc_id) {
-				a_usage = xmalloc(sizeof(local_id_usage_t));
-				a_usage->id = assoc_id;
-				list_append(assoc_usage_list, a_usage);
-				last_id = assoc_id;
 				/* a_usage->loc_tres is made later,
 				   don't do it here.
 				*/
+				a_usage = _get_id_usage(assoc_usage_list,
+							assoc_usage_hash,
+							assoc_id, false);
+				last_id = assoc_id;
 			}
 
 			/* Short circuit this so so we don't get a pointer. */
@@ -1319,20 +1396,9 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 
 			/* do the wckey calculation */
 			if (last_wckeyid != wckey_id) {
-				list_iterator_reset(w_itr);
-				while ((w_usage = list_next(w_itr)))
-					if (w_usage->id == wckey_id)
-						break;
-
-				if (!w_usage) {
-					w_usage = xmalloc(
-						sizeof(local_id_usage_t));
-					w_usage->id = wckey_id;
-					list_append(wckey_usage_list,
-						    w_usage);
-					w_usage->loc_tres = list_create(
-						_destroy_local_tres_usage);
-				}
+				w_usage = _get_id_usage(wckey_usage_list,
+							wckey_usage_hash,
+							wckey_id, true);
 				last_wckeyid = wckey_id;
 			}
 
@@ -1517,16 +1583,29 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		/* now figure out how much more to add to the
 		   associations that could had run in the reservation
 		*/
-		query = NULL;
 		list_iterator_reset(r_itr);
 		while ((r_usage = list_next(r_itr))) {
 			ListIterator t_itr;
 			local_tres_usage_t *loc_tres;
 
-			xstrfmtcat(query, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
-				   cluster_name, resv_table,
-				   r_usage->unused_wall, r_usage->id,
-				   r_usage->orig_start);
+			/*
+			 * The unused time is stored once the whole rollup is
+			 * done, see _resv_unused_query().
+			 */
+			r_key.id = r_usage->id;
+			r_key.orig_start = r_usage->orig_start;
+			if (!(r_unused = list_find_first(
+				      slice->resv_unused_list,
+				      _find_resv_unused, &r_key))) {
+				r_unused = xmalloc(sizeof(local_resv_unused_t));
+				r_unused->id = r_usage->id;
+				r_unused->orig_start = r_usage->orig_start;
+				r_unused->relative =
+					(!slice->first &&
+					 (r_usage->orig_start < slice->start));
+				list_append(slice->resv_unused_list, r_unused);
+			}
+			r_unused->unused_wall = r_usage->unused_wall;
 
 			if (!r_usage->loc_tres ||
 			    !list_count(r_usage->loc_tres))
@@ -1560,20 +1639,12 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					r_usage->local_assocs);
 				while ((assoc = list_next(tmp_itr))) {
 					uint32_t associd = slurm_atoul(assoc);
-					if ((last_id != associd) &&
-					    !(a_usage = list_find_first(
-						      assoc_usage_list,
-						      _find_id_usage,
-						      &associd))) {
-						a_usage = xmalloc(
-							sizeof(local_id_usage_t));
-						a_usage->id = associd;
-						list_append(assoc_usage_list,
-							    a_usage);
-						last_id = associd;
-						a_usage->loc_tres = list_create(
-							_destroy_local_tres_usage);
-					}
+
+					a_usage = _get_id_usage(
+						assoc_usage_list,
+						assoc_usage_hash,
+						associd, true);
+					last_id = associd;
 
 					_add_time_tres(a_usage->loc_tres,
 						       TIME_ALLOC, loc_tres->id,
@@ -1584,17 +1655,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			list_iterator_destroy(t_itr);
 		}
 
-		if (query) {
-			if (debug_flags & DEBUG_FLAG_DB_USAGE)
-				DB_DEBUG(mysql_conn->conn, "query\n%s", query);
-			rc = mysql_db_query(mysql_conn, query);
-			xfree(query);
-			if (rc != SLURM_SUCCESS) {
-				error("couldn't update reservations with unused time");
-				goto end_it;
-			}
-		}
-
 		/* now apply the down time from the slurmctld disconnects */
 		if (c_usage) {
 			list_iterator_reset(c_itr);
@@ -1662,6 +1722,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		a_usage     = NULL;
 		w_usage     = NULL;
 
+		xhash_clear(assoc_usage_hash);
+		xhash_clear(wckey_usage_hash);
 		list_flush(assoc_usage_list);
 		list_flush(cluster_down_list);
 		list_flush(wckey_usage_list);
@@ -1685,6 +1747,8 @@ end_it:
 	if (r_itr)
 		list_iterator_destroy(r_itr);
 
+	xhash_free(assoc_usage_hash);
+	xhash_free(wckey_usage_hash);
 	FREE_NULL_LIST(assoc_usage_list);
 	FREE_NULL_LIST(cluster_down_list);
 	FREE_NULL_LIST(wckey_usage_list);
@@ -1693,61 +1757,292 @@ end_it:
 /* 	info("stop start %s", slurm_ctime2(&curr_start)); */
 /* 	info("stop end %s", slurm_ctime2(&curr_end)); */
 
+	return rc;
+}
+
+/*
+ * Combine the unused time of the reservations each slice ended with, in
+ * order, into the statements storing it.
+ */
+static char *_resv_unused_query(char *cluster_name, rollup_slice_t *slices,
+				int slice_cnt)
+{
+	List resv_unused_list = list_create(_destroy_local_resv_unused);
+	local_resv_unused_t *r_unused, *r_prev;
+	ListIterator itr;
+	char *query = NULL;
+	int i;
+
+	for (i = 0; i < slice_cnt; i++) {
+		itr = list_iterator_create(slices[i].resv_unused_list);
+		while ((r_unused = list_next(itr))) {
+			if (!(r_prev = list_find_first(resv_unused_list,
+						       _find_resv_unused,
+						       r_unused))) {
+				list_append(resv_unused_list,
+					    list_remove(itr));
+				continue;
+			}
+			if (r_unused->relative)
+				r_prev->unused_wall += r_unused->unused_wall;
+			else
+				r_prev->unused_wall = r_unused->unused_wall;
+			if (r_prev->unused_wall < 0)
+				r_prev->unused_wall = 0;
+		}
+		list_iterator_destroy(itr);
+	}
+
+	itr = list_iterator_create(resv_unused_list);
+	while ((r_unused = list_next(itr)))
+		xstrfmtcat(query, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
+			   cluster_name, resv_table, r_unused->unused_wall,
+			   r_unused->id, r_unused->orig_start);
+	list_iterator_destroy(itr);
+	FREE_NULL_LIST(resv_unused_list);
+
+	return query;
+}
+
+/*
+ * Jobs can use more than a Flex reservation, and its unused time is then
+ * clamped at 0 hour by hour. A slice not starting where the rollup starts
+ * doesn't know the value it would be clamped from, so _resv_unused_query()
+ * can't combine the slices right for these reservations.
+ * RET true if a Flex reservation overlaps start to end, or on error
+ */
+static bool _flex_resv_overlap(mysql_conn_t *mysql_conn, char *cluster_name,
+			       time_t start, time_t end)
+{
+	MYSQL_RES *result;
+	char *query;
+	bool overlap = true;
+
+	query = xstrdup_printf("select id_resv from \"%s_%s\" where "
+			       "(flags & %u) && "
+			       "(time_start < %ld && time_end >= %ld) limit 1",
+			       cluster_name, resv_table, RESERVE_FLAG_FLEX,
+			       end, start);
+	if (debug_flags & DEBUG_FLAG_DB_USAGE)
+		DB_DEBUG(mysql_conn->conn, "query\n%s", query);
+	if ((result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		overlap = (mysql_num_rows(result) != 0);
+		mysql_free_result(result);
+	}
+	xfree(query);
+
+	return overlap;
+}
+
+/* Roll up the periods of one slice on a connection of its own */
+static void *_rollup_slice_thread(void *arg)
+{
+	rollup_slice_t *slice = (rollup_slice_t *)arg;
+	mysql_conn_t mysql_conn;
+
+	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
+	mysql_conn.rollback = 1;
+	mysql_conn.conn = slice->conn;
+	slurm_mutex_init(&mysql_conn.lock);
+
+	if ((slice->rc = check_connection(&mysql_conn)) == SLURM_SUCCESS)
+		slice->rc = (slice->rollup)(&mysql_conn, slice);
+
+	if (!mysql_conn.db_conn)
+		;
+	else if (slice->rc == SLURM_SUCCESS) {
+		if (mysql_db_commit(&mysql_conn)) {
+			error("Couldn't commit cluster (%s) rollup from %ld to %ld",
+			      slice->cluster_name, slice->start, slice->end);
+			slice->rc = SLURM_ERROR;
+		}
+	} else if (mysql_db_rollback(&mysql_conn))
+		error("rollback failed");
+
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+
+	return NULL;
+}
+
+/*
+ * Split the periods starting at period[0] to period[period_cnt - 1], and
+ * ending at period[period_cnt], into consecutive slices, up to
+ * MaxRollupThreads of them, or a single one if !parallel.
+ */
+static rollup_slice_t *_create_slices(mysql_conn_t *mysql_conn,
+				      char *cluster_name, time_t *period,
+				      int period_cnt, bool parallel,
+				      int *slice_cnt)
+{
+	rollup_slice_t *slices;
+	int i, cnt = 1;
+
+	if (parallel && slurmdbd_conf && slurmdbd_conf->max_rollup_threads)
+		cnt = slurmdbd_conf->max_rollup_threads;
+	cnt = MIN(cnt, period_cnt);
+
+	slices = xmalloc(sizeof(rollup_slice_t) * cnt);
+	for (i = 0; i < cnt; i++) {
+		slices[i].cluster_name = cluster_name;
+		slices[i].conn = mysql_conn->conn;
+		slices[i].first = !i;
+		slices[i].start = period[(i * period_cnt) / cnt];
+		slices[i].end = period[((i + 1) * period_cnt) / cnt];
+		slices[i].resv_unused_list =
+			list_create(_destroy_local_resv_unused);
+	}
+	*slice_cnt = cnt;
+
+	return slices;
+}
+
+static void _free_slices(rollup_slice_t *slices, int slice_cnt)
+{
+	int i;
+
+	for (i = 0; i < slice_cnt; i++)
+		FREE_NULL_LIST(slices[i].resv_unused_list);
+	xfree(slices);
+}
+
+/*
+ * Roll up the slices in parallel, each on its own connection committing
+ * its work. A single slice is rolled up on mysql_conn without committing,
+ * like the whole rollup always was.
+ */
+static int _run_slices(mysql_conn_t *mysql_conn, rollup_slice_t *slices,
+		       int slice_cnt, char *unit_name)
+{
+	int i, rc = SLURM_SUCCESS;
+
+	if (slice_cnt == 1)
+		return (slices[0].rollup)(mysql_conn, &slices[0]);
+
+	for (i = 0; i < slice_cnt; i++)
+		slurm_thread_create(&slices[i].id, _rollup_slice_thread,
+				    &slices[i]);
+
+	for (i = 0; i < slice_cnt; i++) {
+		pthread_join(slices[i].id, NULL);
+		if (slices[i].rc != SLURM_SUCCESS) {
+			rc = slices[i].rc;
+			continue;
+		}
+		debug("%s: %s rollup of %s done for %ld-%ld, %d of %d slices",
+		      __func__, unit_name, slices[i].cluster_name,
+		      slices[i].start, slices[i].end, i + 1, slice_cnt);
+	}
+
+	return rc;
+}
+
+extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
+				  char *cluster_name,
+				  time_t start, time_t end,
+				  uint16_t archive_data,
+				  uint32_t *period_cnt)
+{
+	int rc = SLURM_SUCCESS;
+	int i, hour_cnt = 0, slice_cnt = 0;
+	time_t *period = NULL;
+	rollup_slice_t *slices = NULL;
+	char *query = NULL;
+	bool parallel;
+
+	if (end > start)
+		hour_cnt = (end - start + 3599) / 3600;
+	if (hour_cnt) {
+		period = xmalloc(sizeof(time_t) * (hour_cnt + 1));
+		for (i = 0; i <= hour_cnt; i++)
+			period[i] = start + (i * 3600);
+		parallel = !_flex_resv_overlap(mysql_conn, cluster_name,
+					       start, end);
+		slices = _create_slices(mysql_conn, cluster_name, period,
+					hour_cnt, parallel, &slice_cnt);
+		xfree(period);
+		for (i = 0; i < slice_cnt; i++)
+			slices[i].rollup = _hourly_rollup_slice;
+
+		rc = _run_slices(mysql_conn, slices, slice_cnt, "hourly");
+	}
+
+	if (rc == SLURM_SUCCESS) {
+		query = _resv_unused_query(cluster_name, slices, slice_cnt);
+		if (query) {
+			if (debug_flags & DEBUG_FLAG_DB_USAGE)
+				DB_DEBUG(mysql_conn->conn, "query\n%s", query);
+			rc = mysql_db_query(mysql_conn, query);
+			xfree(query);
+			if (rc != SLURM_SUCCESS)
+				error("couldn't update reservations with unused time");
+		}
+	}
+	_free_slices(slices, slice_cnt);
+
 	/* go check to see if we archive and purge */
 
 	if (rc == SLURM_SUCCESS) {
 		if (mysql_db_commit(mysql_conn)) {
-			char start[25], end[25];
+			char start_str[25], end_str[25];
 			error("Couldn't commit cluster (%s) "
 			      "hour rollup for %s - %s",
-			      cluster_name, slurm_ctime2_r(&curr_start, start),
-			      slurm_ctime2_r(&curr_end, end));
+			      cluster_name, slurm_ctime2_r(&start, start_str),
+			      slurm_ctime2_r(&end, end_str));
 			rc = SLURM_ERROR;
 		} else
 			rc = _process_purge(mysql_conn, cluster_name,
 					    archive_data, SLURMDB_PURGE_HOURS);
 	}
 
+	if ((rc == SLURM_SUCCESS) && period_cnt)
+		*period_cnt = hour_cnt;
+
 	return rc;
 }
-extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
-				   bool run_month,
-				   char *cluster_name,
-				   time_t start, time_t end,
-				   uint16_t archive_data)
+/*
+ * Get the start of the day or month following curr_start.
+ * Can't just add 86400 since daylight savings starts and ends every
+ * once in a while.
+ */
+static time_t _next_period(time_t curr_start, bool run_month)
 {
-	/* can't just add 86400 since daylight savings starts and ends every
-	 * once in a while
-	 */
-	int rc = SLURM_SUCCESS;
 	struct tm start_tm;
-	time_t curr_start = start;
+
+	if (!slurm_localtime_r(&curr_start, &start_tm)) {
+		error("Couldn't get localtime from start %ld", curr_start);
+		return 0;
+	}
+	start_tm.tm_sec = 0;
+	start_tm.tm_min = 0;
+	start_tm.tm_hour = 0;
+
+	if (run_month) {
+		start_tm.tm_mday = 1;
+		start_tm.tm_mon++;
+	} else
+		start_tm.tm_mday++;
+
+	return slurm_mktime(&start_tm);
+}
+
+/* Roll up the days or months from slice->start to slice->end */
+static int _nonhour_rollup_slice(mysql_conn_t *mysql_conn,
+				 rollup_slice_t *slice)
+{
+	int rc = SLURM_SUCCESS;
+	bool run_month = slice->run_month;
+	char *cluster_name = slice->cluster_name;
+	time_t curr_start = slice->start;
 	time_t curr_end;
 	time_t now = time(NULL);
 	char *query = NULL;
 	uint16_t track_wckey = slurm_get_track_wckey();
-	char *unit_name;
+	char *unit_name = run_month ? "month" : "day";
 
-	while (curr_start < end) {
-		if (!slurm_localtime_r(&curr_start, &start_tm)) {
-			error("Couldn't get localtime from start %ld",
-			      curr_start);
+	while (curr_start < slice->end) {
+		if (!(curr_end = _next_period(curr_start, run_month)))
 			return SLURM_ERROR;
-		}
-		start_tm.tm_sec = 0;
-		start_tm.tm_min = 0;
-		start_tm.tm_hour = 0;
-
-		if (run_month) {
-			unit_name = "month";
-			start_tm.tm_mday = 1;
-			start_tm.tm_mon++;
-		} else {
-			unit_name = "day";
-			start_tm.tm_mday++;
-		}
-
-		curr_end = slurm_mktime(&start_tm);
 
 		if (debug_flags & DEBUG_FLAG_DB_USAGE)
 			DB_DEBUG(mysql_conn->conn,
@@ -1832,12 +2127,55 @@ extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 		curr_start = curr_end;
 	}
 
-/* 	info("stop start %s", slurm_ctime2(&curr_start)); */
-/* 	info("stop end %s", slurm_ctime2(&curr_end)); */
+	return rc;
+}
+
+extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
+				   bool run_month,
+				   char *cluster_name,
+				   time_t start, time_t end,
+				   uint16_t archive_data,
+				   uint32_t *period_cnt)
+{
+	int rc = SLURM_SUCCESS;
+	int i, cnt = 0, slice_cnt = 0;
+	time_t curr_start = start;
+	time_t *period = NULL;
+	rollup_slice_t *slices;
+
+	while (curr_start < end) {
+		xrealloc(period, sizeof(time_t) * (cnt + 2));
+		period[cnt++] = curr_start;
+		if (!(curr_start = _next_period(curr_start, run_month))) {
+			xfree(period);
+			return SLURM_ERROR;
+		}
+	}
+
+	if (cnt) {
+		period[cnt] = curr_start;
+		slices = _create_slices(mysql_conn, cluster_name, period, cnt,
+					true, &slice_cnt);
+		xfree(period);
+		for (i = 0; i < slice_cnt; i++) {
+			slices[i].rollup = _nonhour_rollup_slice;
+			slices[i].run_month = run_month;
+		}
+
+		rc = _run_slices(mysql_conn, slices, slice_cnt,
+				 run_month ? "monthly" : "daily");
+		_free_slices(slices, slice_cnt);
+		if (rc != SLURM_SUCCESS)
+			return rc;
+	}
 
 	/* go check to see if we archive and purge */
 	rc = _process_purge(mysql_conn, cluster_name, archive_data,
 			    run_month ? SLURMDB_PURGE_MONTHS :
 			    SLURMDB_PURGE_DAYS);
+
+	if ((rc == SLURM_SUCCESS) && period_cnt)
+		*period_cnt = cnt;
+
 	return rc;
 }
@@ -48,11 +48,13 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				  char *cluster_name,
 				  time_t start,
 				  time_t end,
-				  uint16_t archive_data);
+				  uint16_t archive_data,
+				  uint32_t *period_cnt);
 extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 				   bool run_month,
 				   char *cluster_name,
 				   time_t start,
 				   time_t end,
-				   uint16_t archive_data);
+				   uint16_t archive_data,
+				   uint32_t *period_cnt);
 #endif
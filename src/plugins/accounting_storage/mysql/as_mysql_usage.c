@@ -82,6 +82,7 @@ static void *_cluster_rollup_usage(void *arg)
 	time_t month_start;
 	time_t month_end;
 	long rollup_time[ROLLUP_COUNT];
+	uint32_t rollup_periods[ROLLUP_COUNT];
 	DEF_TIMERS;
 
 	char *update_req_inx[] = {
@@ -92,6 +93,7 @@ static void *_cluster_rollup_usage(void *arg)
 
 	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
 	memset(rollup_time, 0, sizeof(long) * ROLLUP_COUNT);
+	memset(rollup_periods, 0, sizeof(uint32_t) * ROLLUP_COUNT);
 	mysql_conn.rollback = 1;
 	mysql_conn.conn = local_rollup->mysql_conn->conn;
 	slurm_mutex_init(&mysql_conn.lock);
@@ -293,7 +295,8 @@ static void *_cluster_rollup_usage(void *arg)
 					    local_rollup->cluster_name,
 					    hour_start,
 					    hour_end,
-					    local_rollup->archive_data);
+					    local_rollup->archive_data,
+					    &rollup_periods[ROLLUP_HOUR]);
 		snprintf(timer_str, sizeof(timer_str),
 			 "hourly_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
@@ -308,7 +311,8 @@ static void *_cluster_rollup_usage(void *arg)
 					     local_rollup->cluster_name,
 					     day_start,
 					     day_end,
-					     local_rollup->archive_data);
+					     local_rollup->archive_data,
+					     &rollup_periods[ROLLUP_DAY]);
 		snprintf(timer_str, sizeof(timer_str),
 			 "daily_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
@@ -323,7 +327,8 @@ static void *_cluster_rollup_usage(void *arg)
 					     local_rollup->cluster_name,
 					     month_start,
 					     month_end,
-					     local_rollup->archive_data);
+					     local_rollup->archive_data,
+					     &rollup_periods[ROLLUP_MONTH]);
 		snprintf(timer_str, sizeof(timer_str),
 			 "monthly_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
@@ -395,6 +400,8 @@ end_it:
 		for (i = 0; i < ROLLUP_COUNT; i++) {
 			local_rollup->rollup_stats->rollup_time[i] +=
 				rollup_time[i];
+			local_rollup->rollup_stats->rollup_periods[i] +=
+				rollup_periods[i];
 		}
 	}
 	if ((rc != SLURM_SUCCESS) && ((*local_rollup->rc) == SLURM_SUCCESS))
@@ -101,6 +101,11 @@ extern int acct_storage_p_commit(void *db_conn, bool commit)
 	return SLURM_SUCCESS;
 }
 
+extern int acct_storage_p_batch(void *db_conn, bool batch)
+{
+	return SLURM_SUCCESS;
+}
+
 extern int acct_storage_p_add_users(void *db_conn, uint32_t uid,
 				    List user_list)
 {
@@ -73,6 +73,7 @@ uint16_t running_cache __attribute__((weak_import)) = 0;
 pthread_mutex_t assoc_cache_mutex __attribute__((weak_import));
 pthread_cond_t assoc_cache_cond __attribute__((weak_import));
 int node_record_count __attribute__((weak_import);
+uint64_t job_update_seq __attribute__((weak_import)) = 0;
 #else
 slurm_ctl_conf_t slurmctld_conf;
 List job_list = NULL;
@@ -80,6 +81,7 @@ uint16_t running_cache = 0;
 pthread_mutex_t assoc_cache_mutex;
 pthread_cond_t assoc_cache_cond;
 int node_record_count;
+uint64_t job_update_seq = 0;
 #endif
 
 /*
@@ -405,6 +407,7 @@ static void *_set_db_inx_thread(void *no_data)
 							id_ptr->db_index;
 						job_ptr->job_state &=
 							(~JOB_UPDATE_DB);
+						JOB_RECORD_CHANGED(job_ptr);
 					}
 				}
 				list_iterator_destroy(itr);
@@ -425,8 +428,11 @@ static void *_set_db_inx_thread(void *no_data)
 					goto end_it;
 				}
 				while ((job_ptr = list_next(itr))) {
-					if (job_ptr->db_index == NO_VAL64)
+					if (job_ptr->db_index == NO_VAL64) {
 						job_ptr->db_index = 0;
+						job_journal_dirty(
+							job_ptr->job_id);
+					}
 				}
 				list_iterator_destroy(itr);
 				unlock_slurmctld(job_read_lock);
@@ -557,6 +563,12 @@ extern int acct_storage_p_commit(void *db_conn, bool commit)
 	return rc;
 }
 
+extern int acct_storage_p_batch(void *db_conn, bool batch)
+{
+	/* The SlurmDBD decides this for its own connection */
+	return SLURM_SUCCESS;
+}
+
 extern int acct_storage_p_add_users(void *db_conn, uint32_t uid,
 				    List user_list)
 {
@@ -2577,8 +2589,10 @@ extern int jobacct_storage_p_job_start(void *db_conn,
 		 * same job.  This can happen when an account is being
 		 * deleted and hense the associations dealing with it.
 		 */
-		if (!req.db_index)
+		if (!req.db_index) {
 			job_ptr->db_index = NO_VAL64;
+			JOB_RECORD_CHANGED(job_ptr);
+		}
 
 		if (send_slurmdbd_msg(SLURM_PROTOCOL_VERSION, &msg) < 0) {
 			_partial_free_dbd_job_start(&req);
@@ -2602,6 +2616,7 @@ extern int jobacct_storage_p_job_start(void *db_conn,
 	} else {
 		resp = (dbd_id_rc_msg_t *) msg_rc.data;
 		job_ptr->db_index = resp->db_index;
+		JOB_RECORD_CHANGED(job_ptr);
 		rc = resp->return_code;
 		//info("here got %d for return code", resp->rc);
 		slurmdbd_free_id_rc_msg(resp);
@@ -3094,6 +3109,9 @@ extern int acct_storage_p_get_data(void *db_conn, acct_storage_info_t dinfo,
 				   void *data)
 {
 	int *int_data = (int *) data;
+	uint64_t *uint64_data = (uint64_t *) data;
+	uint64_t queue_bytes, spool_bytes;
+	uint32_t spool_msgs;
 	int rc = SLURM_SUCCESS;
 
 	switch (dinfo) {
@@ -3103,6 +3121,21 @@ extern int acct_storage_p_get_data(void *db_conn, acct_storage_info_t dinfo,
 	case ACCT_STORAGE_INFO_AGENT_COUNT:
 		*int_data = slurmdbd_agent_queue_count();
 		break;
+	case ACCT_STORAGE_INFO_AGENT_BYTES:
+		slurmdbd_agent_queue_bytes(&queue_bytes, &spool_msgs,
+					   &spool_bytes);
+		*uint64_data = queue_bytes;
+		break;
+	case ACCT_STORAGE_INFO_AGENT_SPOOL_COUNT:
+		slurmdbd_agent_queue_bytes(&queue_bytes, &spool_msgs,
+					   &spool_bytes);
+		*int_data = spool_msgs;
+		break;
+	case ACCT_STORAGE_INFO_AGENT_SPOOL_BYTES:
+		slurmdbd_agent_queue_bytes(&queue_bytes, &spool_msgs,
+					   &spool_bytes);
+		*uint64_data = spool_bytes;
+		break;
 	default:
 		error("%s: data request %d invalid", __func__, dinfo);
 		rc = SLURM_ERROR;
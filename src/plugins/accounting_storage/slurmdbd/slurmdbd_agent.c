@@ -37,6 +37,9 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "src/common/slurm_xlator.h"
 #include "src/common/slurmdbd_pack.h"
 #include "src/common/xsignal.h"
@@ -45,9 +48,32 @@
 #include "slurmdbd_agent.h"
 
 #define DBD_MAGIC		0xDEAD3219
+#define DBD_SPOOL_MAGIC		0xDEAD3220
+#define DBD_SPOOL_BATCH		5000	/* messages read from the spool at
+					 * a time */
+#define DBD_SPOOL_LOW		1000	/* queue length to read it under */
 #define MAX_AGENT_QUEUE		10000
 #define SLURMDBD_TIMEOUT	900	/* Seconds SlurmDBD for response */
 
+/*
+ * Messages which do not fit in the agent queue are appended to the spool
+ * file, from which the agent moves them back to the queue in batches once
+ * the SlurmDBD is there again. The file starts with a spool_hdr_t and each
+ * message is preceded by a spool_rec_t.
+ */
+typedef struct {
+	uint32_t magic;
+	uint32_t head;		/* offset of the first message not yet
+				 * moved to the agent queue */
+} spool_hdr_t;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t size;		/* of the message following */
+	uint16_t rpc_version;	/* the message is packed with */
+	uint16_t pad;
+} spool_rec_t;
+
 static pthread_mutex_t agent_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  agent_cond = PTHREAD_COND_INITIALIZER;
 static List      agent_list     = (List) NULL;
@@ -61,6 +87,12 @@ static slurm_persist_conn_t *slurmdbd_conn = NULL;
 static pthread_mutex_t slurmdbd_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  slurmdbd_cond = PTHREAD_COND_INITIALIZER;
 
+/* Protected by agent_lock */
+static int       spool_fd    = -1;
+static uint32_t  spool_cnt   = 0;	/* messages in the spool */
+static uint32_t  spool_head  = 0;
+static uint32_t  spool_size  = 0;	/* of the spool file */
+
 
 static int _send_fini_msg(void)
 {
@@ -477,6 +509,244 @@ end_it:
 	xfree(dbd_fname);
 }
 
+static int _spool_write(void *data, uint32_t size, uint32_t offset)
+{
+	char *ptr = data;
+	ssize_t wrote;
+
+	while (size) {
+		wrote = pwrite(spool_fd, ptr, size, offset);
+		if (wrote > 0) {
+			ptr += wrote;
+			size -= wrote;
+			offset += wrote;
+		} else if ((wrote == -1) && (errno == EINTR))
+			continue;
+		else {
+			error("slurmdbd: spool write error: %m");
+			return SLURM_ERROR;
+		}
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static int _spool_write_hdr(void)
+{
+	spool_hdr_t hdr;
+
+	hdr.magic = DBD_SPOOL_MAGIC;
+	hdr.head = spool_head;
+	return _spool_write(&hdr, sizeof(hdr), 0);
+}
+
+static void _spool_close(void)
+{
+	if (spool_fd < 0)
+		return;
+
+	if (spool_cnt)
+		verbose("slurmdbd: left %u pending RPCs in the spool",
+			spool_cnt);
+	(void) close(spool_fd);
+	spool_fd = -1;
+	spool_cnt = 0;
+}
+
+/*
+ * Open the spool file and count the messages left in it. Anything after
+ * the last whole message, as left by a crash while writing one, is cut.
+ */
+static void _spool_open(void)
+{
+	char *spool_fname, *map = NULL;
+	spool_hdr_t hdr;
+	spool_rec_t rec;
+	struct stat stat_buf;
+	uint32_t offset;
+
+	if (spool_fd >= 0)
+		return;
+
+	spool_fname = slurm_get_state_save_location();
+	xstrcat(spool_fname, "/dbd.spool");
+	spool_fd = open(spool_fname, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (spool_fd < 0) {
+		error("slurmdbd: Opening spool file %s: %m", spool_fname);
+		xfree(spool_fname);
+		return;
+	}
+
+	spool_cnt = 0;
+	spool_head = sizeof(spool_hdr_t);
+	if (fstat(spool_fd, &stat_buf) ||
+	    (stat_buf.st_size < sizeof(spool_hdr_t)) ||
+	    (stat_buf.st_size > UINT32_MAX) ||
+	    ((map = mmap(NULL, stat_buf.st_size, PROT_READ, MAP_SHARED,
+			 spool_fd, 0)) == MAP_FAILED)) {
+		map = NULL;
+		offset = spool_head;
+	} else {
+		/* records are not aligned, so copy their headers out */
+		memcpy(&hdr, map, sizeof(hdr));
+		if ((hdr.magic == DBD_SPOOL_MAGIC) &&
+		    (hdr.head >= sizeof(spool_hdr_t)) &&
+		    (hdr.head <= stat_buf.st_size))
+			spool_head = hdr.head;
+		for (offset = spool_head;
+		     (offset + sizeof(spool_rec_t)) <= stat_buf.st_size;
+		     offset += sizeof(spool_rec_t) + rec.size) {
+			memcpy(&rec, map + offset, sizeof(rec));
+			if ((rec.magic != DBD_SPOOL_MAGIC) ||
+			    (rec.size > MAX_BUF_SIZE) ||
+			    ((offset + sizeof(spool_rec_t) + rec.size) >
+			     stat_buf.st_size))
+				break;
+			spool_cnt++;
+		}
+		if (offset < stat_buf.st_size)
+			error("slurmdbd: spool file %s is truncated to %u bytes",
+			      spool_fname, offset);
+		(void) munmap(map, stat_buf.st_size);
+	}
+
+	if (!spool_cnt)
+		offset = spool_head = sizeof(spool_hdr_t);
+	spool_size = offset;
+	if (ftruncate(spool_fd, spool_size) || _spool_write_hdr()) {
+		error("slurmdbd: Setting up spool file %s: %m", spool_fname);
+		_spool_close();
+	} else if (spool_cnt)
+		verbose("slurmdbd: recovered %u pending RPCs from the spool",
+			spool_cnt);
+	xfree(spool_fname);
+}
+
+/*
+ * Append a message to the spool
+ * RET SLURM_SUCCESS or SLURM_ERROR if it could not be written
+ */
+static int _spool_append(Buf buffer, uint16_t rpc_version)
+{
+	spool_rec_t rec;
+
+	if (spool_fd < 0)
+		return SLURM_ERROR;
+
+	rec.magic = DBD_SPOOL_MAGIC;
+	rec.size = get_buf_offset(buffer);
+	rec.rpc_version = rpc_version;
+	rec.pad = 0;
+	if (((uint64_t) spool_size + sizeof(rec) + rec.size) > UINT32_MAX) {
+		error("slurmdbd: spool file is full");
+		return SLURM_ERROR;
+	}
+	if (_spool_write(&rec, sizeof(rec), spool_size) ||
+	    _spool_write(get_buf_data(buffer), rec.size,
+			 spool_size + sizeof(rec))) {
+		/* Leave a partial message to be written over */
+		return SLURM_ERROR;
+	}
+
+	if (!spool_cnt)
+		info("slurmdbd: agent queue is full, spooling messages");
+	spool_size += sizeof(rec) + rec.size;
+	spool_cnt++;
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Move up to DBD_SPOOL_BATCH messages from the spool to the agent queue if
+ * it is running low. The file is emptied once all of them were moved.
+ *
+ * Only the agent thread calls this, and the spool is only opened and closed
+ * while the agent thread is not running. Other threads just append past
+ * spool_size, so the messages are read and repacked without agent_lock,
+ * which is only taken to add them to the queue.
+ */
+static void _spool_drain(void)
+{
+	char *map;
+	spool_rec_t rec;
+	uint32_t map_start, map_size, offset, cnt, i, moved;
+	slurmdbd_msg_t msg;
+	Buf buffer;
+	List drain_list;
+
+	slurm_mutex_lock(&agent_lock);
+	if (!agent_list || !spool_cnt || (spool_fd < 0) ||
+	    (list_count(agent_list) >= DBD_SPOOL_LOW)) {
+		slurm_mutex_unlock(&agent_lock);
+		return;
+	}
+	cnt = MIN(spool_cnt, DBD_SPOOL_BATCH);
+	offset = spool_head;
+	map_start = spool_head & ~((uint32_t) getpagesize() - 1);
+	map_size = spool_size - map_start;
+	slurm_mutex_unlock(&agent_lock);
+
+	map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, spool_fd,
+		   map_start);
+	if (map == MAP_FAILED) {
+		error("slurmdbd: mmap of spool file: %m");
+		return;
+	}
+
+	drain_list = list_create(slurmdbd_free_buffer);
+	for (i = 0; i < cnt; i++) {
+		memcpy(&rec, map + (offset - map_start), sizeof(rec));
+		offset += sizeof(rec);
+		buffer = init_buf(rec.size);
+		memcpy(get_buf_data(buffer), map + (offset - map_start),
+		       rec.size);
+		set_buf_offset(buffer, rec.size);
+		offset += rec.size;
+
+		if (rec.rpc_version != slurmdbd_conn->version) {
+			/* repack with the version the queue is sent with */
+			set_buf_offset(buffer, 0);
+			if (unpack_slurmdbd_msg(&msg, rec.rpc_version,
+						buffer) == SLURM_SUCCESS) {
+				free_buf(buffer);
+				buffer = pack_slurmdbd_msg(
+					&msg, slurmdbd_conn->version);
+			} else {
+				free_buf(buffer);
+				buffer = NULL;
+			}
+		}
+		if (!buffer) {
+			error("slurmdbd: bad message in spool");
+			continue;
+		}
+		list_enqueue(drain_list, buffer);
+	}
+	(void) munmap(map, map_size);
+
+	/*
+	 * Nothing was added to agent_list meanwhile, as messages are spooled
+	 * while spool_cnt is set, so these stay ahead of newer messages.
+	 */
+	slurm_mutex_lock(&agent_lock);
+	moved = list_transfer(agent_list, drain_list);
+	spool_cnt -= cnt;
+	if (spool_cnt)
+		spool_head = offset;
+	else {
+		spool_head = spool_size = sizeof(spool_hdr_t);
+		if (ftruncate(spool_fd, spool_size))
+			error("slurmdbd: truncate of spool file: %m");
+		info("slurmdbd: spool is empty");
+	}
+	if (_spool_write_hdr())
+		error("slurmdbd: unable to save spool position");
+	debug("slurmdbd: moved %u RPCs from the spool, %u left",
+	      moved, spool_cnt);
+	slurm_mutex_unlock(&agent_lock);
+	FREE_NULL_LIST(drain_list);
+}
+
 /* Open a connection to the Slurm DBD and set slurmdbd_conn */
 static void _open_slurmdbd_conn(bool need_db)
 {
@@ -600,6 +870,9 @@ static void *_agent(void *x)
 				fail_time = time(NULL);
 		}
 
+		if (slurmdbd_conn->fd >= 0)
+			_spool_drain();
+
 		slurm_mutex_lock(&agent_lock);
 		if (agent_list && slurmdbd_conn->fd)
 			cnt = list_count(agent_list);
@@ -717,6 +990,7 @@ static void *_agent(void *x)
 	slurm_mutex_lock(&agent_lock);
 	_save_dbd_state();
 	FREE_NULL_LIST(agent_list);
+	_spool_close();
 	slurm_mutex_unlock(&agent_lock);
 	return NULL;
 }
@@ -730,6 +1004,7 @@ static void _create_agent(void)
 	if (agent_list == NULL) {
 		agent_list = list_create(slurmdbd_free_buffer);
 		_load_dbd_state();
+		_spool_open();
 	}
 
 	if (agent_tid == 0) {
@@ -1060,7 +1335,7 @@ extern int send_slurmdbd_msg(uint16_t rpc_version, slurmdbd_msg_t *req)
 			return SLURM_ERROR;
 		}
 	}
-	cnt = list_count(agent_list);
+	cnt = list_count(agent_list) + spool_cnt;
 	if ((cnt >= (max_agent_queue / 2)) &&
 	    (difftime(time(NULL), syslog_time) > 120)) {
 		/* Record critical error every 120 seconds */
@@ -1071,6 +1346,18 @@ extern int send_slurmdbd_msg(uint16_t rpc_version, slurmdbd_msg_t *req)
 		if (slurmdbd_conn->trigger_callbacks.dbd_fail)
 			(slurmdbd_conn->trigger_callbacks.dbd_fail)();
 	}
+	/*
+	 * Once the queue is full messages go to the spool, and keep going
+	 * there until it is empty so they are sent in order.
+	 */
+	if ((spool_cnt || (list_count(agent_list) >= MAX_AGENT_QUEUE)) &&
+	    (_spool_append(buffer, slurmdbd_conn->version) == SLURM_SUCCESS)) {
+		free_buf(buffer);
+		slurm_cond_broadcast(&agent_cond);
+		slurm_mutex_unlock(&agent_lock);
+		return rc;
+	}
+	cnt = list_count(agent_list);
 	if (cnt == (max_agent_queue - 1))
 		cnt -= _purge_step_req();
 	if (cnt == (max_agent_queue - 1))
@@ -1105,7 +1392,32 @@ extern bool slurmdbd_conn_active(void)
 
 extern int slurmdbd_agent_queue_count(void)
 {
-	if (!agent_list)
-		return 0;
-	return list_count(agent_list);
+	int cnt = 0;
+
+	slurm_mutex_lock(&agent_lock);
+	if (agent_list)
+		cnt = list_count(agent_list) + spool_cnt;
+	slurm_mutex_unlock(&agent_lock);
+
+	return cnt;
+}
+
+extern void slurmdbd_agent_queue_bytes(uint64_t *queue_bytes,
+				       uint32_t *spool_msgs,
+				       uint64_t *spool_bytes)
+{
+	ListIterator itr;
+	Buf buffer;
+
+	*queue_bytes = 0;
+	slurm_mutex_lock(&agent_lock);
+	if (agent_list) {
+		itr = list_iterator_create(agent_list);
+		while ((buffer = list_next(itr)))
+			*queue_bytes += get_buf_offset(buffer);
+		list_iterator_destroy(itr);
+	}
+	*spool_msgs = spool_cnt;
+	*spool_bytes = spool_size - spool_head;
+	slurm_mutex_unlock(&agent_lock);
 }
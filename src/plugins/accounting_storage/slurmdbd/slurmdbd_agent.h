@@ -78,4 +78,10 @@ extern bool slurmdbd_conn_active(void);
 /* Return the number of messages waiting to be sent to the DBD */
 extern int slurmdbd_agent_queue_count(void);
 
+/* Return the bytes held in the agent queue and the messages and bytes
+ * held in its spool file */
+extern void slurmdbd_agent_queue_bytes(uint64_t *queue_bytes,
+				       uint32_t *spool_msgs,
+				       uint64_t *spool_bytes);
+
 #endif
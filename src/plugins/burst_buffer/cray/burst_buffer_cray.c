@@ -706,6 +706,7 @@ static bb_job_t *_get_bb_job(struct job_record *job_ptr)
 			   "%s: Invalid burst buffer spec (%s)",
 			   plugin_type, job_ptr->burst_buffer);
 		job_ptr->priority = 0;
+		JOB_RECORD_CHANGED(job_ptr);
 		info("Invalid burst buffer spec for %pJ (%s)",
 		     job_ptr, job_ptr->burst_buffer);
 		bb_job_del(&bb_state, job_ptr->job_id);
@@ -1757,6 +1758,7 @@ static void *_start_stage_in(void *x)
 		xstrfmtcat(job_ptr->state_desc, "%s: %s: %s",
 			   plugin_type, op, resp_msg);
 		job_ptr->priority = 0;	/* Hold job */
+		JOB_RECORD_CHANGED(job_ptr);
 		bb_alloc = bb_find_alloc_rec(&bb_state, job_ptr);
 		if (bb_alloc) {
 			bb_alloc->state_time = time(NULL);
@@ -1939,6 +1941,7 @@ static void *_start_stage_out(void *x)
 			job_ptr->job_state &= (~JOB_STAGE_OUT);
 			xfree(job_ptr->state_desc);
 			last_job_update = time(NULL);
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 		slurm_mutex_lock(&bb_state.bb_mutex);
 		bb_job = _get_bb_job(job_ptr);
@@ -2104,6 +2107,7 @@ static void *_start_teardown(void *x)
 		job_ptr = find_job_record(teardown_args->job_id);
 		if (job_ptr) {
 			job_ptr->state_reason = FAIL_BURST_BUFFER_OP;
+			JOB_RECORD_CHANGED(job_ptr);
 			xfree(job_ptr->state_desc);
 			xstrfmtcat(job_ptr->state_desc, "%s: teardown: %s",
 				   plugin_type, resp_msg);
@@ -2141,6 +2145,7 @@ static void *_start_teardown(void *x)
 				 */
 				mail_job_info(job_ptr, MAIL_JOB_STAGE_OUT);
 				job_ptr->mail_type &= (~MAIL_JOB_STAGE_OUT);
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 		} else {
 			/*
@@ -3101,6 +3106,7 @@ static void _purge_vestigial_bufs(void)
 				    (job_ptr->details->begin_time <defer_time)){
 					job_ptr->details->begin_time =
 						defer_time;
+					JOB_RECORD_CHANGED(job_ptr);
 				}
 			}
 			bb_alloc = bb_alloc->next;
@@ -3862,6 +3868,7 @@ extern int bb_p_job_begin(struct job_record *job_ptr)
 		job_ptr->state_desc =
 			xstrdup("Could not find burst buffer record");
 		job_ptr->state_reason = FAIL_BURST_BUFFER_OP;
+		JOB_RECORD_CHANGED(job_ptr);
 		_queue_teardown(job_ptr->job_id, job_ptr->user_id, true);
 		slurm_mutex_unlock(&bb_state.bb_mutex);
 		return SLURM_ERROR;
@@ -3874,6 +3881,7 @@ extern int bb_p_job_begin(struct job_record *job_ptr)
 		job_ptr->state_desc =
 			xstrdup("Error managing persistent burst buffers");
 		job_ptr->state_reason = FAIL_BURST_BUFFER_OP;
+		JOB_RECORD_CHANGED(job_ptr);
 		_queue_teardown(job_ptr->job_id, job_ptr->user_id, true);
 		slurm_mutex_unlock(&bb_state.bb_mutex);
 		return SLURM_ERROR;
@@ -3990,6 +3998,7 @@ extern int bb_p_job_begin(struct job_record *job_ptr)
 		if (job_ptr->details) {	/* Defer launch until completion */
 			job_ptr->details->prolog_running++;
 			job_ptr->job_state |= JOB_CONFIGURING;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 
 		slurm_thread_create_detached(NULL, _start_pre_run,
@@ -4007,6 +4016,7 @@ fini:
 static void _kill_job(struct job_record *job_ptr, bool hold_job)
 {
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 	job_ptr->end_time = last_job_update;
 	if (hold_job)
 		job_ptr->priority = 0;
@@ -4106,6 +4116,7 @@ static void *_start_pre_run(void *x)
 		if (run_kill_job)
 			job_ptr->job_state &= ~JOB_CONFIGURING;
 		prolog_running_decr(job_ptr);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 	slurm_mutex_unlock(&bb_state.bb_mutex);
 	if (run_kill_job) {
@@ -4181,6 +4192,7 @@ extern int bb_p_job_start_stage_out(struct job_record *job_ptr)
 	} else if (bb_job->state < BB_STATE_POST_RUN) {
 		bb_job->state = BB_STATE_POST_RUN;
 		job_ptr->job_state |= JOB_STAGE_OUT;
+		JOB_RECORD_CHANGED(job_ptr);
 		xfree(job_ptr->state_desc);
 		xstrfmtcat(job_ptr->state_desc, "%s: Stage-out in progress",
 			   plugin_type);
@@ -4380,6 +4392,7 @@ static int _create_bufs(struct job_record *job_ptr, bb_job_t *bb_job,
 				      job_ptr, job_ptr->user_id,
 				      buf_ptr->name, bb_alloc->user_id);
 				job_ptr->priority = 0;
+				JOB_RECORD_CHANGED(job_ptr);
 				job_ptr->state_reason = FAIL_BURST_BUFFER_OP;
 				xfree(job_ptr->state_desc);
 				job_ptr->state_desc = xstrdup(
@@ -4448,6 +4461,7 @@ static int _create_bufs(struct job_record *job_ptr, bb_job_t *bb_job,
 					   "denied",
 					   plugin_type, buf_ptr->name);
 				job_ptr->priority = 0;  /* Hold job */
+				JOB_RECORD_CHANGED(job_ptr);
 				continue;
 			}
 
@@ -4652,6 +4666,7 @@ static void *_create_persistent(void *x)
 		} else {
 			job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
 			job_ptr->priority = 0;
+			JOB_RECORD_CHANGED(job_ptr);
 			xfree(job_ptr->state_desc);
 			xstrfmtcat(job_ptr->state_desc, "%s: %s: %s",
 				   plugin_type, __func__, resp_msg);
@@ -4795,6 +4810,7 @@ static void *_destroy_persistent(void *x)
 			_update_system_comment(job_ptr, "teardown",
 					       resp_msg, 0);
 			job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
+			JOB_RECORD_CHANGED(job_ptr);
 			xfree(job_ptr->state_desc);
 			xstrfmtcat(job_ptr->state_desc, "%s: %s: %s",
 				   plugin_type, __func__, resp_msg);
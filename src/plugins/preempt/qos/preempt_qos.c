@@ -121,7 +121,7 @@ extern List find_preemptable_jobs(struct job_record *job_ptr)
 
 		/* This job is a preemption candidate */
 		if (preemptee_job_list == NULL) {
-			preemptee_job_list = list_create(NULL);
+			preemptee_job_list = list_create_unlocked(NULL);
 		}
 		list_append(preemptee_job_list, job_p);
 	}
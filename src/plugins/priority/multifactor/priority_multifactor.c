@@ -82,6 +82,7 @@ void *acct_db_conn  __attribute__((weak_import)) = NULL;
 uint32_t cluster_cpus __attribute__((weak_import)) = NO_VAL;
 List job_list  __attribute__((weak_import)) = NULL;
 time_t last_job_update __attribute__((weak_import)) = (time_t) 0;
+uint64_t job_update_seq __attribute__((weak_import)) = 0;
 uint16_t part_max_priority __attribute__((weak_import)) = 0;
 slurm_ctl_conf_t slurmctld_conf __attribute__((weak_import));
 int slurmctld_tres_cnt __attribute__((weak_import)) = 0;
@@ -91,6 +92,7 @@ void *acct_db_conn = NULL;
 uint32_t cluster_cpus = NO_VAL;
 List job_list = NULL;
 time_t last_job_update = (time_t) 0;
+uint64_t job_update_seq = 0;
 uint16_t part_max_priority = 0;
 slurm_ctl_conf_t slurmctld_conf;
 int slurmctld_tres_cnt = 0;
@@ -1991,6 +1993,7 @@ extern int decay_apply_weighted_factors(struct job_record *job_ptr,
 	    (job_ptr->priority < new_prio)) {
 		job_ptr->priority = new_prio;
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
 	debug2("priority for job %u is now %u",
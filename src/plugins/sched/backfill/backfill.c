@@ -95,6 +95,7 @@
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/srun_comm.h"
 #include "backfill.h"
+#include "node_timeline.h"
 
 #define BACKFILL_INTERVAL	30
 #define BACKFILL_RESOLUTION	60
@@ -182,6 +183,8 @@ static int defer_rpc_cnt = 0;
 static int sched_timeout = SCHED_TIMEOUT;
 static int yield_sleep   = YIELD_SLEEP;
 static List pack_job_list = NULL;
+static bool bf_node_timeline = false;
+static node_timeline_t *bf_timeline = NULL;
 
 /*********************** local functions *********************/
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
@@ -202,6 +205,9 @@ static void _load_config(void);
 static bool _many_pending_rpcs(void);
 static bool _more_work(time_t last_backfill_time);
 static uint32_t _my_sleep(int usec);
+static void _node_space_and(node_space_map_t *node_space,
+			    bitstr_t *avail_bitmap, time_t start_res,
+			    uint32_t end_time, time_t *later_start);
 static int  _num_feature_count(struct job_record *job_ptr, bool *has_xand,
 			       bool *has_xor);
 static int  _pack_find_map(void *x, void *key);
@@ -218,6 +224,7 @@ static int  _start_job(struct job_record *job_ptr, bitstr_t *avail_bitmap);
 static bool _test_resv_overlap(node_space_map_t *node_space,
 			       bitstr_t *use_bitmap, uint32_t start_time,
 			       uint32_t end_reserve);
+static void _timeline_dump(node_timeline_t *tl);
 static int  _try_sched(struct job_record *job_ptr, bitstr_t **avail_bitmap,
 		       uint32_t min_nodes, uint32_t max_nodes,
 		       uint32_t req_nodes, bitstr_t *exc_core_bitmap);
@@ -257,6 +264,11 @@ static void _dump_node_space_table(node_space_map_t *node_space_ptr)
 	int i = 0;
 	char begin_buf[32], end_buf[32], *node_list;
 
+	if (bf_timeline) {
+		_timeline_dump(bf_timeline);
+		return;
+	}
+
 	info("=========================================");
 	while (1) {
 		slurm_make_time_str(&node_space_ptr[i].begin_time,
@@ -275,6 +287,8 @@ static void _dump_node_space_table(node_space_map_t *node_space_ptr)
 
 static void _set_job_time_limit(struct job_record *job_ptr, uint32_t new_limit)
 {
+	if (job_ptr->time_limit != new_limit)
+		JOB_RECORD_CHANGED(job_ptr);
 	job_ptr->time_limit = new_limit;
 	/* reset flag if we have a NO_VAL time_limit */
 	if (job_ptr->time_limit == NO_VAL)
@@ -845,6 +859,11 @@ static void _load_config(void)
 		yield_sleep = YIELD_SLEEP;
 	}
 
+	if (sched_params && xstrcasestr(sched_params, "bf_node_timeline"))
+		bf_node_timeline = true;
+	else
+		bf_node_timeline = false;
+
 	if (sched_params && (tmp_ptr = xstrcasestr(sched_params,
 						   "max_rpc_cnt=")))
 		defer_rpc_cnt = atoi(tmp_ptr + 12);
@@ -969,14 +988,48 @@ extern void *backfill_agent(void *args)
 	return NULL;
 }
 
+/*
+ * AND avail_bitmap with the available nodes of every node_space record
+ * overlapping the time window from start_res to end_time and set later_start
+ * to the end time of the first such record (if not already set).
+ */
+static void _node_space_and(node_space_map_t *node_space,
+			    bitstr_t *avail_bitmap, time_t start_res,
+			    uint32_t end_time, time_t *later_start)
+{
+	int j;
+
+	if (bf_timeline) {
+		node_timeline_and(bf_timeline, avail_bitmap, start_res,
+				  end_time + 1, later_start);
+		return;
+	}
+
+	for (j = 0; ; ) {
+		if ((node_space[j].end_time > start_res) &&
+		     node_space[j].next && (*later_start == 0))
+			*later_start = node_space[j].end_time;
+		if (node_space[j].end_time <= start_res)
+			;
+		else if (node_space[j].begin_time <= end_time)
+			bit_and(avail_bitmap, node_space[j].avail_bitmap);
+		else
+			break;
+		if ((j = node_space[j].next) == 0)
+			break;
+	}
+}
+
 /* Clear the start_time for all pending jobs. This is used to ensure that a job which
  * can run in multiple partitions has its start_time set to the smallest
  * value in any of those partitions. */
 static int _clear_job_start_times(void *x, void *arg)
 {
 	struct job_record *job_ptr = (struct job_record *) x;
-	if (IS_JOB_PENDING(job_ptr))
+	if (IS_JOB_PENDING(job_ptr) && job_ptr->start_time) {
 		job_ptr->start_time = 0;
+		JOB_RECORD_CHANGED(job_ptr);
+	}
 	return SLURM_SUCCESS;
 }
 
@@ -1193,6 +1246,9 @@ static int _attempt_backfill(void)
 	node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
 	node_space[0].next = 0;
 	node_space_recs = 1;
+	if (bf_node_timeline)
+		bf_timeline = node_timeline_create(avail_node_bitmap,
+						   sched_start, window_end);
 	if (debug_flags & DEBUG_FLAG_BACKFILL_MAP)
 		_dump_node_space_table(node_space);
 
@@ -1350,13 +1406,16 @@ static int _attempt_backfill(void)
 				job_ptr->state_reason = WAIT_NO_REASON;
 				xfree(job_ptr->state_desc);
 				job_ptr->assoc_id = assoc_rec.id;
-				last_job_update = now;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				debug("backfill: %pJ has invalid association",
 				      job_ptr);
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason =
 					WAIT_ASSOC_RESOURCE_LIMIT;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 				continue;
 			}
 		}
@@ -1377,13 +1436,15 @@ static int _attempt_backfill(void)
 				      job_ptr);
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = FAIL_QOS;
-				last_job_update = now;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 				assoc_mgr_unlock(&locks);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
-				last_job_update = now;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -1835,20 +1896,8 @@ next_task:
 		bit_and(avail_bitmap, up_node_bitmap);
 		filter_by_node_owner(job_ptr, avail_bitmap);
 		filter_by_node_mcs(job_ptr, mcs_select, avail_bitmap);
-		for (j = 0; ; ) {
-			if ((node_space[j].end_time > start_res) &&
-			     node_space[j].next && (later_start == 0))
-				later_start = node_space[j].end_time;
-			if (node_space[j].end_time <= start_res)
-				;
-			else if (node_space[j].begin_time <= end_time) {
-				bit_and(avail_bitmap,
-					node_space[j].avail_bitmap);
-			} else
-				break;
-			if ((j = node_space[j].next) == 0)
-				break;
-		}
+		_node_space_and(node_space, avail_bitmap, start_res,
+				end_time, &later_start);
 		if (resv_end && (++resv_end < window_end) &&
 		    ((later_start == 0) || (resv_end < later_start))) {
 			later_start = resv_end;
@@ -1956,7 +2005,7 @@ next_task:
 			orig_end_time = end_time;
 			end_time += boot_time;
 
-			for (j = 0; ; ) {
+			for (j = 0; !bf_timeline; ) {
 				if (node_space[j].end_time <= start_res)
 					;
 				else if (node_space[j].begin_time <= end_time) {
@@ -1969,6 +2018,11 @@ next_task:
 				if ((j = node_space[j].next) == 0)
 					break;
 			}
+			if (bf_timeline) {
+				node_timeline_and(bf_timeline, avail_bitmap,
+						  orig_end_time + 1,
+						  end_time + 1, NULL);
+			}
 		}
 		if (test_fini != 1) {
 			/* Either active_bitmap was NULL or not usable by the
@@ -2000,6 +2054,7 @@ next_task:
 		if (start_res > job_ptr->start_time) {
 			job_ptr->start_time = start_res;
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 		/*
 		 * avail_bitmap at this point contains a bitmap of nodes
@@ -2033,6 +2088,7 @@ next_task:
 				     job_reason_string(job_ptr->state_reason),
 				     job_ptr->priority);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			_set_job_time_limit(job_ptr, orig_time_limit);
 			later_start = 0;
 			if (bb == -1)
@@ -2440,6 +2496,8 @@ skip_start:
 			break;
 	}
 	xfree(node_space);
+	node_timeline_free(bf_timeline);
+	bf_timeline = NULL;
 	FREE_NULL_LIST(job_queue);
 
 	gettimeofday(&bf_time2, NULL);
@@ -2495,6 +2553,7 @@ static int _start_job(struct job_record *job_ptr, bitstr_t *resv_bitmap)
 	if (rc == SLURM_SUCCESS) {
 		/* job initiated */
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 		info("backfill: Started %pJ in %s on %s",
 		     job_ptr, job_ptr->part_ptr->name, job_ptr->nodes);
 		power_g_job_start(job_ptr);
@@ -2545,7 +2604,12 @@ static uint32_t _get_job_max_tl(struct job_record *job_ptr, time_t now,
 	if (job_ptr->time_min == 0)
 		return max_tl;
 
-	for (j = 0; ; ) {
+	if (bf_timeline) {
+		comp_time = node_timeline_first_resv(bf_timeline,
+						     job_ptr->node_bitmap, now,
+						     job_ptr->end_time);
+	}
+	for (j = 0; !bf_timeline; ) {
 		if ((node_space[j].begin_time != now) && // No current conflicts
 		    (node_space[j].begin_time < job_ptr->end_time) &&
 		    (!bit_super_set(job_ptr->node_bitmap,
@@ -2577,8 +2641,18 @@ static void _reset_job_time_limit(struct job_record *job_ptr, time_t now,
 	int32_t j, resv_delay;
 	uint32_t orig_time_limit = job_ptr->time_limit;
 	uint32_t new_time_limit;
-
-	for (j = 0; ; ) {
+	time_t resv_time;
+
+	if (bf_timeline &&
+	    (resv_time = node_timeline_first_resv(bf_timeline,
+						  job_ptr->node_bitmap, now,
+						  job_ptr->end_time))) {
+		resv_delay = difftime(resv_time, now);
+		resv_delay /= 60;	/* seconds to minutes */
+		if (resv_delay < job_ptr->time_limit)
+			job_ptr->time_limit = resv_delay;
+	}
+	for (j = 0; !bf_timeline; ) {
 		if ((node_space[j].begin_time != now) && // No current conflicts
 		    (node_space[j].begin_time < job_ptr->end_time) &&
 		    (!bit_super_set(job_ptr->node_bitmap,
@@ -2621,6 +2695,29 @@ static bool _more_work (time_t last_backfill_time)
 	return rc;
 }
 
+/* Log node timeline in the same format as the node_space map */
+static void _timeline_dump(node_timeline_t *tl)
+{
+	bitstr_t *avail_bitmap;
+	time_t begin_time, end_time;
+	char begin_buf[32], end_buf[32], *node_list;
+	int i;
+
+	info("=========================================");
+	for (i = 0; node_timeline_slice(tl, i, &begin_time, &end_time); i++) {
+		avail_bitmap = bit_copy(avail_node_bitmap);
+		node_timeline_and(tl, avail_bitmap, begin_time, end_time, NULL);
+		slurm_make_time_str(&begin_time, begin_buf, sizeof(begin_buf));
+		slurm_make_time_str(&end_time, end_buf, sizeof(end_buf));
+		node_list = bitmap2node_name(avail_bitmap);
+		info("Begin:%s End:%s Nodes:%s",
+		     begin_buf, end_buf, node_list);
+		xfree(node_list);
+		FREE_NULL_BITMAP(avail_bitmap);
+	}
+	info("=========================================");
+}
+
 /* Create a reservation for a job in the future */
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap,
@@ -2630,6 +2727,14 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 	bool placed = false;
 	int i, j;
 
+	if (bf_timeline) {
+		node_timeline_add(bf_timeline, start_time, end_reserve,
+				  res_bitmap);
+		/* Same limit on reservations as the node_space map */
+		(*node_space_recs) += 2;
+		return;
+	}
+
 #if 0	
 	info("add job start:%u end:%u", start_time, end_reserve);
 	for (j = 0; ; ) {
@@ -2728,6 +2833,11 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 	bool overlap = false;
 	int j;
 
+	if (bf_timeline) {
+		return node_timeline_overlap(bf_timeline, use_bitmap,
+					     start_time, end_reserve);
+	}
+
 	for (j=0; ; ) {
 		if ((node_space[j].end_time   > start_time) &&
 		    (node_space[j].begin_time < end_reserve) &&
@@ -2868,10 +2978,12 @@ static time_t _pack_start_find(struct job_record *job_ptr, time_t now)
 			if (job_ptr->state_reason == WAIT_TIME) {
 				job_ptr->state_reason = WAIT_NO_REASON;
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 			if (job_ptr->state_reason_prev == WAIT_TIME) {
 				job_ptr->state_reason_prev = WAIT_NO_REASON;
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 		}
 
@@ -3220,6 +3332,7 @@ static void _pack_kill_now(pack_job_map_t *map)
 		job_ptr->end_time   = now;
 		job_ptr->job_state  = JOB_PENDING | JOB_COMPLETING;
 		last_job_update     = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		build_cg_bitmap(job_ptr);
 		job_completion_logger(job_ptr, false);
 		deallocate_nodes(job_ptr, false, false, false);
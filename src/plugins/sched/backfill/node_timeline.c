@@ -0,0 +1,250 @@
+/*****************************************************************************\
+ *  node_timeline.c - time indexed node reservations for the backfill scheduler
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <string.h>
+
+#include "src/common/cbitstring.h"
+#include "src/common/macros.h"
+#include "src/common/xmalloc.h"
+
+#include "node_timeline.h"
+
+typedef struct node_resv {
+	time_t begin_time;
+	time_t end_time;
+	time_t max_end_time;	/* Latest end_time of this and earlier records */
+	cbitstr_t *node_bitmap;	/* Reserved nodes */
+} node_resv_t;
+
+struct node_timeline {
+	bitstr_t *avail_bitmap;		/* Nodes available at begin_time */
+	time_t begin_time;		/* Start of backfill window */
+	time_t end_time;		/* End of backfill window */
+	node_resv_t *resv;		/* Reservations, by begin_time */
+	int resv_cnt;
+	int resv_size;
+	time_t *bound;			/* Sorted reservation begin/end times */
+	int bound_cnt;
+	int bound_size;
+};
+
+extern node_timeline_t *node_timeline_create(bitstr_t *avail_bitmap,
+					     time_t begin_time,
+					     time_t end_time)
+{
+	node_timeline_t *tl = xmalloc(sizeof(node_timeline_t));
+
+	tl->avail_bitmap = bit_copy(avail_bitmap);
+	tl->begin_time = begin_time;
+	tl->end_time = end_time;
+
+	return tl;
+}
+
+extern void node_timeline_free(node_timeline_t *tl)
+{
+	int i;
+
+	if (!tl)
+		return;
+	for (i = 0; i < tl->resv_cnt; i++)
+		cbit_free(tl->resv[i].node_bitmap);
+	xfree(tl->resv);
+	xfree(tl->bound);
+	FREE_NULL_BITMAP(tl->avail_bitmap);
+	xfree(tl);
+}
+
+/* Return index of the first bound greater than the specified time */
+static int _bound_next(node_timeline_t *tl, time_t when)
+{
+	int lo = 0, hi = tl->bound_cnt, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (tl->bound[mid] <= when)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/* Add a time at which node availability changes */
+static void _bound_add(node_timeline_t *tl, time_t when)
+{
+	int i;
+
+	if ((when <= tl->begin_time) || (when >= tl->end_time))
+		return;
+	i = _bound_next(tl, when);
+	if ((i > 0) && (tl->bound[i - 1] == when))
+		return;
+	if (tl->bound_cnt >= tl->bound_size) {
+		tl->bound_size = MAX(64, tl->bound_size * 2);
+		xrealloc(tl->bound, sizeof(time_t) * tl->bound_size);
+	}
+	memmove(tl->bound + i + 1, tl->bound + i,
+		sizeof(time_t) * (tl->bound_cnt - i));
+	tl->bound[i] = when;
+	tl->bound_cnt++;
+}
+
+/* Return count of reservations which begin before the specified time */
+static int _resv_before(node_timeline_t *tl, time_t when)
+{
+	int lo = 0, hi = tl->resv_cnt, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (tl->resv[mid].begin_time < when)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+extern void node_timeline_add(node_timeline_t *tl, time_t begin_time,
+			      time_t end_time, bitstr_t *res_bitmap)
+{
+	bitstr_t *resv_bitmap;
+	node_resv_t *resv;
+	int i;
+
+	begin_time = MAX(begin_time, tl->begin_time);
+	_bound_add(tl, begin_time);
+	_bound_add(tl, end_time);
+	if (end_time <= begin_time)
+		return;
+
+	resv_bitmap = bit_copy(res_bitmap);
+	bit_not(resv_bitmap);
+	if (bit_ffs(resv_bitmap) == -1) {
+		FREE_NULL_BITMAP(resv_bitmap);
+		return;
+	}
+
+	/* After any reservations with the same begin_time */
+	i = _resv_before(tl, begin_time + 1);
+	if (tl->resv_cnt >= tl->resv_size) {
+		tl->resv_size = MAX(64, tl->resv_size * 2);
+		xrealloc(tl->resv, sizeof(node_resv_t) * tl->resv_size);
+	}
+	memmove(tl->resv + i + 1, tl->resv + i,
+		sizeof(node_resv_t) * (tl->resv_cnt - i));
+	resv = &tl->resv[i];
+	resv->begin_time = begin_time;
+	resv->end_time = end_time;
+	resv->node_bitmap = cbit_from_bitstr(resv_bitmap);
+	FREE_NULL_BITMAP(resv_bitmap);
+	tl->resv_cnt++;
+
+	for ( ; i < tl->resv_cnt; i++) {
+		resv = &tl->resv[i];
+		resv->max_end_time = resv->end_time;
+		if (i && (resv[-1].max_end_time > resv->max_end_time))
+			resv->max_end_time = resv[-1].max_end_time;
+	}
+}
+
+extern void node_timeline_and(node_timeline_t *tl, bitstr_t *avail_bitmap,
+			      time_t begin_time, time_t end_time,
+			      time_t *later_start)
+{
+	node_resv_t *resv;
+	int i;
+
+	bit_and(avail_bitmap, tl->avail_bitmap);
+	for (i = _resv_before(tl, end_time) - 1; i >= 0; i--) {
+		resv = &tl->resv[i];
+		if (resv->max_end_time <= begin_time)
+			break;
+		if (resv->end_time > begin_time)
+			bit_and_not_cbit(avail_bitmap, resv->node_bitmap);
+	}
+
+	if (later_start && (*later_start == 0)) {
+		i = _bound_next(tl, begin_time);
+		if (i < tl->bound_cnt)
+			*later_start = tl->bound[i];
+	}
+}
+
+extern bool node_timeline_overlap(node_timeline_t *tl, bitstr_t *use_bitmap,
+				  time_t begin_time, time_t end_time)
+{
+	node_resv_t *resv;
+	int i;
+
+	if (!bit_super_set(use_bitmap, tl->avail_bitmap))
+		return true;
+	for (i = _resv_before(tl, end_time) - 1; i >= 0; i--) {
+		resv = &tl->resv[i];
+		if (resv->max_end_time <= begin_time)
+			break;
+		if ((resv->end_time > begin_time) &&
+		    bit_overlap_any_cbit(use_bitmap, resv->node_bitmap))
+			return true;
+	}
+	return false;
+}
+
+extern time_t node_timeline_first_resv(node_timeline_t *tl,
+				       bitstr_t *node_bitmap, time_t now,
+				       time_t end_time)
+{
+	node_resv_t *resv;
+	int i;
+
+	/* Reservations are by begin_time, so the first match is earliest */
+	for (i = 0; i < tl->resv_cnt; i++) {
+		resv = &tl->resv[i];
+		if (resv->begin_time >= end_time)
+			break;
+		if ((resv->begin_time != now) &&
+		    bit_overlap_any_cbit(node_bitmap, resv->node_bitmap))
+			return resv->begin_time;
+	}
+	return 0;
+}
+
+extern bool node_timeline_slice(node_timeline_t *tl, int inx,
+				time_t *begin_time, time_t *end_time)
+{
+	if ((inx < 0) || (inx > tl->bound_cnt))
+		return false;
+	*begin_time = inx ? tl->bound[inx - 1] : tl->begin_time;
+	*end_time = (inx < tl->bound_cnt) ? tl->bound[inx] : tl->end_time;
+	return true;
+}
@@ -0,0 +1,101 @@
+/*****************************************************************************\
+ *  node_timeline.h - time indexed node reservations for the backfill scheduler
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURM_BACKFILL_NODE_TIMELINE_H
+#define _SLURM_BACKFILL_NODE_TIMELINE_H
+
+#include <stdbool.h>
+#include <time.h>
+
+#include "src/common/bitstring.h"
+
+/*
+ * Alternative to the backfill node_space map, used with
+ * SchedulerParameters=bf_node_timeline. Rather than a full cluster bitmap for
+ * every time slice, each reservation for a pending job is kept once, with its
+ * nodes run-length compressed, in an array sorted by begin time. Every record
+ * also holds the latest end time of itself and all earlier records, so the
+ * reservations overlapping a time window are found by a binary search on the
+ * window end followed by a backward scan which stops as soon as no earlier
+ * record can reach the window start. A sorted array of all reservation begin
+ * and end times identifies the next time at which node availability changes.
+ */
+typedef struct node_timeline node_timeline_t;
+
+/* Create a timeline from begin_time to end_time of the nodes in avail_bitmap */
+extern node_timeline_t *node_timeline_create(bitstr_t *avail_bitmap,
+					     time_t begin_time,
+					     time_t end_time);
+
+extern void node_timeline_free(node_timeline_t *tl);
+
+/*
+ * Reserve nodes from begin_time to end_time - 1
+ * res_bitmap IN - nodes NOT to be reserved (same as node_space map)
+ */
+extern void node_timeline_add(node_timeline_t *tl, time_t begin_time,
+			      time_t end_time, bitstr_t *res_bitmap);
+
+/*
+ * Clear nodes from avail_bitmap which are not available at any time from
+ * begin_time to end_time - 1.
+ * later_start IN/OUT - if not NULL and zero, set to the next time after
+ *	begin_time at which node availability changes
+ */
+extern void node_timeline_and(node_timeline_t *tl, bitstr_t *avail_bitmap,
+			      time_t begin_time, time_t end_time,
+			      time_t *later_start);
+
+/*
+ * Test if any of the nodes in use_bitmap are not available at any time from
+ * begin_time to end_time - 1
+ */
+extern bool node_timeline_overlap(node_timeline_t *tl, bitstr_t *use_bitmap,
+				  time_t begin_time, time_t end_time);
+
+/*
+ * Return the earliest begin time (other than now) of any reservation of the
+ * nodes in node_bitmap which begins before end_time, zero if none
+ */
+extern time_t node_timeline_first_resv(node_timeline_t *tl,
+				       bitstr_t *node_bitmap, time_t now,
+				       time_t end_time);
+
+/*
+ * Get the time slice inx, between consecutive times at which node
+ * availability changes. Return false if there is no such slice.
+ */
+extern bool node_timeline_slice(node_timeline_t *tl, int inx,
+				time_t *begin_time, time_t *end_time);
+
+#endif	/* _SLURM_BACKFILL_NODE_TIMELINE_H */
@@ -143,6 +143,7 @@ static void _compute_start_times(void)
 {
 	int j, rc = SLURM_SUCCESS, job_cnt = 0;
 	List job_queue;
+	job_queue_heap_t job_heap;
 	job_queue_rec_t *job_queue_rec;
 	List preemptee_candidates = NULL;
 	struct job_record *job_ptr;
@@ -157,8 +158,9 @@ static void _compute_start_times(void)
 	last_job_alloc = now - 1;
 	alloc_bitmap = bit_alloc(node_record_count);
 	job_queue = build_job_queue(true, false);
-	sort_job_queue(job_queue);
-	while ((job_queue_rec = (job_queue_rec_t *) list_pop(job_queue))) {
+	job_queue_heap_build(job_queue, &job_heap);
+	FREE_NULL_LIST(job_queue);
+	while ((job_queue_rec = job_queue_heap_pop(&job_heap))) {
 		job_ptr  = job_queue_rec->job_ptr;
 		part_ptr = job_queue_rec->part_ptr;
 		xfree(job_queue_rec);
@@ -210,6 +212,7 @@ static void _compute_start_times(void)
 				       exc_core_bitmap);
 		if (rc == SLURM_SUCCESS) {
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			if (job_ptr->time_limit == INFINITE)
 				time_limit = 365 * 24 * 60 * 60;
 			else if (job_ptr->time_limit != NO_VAL)
@@ -235,7 +238,7 @@ static void _compute_start_times(void)
 			break;
 		}
 	}
-	FREE_NULL_LIST(job_queue);
+	job_queue_heap_free(&job_heap);
 	FREE_NULL_BITMAP(alloc_bitmap);
 }
 
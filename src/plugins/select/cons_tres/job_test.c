@@ -3753,8 +3753,8 @@ static int _eval_nodes_dfly(struct job_record *job_ptr,
 		     i < switch_record_cnt; i++, switch_ptr++) {
 			if (switch_required[i])
 				continue;
-			if (bit_overlap(req2_nodes_bitmap,
-					switch_node_bitmap[i])) {
+			if (bit_overlap_any(req2_nodes_bitmap,
+					    switch_node_bitmap[i])) {
 				switch_required[i] = 1;
 				if (switch_record_table[i].level == 0) {
 					leaf_switch_count++;
@@ -4391,8 +4391,8 @@ static int _eval_nodes_topo(struct job_record *job_ptr,
 		     i < switch_record_cnt; i++, switch_ptr++) {
 			if (switch_required[i])
 				continue;
-			if (bit_overlap(req2_nodes_bitmap,
-					switch_node_bitmap[i])) {
+			if (bit_overlap_any(req2_nodes_bitmap,
+					    switch_node_bitmap[i])) {
 				switch_required[i] = 1;
 				if (switch_record_table[i].level == 0) {
 					leaf_switch_count++;
@@ -6528,8 +6528,8 @@ top:	orig_node_map = bit_copy(save_node_map);
 				    (mode != PREEMPT_MODE_CHECKPOINT) &&
 				    (mode != PREEMPT_MODE_CANCEL))
 					continue;
-				if (bit_overlap(node_bitmap,
-						tmp_job_ptr->node_bitmap) == 0)
+				if (!bit_overlap_any(node_bitmap,
+						     tmp_job_ptr->node_bitmap))
 					continue;
 				list_append(*preemptee_job_list,
 					    tmp_job_ptr);
@@ -6835,8 +6835,8 @@ extern int will_run_test(struct job_record *job_ptr, bitstr_t *node_bitmap,
 		preemptee_iterator =list_iterator_create(preemptee_candidates);
 		while ((tmp_job_ptr = (struct job_record *)
 			list_next(preemptee_iterator))) {
-			if (bit_overlap(node_bitmap,
-					tmp_job_ptr->node_bitmap) == 0)
+			if (!bit_overlap_any(node_bitmap,
+					     tmp_job_ptr->node_bitmap))
 				continue;
 			list_append(*preemptee_job_list, tmp_job_ptr);
 		}
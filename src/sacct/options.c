@@ -655,9 +655,12 @@ extern int get_data(void)
 	int cnt;
 	char *tmp_usage;
 
+	FREE_NULL_LIST(jobs);
 	if (params.opt_completion) {
 		jobs = slurmdb_jobcomp_jobs_get(job_cond);
 		return SLURM_SUCCESS;
+	} else if (job_cond->chunk_size) {
+		jobs = slurmdb_jobs_get_next(acct_db_conn, job_cond);
 	} else {
 		jobs = slurmdb_jobs_get(acct_db_conn, job_cond);
 	}
@@ -1415,6 +1418,14 @@ extern void parse_command_line(int argc, char **argv)
 	}
 	field_count = list_count(print_fields_list);
 
+	/*
+	 * Get and print the jobs a chunk at a time, unless duplicate
+	 * federated jobs are to be removed across all of them.
+	 */
+	if (!params.opt_completion &&
+	    (!params.cluster_name || (job_cond->flags & JOBCOND_FLAG_DUP)))
+		job_cond->chunk_size = SACCT_CHUNK_SIZE;
+
 	if (optind < argc) {
 		error("Unknown arguments:");
 		for (i=optind; i<argc; i++)
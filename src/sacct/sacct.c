@@ -181,12 +181,14 @@ int main(int argc, char **argv)
 	switch (op) {
 	case SACCT_LIST:
 		print_fields_header(print_fields_list);
-		if (get_data() == SLURM_ERROR)
-			exit(errno);
-		if (params.opt_completion)
-			do_list_completion();
-		else
-			do_list();
+		do {
+			if (get_data() == SLURM_ERROR)
+				exit(errno);
+			if (params.opt_completion)
+				do_list_completion();
+			else
+				do_list();
+		} while (params.job_cond->chunk_size && list_count(jobs));
 		break;
 	case SACCT_HELP:
 		do_help();
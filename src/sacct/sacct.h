@@ -71,6 +71,7 @@
 #define LONG_COMP_FIELDS "jobid,uid,jobname,partition,nnodes,nodelist,state,start,end,timelimit"
 
 #define MAX_PRINTFIELDS 100
+#define SACCT_CHUNK_SIZE 1000	/* jobs to get from the database at a time */
 #define FORMAT_STRING_SIZE 34
 
 #define SECONDS_IN_MINUTE 60
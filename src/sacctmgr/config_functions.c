@@ -191,11 +191,24 @@ extern int sacctmgr_list_stats(int argc, char **argv)
 		if (buf->rollup_count[i] > 1)
 			roll_ave /= buf->rollup_count[i];
 		printf("\t%-10s count:%-6u ave_time:%-6"PRIu64
-		       " max_time:%-12"PRIu64" total_time:%-12"PRIu64"\n",
+		       " max_time:%-12"PRIu64" total_time:%-12"PRIu64,
 		       rollup_type, buf->rollup_count[i], roll_ave,
 		       buf->rollup_max_time[i], buf->rollup_time[i]);
+		if (buf->rollup_periods)
+			printf(" periods:%-8"PRIu64, buf->rollup_periods[i]);
+		printf("\n");
 	}
 
+	printf("\nBatched message statistics\n");
+	roll_ave = buf->batch_time;
+	if (buf->batch_cnt > 1)
+		roll_ave /= buf->batch_cnt;
+	printf("\tcount:%-6u failed:%-6u messages:%-8"PRIu64
+	       " ave_time:%-6"PRIu64" max_time:%-12"PRIu64
+	       " total_time:%-12"PRIu64"\n",
+	       buf->batch_cnt, buf->batch_fail_cnt, buf->batch_rec_cnt,
+	       roll_ave, buf->batch_max_time, buf->batch_time);
+
 	if (argc) {
 		if (!xstrncasecmp(argv[0], "ave_time", 2))
 			sort_by_ave_time = true;
@@ -52,6 +52,7 @@ extern int  sdiag_param;
 extern bool sort_by_id;
 extern bool sort_by_time;
 extern bool sort_by_time2;
+extern bool parsable;
 
 /*
  * parse_command_line, fill in params data structure with data
@@ -63,6 +64,7 @@ extern void parse_command_line(int argc, char **argv)
 	static struct option long_options[] = {
 		{"all",		no_argument,	0,	'a'},
 		{"help",	no_argument,	0,	'h'},
+		{"parsable",	no_argument,	0,	'p'},
 		{"reset",	no_argument,	0,	'r'},
 		{"sort-by-id",	no_argument,	0,	'i'},
 		{"sort-by-time",no_argument,	0,	't'},
@@ -72,7 +74,7 @@ extern void parse_command_line(int argc, char **argv)
 		{NULL,		0,		0,	0}
 	};
 
-	while ((opt_char = getopt_long(argc, argv, "ahirtTV", long_options,
+	while ((opt_char = getopt_long(argc, argv, "ahiprtTV", long_options,
 				       &option_index)) != -1) {
 		switch (opt_char) {
 			case (int)'a':
@@ -85,6 +87,9 @@ extern void parse_command_line(int argc, char **argv)
 			case (int)'i':
 				sort_by_id = true;
 				break;
+			case (int)'p':
+				parsable = true;
+				break;
 			case (int)'r':
 				sdiag_param = STAT_COMMAND_RESET;
 				break;
@@ -109,7 +114,7 @@ extern void parse_command_line(int argc, char **argv)
 
 static void _usage( void )
 {
-	printf("\nUsage: sdiag [-ar] \n");
+	printf("\nUsage: sdiag [-apr] \n");
 }
 
 static void _help( void )
@@ -117,6 +122,7 @@ static void _help( void )
 	printf ("\
 Usage: sdiag [OPTIONS]\n\
   -a              all statistics\n\
+  -p              RPC statistics only, one \"|\" delimited record per line\n\
   -r              reset statistics\n\
 \nHelp options:\n\
   --help          show this help message\n\
@@ -55,10 +55,15 @@ int sdiag_param = STAT_COMMAND_GET;
 bool sort_by_id    = false;
 bool sort_by_time  = false;
 bool sort_by_time2 = false;
+bool parsable      = false;
 
 stats_info_response_msg_t *buf;
 uint32_t *rpc_type_ave_time = NULL, *rpc_user_ave_time = NULL;
+int *rpc_type_order = NULL, *rpc_user_order = NULL;
 
+static void _print_lock_stats(void);
+static void _print_rpc_parsable(void);
+static void _print_rpc_queue_stats(void);
 static int  _print_stats(void);
 static void _sort_rpc(void);
 
@@ -86,12 +91,17 @@ int main(int argc, char **argv)
 					  (stats_info_request_msg_t *)&req);
 		if (rc == SLURM_SUCCESS) {
 			_sort_rpc();
-			rc = _print_stats();
+			if (parsable)
+				_print_rpc_parsable();
+			else
+				rc = _print_stats();
 #ifdef MEMORY_LEAK_DEBUG
 			uid_cache_clear();
 			slurm_free_stats_response_msg(buf);
 			xfree(rpc_type_ave_time);
 			xfree(rpc_user_ave_time);
+			xfree(rpc_type_order);
+			xfree(rpc_user_order);
 #endif
 		} else
 			slurm_perror("slurm_get_statistics");
@@ -102,7 +112,7 @@ int main(int argc, char **argv)
 
 static int _print_stats(void)
 {
-	int i;
+	int i, j;
 
 	if (!buf) {
 		printf("No data available. Probably slurmctld is not working\n");
@@ -119,7 +129,11 @@ static int _print_stats(void)
 	printf("Server thread count:  %d\n", buf->server_thread_count);
 	printf("Agent queue size:     %d\n", buf->agent_queue_size);
 	printf("Agent count:          %d\n", buf->agent_count);
-	printf("DBD Agent queue size: %d\n\n", buf->dbd_agent_queue_size);
+	printf("DBD Agent queue size: %d\n", buf->dbd_agent_queue_size);
+	printf("DBD Agent queue bytes: %"PRIu64"\n",
+	       buf->dbd_agent_queue_bytes);
+	printf("DBD Agent spooled:    %u (%"PRIu64" bytes)\n\n",
+	       buf->dbd_agent_spool_cnt, buf->dbd_agent_spool_bytes);
 
 	printf("Jobs submitted: %d\n", buf->jobs_submitted);
 	printf("Jobs started:   %d\n", buf->jobs_started);
@@ -184,25 +198,67 @@ static int _print_stats(void)
 		       buf->bf_queue_len_sum / buf->bf_cycle_counter);
 	}
 
+	if (buf->comp_batch_cnt) {
+		printf("\nCompletion RPC batches\n");
+		printf("\tTotal batches: %u\n", buf->comp_batch_cnt);
+		printf("\tTotal RPCs:    %u\n", buf->comp_batch_msgs);
+		printf("\tMean batch:    %u\n",
+		       buf->comp_batch_msgs / buf->comp_batch_cnt);
+		printf("\tMax batch:     %u\n", buf->comp_batch_max);
+	}
+
+	if (buf->msg_aggr_cnt) {
+		printf("\nMessage aggregation\n");
+		printf("\tComposite RPCs: %u\n", buf->msg_aggr_cnt);
+		printf("\tMessages:       %u\n", buf->msg_aggr_msgs);
+		printf("\tMean fan-in:    %u\n",
+		       buf->msg_aggr_msgs / buf->msg_aggr_cnt);
+		printf("\tMax fan-in:     %u\n", buf->msg_aggr_fanin_max);
+		printf("\tMax depth:      %u\n", buf->msg_aggr_depth_max);
+		if (buf->msg_aggr_msgs) {
+			printf("\tMean latency:   %"PRIu64" usec\n",
+			       buf->msg_aggr_latency_sum /
+			       buf->msg_aggr_msgs);
+		}
+		printf("\tMax latency:    %"PRIu64" usec\n",
+		       buf->msg_aggr_latency_max);
+	}
+
 	printf("\nLatency for 1000 calls to gettimeofday(): %d microseconds\n",
 	       buf->gettimeofday_latency);
 
 	printf("\nRemote Procedure Call statistics by message type\n");
-	for (i = 0; i < buf->rpc_type_size; i++) {
+	for (j = 0; j < buf->rpc_type_size; j++) {
+		i = rpc_type_order[j];
 		printf("\t%-40s(%5u) count:%-6u "
-		       "ave_time:%-6u total_time:%"PRIu64"\n",
+		       "ave_time:%-6u total_time:%"PRIu64,
 		       rpc_num2string(buf->rpc_type_id[i]),
 		       buf->rpc_type_id[i], buf->rpc_type_cnt[i],
 		       rpc_type_ave_time[i], buf->rpc_type_time[i]);
+		if (buf->rpc_type_max) {
+			printf(" p50:%-6"PRIu64" p99:%-6"PRIu64
+			       " max:%"PRIu64,
+			       buf->rpc_type_p50[i], buf->rpc_type_p99[i],
+			       buf->rpc_type_max[i]);
+		}
+		printf("\n");
 	}
 
 	printf("\nRemote Procedure Call statistics by user\n");
-	for (i = 0; i < buf->rpc_user_size; i++) {
+	for (j = 0; j < buf->rpc_user_size; j++) {
+		i = rpc_user_order[j];
 		printf("\t%-16s(%8u) count:%-6u "
-		       "ave_time:%-6u total_time:%"PRIu64"\n",
+		       "ave_time:%-6u total_time:%"PRIu64,
 		       uid_to_string_cached((uid_t)buf->rpc_user_id[i]),
 		       buf->rpc_user_id[i], buf->rpc_user_cnt[i],
 		       rpc_user_ave_time[i], buf->rpc_user_time[i]);
+		if (buf->rpc_user_max) {
+			printf(" p50:%-6"PRIu64" p99:%-6"PRIu64
+			       " max:%"PRIu64,
+			       buf->rpc_user_p50[i], buf->rpc_user_p99[i],
+			       buf->rpc_user_max[i]);
+		}
+		printf("\n");
 	}
 
 	printf("\nPending RPC statistics\n");
@@ -226,184 +282,166 @@ static int _print_stats(void)
 		       buf->rpc_dump_hostlist[i]);
 	}
 
+	if (buf->lock_stat_size > 0)
+		_print_lock_stats();
+	if (buf->rpc_class_size > 0)
+		_print_rpc_queue_stats();
+
 	return 0;
 }
 
-static void _sort_rpc(void)
+static void _print_lock_stats(void)
 {
 	int i, j;
-	uint16_t type_id;
-	uint32_t type_ave, type_cnt, user_ave, user_cnt, user_id;
-	uint64_t type_time, user_time;
+	uint64_t limit, *hist;
 
-	rpc_type_ave_time = xmalloc(sizeof(uint32_t) * buf->rpc_type_size);
-	rpc_user_ave_time = xmalloc(sizeof(uint32_t) * buf->rpc_user_size);
+	printf("\nLock statistics (microseconds)\n");
+	for (i = 0; i < buf->lock_stat_size; i++) {
+		if (buf->lock_acquire_cnt[i] == 0)
+			continue;
+		printf("\t%-18s count:%-8"PRIu64" ave_wait:%-6"PRIu64
+		       " max_wait:%-8"PRIu64" ave_hold:%-6"PRIu64
+		       " max_hold:%"PRIu64"\n",
+		       buf->lock_stat_name[i], buf->lock_acquire_cnt[i],
+		       buf->lock_wait_time[i] / buf->lock_acquire_cnt[i],
+		       buf->lock_wait_max[i],
+		       buf->lock_hold_time[i] / buf->lock_acquire_cnt[i],
+		       buf->lock_hold_max[i]);
 
-	if (sort_by_id) {
-		for (i = 0; i < buf->rpc_type_size; i++) {
-			for (j = i+1; j < buf->rpc_type_size; j++) {
-				if (buf->rpc_type_id[i] <= buf->rpc_type_id[j])
-					continue;
-				type_id   = buf->rpc_type_id[i];
-				type_cnt  = buf->rpc_type_cnt[i];
-				type_time = buf->rpc_type_time[i];
-				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
-				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
-				buf->rpc_type_time[i] = buf->rpc_type_time[j];
-				buf->rpc_type_id[j]   = type_id;
-				buf->rpc_type_cnt[j]  = type_cnt;
-				buf->rpc_type_time[j] = type_time;
-			}
-			if (buf->rpc_type_cnt[i]) {
-				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
-						       buf->rpc_type_cnt[i];
-			}
-		}
-		for (i = 0; i < buf->rpc_user_size; i++) {
-			for (j = i+1; j < buf->rpc_user_size; j++) {
-				if (buf->rpc_user_id[i] <= buf->rpc_user_id[j])
-					continue;
-				user_id   = buf->rpc_user_id[i];
-				user_cnt  = buf->rpc_user_cnt[i];
-				user_time = buf->rpc_user_time[i];
-				buf->rpc_user_id[i]   = buf->rpc_user_id[j];
-				buf->rpc_user_cnt[i]  = buf->rpc_user_cnt[j];
-				buf->rpc_user_time[i] = buf->rpc_user_time[j];
-				buf->rpc_user_id[j]   = user_id;
-				buf->rpc_user_cnt[j]  = user_cnt;
-				buf->rpc_user_time[j] = user_time;
-			}
-			if (buf->rpc_user_cnt[i]) {
-				rpc_user_ave_time[i] = buf->rpc_user_time[i] /
-						       buf->rpc_user_cnt[i];
-			}
+		hist = buf->lock_hold_hist + (i * buf->lock_hist_size);
+		printf("\t%-18s", "");
+		for (j = 0, limit = 10; j < buf->lock_hist_size;
+		     j++, limit *= 10) {
+			if (j == (buf->lock_hist_size - 1))
+				printf(" >=%"PRIu64":", limit / 10);
+			else
+				printf(" <%"PRIu64":", limit);
+			printf("%"PRIu64, hist[j]);
 		}
-	} else if (sort_by_time) {
-		for (i = 0; i < buf->rpc_type_size; i++) {
-			for (j = i+1; j < buf->rpc_type_size; j++) {
-				if (buf->rpc_type_time[i] >= buf->rpc_type_time[j])
-					continue;
-				type_id   = buf->rpc_type_id[i];
-				type_cnt  = buf->rpc_type_cnt[i];
-				type_time = buf->rpc_type_time[i];
-				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
-				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
-				buf->rpc_type_time[i] = buf->rpc_type_time[j];
-				buf->rpc_type_id[j]   = type_id;
-				buf->rpc_type_cnt[j]  = type_cnt;
-				buf->rpc_type_time[j] = type_time;
-			}
-			if (buf->rpc_type_cnt[i]) {
-				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
-						       buf->rpc_type_cnt[i];
-			}
-		}
-		for (i = 0; i < buf->rpc_user_size; i++) {
-			for (j = i+1; j < buf->rpc_user_size; j++) {
-				if (buf->rpc_user_time[i] >= buf->rpc_user_time[j])
-					continue;
-				user_id   = buf->rpc_user_id[i];
-				user_cnt  = buf->rpc_user_cnt[i];
-				user_time = buf->rpc_user_time[i];
-				buf->rpc_user_id[i]   = buf->rpc_user_id[j];
-				buf->rpc_user_cnt[i]  = buf->rpc_user_cnt[j];
-				buf->rpc_user_time[i] = buf->rpc_user_time[j];
-				buf->rpc_user_id[j]   = user_id;
-				buf->rpc_user_cnt[j]  = user_cnt;
-				buf->rpc_user_time[j] = user_time;
-			}
-			if (buf->rpc_user_cnt[i]) {
-				rpc_user_ave_time[i] = buf->rpc_user_time[i] /
-						       buf->rpc_user_cnt[i];
-			}
-		}
-	} else if (sort_by_time2) {
-		for (i = 0; i < buf->rpc_type_size; i++) {
-			if (buf->rpc_type_cnt[i]) {
-				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
-						       buf->rpc_type_cnt[i];
-			}
-		}
-		for (i = 0; i < buf->rpc_type_size; i++) {
-			for (j = i+1; j < buf->rpc_type_size; j++) {
-				if (rpc_type_ave_time[i] >= rpc_type_ave_time[j])
-					continue;
-				type_ave  = rpc_type_ave_time[i];
-				type_id   = buf->rpc_type_id[i];
-				type_cnt  = buf->rpc_type_cnt[i];
-				type_time = buf->rpc_type_time[i];
-				rpc_type_ave_time[i]  = rpc_type_ave_time[j];
-				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
-				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
-				buf->rpc_type_time[i] = buf->rpc_type_time[j];
-				rpc_type_ave_time[j]  = type_ave;
-				buf->rpc_type_id[j]   = type_id;
-				buf->rpc_type_cnt[j]  = type_cnt;
-				buf->rpc_type_time[j] = type_time;
-			}
-		}
-		for (i = 0; i < buf->rpc_user_size; i++) {
-			if (buf->rpc_user_cnt[i]) {
-				rpc_user_ave_time[i] = buf->rpc_user_time[i] /
-						       buf->rpc_user_cnt[i];
-			}
-		}
-		for (i = 0; i < buf->rpc_user_size; i++) {
-			for (j = i+1; j < buf->rpc_user_size; j++) {
-				if (rpc_user_ave_time[i] >= rpc_user_ave_time[j])
-					continue;
-				user_ave  = rpc_user_ave_time[i];
-				user_id   = buf->rpc_user_id[i];
-				user_cnt  = buf->rpc_user_cnt[i];
-				user_time = buf->rpc_user_time[i];
-				rpc_user_ave_time[i]  = rpc_user_ave_time[j];
-				buf->rpc_user_id[i]   = buf->rpc_user_id[j];
-				buf->rpc_user_cnt[i]  = buf->rpc_user_cnt[j];
-				buf->rpc_user_time[i] = buf->rpc_user_time[j];
-				rpc_user_ave_time[j]  = user_ave;
-				buf->rpc_user_id[j]   = user_id;
-				buf->rpc_user_cnt[j]  = user_cnt;
-				buf->rpc_user_time[j] = user_time;
-			}
-		}
-	} else { /* sort by count */
-		for (i = 0; i < buf->rpc_type_size; i++) {
-			for (j = i+1; j < buf->rpc_type_size; j++) {
-				if (buf->rpc_type_cnt[i] >= buf->rpc_type_cnt[j])
-					continue;
-				type_id   = buf->rpc_type_id[i];
-				type_cnt  = buf->rpc_type_cnt[i];
-				type_time = buf->rpc_type_time[i];
-				buf->rpc_type_id[i]   = buf->rpc_type_id[j];
-				buf->rpc_type_cnt[i]  = buf->rpc_type_cnt[j];
-				buf->rpc_type_time[i] = buf->rpc_type_time[j];
-				buf->rpc_type_id[j]   = type_id;
-				buf->rpc_type_cnt[j]  = type_cnt;
-				buf->rpc_type_time[j] = type_time;
-			}
-			if (buf->rpc_type_cnt[i]) {
-				rpc_type_ave_time[i] = buf->rpc_type_time[i] /
-						       buf->rpc_type_cnt[i];
-			}
+		printf("\n");
+	}
+}
+
+/*
+ * Print the RPC statistics by message type and by user one record per line,
+ * with fields separated by "|", for processing by other programs
+ */
+static void _print_rpc_parsable(void)
+{
+	int i, j;
+
+	printf("kind|id|name|count|ave_time|total_time|p50|p99|max\n");
+	for (j = 0; j < buf->rpc_type_size; j++) {
+		i = rpc_type_order[j];
+		printf("type|%u|%s|%u|%u|%"PRIu64"|%"PRIu64"|%"PRIu64"|%"PRIu64
+		       "\n", buf->rpc_type_id[i],
+		       rpc_num2string(buf->rpc_type_id[i]),
+		       buf->rpc_type_cnt[i], rpc_type_ave_time[i],
+		       buf->rpc_type_time[i],
+		       buf->rpc_type_p50 ? buf->rpc_type_p50[i] : 0,
+		       buf->rpc_type_p99 ? buf->rpc_type_p99[i] : 0,
+		       buf->rpc_type_max ? buf->rpc_type_max[i] : 0);
+	}
+	for (j = 0; j < buf->rpc_user_size; j++) {
+		i = rpc_user_order[j];
+		printf("user|%u|%s|%u|%u|%"PRIu64"|%"PRIu64"|%"PRIu64"|%"PRIu64
+		       "\n", buf->rpc_user_id[i],
+		       uid_to_string_cached((uid_t)buf->rpc_user_id[i]),
+		       buf->rpc_user_cnt[i], rpc_user_ave_time[i],
+		       buf->rpc_user_time[i],
+		       buf->rpc_user_p50 ? buf->rpc_user_p50[i] : 0,
+		       buf->rpc_user_p99 ? buf->rpc_user_p99[i] : 0,
+		       buf->rpc_user_max ? buf->rpc_user_max[i] : 0);
+	}
+}
+
+static void _print_rpc_queue_stats(void)
+{
+	int i;
+	uint64_t ave_wait;
+
+	printf("\nRPC queue statistics (microseconds)\n");
+	printf("\tWorker threads: %u\n", buf->rpc_worker_cnt);
+	for (i = 0; i < buf->rpc_class_size; i++) {
+		ave_wait = 0;
+		if (buf->rpc_class_cnt[i])
+			ave_wait = buf->rpc_class_wait_time[i] /
+				   buf->rpc_class_cnt[i];
+		printf("\t%-6s depth:%-5u max_depth:%-5u active:%-5u"
+		       " count:%-8"PRIu64" ave_wait:%-6"PRIu64
+		       " max_wait:%"PRIu64"\n",
+		       buf->rpc_class_name[i], buf->rpc_class_depth[i],
+		       buf->rpc_class_depth_max[i], buf->rpc_class_active[i],
+		       buf->rpc_class_cnt[i], ave_wait,
+		       buf->rpc_class_wait_max[i]);
+	}
+}
+
+/* Compare RPC statistics records by the selected sort order */
+static int _rpc_cmp(uint32_t id_a, uint32_t id_b, uint32_t cnt_a,
+		    uint32_t cnt_b, uint64_t time_a, uint64_t time_b)
+{
+	uint64_t ave_a = 0, ave_b = 0;
+
+	if (sort_by_id)
+		return (id_a > id_b) - (id_a < id_b);
+	if (sort_by_time)
+		return (time_a < time_b) - (time_a > time_b);
+	if (sort_by_time2) {
+		if (cnt_a)
+			ave_a = time_a / cnt_a;
+		if (cnt_b)
+			ave_b = time_b / cnt_b;
+		return (ave_a < ave_b) - (ave_a > ave_b);
+	}
+	return (cnt_a < cnt_b) - (cnt_a > cnt_b);
+}
+
+static int _rpc_type_cmp(const void *x, const void *y)
+{
+	int a = *(int *) x, b = *(int *) y;
+
+	return _rpc_cmp(buf->rpc_type_id[a], buf->rpc_type_id[b],
+			buf->rpc_type_cnt[a], buf->rpc_type_cnt[b],
+			buf->rpc_type_time[a], buf->rpc_type_time[b]);
+}
+
+static int _rpc_user_cmp(const void *x, const void *y)
+{
+	int a = *(int *) x, b = *(int *) y;
+
+	return _rpc_cmp(buf->rpc_user_id[a], buf->rpc_user_id[b],
+			buf->rpc_user_cnt[a], buf->rpc_user_cnt[b],
+			buf->rpc_user_time[a], buf->rpc_user_time[b]);
+}
+
+/*
+ * Compute the average RPC times and the order in which to report the RPC
+ * types and users, sorted by count unless another order was requested
+ */
+static void _sort_rpc(void)
+{
+	int i;
+
+	rpc_type_ave_time = xmalloc(sizeof(uint32_t) * buf->rpc_type_size);
+	rpc_type_order = xmalloc(sizeof(int) * buf->rpc_type_size);
+	for (i = 0; i < buf->rpc_type_size; i++) {
+		if (buf->rpc_type_cnt[i]) {
+			rpc_type_ave_time[i] = buf->rpc_type_time[i] /
+					       buf->rpc_type_cnt[i];
 		}
-		for (i = 0; i < buf->rpc_user_size; i++) {
-			for (j = i+1; j < buf->rpc_user_size; j++) {
-				if (buf->rpc_user_cnt[i] >= buf->rpc_user_cnt[j])
-					continue;
-				user_id   = buf->rpc_user_id[i];
-				user_cnt  = buf->rpc_user_cnt[i];
-				user_time = buf->rpc_user_time[i];
-				buf->rpc_user_id[i]   = buf->rpc_user_id[j];
-				buf->rpc_user_cnt[i]  = buf->rpc_user_cnt[j];
-				buf->rpc_user_time[i] = buf->rpc_user_time[j];
-				buf->rpc_user_id[j]   = user_id;
-				buf->rpc_user_cnt[j]  = user_cnt;
-				buf->rpc_user_time[j] = user_time;
-			}
-			if (buf->rpc_user_cnt[i]) {
-				rpc_user_ave_time[i] = buf->rpc_user_time[i] /
-						       buf->rpc_user_cnt[i];
-			}
+		rpc_type_order[i] = i;
+	}
+	qsort(rpc_type_order, buf->rpc_type_size, sizeof(int), _rpc_type_cmp);
+
+	rpc_user_ave_time = xmalloc(sizeof(uint32_t) * buf->rpc_user_size);
+	rpc_user_order = xmalloc(sizeof(int) * buf->rpc_user_size);
+	for (i = 0; i < buf->rpc_user_size; i++) {
+		if (buf->rpc_user_cnt[i]) {
+			rpc_user_ave_time[i] = buf->rpc_user_time[i] /
+					       buf->rpc_user_cnt[i];
 		}
+		rpc_user_order[i] = i;
 	}
+	qsort(rpc_user_order, buf->rpc_user_size, sizeof(int), _rpc_user_cmp);
 }
@@ -512,6 +512,7 @@ static bool _valid_job_assoc(struct job_record *job_ptr)
 			return false;
 		}
 		job_ptr->assoc_id = assoc_rec.id;
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 	return true;
 }
@@ -2336,6 +2337,7 @@ static int _qos_job_time_out(struct job_record *job_ptr,
 	switch (tres_usage) {
 	case TRES_USAGE_CUR_EXCEEDS_LIMIT:
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		info("%pJ timed out, the job is at or exceeds QOS %s's group max tres(%s) minutes of %"PRIu64" with %"PRIu64"",
 		     job_ptr, qos_ptr->name,
 		     assoc_mgr_tres_name_array[tres_pos],
@@ -2361,6 +2363,7 @@ static int _qos_job_time_out(struct job_record *job_ptr,
 
 		if (wall_mins >= qos_ptr->grp_wall) {
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			info("%pJ timed out, the job is at or exceeds QOS %s's group wall limit of %u with %u",
 			     job_ptr, qos_ptr->name,
 			     qos_ptr->grp_wall, wall_mins);
@@ -2380,6 +2383,7 @@ static int _qos_job_time_out(struct job_record *job_ptr,
 		break;
 	case TRES_USAGE_REQ_EXCEEDS_LIMIT:
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		info("%pJ timed out, the job is at or exceeds QOS %s's max tres(%s) minutes of %"PRIu64" with %"PRIu64,
 		     job_ptr, qos_ptr->name,
 		     assoc_mgr_tres_name_array[tres_pos],
@@ -3187,6 +3191,19 @@ extern bool acct_policy_job_runnable_state(struct job_record *job_ptr)
 	return true;
 }
 
+/*
+ * Report a job whose state reason was changed by the limit tests in
+ * incremental job info RPCs. Most pending jobs keep theirs between tests.
+ */
+static void _job_reason_changed(struct job_record *job_ptr,
+				uint32_t orig_reason)
+{
+	if (job_ptr->state_reason == orig_reason)
+		return;
+	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
+}
+
 /*
  * acct_policy_job_runnable_pre_select - Determine if the specified
  *	job can execute right now or not depending upon accounting
@@ -3207,6 +3224,7 @@ extern bool acct_policy_job_runnable_pre_select(struct job_record *job_ptr,
 	int parent = 0; /* flag to tell us if we are looking at the
 			 * parent or not
 			 */
+	uint32_t orig_reason = job_ptr->state_reason;
 	assoc_mgr_lock_t locks =
 		{ .assoc = READ_LOCK, .qos = READ_LOCK, .tres = READ_LOCK };
 
@@ -3217,6 +3235,7 @@ extern bool acct_policy_job_runnable_pre_select(struct job_record *job_ptr,
 	if (!_valid_job_assoc(job_ptr)) {
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = FAIL_ACCOUNT;
+		_job_reason_changed(job_ptr, orig_reason);
 		return false;
 	}
 
@@ -3391,6 +3410,7 @@ end_it:
 	if (!assoc_mgr_locked)
 		assoc_mgr_unlock(&locks);
 	slurmdb_free_qos_rec_members(&qos_rec);
+	_job_reason_changed(job_ptr, orig_reason);
 
 	return rc;
 }
@@ -3417,6 +3437,7 @@ extern bool acct_policy_job_runnable_post_select(
 	int parent = 0; /* flag to tell us if we are looking at the
 			 * parent or not
 			 */
+	uint32_t orig_reason = job_ptr->state_reason;
 	assoc_mgr_lock_t locks =
 		{ .assoc = READ_LOCK, .qos = READ_LOCK, .tres = READ_LOCK };
 
@@ -3742,6 +3763,7 @@ end_it:
 	if (!assoc_mgr_locked)
 		assoc_mgr_unlock(&locks);
 	slurmdb_free_qos_rec_members(&qos_rec);
+	_job_reason_changed(job_ptr, orig_reason);
 
 	return rc;
 }
@@ -3932,6 +3954,7 @@ extern int acct_policy_update_pending_job(struct job_record *job_ptr)
 
 	if (update_accounting) {
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 		debug("limits changed for %pJ: updating accounting", job_ptr);
 		/* Update job record in accounting to reflect changes */
 		jobacct_storage_job_start_direct(acct_db_conn, job_ptr);
@@ -4024,6 +4047,7 @@ extern bool acct_policy_job_time_out(struct job_record *job_ptr)
 		switch (tres_usage) {
 		case TRES_USAGE_CUR_EXCEEDS_LIMIT:
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			info("%pJ timed out, the job is at or exceeds assoc %u(%s/%s/%s) group max tres(%s) minutes of %"PRIu64" with %"PRIu64,
 			     job_ptr, assoc->id, assoc->acct,
 			     assoc->user, assoc->partition,
@@ -4062,6 +4086,7 @@ extern bool acct_policy_job_time_out(struct job_record *job_ptr)
 			break;
 		case TRES_USAGE_REQ_EXCEEDS_LIMIT:
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			info("%pJ timed out, the job is at or exceeds assoc %u(%s/%s/%s) max tres(%s) minutes of %"PRIu64" with %"PRIu64,
 			     job_ptr, assoc->id, assoc->acct,
 			     assoc->user, assoc->partition,
@@ -4140,8 +4165,10 @@ extern int acct_policy_handle_accrue_time(struct job_record *job_ptr,
 	 * submit_time.  Accrue limits don't work with this flag.
 	 */
 	if (priority_flags & PRIORITY_FLAGS_ACCRUE_ALWAYS) {
-		if (!details_ptr->accrue_time)
+		if (!details_ptr->accrue_time) {
 			details_ptr->accrue_time = details_ptr->submit_time;
+			JOB_RECORD_CHANGED(job_ptr);
+		}
 		return SLURM_SUCCESS;
 	}
 
@@ -4267,6 +4294,7 @@ extern int acct_policy_handle_accrue_time(struct job_record *job_ptr,
 				((max_jobs_accrue == INFINITE) &&
 				 details_ptr->begin_time) ?
 				details_ptr->begin_time : time(NULL);
+			JOB_RECORD_CHANGED(job_ptr);
 
 			/*
 			 * If we have an array here and no limit we want to add
@@ -4330,6 +4358,7 @@ extern int acct_policy_handle_accrue_time(struct job_record *job_ptr,
 			goto endit;
 		}
 		details_ptr->accrue_time = now;
+		JOB_RECORD_CHANGED(old_job_ptr);
 		debug3("%pJ is now accruing time %ld", old_job_ptr, now);
 	}
 
@@ -4487,6 +4516,7 @@ extern void acct_policy_remove_accrue_time(struct job_record *job_ptr,
 	/* reset the job */
 	job_ptr->details->accrue_time = 0;
 	job_ptr->bit_flags &= ~JOB_ACCRUE_OVER;
+	JOB_RECORD_CHANGED(job_ptr);
 
 end_it:
 	if (!assoc_mgr_locked)
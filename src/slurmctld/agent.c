@@ -1109,8 +1109,11 @@ static void *_thread_per_group_rpc(void *args)
 					}
 				}
 
-				if (job_ptr)
+				if (job_ptr) {
 					job_ptr->job_state &= ~JOB_SIGNALING;
+					last_job_update = time(NULL);
+					JOB_RECORD_CHANGED(job_ptr);
+				}
 
 				unlock_slurmctld(job_write_lock);
 			}
@@ -1197,8 +1200,11 @@ cleanup:
 			job_id = msg_ptr->job_id;
 			lock_slurmctld(job_write_lock);
 			job_ptr = find_job_record(job_id);
-			if (job_ptr)
+			if (job_ptr) {
 				job_ptr->job_state &= ~JOB_SIGNALING;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
+			}
 			unlock_slurmctld(job_write_lock);
 		}
 	}
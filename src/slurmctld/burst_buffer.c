@@ -744,6 +744,7 @@ extern int bb_g_job_test_stage_out(struct job_record *job_ptr)
 	if ((rc != 0) && (job_ptr->mail_type & MAIL_JOB_STAGE_OUT)) {
 		mail_job_info(job_ptr, MAIL_JOB_STAGE_OUT);
 		job_ptr->mail_type &= (~MAIL_JOB_STAGE_OUT);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
 	return rc;
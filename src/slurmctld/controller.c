@@ -223,6 +223,61 @@ typedef struct primary_thread_arg {
 	char *prog_type;
 } primary_thread_arg_t;
 
+/*
+ * RPC classes in the order their queues are serviced by the RPC workers.
+ * Each class may use at most rpc_class_share quarters of the workers, so a
+ * burst of one class can not keep the others from running.
+ */
+typedef enum {
+	RPC_CLASS_NODE,		/* node registration and job/step completion */
+	RPC_CLASS_READ,		/* information requests */
+	RPC_CLASS_JOB,		/* job submission, update and all others */
+	RPC_CLASS_CNT
+} rpc_class_t;
+
+static const char *rpc_class_name[RPC_CLASS_CNT] = {
+	"Node", "Read", "Job"
+};
+static const int rpc_class_share[RPC_CLASS_CNT] = { 3, 3, 2 };
+
+/*
+ * A client must send its RPC within RPC_RECV_TIMEOUT msec of connecting, and
+ * at most half of the workers receive at once, so slow or stalled clients can
+ * not hold the workers needed to process received RPCs.
+ */
+#define RPC_RECV_TIMEOUT	2000
+/* Workers above RPC_WORKER_MIN exit after RPC_WORKER_IDLE seconds idle */
+#define RPC_WORKER_MIN		4
+#define RPC_WORKER_IDLE		60
+
+typedef struct {
+	List     queue;		/* received RPCs, rpc_work_t */
+	uint32_t active;	/* RPCs being processed */
+	uint32_t active_limit;
+	uint32_t depth_max;
+	uint64_t cnt;		/* RPCs started */
+	uint64_t wait_time;	/* usec queued */
+	uint64_t wait_max;	/* usec */
+} rpc_class_queue_t;
+
+typedef struct {
+	connection_arg_t *conn;
+	slurm_msg_t *msg;	/* NULL until received */
+	rpc_class_t class;
+	struct timeval queue_time;
+} rpc_work_t;
+
+static rpc_class_queue_t rpc_class[RPC_CLASS_CNT];
+static pthread_cond_t  rpc_queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t rpc_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List     rpc_recv_queue = NULL;	/* accepted connections */
+static uint32_t rpc_recv_active = 0;	/* connections being received */
+static uint32_t rpc_recv_limit = 1;
+static uint32_t rpc_worker_cnt = 0;
+static uint32_t rpc_worker_idle = 0;
+static uint32_t rpc_worker_max = 1;	/* SlurmctldParameters=rpc_workers */
+static bool     rpc_worker_stop = false;
+
 static int          _accounting_cluster_ready();
 static int          _accounting_mark_all_nodes_down(char *reason);
 static void *       _assoc_cache_mgr(void *no_data);
@@ -239,6 +294,15 @@ static void         _parse_commandline(int argc, char **argv);
 static void *       _purge_files_thread(void *no_data);
 static void         _remove_assoc(slurmdb_assoc_rec_t *rec);
 static void         _remove_qos(slurmdb_qos_rec_t *rec);
+static rpc_class_t  _rpc_class(uint16_t msg_type);
+static void         _rpc_class_limits(void);
+static void *       _rpc_worker(void *no_data);
+static void         _rpc_workers_fini(void);
+static void         _rpc_workers_init(void);
+static void         _rpc_work_fini(rpc_work_t *work);
+static rpc_work_t * _rpc_work_next(void);
+static void         _rpc_work_queue(List queue, rpc_work_t *work);
+static bool         _rpc_work_recv(rpc_work_t *work);
 static void         _run_primary_prog(bool primary_on);
 static void *       _service_connection(void *arg);
 static void         _set_work_dir(void);
@@ -998,6 +1062,7 @@ static void _reconfigure_slurm(void)
 		slurmctld_config.send_groups_in_cred = true;
 
 	gs_reconfig();
+	_rpc_class_limits();
 	unlock_slurmctld(config_write_lock);
 	xcgroup_reconfig_slurm_cgroup_conf();
 	assoc_mgr_set_missing_uids();
@@ -1089,7 +1154,8 @@ static void _sig_handler(int signal)
 }
 
 /*
- * _slurmctld_rpc_mgr - Read incoming RPCs and create pthread for each
+ * _slurmctld_rpc_mgr - Accept incoming RPCs and queue them for the RPC
+ *	worker threads
  */
 static void *_slurmctld_rpc_mgr(void *no_data)
 {
@@ -1159,6 +1225,8 @@ static void *_slurmctld_rpc_mgr(void *no_data)
 	xsignal(SIGUSR1, _sig_handler);
 	xsignal_unblock(sigarray);
 
+	_rpc_workers_init();
+
 	/*
 	 * Process incoming RPCs until told to shutdown
 	 */
@@ -1214,12 +1282,14 @@ static void *_slurmctld_rpc_mgr(void *no_data)
 			slurmctld_diag_stats.proc_req_raw++;
 			_service_connection(conn_arg);
 		} else {
-			slurm_thread_create_detached(NULL, _service_connection,
-						     conn_arg);
+			rpc_work_t *work = xmalloc(sizeof(rpc_work_t));
+			work->conn = conn_arg;
+			_rpc_work_queue(rpc_recv_queue, work);
 		}
 	}
 
 	debug3("%s shutting down", __func__);
+	_rpc_workers_fini();
 	for (i = 0; i < nports; i++)
 		close(sockfd[i]);
 	xfree(sockfd);
@@ -1228,6 +1298,345 @@ static void *_slurmctld_rpc_mgr(void *no_data)
 	return NULL;
 }
 
+/* Return the queue class used to schedule an RPC of the given type */
+static rpc_class_t _rpc_class(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case MESSAGE_NODE_REGISTRATION_STATUS:
+	case MESSAGE_EPILOG_COMPLETE:
+	case MESSAGE_COMPOSITE:
+	case REQUEST_COMPLETE_BATCH_SCRIPT:
+	case REQUEST_COMPLETE_PROLOG:
+	case REQUEST_STEP_COMPLETE:
+		return RPC_CLASS_NODE;
+	case REQUEST_ASSOC_MGR_INFO:
+	case REQUEST_BUILD_INFO:
+	case REQUEST_BURST_BUFFER_INFO:
+	case REQUEST_BURST_BUFFER_STATUS:
+	case REQUEST_CONTROL_STATUS:
+	case REQUEST_FED_INFO:
+	case REQUEST_FRONT_END_INFO:
+	case REQUEST_JOB_ALLOCATION_INFO:
+	case REQUEST_JOB_END_TIME:
+	case REQUEST_JOB_INFO:
+	case REQUEST_JOB_INFO_SINGLE:
+	case REQUEST_JOB_PACK_ALLOC_INFO:
+	case REQUEST_JOB_READY:
+	case REQUEST_JOB_STEP_INFO:
+	case REQUEST_JOB_USER_INFO:
+	case REQUEST_LAYOUT_INFO:
+	case REQUEST_LICENSE_INFO:
+	case REQUEST_NODE_INFO:
+	case REQUEST_NODE_INFO_SINGLE:
+	case REQUEST_PARTITION_INFO:
+	case REQUEST_PING:
+	case REQUEST_POWERCAP_INFO:
+	case REQUEST_PRIORITY_FACTORS:
+	case REQUEST_RESERVATION_INFO:
+	case REQUEST_SHARE_INFO:
+	case REQUEST_STATS_INFO:
+	case REQUEST_TOPO_INFO:
+	case REQUEST_TRIGGER_GET:
+		return RPC_CLASS_READ;
+	default:
+		return RPC_CLASS_JOB;
+	}
+}
+
+/*
+ * Set the RPC worker pool size from SlurmctldParameters=rpc_workers, at most
+ * max_server_threads, and the concurrency limits of receiving and of each RPC
+ * class from the pool size. Workers above a reduced pool size exit once idle.
+ * NOTE: Caller must hold the config read lock
+ */
+static void _rpc_class_limits(void)
+{
+	char *tmp_ptr;
+	uint32_t workers = max_server_threads;
+	int i;
+
+	if ((tmp_ptr = xstrcasestr(slurmctld_conf.slurmctld_params,
+				   "rpc_workers="))) {
+		i = atoi(tmp_ptr + 12);
+		if (i < 1)
+			error("Invalid SlurmctldParameters rpc_workers: %d", i);
+		else
+			workers = MIN(i, max_server_threads);
+	}
+
+	slurm_mutex_lock(&rpc_queue_mutex);
+	rpc_worker_max = workers;
+	rpc_recv_limit = MAX(1, workers / 2);
+	for (i = 0; i < RPC_CLASS_CNT; i++) {
+		rpc_class[i].active_limit =
+			MAX(1, (workers * rpc_class_share[i]) / 4);
+	}
+	slurm_cond_broadcast(&rpc_queue_cond);
+	slurm_mutex_unlock(&rpc_queue_mutex);
+}
+
+/*
+ * Return the next connection to work on, NULL if none can be started now.
+ * New connections are received first so their class is known, while fewer
+ * than rpc_recv_limit are being received, then received RPCs are started in
+ * class priority order while the class is below its concurrency limit.
+ * NOTE: rpc_queue_mutex must be locked by the caller
+ */
+static rpc_work_t *_rpc_work_next(void)
+{
+	rpc_work_t *work;
+	uint64_t wait_usec;
+	int i;
+
+	if ((rpc_recv_active < rpc_recv_limit) &&
+	    (work = list_dequeue(rpc_recv_queue))) {
+		rpc_recv_active++;
+		return work;
+	}
+
+	for (i = 0; i < RPC_CLASS_CNT; i++) {
+		if (rpc_class[i].active >= rpc_class[i].active_limit)
+			continue;
+		if (!(work = list_dequeue(rpc_class[i].queue)))
+			continue;
+		rpc_class[i].active++;
+		rpc_class[i].cnt++;
+		wait_usec = MAX(0, slurm_delta_tv(&work->queue_time));
+		rpc_class[i].wait_time += wait_usec;
+		rpc_class[i].wait_max = MAX(rpc_class[i].wait_max, wait_usec);
+		return work;
+	}
+
+	return NULL;
+}
+
+/*
+ * Queue work for the RPC worker threads, starting another worker if none is
+ * idle and the pool is below rpc_worker_max
+ */
+static void _rpc_work_queue(List queue, rpc_work_t *work)
+{
+	uint32_t depth;
+	int i;
+
+	gettimeofday(&work->queue_time, NULL);
+	slurm_mutex_lock(&rpc_queue_mutex);
+	list_enqueue(queue, work);
+	for (i = 0; i < RPC_CLASS_CNT; i++) {
+		if (queue != rpc_class[i].queue)
+			continue;
+		depth = list_count(queue);
+		rpc_class[i].depth_max = MAX(rpc_class[i].depth_max, depth);
+	}
+	if ((rpc_worker_idle == 0) && (rpc_worker_cnt < rpc_worker_max)) {
+		rpc_worker_cnt++;
+		slurm_thread_create_detached(NULL, _rpc_worker, NULL);
+	} else {
+		slurm_cond_signal(&rpc_queue_cond);
+	}
+	slurm_mutex_unlock(&rpc_queue_mutex);
+}
+
+/*
+ * Receive the RPC on a newly accepted connection and queue it by class
+ * RET true if queued, false if the connection is complete
+ */
+static bool _rpc_work_recv(rpc_work_t *work)
+{
+	connection_arg_t *conn = work->conn;
+
+	work->msg = xmalloc(sizeof(slurm_msg_t));
+	slurm_msg_t_init(work->msg);
+	work->msg->flags |= SLURM_MSG_KEEP_BUFFER | SLURM_MSG_USE_ARENA;
+	/*
+	 * slurm_receive_msg sets msg connection fd to accepted fd. This allows
+	 * possibility for slurmctld_req() to close accepted connection.
+	 */
+	if (slurm_receive_msg(conn->newsockfd, work->msg,
+			      RPC_RECV_TIMEOUT) != 0) {
+		char addr_buf[32];
+		slurm_print_slurm_addr(&conn->cli_addr, addr_buf,
+				       sizeof(addr_buf));
+		error("slurm_receive_msg [%s]: %m", addr_buf);
+		/* close the new socket */
+		close(conn->newsockfd);
+		conn->newsockfd = -1;
+		return false;
+	}
+
+	if (errno != SLURM_SUCCESS) {
+		if (errno == SLURM_PROTOCOL_VERSION_ERROR) {
+			slurm_send_rc_msg(work->msg,
+					  SLURM_PROTOCOL_VERSION_ERROR);
+		} else
+			info("_service_connection/slurm_receive_msg %m");
+		return false;
+	}
+
+	work->class = _rpc_class(work->msg->msg_type);
+	_rpc_work_queue(rpc_class[work->class].queue, work);
+	return true;
+}
+
+/* Close the connection and release the thread count of completed work */
+static void _rpc_work_fini(rpc_work_t *work)
+{
+	connection_arg_t *conn = work->conn;
+
+	if ((conn->newsockfd >= 0) && (close(conn->newsockfd) < 0))
+		error ("close(%d): %m",  conn->newsockfd);
+	if (work->msg) {
+		slurm_free_msg_members(work->msg);
+		xfree(work->msg);
+	}
+	xfree(work->conn);
+	xfree(work);
+	server_thread_decr();
+}
+
+/*
+ * _rpc_worker - RPC worker thread, receives and processes the RPCs queued
+ *	by _slurmctld_rpc_mgr() until told to stop and no work remains
+ */
+static void *_rpc_worker(void *no_data)
+{
+	rpc_work_t *work;
+	rpc_class_t class;
+	struct timespec ts = {0, 0};
+
+#if HAVE_SYS_PRCTL_H
+	if (prctl(PR_SET_NAME, "srvcn", NULL, NULL, NULL) < 0) {
+		error("%s: cannot set my name to %s %m", __func__, "srvcn");
+	}
+#endif
+	slurm_mutex_lock(&rpc_queue_mutex);
+	while (1) {
+		/* Shrink the pool after its size was reduced */
+		if (rpc_worker_cnt > rpc_worker_max)
+			break;
+		if (!(work = _rpc_work_next())) {
+			if (rpc_worker_stop)
+				break;
+			rpc_worker_idle++;
+			ts.tv_sec = time(NULL) + RPC_WORKER_IDLE;
+			slurm_cond_timedwait(&rpc_queue_cond, &rpc_queue_mutex,
+					     &ts);
+			rpc_worker_idle--;
+			/* Shrink the pool while idle */
+			if ((time(NULL) >= ts.tv_sec) &&
+			    (rpc_worker_cnt > RPC_WORKER_MIN) &&
+			    !list_count(rpc_recv_queue))
+				break;
+			continue;
+		}
+		slurm_mutex_unlock(&rpc_queue_mutex);
+
+		if (!work->msg) {
+			/* Newly accepted connection */
+			if (!_rpc_work_recv(work))
+				_rpc_work_fini(work);
+			slurm_mutex_lock(&rpc_queue_mutex);
+			rpc_recv_active--;
+			/* Connections held back by the receive limit */
+			if (list_count(rpc_recv_queue))
+				slurm_cond_signal(&rpc_queue_cond);
+			continue;
+		}
+
+		class = work->class;
+		slurmctld_req(work->msg, work->conn);
+		_rpc_work_fini(work);
+
+		slurm_mutex_lock(&rpc_queue_mutex);
+		rpc_class[class].active--;
+		/* Work held back by the class limit may now start */
+		if (list_count(rpc_class[class].queue))
+			slurm_cond_signal(&rpc_queue_cond);
+	}
+	rpc_worker_cnt--;
+	/* Pass on any wakeup meant for work this worker leaves queued */
+	slurm_cond_signal(&rpc_queue_cond);
+	slurm_mutex_unlock(&rpc_queue_mutex);
+
+	return NULL;
+}
+
+/* Start the RPC worker pool, queues persist across restarts */
+static void _rpc_workers_init(void)
+{
+	/* Locks: Read config */
+	slurmctld_lock_t config_read_lock = {
+		READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	int i;
+
+	slurm_mutex_lock(&rpc_queue_mutex);
+	if (!rpc_recv_queue) {
+		rpc_recv_queue = list_create(NULL);
+		for (i = 0; i < RPC_CLASS_CNT; i++)
+			rpc_class[i].queue = list_create(NULL);
+	}
+	rpc_worker_stop = false;
+	slurm_mutex_unlock(&rpc_queue_mutex);
+	lock_slurmctld(config_read_lock);
+	_rpc_class_limits();
+	unlock_slurmctld(config_read_lock);
+}
+
+/* Tell idle RPC workers to exit once all queued work is complete */
+static void _rpc_workers_fini(void)
+{
+	slurm_mutex_lock(&rpc_queue_mutex);
+	rpc_worker_stop = true;
+	slurm_cond_broadcast(&rpc_queue_cond);
+	slurm_mutex_unlock(&rpc_queue_mutex);
+}
+
+/* pack_rpc_queue_stats - pack RPC worker and class queue statistics */
+extern void pack_rpc_queue_stats(Buf buffer)
+{
+	uint32_t depth[RPC_CLASS_CNT], depth_max[RPC_CLASS_CNT];
+	uint32_t active[RPC_CLASS_CNT];
+	uint64_t cnt[RPC_CLASS_CNT], wait_time[RPC_CLASS_CNT];
+	uint64_t wait_max[RPC_CLASS_CNT];
+	int i;
+
+	slurm_mutex_lock(&rpc_queue_mutex);
+	pack32(rpc_worker_cnt, buffer);
+	for (i = 0; i < RPC_CLASS_CNT; i++) {
+		depth[i] = rpc_class[i].queue ?
+			   list_count(rpc_class[i].queue) : 0;
+		depth_max[i] = rpc_class[i].depth_max;
+		active[i]    = rpc_class[i].active;
+		cnt[i]       = rpc_class[i].cnt;
+		wait_time[i] = rpc_class[i].wait_time;
+		wait_max[i]  = rpc_class[i].wait_max;
+	}
+	slurm_mutex_unlock(&rpc_queue_mutex);
+
+	packstr_array((char **) rpc_class_name, RPC_CLASS_CNT, buffer);
+	pack32_array(depth, RPC_CLASS_CNT, buffer);
+	pack32_array(depth_max, RPC_CLASS_CNT, buffer);
+	pack32_array(active, RPC_CLASS_CNT, buffer);
+	pack64_array(cnt, RPC_CLASS_CNT, buffer);
+	pack64_array(wait_time, RPC_CLASS_CNT, buffer);
+	pack64_array(wait_max, RPC_CLASS_CNT, buffer);
+}
+
+/* reset_rpc_queue_stats - clear RPC class queue statistics */
+extern void reset_rpc_queue_stats(void)
+{
+	int i;
+
+	slurm_mutex_lock(&rpc_queue_mutex);
+	for (i = 0; i < RPC_CLASS_CNT; i++) {
+		rpc_class[i].depth_max = 0;
+		rpc_class[i].cnt = 0;
+		rpc_class[i].wait_time = 0;
+		rpc_class[i].wait_max = 0;
+	}
+	slurm_mutex_unlock(&rpc_queue_mutex);
+}
+
 /*
  * _service_connection - service the RPC
  * IN/OUT arg - really just the connection's file descriptor, freed
@@ -1246,7 +1655,7 @@ static void *_service_connection(void *arg)
 	}
 #endif
 	slurm_msg_t_init(&msg);
-	msg.flags |= SLURM_MSG_KEEP_BUFFER;
+	msg.flags |= SLURM_MSG_KEEP_BUFFER | SLURM_MSG_USE_ARENA;
 	/*
 	 * slurm_receive_msg sets msg connection fd to accepted fd. This allows
 	 * possibility for slurmctld_req() to close accepted connection.
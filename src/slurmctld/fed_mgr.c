@@ -587,8 +587,10 @@ static int _foreach_job_no_requeue(void *object, void *arg)
 {
 	struct job_record *job_ptr = (struct job_record *)object;
 
-	if (job_ptr->details)
+	if (job_ptr->details) {
 		job_ptr->details->requeue = 0;
+		JOB_RECORD_CHANGED(job_ptr);
+	}
 
 	return SLURM_SUCCESS;
 }
@@ -1379,6 +1381,7 @@ static int _remove_sibling_bit(struct job_record *job_ptr,
 		job_ptr->job_state |= JOB_REVOKED;
 	else if (!job_ptr->fed_details->cluster_lock)
 		job_ptr->job_state &= ~JOB_REVOKED;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	update_job_fed_details(job_ptr);
 
@@ -1670,6 +1673,7 @@ send_msg:
 		if (!(job_ptr->fed_details->siblings_viable &
 		      FED_SIBLING_BIT(fed_mgr_cluster_rec->fed.id)))
 			job_ptr->job_state |= JOB_REVOKED;
+		JOB_RECORD_CHANGED(job_ptr);
 
 		add_fed_job_info(job_ptr);
 		schedule_job_save();	/* Has own locks */
@@ -1691,6 +1695,7 @@ static void _do_fed_job_complete(struct job_record *job_ptr, uint32_t exit_code,
 		 * state in place. JOB_SPECIAL_EXIT may be in the
 		 * states. */
 		job_ptr->job_state &= ~(JOB_PENDING | JOB_COMPLETING);
+		JOB_RECORD_CHANGED(job_ptr);
 		batch_requeue_fini(job_ptr);
 	} else {
 		fed_mgr_job_revoke(job_ptr, true, exit_code, start_time);
@@ -1833,6 +1838,7 @@ static void _fed_job_start_revoke(fed_job_info_t *job_info,
 	job_ptr->fed_details->siblings_active =
 		job_info->siblings_active =
 		FED_SIBLING_BIT(cluster_lock);
+	JOB_RECORD_CHANGED(job_ptr);
 	update_job_fed_details(job_ptr);
 
 	if (old_active & ~FED_SIBLING_BIT(cluster_lock)) {
@@ -3318,6 +3324,7 @@ static void _add_remove_sibling_jobs(struct job_record *job_ptr)
 	new_sibs = _get_viable_sibs(job_ptr->clusters, feature_sibs,
 				    job_ptr->array_recs ? true : false, NULL);
 	job_ptr->fed_details->siblings_viable = new_sibs;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	add_sibs =  new_sibs & ~old_sibs;
 	rem_sibs = ~new_sibs &  old_sibs;
@@ -3567,6 +3574,7 @@ extern int fed_mgr_job_allocate(slurm_msg_t *msg, job_desc_msg_t *job_desc,
 	if (!(job_ptr->fed_details->siblings_viable &
 	      FED_SIBLING_BIT(fed_mgr_cluster_rec->fed.id)))
 		job_ptr->job_state |= JOB_REVOKED;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	*job_id_ptr = job_ptr->job_id;
 
@@ -3810,6 +3818,7 @@ extern int fed_mgr_job_lock(struct job_record *job_ptr)
 
 		if (!rc) {
 			job_ptr->fed_details->cluster_lock = cluster_id;
+			JOB_RECORD_CHANGED(job_ptr);
 			fed_mgr_job_lock_set(job_ptr->job_id, cluster_id);
 		}
 
@@ -3969,6 +3978,7 @@ extern int fed_mgr_job_unlock(struct job_record *job_ptr)
 
 		if (!rc) {
 			job_ptr->fed_details->cluster_lock = 0;
+			JOB_RECORD_CHANGED(job_ptr);
 			fed_mgr_job_lock_unset(job_ptr->job_id, cluster_id);
 		}
 
@@ -4184,6 +4194,8 @@ extern int fed_mgr_job_revoke(struct job_record *job_ptr, bool job_complete,
 	job_ptr->end_time   = start_time;
 	job_ptr->state_reason = WAIT_NO_REASON;
 	xfree(job_ptr->state_desc);
+	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/*
 	 * Since the job is purged/revoked quickly on the non-origin side it's
@@ -4283,6 +4295,7 @@ extern int fed_mgr_job_requeue_test(struct job_record *job_ptr, uint32_t state)
 					 state);
 
 		job_ptr->job_state |= JOB_REQUEUE_FED;
+		JOB_RECORD_CHANGED(job_ptr);
 
 		return SLURM_SUCCESS;
 	}
@@ -4347,6 +4360,7 @@ extern int fed_mgr_job_requeue(struct job_record *job_ptr)
 
 	/* clear where actual siblings were */
 	job_ptr->fed_details->siblings_active = 0;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/* don't submit siblings for jobs that are held */
 	if (job_ptr->priority == 0) {
@@ -4717,6 +4731,7 @@ static int _reconcile_fed_job(struct job_record *job_ptr,
 			     __func__, job_ptr,
 			     job_ptr->fed_details->cluster_lock);
 			job_ptr->fed_details->siblings_active &= ~sibling_bit;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 	} else if (remote_job) {
 		info("%s: %pJ found on remote sibling %s state:%s",
@@ -4782,6 +4797,7 @@ static int _reconcile_fed_job(struct job_record *job_ptr,
 				     __func__, job_ptr, sibling_name);
 				job_ptr->fed_details->siblings_active |=
 					sibling_bit;
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 			if (IS_JOB_CANCELLED(remote_job)) {
 				info("%s: %pJ is cancelled on sibling %s, must have been cancelled while the origin was down",
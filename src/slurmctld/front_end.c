@@ -958,6 +958,8 @@ extern void sync_front_end_state(void)
 				      job_ptr->batch_host, job_ptr);
 				job_ptr->job_state = JOB_NODE_FAIL |
 						     JOB_COMPLETING;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else if (job_ptr->front_end_ptr == NULL) {
 				info("front end node %s has vanished",
 				     job_ptr->batch_host);
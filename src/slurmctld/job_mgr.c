@@ -60,8 +60,10 @@
 #include "slurm/slurm_errno.h"
 
 #include "src/common/slurm_acct_gather.h"
+#include "src/common/arena.h"
 #include "src/common/assoc_mgr.h"
 #include "src/common/bitstring.h"
+#include "src/common/cbitstring.h"
 #include "src/common/cpu_frequency.h"
 #include "src/common/fd.h"
 #include "src/common/forward.h"
@@ -81,6 +83,7 @@
 #include "src/common/tres_bind.h"
 #include "src/common/tres_frequency.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/slurmctld/acct_policy.h"
@@ -111,14 +114,25 @@
 #define TOP_PRIORITY 0xffff0000	/* large, but leave headroom for higher */
 #define PURGE_OLD_JOB_IN_SEC 2592000 /* 30 days in seconds */
 
-#define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
-#define JOB_ARRAY_HASH_INX(_job_id, _task_id) \
-	((_job_id + _task_id) % hash_table_size)
+#define JOB_ARRAY_TASK_KEY(_job_id, _task_id) \
+	((((uint64_t) (_job_id)) << 32) | (_task_id))
 
 /* No need to change we always pack SLURM_PROTOCOL_VERSION */
 #define JOB_STATE_VERSION     "PROTOCOL_VERSION"
 #define JOB_CKPT_VERSION      "PROTOCOL_VERSION"
 
+/* Count of purged job IDs remembered for incremental job info RPCs */
+#define PURGED_JOB_HIST_SIZE	65536
+/* Count of seconds' last_update times remembered for the same */
+#define JOB_INFO_TIME_HIST_SIZE	4096
+
+/* Maximum seconds between snapshots of all job state, changes in between are
+ * appended to the job state journal */
+#define JOB_JOURNAL_MAX_AGE	600
+/* job_state.journal.old and job_state.journal when recovering from
+ * job_state.old */
+#define JOB_JOURNAL_FILES	2
+
 typedef enum {
 	JOB_HASH_JOB,
 	JOB_HASH_ARRAY_JOB,
@@ -141,9 +155,29 @@ typedef struct {
 	uid_t     uid;
 } _foreach_pack_job_info_t;
 
+typedef struct {
+	uint32_t job_id;
+	uint64_t purge_seq;	/* job_update_seq of the purge */
+	uid_t user_id;		/* owner, account and mcs_label of the */
+	char *account;		/* job for PrivateData=jobs checks */
+	char *mcs_label;
+} purged_job_t;
+
+typedef struct {
+	time_t   time;		/* last_update given to job info clients */
+	uint64_t seq;		/* job_update_seq at that time */
+} job_info_time_t;
+
+typedef struct {
+	uint32_t job_id;
+	uint32_t offset;	/* offset of job record in journal */
+	uint32_t len;		/* length of job record, zero if purged */
+} job_journal_rec_t;
+
 /* Global variables */
 List   job_list = NULL;		/* job_record list */
 time_t last_job_update;		/* time of last update to job records */
+uint64_t job_update_seq = 0;	/* sequence number of last job record change */
 
 List purge_files_list = NULL;	/* job files to delete */
 
@@ -152,15 +186,34 @@ static int      bf_min_age_reserve = 0;
 static uint32_t delay_boot = 0;
 static uint32_t highest_prio = 0;
 static uint32_t lowest_prio  = TOP_PRIORITY;
-static int      hash_table_size = 0;
 static int      job_count = 0;		/* job's in the system */
 static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
-static struct   job_record **job_hash = NULL;
-static struct   job_record **job_array_hash_j = NULL;
-static struct   job_record **job_array_hash_t = NULL;
+static xhash_t  *job_hash = NULL;		/* by job_id */
+static xhash_t  *job_array_hash_j = NULL;	/* by array_job_id, see
+						 * _add_job_array_hash() */
+static xhash_t  *job_array_hash_t = NULL;	/* by array job and task ID */
 static bool     kill_invalid_dep;
 static time_t   last_file_write_time = (time_t) 0;
+static time_t   last_job_journal_time = (time_t) 0; /* last job state save */
+static uint64_t last_job_journal_seq = 0; /* job_update_seq at that save */
+static uint32_t job_journal_size = 0;	/* bytes journaled since snapshot */
+static uint32_t job_snapshot_size = 0;	/* bytes in last job state snapshot */
 static uint32_t max_array_size = NO_VAL;
+static purged_job_t *purged_job_hist = NULL;	/* ring of purged job IDs */
+static uint32_t purged_job_head = 0;
+static uint32_t purged_job_cnt = 0;
+static uint64_t purged_job_begin = 0;	/* purge history is complete after
+					 * this job_update_seq */
+static job_info_time_t *job_info_time_hist = NULL; /* ring of last_update
+						    * times given to job info
+						    * clients */
+static uint32_t job_info_time_head = 0;
+static uint32_t job_info_time_cnt = 0;
+static pthread_mutex_t job_info_time_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t *journal_dirty_ids = NULL; /* see job_journal_dirty() */
+static uint32_t journal_dirty_cnt = 0;
+static uint32_t journal_dirty_size = 0;
+static pthread_mutex_t journal_dirty_mutex = PTHREAD_MUTEX_INITIALIZER;
 static bitstr_t *requeue_exit = NULL;
 static bitstr_t *requeue_exit_hold = NULL;
 static bool     validate_cfgd_licenses = true;
@@ -173,6 +226,7 @@ static int  _checkpoint_job_record (struct job_record *job_ptr,
 static void _clear_job_gres_details(struct job_record *job_ptr);
 static int  _copy_job_desc_to_file(job_desc_msg_t * job_desc,
 				   uint32_t job_id);
+static char **_copy_job_desc_array(uint32_t cnt, char **array);
 static int  _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 					 struct job_record **job_ptr,
 					 bitstr_t ** exc_bitmap,
@@ -187,9 +241,17 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	bool locked);
 static void _dump_job_details(struct job_details *detail_ptr, Buf buffer);
 static void _dump_job_state(struct job_record *dump_job_ptr, Buf buffer);
+static void _dump_job_state_rec(struct job_record *job_ptr, Buf buffer);
+#ifndef NDEBUG
+static uint32_t _job_state_cksum(Buf buffer, uint32_t offset);
+static void _verify_job_journal(uint32_t **dirty_ids, uint32_t *dirty_cnt);
+#endif
 static void _dump_job_fed_details(job_fed_details_t *fed_details_ptr,
 				  Buf buffer);
 static job_fed_details_t *_dup_job_fed_details(job_fed_details_t *src);
+static job_journal_rec_t *_find_job_journal_rec(job_journal_rec_t *recs,
+						uint32_t rec_cnt,
+						uint32_t job_id);
 static void _get_batch_job_dir_ids(List batch_dirs);
 static bool _get_whole_hetjob(void);
 static void _job_array_comp(struct job_record *job_ptr, bool was_running,
@@ -197,6 +259,8 @@ static void _job_array_comp(struct job_record *job_ptr, bool was_running,
 static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			struct job_record **job_rec_ptr, uid_t submit_uid,
 			char **err_msg, uint16_t protocol_version);
+static int  _job_journal_rec_cmp(const void *x, const void *y);
+static bool _job_journal_usable(time_t now);
 static void _job_timed_out(struct job_record *job_ptr, bool preempted);
 static void _kill_dependent(struct job_record *job_ptr);
 static void _list_delete_job(void *job_entry);
@@ -210,9 +274,21 @@ static bitstr_t *_make_requeue_array(char *conf_buf);
 static uint32_t _max_switch_wait(uint32_t input_wait);
 static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
 				      time_t now, time_t node_boot_time);
+static Buf  _open_job_journal(const char *name, time_t snap_time,
+			      bool match_prev, uint16_t *protocol_version);
+static void _open_job_journals(time_t snap_time, Buf *journal_buf,
+			       uint16_t *journal_version);
 static Buf  _open_job_state_file(char **state_file);
 static time_t _get_last_job_state_write_time(void);
 static void _pack_job_for_ckpt (struct job_record *job_ptr, Buf buffer);
+static void _pack_job_journal(Buf buffer, time_t now, uint32_t *dirty_ids,
+			      uint32_t dirty_cnt);
+static void _put_journal_dirty(uint32_t *job_ids, uint32_t cnt);
+static uint32_t *_take_journal_dirty(uint32_t *cnt);
+static void _pack_job_state_header(Buf buffer, time_t now);
+static void _pack_job_info_trailer(uint16_t delta, uint32_t *removed_job_id,
+				   uint32_t removed_cnt, Buf buffer,
+				   uint16_t protocol_version);
 static void _pack_default_job_details(struct job_record *job_ptr,
 				      Buf buffer,
 				      uint16_t protocol_version);
@@ -221,10 +297,14 @@ static void _pack_pending_job_details(struct job_details *detail_ptr,
 				      uint16_t protocol_version);
 static bool _parse_array_tok(char *tok, bitstr_t *array_bitmap, uint32_t max);
 static void _purge_missing_jobs(int node_inx, time_t now);
+static void _purged_job_hist_add(struct job_record *job_ptr);
+static time_t _job_info_time(void);
 static int  _read_data_array_from_file(int fd, char *file_name, char ***data,
 				       uint32_t * size,
 				       struct job_record *job_ptr);
 static char *_read_job_ckpt_file(char *ckpt_file, int *size_ptr);
+static uint32_t _read_job_journal(Buf buffer, uint32_t *job_id_seq,
+				  job_journal_rec_t **recs_ptr);
 static void _remove_defunct_batch_dirs(List batch_dirs);
 static void _remove_job_hash(struct job_record *job_ptr,
 			     job_hash_type_t type);
@@ -265,6 +345,7 @@ static bool _validate_min_mem_partition(job_desc_msg_t *job_desc_msg,
 static bool _valid_pn_min_mem(job_desc_msg_t * job_desc_msg,
 			      struct part_record *part_ptr);
 static int  _write_data_to_file(char *file_name, char *data);
+static int  _write_job_state_file(char *file_name, Buf buffer, bool append);
 static int  _write_data_array_to_file(char *file_name, char **data,
 				      uint32_t size);
 static void _xmit_new_end_time(struct job_record *job_ptr);
@@ -476,6 +557,7 @@ static struct job_record *_create_job_record(uint32_t num_jobs)
 	job_ptr->magic = JOB_MAGIC;
 	job_ptr->array_task_id = NO_VAL;
 	job_ptr->details = detail_ptr;
+	JOB_RECORD_CHANGED(job_ptr);
 	job_ptr->prio_factors = xmalloc(sizeof(priority_factors_object_t));
 	job_ptr->step_list = list_create(NULL);
 
@@ -664,18 +746,279 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	return qos_ptr;
 }
 
+/*
+ * Write a job state buffer to a file, truncating or appending to it
+ * RET 0 or error code
+ */
+static int _write_job_state_file(char *file_name, Buf buffer, bool append)
+{
+	int error_code = SLURM_SUCCESS, log_fd, rc;
+	int flags = O_CREAT | O_WRONLY | O_CLOEXEC;
+	int pos = 0, nwrite, amount;
+	char *data;
+
+	flags |= append ? O_APPEND : O_TRUNC;
+	log_fd = open(file_name, flags, 0600);
+	if (log_fd < 0) {
+		error("Can't save state, create file %s error %m", file_name);
+		return errno;
+	}
+
+	nwrite = get_buf_offset(buffer);
+	data = (char *)get_buf_data(buffer);
+	while (nwrite > 0) {
+		amount = write(log_fd, &data[pos], nwrite);
+		if ((amount < 0) && (errno != EINTR)) {
+			error("Error writing file %s, %m", file_name);
+			error_code = errno;
+			break;
+		}
+		nwrite -= amount;
+		pos    += amount;
+	}
+
+	rc = fsync_and_close(log_fd, "job");
+	if (rc && !error_code)
+		error_code = rc;
+	return error_code;
+}
+
+/*
+ * Pack a job record preceded by its job ID and length so that job state
+ * loading can skip records superseded by the job state journal
+ */
+static void _dump_job_state_rec(struct job_record *job_ptr, Buf buffer)
+{
+	uint32_t len_offset, end_offset;
+
+	pack32(job_ptr->job_id, buffer);
+	len_offset = get_buf_offset(buffer);
+	pack32(0, buffer);
+	_dump_job_state(job_ptr, buffer);
+	end_offset = get_buf_offset(buffer);
+#ifndef NDEBUG
+	/* Only the job state save thread uses this, see _verify_job_journal */
+	job_ptr->journal_cksum = _job_state_cksum(buffer, len_offset +
+						  sizeof(uint32_t));
+#endif
+	set_buf_offset(buffer, len_offset);
+	pack32(end_offset - len_offset - sizeof(uint32_t), buffer);
+	set_buf_offset(buffer, end_offset);
+}
+
+#ifndef NDEBUG
+/* FNV-1a hash of the buffer contents from offset to the current offset */
+static uint32_t _job_state_cksum(Buf buffer, uint32_t offset)
+{
+	unsigned char *data = (unsigned char *) get_buf_data(buffer);
+	uint32_t i, hash = 2166136261U;
+
+	for (i = offset; i < get_buf_offset(buffer); i++) {
+		hash ^= data[i];
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+/*
+ * Debug check of the job state journal: each job not about to be journaled
+ * must still pack exactly as it did when last saved. A difference means the
+ * job was changed without JOB_RECORD_CHANGED() or job_journal_dirty() and
+ * would be lost on restart, so report it and journal the job anyway.
+ * dirty_ids IN/OUT - jobs changed under the job read lock, sorted here
+ */
+static void _verify_job_journal(uint32_t **dirty_ids, uint32_t *dirty_cnt)
+{
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	uint32_t sorted_cnt = *dirty_cnt;
+	Buf buffer = init_buf(BUF_SIZE);
+
+	if (sorted_cnt)
+		qsort(*dirty_ids, sorted_cnt, sizeof(uint32_t), _job_id_cmp);
+
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if (job_ptr->update_seq > last_job_journal_seq)
+			continue;
+		if (sorted_cnt &&
+		    bsearch(&job_ptr->job_id, *dirty_ids, sorted_cnt,
+			    sizeof(uint32_t), _job_id_cmp))
+			continue;
+		set_buf_offset(buffer, 0);
+		_dump_job_state(job_ptr, buffer);
+		if (_job_state_cksum(buffer, 0) == job_ptr->journal_cksum)
+			continue;
+		error("%s: %pJ changed without JOB_RECORD_CHANGED()",
+		      __func__, job_ptr);
+		xrealloc(*dirty_ids, sizeof(uint32_t) * (*dirty_cnt + 1));
+		(*dirty_ids)[(*dirty_cnt)++] = job_ptr->job_id;
+	}
+	list_iterator_destroy(job_iterator);
+	free_buf(buffer);
+}
+#endif
+
+/*
+ * Return true if the changes since the last job state save can be appended
+ * to the job state journal rather than writing a new snapshot of all jobs
+ */
+static bool _job_journal_usable(time_t now)
+{
+	if (!last_file_write_time || !last_job_journal_time)
+		return false;
+	if (job_journal_size > (job_snapshot_size / 2))
+		return false;
+	if (difftime(now, last_file_write_time) > JOB_JOURNAL_MAX_AGE)
+		return false;
+	/* Purge history must cover the period since the last save */
+	if (last_job_journal_seq < purged_job_begin)
+		return false;
+	return true;
+}
+
+/*
+ * job_journal_dirty - Note a change to a job record made while holding only
+ *	the job read lock, see slurmctld.h
+ */
+extern void job_journal_dirty(uint32_t job_id)
+{
+	_put_journal_dirty(&job_id, 1);
+}
+
+/* Add job IDs to the set of jobs changed under the job read lock */
+static void _put_journal_dirty(uint32_t *job_ids, uint32_t cnt)
+{
+	slurm_mutex_lock(&journal_dirty_mutex);
+	if ((journal_dirty_cnt + cnt) > journal_dirty_size) {
+		journal_dirty_size = MAX(journal_dirty_size * 2,
+					 journal_dirty_cnt + cnt);
+		journal_dirty_size = MAX(journal_dirty_size, 256);
+		xrealloc(journal_dirty_ids,
+			 sizeof(uint32_t) * journal_dirty_size);
+	}
+	memcpy(journal_dirty_ids + journal_dirty_cnt, job_ids,
+	       sizeof(uint32_t) * cnt);
+	journal_dirty_cnt += cnt;
+	slurm_mutex_unlock(&journal_dirty_mutex);
+}
+
+/*
+ * Remove and return the set of jobs changed under the job read lock.
+ * Call before packing job state, so later changes stay in the set.
+ * cnt OUT - count of job IDs returned
+ * RET job IDs, may contain duplicates, free with xfree()
+ */
+static uint32_t *_take_journal_dirty(uint32_t *cnt)
+{
+	uint32_t *job_ids;
+
+	slurm_mutex_lock(&journal_dirty_mutex);
+	job_ids = journal_dirty_ids;
+	*cnt = journal_dirty_cnt;
+	journal_dirty_ids = NULL;
+	journal_dirty_cnt = 0;
+	journal_dirty_size = 0;
+	slurm_mutex_unlock(&journal_dirty_mutex);
+
+	return job_ids;
+}
+
+static int _job_id_cmp(const void *x, const void *y)
+{
+	uint32_t id1 = *(const uint32_t *) x, id2 = *(const uint32_t *) y;
+
+	if (id1 != id2)
+		return (id1 < id2) ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Pack a job state journal batch: the jobs changed and the IDs of jobs purged
+ * since the last job state save
+ * dirty_ids IN - jobs changed under the job read lock, from
+ *	_take_journal_dirty(), sorted here
+ */
+static void _pack_job_journal(Buf buffer, time_t now, uint32_t *dirty_ids,
+			      uint32_t dirty_cnt)
+{
+	ListIterator job_iterator;
+	struct job_record *job_ptr;
+	uint32_t cnt_offset, end_offset, rec_cnt = 0;
+	uint32_t i, inx;
+
+	pack32(0, buffer);		/* batch length, filled in below */
+	pack_time(now, buffer);
+	pack32(job_id_sequence, buffer);
+	cnt_offset = get_buf_offset(buffer);
+	pack32(rec_cnt, buffer);
+
+	job_iterator = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		if (job_ptr->update_seq <= last_job_journal_seq)
+			continue;
+		_dump_job_state_rec(job_ptr, buffer);
+		rec_cnt++;
+	}
+	list_iterator_destroy(job_iterator);
+
+	/* Jobs already packed above were changed under the write lock too */
+	if (dirty_cnt)
+		qsort(dirty_ids, dirty_cnt, sizeof(uint32_t), _job_id_cmp);
+	for (i = 0; i < dirty_cnt; i++) {
+		if (i && (dirty_ids[i] == dirty_ids[i - 1]))
+			continue;
+		job_ptr = find_job_record(dirty_ids[i]);
+		if (!job_ptr || (job_ptr->update_seq > last_job_journal_seq))
+			continue;
+		_dump_job_state_rec(job_ptr, buffer);
+		rec_cnt++;
+	}
+
+	inx = purged_job_head;
+	for (i = 0; i < purged_job_cnt; i++) {
+		inx = (inx + PURGED_JOB_HIST_SIZE - 1) % PURGED_JOB_HIST_SIZE;
+		if (purged_job_hist[inx].purge_seq <= last_job_journal_seq)
+			break;
+		pack32(purged_job_hist[inx].job_id, buffer);
+		pack32(0, buffer);	/* zero length record: job purged */
+		rec_cnt++;
+	}
+
+	end_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	pack32(end_offset - sizeof(uint32_t), buffer);
+	set_buf_offset(buffer, cnt_offset);
+	pack32(rec_cnt, buffer);
+	set_buf_offset(buffer, end_offset);
+}
+
+/* Pack the header of a job state file or job state journal */
+static void _pack_job_state_header(Buf buffer, time_t now)
+{
+	packstr(JOB_STATE_VERSION, buffer);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(now, buffer);
+}
+
 /*
  * dump_all_job_state - save the state of all jobs to file for checkpoint
  *	Changes here should be reflected in load_last_job_id() and
  *	load_all_job_state().
+ *	Changes since the last save are appended to the job state journal.
+ *	A new snapshot of all jobs is written once the journal grows to half
+ *	the size of the last snapshot or JOB_JOURNAL_MAX_AGE has elapsed.
+ *	The journal is then completed up to the new snapshot and kept as
+ *	job_state.journal.old to be replayed with job_state.old.
  * RET 0 or error code
  */
 int dump_all_job_state(void)
 {
 	/* Save high-water mark to avoid buffer growth with copies */
 	static int high_buffer_size = (1024 * 1024);
-	int error_code = SLURM_SUCCESS, log_fd;
+	int error_code = SLURM_SUCCESS;
 	char *old_file, *new_file, *reg_file;
+	char *journal_file, *journal_new, *journal_old;
 	struct stat stat_buf;
 	/* Locks: Read config and job */
 	slurmctld_lock_t job_read_lock =
@@ -683,8 +1026,12 @@ int dump_all_job_state(void)
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
 	Buf buffer = init_buf(high_buffer_size);
-	time_t now = time(NULL);
+	Buf journal_buf = NULL, tail_buf = NULL;
+	time_t now = time(NULL), snap_time = now;
 	time_t last_state_file_time;
+	uint64_t save_seq;
+	uint32_t *dirty_ids, dirty_cnt = 0;
+	bool journal, rotate = false;
 	DEF_TIMERS;
 
 	START_TIMER;
@@ -707,37 +1054,76 @@ int dump_all_job_state(void)
 		}
 	}
 
-	/* write header: version, time */
-	packstr(JOB_STATE_VERSION, buffer);
-	pack16(SLURM_PROTOCOL_VERSION, buffer);
-	pack_time(now, buffer);
+	lock_slurmctld(job_read_lock);
+	save_seq = job_update_seq;
+	dirty_ids = _take_journal_dirty(&dirty_cnt);
+	journal = _job_journal_usable(now);
+	if (journal) {
+#ifndef NDEBUG
+		_verify_job_journal(&dirty_ids, &dirty_cnt);
+#endif
+		_pack_job_journal(buffer, now, dirty_ids, dirty_cnt);
+		debug3("Writing job id %u to job_state journal",
+		       job_id_sequence);
+	} else {
+		/*
+		 * The journal is matched to its snapshot by time stamp, so
+		 * never write two snapshots with the same time stamp
+		 */
+		if (snap_time <= last_file_write_time)
+			snap_time = last_file_write_time + 1;
 
-	/*
-	 * write header: job id
-	 * This is needed so that the job id remains persistent even after
-	 * slurmctld is restarted.
-	 */
-	pack32( job_id_sequence, buffer);
+		/* write header: version, time */
+		_pack_job_state_header(buffer, snap_time);
 
-	debug3("Writing job id %u to header record of job_state file",
-	       job_id_sequence);
+		/*
+		 * write header: job id
+		 * This is needed so that the job id remains persistent even
+		 * after slurmctld is restarted.
+		 */
+		pack32(job_id_sequence, buffer);
 
-	/* write individual job records */
-	lock_slurmctld(job_read_lock);
-	job_iterator = list_iterator_create(job_list);
-	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		_dump_job_state(job_ptr, buffer);
-	}
-	list_iterator_destroy(job_iterator);
+		debug3("Writing job id %u to header record of job_state file",
+		       job_id_sequence);
 
+		/* write individual job records */
+		job_iterator = list_iterator_create(job_list);
+		while ((job_ptr = list_next(job_iterator)))
+			_dump_job_state_rec(job_ptr, buffer);
+		list_iterator_destroy(job_iterator);
+
+		/*
+		 * Complete the current journal up to this snapshot, so that
+		 * job_state.old and job_state.journal.old recover the same
+		 * state as this snapshot
+		 */
+		if (last_job_journal_time &&
+		    (last_job_journal_seq >= purged_job_begin)) {
+			tail_buf = init_buf(BUF_SIZE);
+			_pack_job_journal(tail_buf, now, dirty_ids, dirty_cnt);
+		}
+
+		/*
+		 * Start a new, empty journal for this snapshot, also naming
+		 * the snapshot it follows for recovery from job_state.old
+		 */
+		journal_buf = init_buf(BUF_SIZE);
+		_pack_job_state_header(journal_buf, snap_time);
+		pack_time(last_state_file_time, journal_buf);
+	}
 
-	/* write the buffer to file */
 	old_file = xstrdup(slurmctld_conf.state_save_location);
 	xstrcat(old_file, "/job_state.old");
 	reg_file = xstrdup(slurmctld_conf.state_save_location);
 	xstrcat(reg_file, "/job_state");
 	new_file = xstrdup(slurmctld_conf.state_save_location);
 	xstrcat(new_file, "/job_state.new");
+	journal_file = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(journal_file, "/job_state.journal");
+	journal_new = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(journal_new, "/job_state.journal.new");
+	journal_old = xstrdup(slurmctld_conf.state_save_location);
+	xstrcat(journal_old, "/job_state.journal.old");
 	unlock_slurmctld(job_read_lock);
 
 	if (stat(reg_file, &stat_buf) == 0) {
@@ -756,36 +1142,25 @@ int dump_all_job_state(void)
 	}
 
 	lock_state_files();
-	log_fd = open(new_file, O_CREAT|O_WRONLY|O_TRUNC|O_CLOEXEC, 0600);
-	if (log_fd < 0) {
-		error("Can't save state, create file %s error %m",
-		      new_file);
-		error_code = errno;
-	} else {
-		int pos = 0, nwrite, amount, rc;
-		char *data;
-
-		nwrite = get_buf_offset(buffer);
-		data = (char *)get_buf_data(buffer);
-		high_buffer_size = MAX(nwrite, high_buffer_size);
-		while (nwrite > 0) {
-			amount = write(log_fd, &data[pos], nwrite);
-			if ((amount < 0) && (errno != EINTR)) {
-				error("Error writing file %s, %m", new_file);
-				error_code = errno;
-				break;
-			}
-			nwrite -= amount;
-			pos    += amount;
+	high_buffer_size = MAX(get_buf_offset(buffer), high_buffer_size);
+	if (journal) {
+		error_code = _write_job_state_file(journal_file, buffer, true);
+		if (error_code) {
+			/* A partial batch is ignored when loading, but
+			 * anything appended after it would be too */
+			last_job_journal_time = (time_t) 0;
+		} else {
+			last_job_journal_time = now;
+			last_job_journal_seq = save_seq;
+			job_journal_size += get_buf_offset(buffer);
 		}
-
-		rc = fsync_and_close(log_fd, "job");
-		if (rc && !error_code)
-			error_code = rc;
-	}
-	if (error_code)
+	} else if ((error_code = _write_job_state_file(new_file, buffer,
+						       false))) {
 		(void) unlink(new_file);
-	else {			/* file shuffle */
+	} else {		/* file shuffle */
+		if (tail_buf &&
+		    !_write_job_state_file(journal_file, tail_buf, true))
+			rotate = true;
 		(void) unlink(old_file);
 		if (link(reg_file, old_file))
 			debug4("unable to create link for %s -> %s: %m",
@@ -795,14 +1170,45 @@ int dump_all_job_state(void)
 			debug4("unable to create link for %s -> %s: %m",
 			       new_file, reg_file);
 		(void) unlink(new_file);
-		last_file_write_time = now;
+		last_file_write_time = snap_time;
+		job_snapshot_size = get_buf_offset(buffer);
+		job_journal_size = 0;
+
+		/*
+		 * A stale journal is ignored as its time stamp differs, an
+		 * incomplete one must not be replayed with job_state.old
+		 */
+		if (!rotate || rename(journal_file, journal_old))
+			(void) unlink(journal_old);
+		if (_write_job_state_file(journal_new, journal_buf, false) ||
+		    rename(journal_new, journal_file)) {
+			error("Unable to create job state journal %s",
+			      journal_file);
+			(void) unlink(journal_new);
+			last_job_journal_time = (time_t) 0;
+		} else {
+			last_job_journal_time = now;
+			last_job_journal_seq = save_seq;
+		}
 	}
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
+	xfree(journal_file);
+	xfree(journal_new);
+	xfree(journal_old);
 	unlock_state_files();
 
+	/* Unsaved changes must be in the next journal batch or snapshot */
+	if (error_code && dirty_cnt)
+		_put_journal_dirty(dirty_ids, dirty_cnt);
+	xfree(dirty_ids);
+
 	free_buf(buffer);
+	if (journal_buf)
+		free_buf(journal_buf);
+	if (tail_buf)
+		free_buf(tail_buf);
 	END_TIMER2("dump_all_job_state");
 	return error_code;
 }
@@ -923,9 +1329,193 @@ unpack_error:
 	return buf_time;
 }
 
+/*
+ * Open a job state journal, if it applies to the job state file written at
+ * snap_time
+ * IN name - "job_state.journal" or "job_state.journal.old"
+ * IN match_prev - match snap_time to the job state file preceding the
+ *	journal's own (the one now in job_state.old) rather than to its own
+ * OUT protocol_version - protocol version of the journal's job records
+ * RET buffer positioned at the first journal batch or NULL if none applies
+ */
+static Buf _open_job_journal(const char *name, time_t snap_time,
+			     bool match_prev, uint16_t *protocol_version)
+{
+	char *journal_file, *ver_str = NULL;
+	uint32_t ver_str_len;
+	time_t buf_time = (time_t) 0, prev_time = (time_t) 0;
+	Buf buffer;
+
+	*protocol_version = NO_VAL16;
+	journal_file = xstrdup_printf("%s/%s",
+				      slurmctld_conf.state_save_location, name);
+	buffer = create_mmap_buf(journal_file);
+	if (!buffer) {
+		debug("No job state journal (%s) to recover", journal_file);
+		xfree(journal_file);
+		return NULL;
+	}
+
+	safe_unpackstr_xmalloc(&ver_str, &ver_str_len, buffer);
+	if (ver_str && !xstrcmp(ver_str, JOB_STATE_VERSION))
+		safe_unpack16(protocol_version, buffer);
+	safe_unpack_time(&buf_time, buffer);
+	safe_unpack_time(&prev_time, buffer);
+	if ((*protocol_version < SLURM_19_05_PROTOCOL_VERSION) ||
+	    (*protocol_version == NO_VAL16))
+		goto unpack_error;
+	if ((match_prev ? prev_time : buf_time) != snap_time) {
+		debug("Ignoring job state journal %s written for another job state file",
+		      journal_file);
+		xfree(ver_str);
+		xfree(journal_file);
+		free_buf(buffer);
+		return NULL;
+	}
+
+	xfree(ver_str);
+	xfree(journal_file);
+	return buffer;
+
+unpack_error:
+	error("Invalid job state journal %s header, ignoring it",
+	      journal_file);
+	xfree(ver_str);
+	xfree(journal_file);
+	free_buf(buffer);
+	return NULL;
+}
+
+/*
+ * Open the job state journals to replay on top of the job state file written
+ * at snap_time: job_state.journal or, when recovering from job_state.old,
+ * job_state.journal.old followed by the job_state.journal written after it
+ * OUT journal_buf - JOB_JOURNAL_FILES journals in replay order, NULL if unused
+ * OUT journal_version - protocol version of each journal's job records
+ */
+static void _open_job_journals(time_t snap_time, Buf *journal_buf,
+			       uint16_t *journal_version)
+{
+	journal_buf[1] = NULL;
+	if ((journal_buf[0] = _open_job_journal("job_state.journal", snap_time,
+						false, &journal_version[0])))
+		return;
+	if ((journal_buf[0] = _open_job_journal("job_state.journal.old",
+						snap_time, false,
+						&journal_version[0]))) {
+		info("Recovering jobs from job state journal %s/job_state.journal.old",
+		     slurmctld_conf.state_save_location);
+		journal_buf[1] = _open_job_journal("job_state.journal",
+						   snap_time, true,
+						   &journal_version[1]);
+	}
+}
+
+static int _job_journal_rec_cmp(const void *x, const void *y)
+{
+	const job_journal_rec_t *rec1 = x, *rec2 = y;
+
+	if (rec1->job_id != rec2->job_id)
+		return (rec1->job_id < rec2->job_id) ? -1 : 1;
+	if (rec1->offset != rec2->offset)
+		return (rec1->offset < rec2->offset) ? -1 : 1;
+	return 0;
+}
+
+/*
+ * Read the batches of a job state journal, stopping at the first incomplete
+ * batch (e.g. a write interrupted by a crash)
+ * IN buffer - journal as returned by _open_job_journal()
+ * OUT job_id_seq - job id sequence of the last complete batch, unchanged if
+ *	there are none
+ * OUT recs_ptr - latest journal record of each job sorted by job ID, NULL if
+ *	not wanted, xfree() when done
+ * RET count of records in recs_ptr
+ */
+static uint32_t _read_job_journal(Buf buffer, uint32_t *job_id_seq,
+				  job_journal_rec_t **recs_ptr)
+{
+	job_journal_rec_t *recs = NULL;
+	uint32_t rec_cnt = 0, rec_size = 0, batch_rec_cnt = 0;
+	uint32_t batch_len, batch_end, batch_seq, job_id, len, i, j;
+	time_t batch_time;
+
+	while (remaining_buf(buffer) > 0) {
+		safe_unpack32(&batch_len, buffer);
+		if (batch_len > remaining_buf(buffer))
+			goto unpack_error;
+		batch_end = get_buf_offset(buffer) + batch_len;
+		safe_unpack_time(&batch_time, buffer);
+		safe_unpack32(&batch_seq, buffer);
+		safe_unpack32(&batch_rec_cnt, buffer);
+		for (i = 0; i < batch_rec_cnt; i++) {
+			safe_unpack32(&job_id, buffer);
+			safe_unpack32(&len, buffer);
+			if (len > (batch_end - get_buf_offset(buffer)))
+				goto unpack_error;
+			if (recs_ptr) {
+				if ((rec_cnt + i) >= rec_size) {
+					rec_size += 1024;
+					xrealloc(recs, sizeof(job_journal_rec_t)
+						       * rec_size);
+				}
+				recs[rec_cnt + i].job_id = job_id;
+				recs[rec_cnt + i].offset =
+					get_buf_offset(buffer);
+				recs[rec_cnt + i].len = len;
+			}
+			set_buf_offset(buffer, get_buf_offset(buffer) + len);
+		}
+		if (get_buf_offset(buffer) != batch_end)
+			goto unpack_error;
+		if (recs_ptr)
+			rec_cnt += batch_rec_cnt;
+		*job_id_seq = batch_seq;
+	}
+	goto fini;
+
+unpack_error:
+	error("Incomplete job state journal batch, ignoring it and any following");
+
+fini:
+	if (!recs_ptr)
+		return 0;
+
+	/* Keep only the latest record of each job */
+	qsort(recs, rec_cnt, sizeof(job_journal_rec_t), _job_journal_rec_cmp);
+	for (i = 0, j = 0; i < rec_cnt; i++) {
+		if (((i + 1) < rec_cnt) &&
+		    (recs[i].job_id == recs[i + 1].job_id))
+			continue;
+		recs[j++] = recs[i];
+	}
+	*recs_ptr = recs;
+	return j;
+}
+
+static job_journal_rec_t *_find_job_journal_rec(job_journal_rec_t *recs,
+						uint32_t rec_cnt,
+						uint32_t job_id)
+{
+	int lo = 0, hi = (int) rec_cnt - 1, mid;
+
+	while (lo <= hi) {
+		mid = (lo + hi) / 2;
+		if (recs[mid].job_id == job_id)
+			return &recs[mid];
+		if (recs[mid].job_id < job_id)
+			lo = mid + 1;
+		else
+			hi = mid - 1;
+	}
+	return NULL;
+}
+
 /*
  * load_all_job_state - load the job state from file, recover from last
  *	checkpoint. Execute this after loading the configuration file data.
+ *	Job records changed or purged since the file was written are then
+ *	recovered from the job state journal.
  *	Changes here should be reflected in load_last_job_id().
  * RET 0 or error code
  */
@@ -934,12 +1524,16 @@ extern int load_all_job_state(void)
 	int error_code = SLURM_SUCCESS;
 	int job_cnt = 0;
 	char *state_file = NULL;
-	Buf buffer;
+	Buf buffer, journal_buf[JOB_JOURNAL_FILES] = { NULL };
 	time_t buf_time;
-	uint32_t saved_job_id;
+	uint32_t saved_job_id, journal_job_id = 0;
+	uint32_t job_id, len, i, rec_cnt[JOB_JOURNAL_FILES] = { 0 };
+	job_journal_rec_t *recs[JOB_JOURNAL_FILES] = { NULL }, *rec;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
 	uint16_t protocol_version = NO_VAL16;
+	uint16_t journal_version[JOB_JOURNAL_FILES];
+	int j, k;
 
 	/* read the file */
 	lock_state_files();
@@ -976,6 +1570,17 @@ extern int load_all_job_state(void)
 		job_id_sequence = MAX(saved_job_id, job_id_sequence);
 	debug3("Job id in job_state header is %u", saved_job_id);
 
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION)
+		_open_job_journals(buf_time, journal_buf, journal_version);
+	for (j = 0; (j < JOB_JOURNAL_FILES) && journal_buf[j]; j++) {
+		rec_cnt[j] = _read_job_journal(journal_buf[j], &journal_job_id,
+					       &recs[j]);
+	}
+	if (journal_job_id && (journal_job_id <= slurmctld_conf.max_job_id))
+		job_id_sequence = MAX(journal_job_id, job_id_sequence);
+	if (journal_buf[0])
+		debug3("Job id in job_state journal is %u", journal_job_id);
+
 	/*
 	 * Previously we locked the tres read lock before this loop.  It turned
 	 * out that created a double lock when steps were being loaded during
@@ -984,13 +1589,58 @@ extern int load_all_job_state(void)
 	 * into the _load_job_state function than any other option.
 	 */
 	while (remaining_buf(buffer) > 0) {
+		if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+			safe_unpack32(&job_id, buffer);
+			safe_unpack32(&len, buffer);
+			if (len > remaining_buf(buffer))
+				goto unpack_error;
+			/* Skip records superseded by a journal */
+			for (j = 0; j < JOB_JOURNAL_FILES; j++) {
+				if (_find_job_journal_rec(recs[j], rec_cnt[j],
+							  job_id))
+					break;
+			}
+			if (j < JOB_JOURNAL_FILES) {
+				set_buf_offset(buffer,
+					       get_buf_offset(buffer) + len);
+				continue;
+			}
+		}
 		error_code = _load_job_state(buffer, protocol_version);
 		if (error_code != SLURM_SUCCESS)
 			goto unpack_error;
 		job_cnt++;
 	}
+
+	for (j = 0; (j < JOB_JOURNAL_FILES) && journal_buf[j]; j++) {
+		for (i = 0; i < rec_cnt[j]; i++) {
+			rec = &recs[j][i];
+			if (rec->len == 0)	/* job purged */
+				continue;
+			/* Skip records superseded by a later journal */
+			for (k = j + 1; k < JOB_JOURNAL_FILES; k++) {
+				if (_find_job_journal_rec(recs[k], rec_cnt[k],
+							  rec->job_id))
+					break;
+			}
+			if (k < JOB_JOURNAL_FILES)
+				continue;
+			set_buf_offset(journal_buf[j], rec->offset);
+			error_code = _load_job_state(journal_buf[j],
+						     journal_version[j]);
+			if (error_code != SLURM_SUCCESS)
+				goto unpack_error;
+			job_cnt++;
+		}
+		debug("Recovered %u job state journal records", rec_cnt[j]);
+	}
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
+	for (j = 0; j < JOB_JOURNAL_FILES; j++) {
+		xfree(recs[j]);
+		if (journal_buf[j])
+			free_buf(journal_buf[j]);
+	}
 	free_buf(buffer);
 	info("Recovered information about %d jobs", job_cnt);
 	return error_code;
@@ -1000,6 +1650,11 @@ unpack_error:
 		fatal("Incomplete job state save file, start with '-i' to ignore this");
 	error("Incomplete job state save file");
 	info("Recovered information about %d jobs", job_cnt);
+	for (j = 0; j < JOB_JOURNAL_FILES; j++) {
+		xfree(recs[j]);
+		if (journal_buf[j])
+			free_buf(journal_buf[j]);
+	}
 	free_buf(buffer);
 	return SLURM_ERROR;
 }
@@ -1012,11 +1667,13 @@ unpack_error:
 extern int load_last_job_id( void )
 {
 	char *state_file = NULL;
-	Buf buffer;
+	Buf buffer, journal_buf[JOB_JOURNAL_FILES] = { NULL };
 	time_t buf_time;
 	char *ver_str = NULL;
 	uint32_t ver_str_len;
 	uint16_t protocol_version = NO_VAL16;
+	uint16_t journal_version[JOB_JOURNAL_FILES];
+	int j;
 
 	/* read the file */
 	lock_state_files();
@@ -1051,6 +1708,18 @@ extern int load_last_job_id( void )
 
 	/* Ignore the state for individual jobs stored here */
 
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION)
+		_open_job_journals(buf_time, journal_buf, journal_version);
+	for (j = 0; (j < JOB_JOURNAL_FILES) && journal_buf[j]; j++) {
+		(void) _read_job_journal(journal_buf[j], &job_id_sequence,
+					 NULL);
+		debug3("Job ID in job_state journal is %u", job_id_sequence);
+	}
+	for (j = 0; j < JOB_JOURNAL_FILES; j++) {
+		if (journal_buf[j])
+			free_buf(journal_buf[j]);
+	}
+
 	xfree(ver_str);
 	free_buf(buffer);
 	return SLURM_SUCCESS;
@@ -2758,6 +3427,24 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static uint64_t _job_hash_id(void *x)
+{
+	return ((struct job_record *) x)->job_id;
+}
+
+static uint64_t _job_array_hash_id(void *x)
+{
+	return ((struct job_record *) x)->array_job_id;
+}
+
+static uint64_t _job_array_task_hash_id(void *x)
+{
+	struct job_record *job_ptr = (struct job_record *) x;
+
+	return JOB_ARRAY_TASK_KEY(job_ptr->array_job_id,
+				  job_ptr->array_task_id);
+}
+
 /* _add_job_hash - add a job hash entry for given job record, job_id must
  *	already be set
  * IN job_ptr - pointer to job record
@@ -2765,11 +3452,7 @@ unpack_error:
  */
 static void _add_job_hash(struct job_record *job_ptr)
 {
-	int inx;
-
-	inx = JOB_HASH_INX(job_ptr->job_id);
-	job_ptr->job_next = job_hash[inx];
-	job_hash[inx] = job_ptr;
+	xhash_add(job_hash, job_ptr);
 }
 
 /* _remove_job_hash - remove a job hash entry for given job record, job_id must
@@ -2781,77 +3464,60 @@ static void _add_job_hash(struct job_record *job_ptr)
 static void _remove_job_hash(struct job_record *job_entry,
 			     job_hash_type_t type)
 {
-	struct job_record *job_ptr, **job_pptr;
+	struct job_record *job_ptr;
+	uint64_t key;
 
 	xassert(job_entry);
 
 	switch (type) {
 	case JOB_HASH_JOB:
-		job_pptr = &job_hash[JOB_HASH_INX(job_entry->job_id)];
+		if (xhash_get_int(job_hash, job_entry->job_id) != job_entry) {
+			error("%s: Could not find hash entry for JobId=%u",
+			      __func__, job_entry->job_id);
+			return;
+		}
+		xhash_pop_int(job_hash, job_entry->job_id);
 		break;
 	case JOB_HASH_ARRAY_JOB:
-		job_pptr = &job_array_hash_j[
-			JOB_HASH_INX(job_entry->array_job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j,
+					job_entry->array_job_id);
+		if (job_ptr == job_entry) {
+			xhash_pop_int(job_array_hash_j,
+				      job_entry->array_job_id);
+			if (job_entry->job_array_next_j)
+				xhash_add(job_array_hash_j,
+					  job_entry->job_array_next_j);
+		} else {
+			while (job_ptr &&
+			       (job_ptr->job_array_next_j != job_entry)) {
+				xassert(job_ptr->magic == JOB_MAGIC);
+				job_ptr = job_ptr->job_array_next_j;
+			}
+			if (!job_ptr) {
+				error("%s: job array hash error %u", __func__,
+				      job_entry->array_job_id);
+				return;
+			}
+			job_ptr->job_array_next_j =
+				job_entry->job_array_next_j;
+		}
+		job_entry->job_array_next_j = NULL;
 		break;
 	case JOB_HASH_ARRAY_TASK:
-		job_pptr = &job_array_hash_t[
-			JOB_ARRAY_HASH_INX(job_entry->array_job_id,
-					   job_entry->array_task_id)];
-		break;
-	default:
-		fatal("%s: unknown job_hash_type_t %d", __func__, type);
-		return;
-	}
-
-	while ((job_pptr != NULL) && (*job_pptr != NULL) &&
-	       ((job_ptr = *job_pptr) != job_entry)) {
-		xassert(job_ptr->magic == JOB_MAGIC);
-		switch (type) {
-		case JOB_HASH_JOB:
-			job_pptr = &job_ptr->job_next;
-			break;
-		case JOB_HASH_ARRAY_JOB:
-			job_pptr = &job_ptr->job_array_next_j;
-			break;
-		case JOB_HASH_ARRAY_TASK:
-			job_pptr = &job_ptr->job_array_next_t;
-			break;
-		}
-	}
-
-	if (job_pptr == NULL) {
-		switch (type) {
-		case JOB_HASH_JOB:
-			error("%s: Could not find hash entry for JobId=%u",
-			      __func__, job_entry->job_id);
-			break;
-		case JOB_HASH_ARRAY_JOB:
-			error("%s: job array hash error %u", __func__,
-			      job_entry->array_job_id);
-			break;
-		case JOB_HASH_ARRAY_TASK:
+		key = JOB_ARRAY_TASK_KEY(job_entry->array_job_id,
+					 job_entry->array_task_id);
+		if (xhash_get_int(job_array_hash_t, key) != job_entry) {
 			error("%s: job array, task ID hash error %u_%u",
 			      __func__,
 			      job_entry->array_job_id,
 			      job_entry->array_task_id);
-			break;
+			return;
 		}
-		return;
-	}
-
-	switch (type) {
-	case JOB_HASH_JOB:
-		*job_pptr = job_entry->job_next;
-		job_entry->job_next = NULL;
-		break;
-	case JOB_HASH_ARRAY_JOB:
-		*job_pptr = job_entry->job_array_next_j;
-		job_entry->job_array_next_j = NULL;
-		break;
-	case JOB_HASH_ARRAY_TASK:
-		*job_pptr = job_entry->job_array_next_t;
-		job_entry->job_array_next_t = NULL;
+		xhash_pop_int(job_array_hash_t, key);
 		break;
+	default:
+		fatal("%s: unknown job_hash_type_t %d", __func__, type);
+		return;
 	}
 }
 
@@ -2859,21 +3525,19 @@ static void _remove_job_hash(struct job_record *job_entry,
  *	array_job_id and array_task_id must already be set
  * IN job_ptr - pointer to job record
  * Globals: hash table updated
+ *
+ * job_array_hash_j holds the most recently added task of each job array,
+ * which heads a list of all of its tasks linked through job_array_next_j.
  */
 void _add_job_array_hash(struct job_record *job_ptr)
 {
-	int inx;
-
 	if (job_ptr->array_task_id == NO_VAL)
 		return;	/* Not a job array */
 
-	inx = JOB_HASH_INX(job_ptr->array_job_id);
-	job_ptr->job_array_next_j = job_array_hash_j[inx];
-	job_array_hash_j[inx] = job_ptr;
-
-	inx = JOB_ARRAY_HASH_INX(job_ptr->array_job_id,job_ptr->array_task_id);
-	job_ptr->job_array_next_t = job_array_hash_t[inx];
-	job_array_hash_t[inx] = job_ptr;
+	job_ptr->job_array_next_j = xhash_pop_int(job_array_hash_j,
+						  job_ptr->array_job_id);
+	xhash_add(job_array_hash_j, job_ptr);
+	xhash_add(job_array_hash_t, job_ptr);
 }
 
 /* For the job array data structure, build the string representation of the
@@ -2916,7 +3580,6 @@ extern void build_array_str(struct job_record *job_ptr)
 extern bool test_job_array_complete(uint32_t array_job_id)
 {
 	struct job_record *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -2927,8 +3590,7 @@ extern bool test_job_array_complete(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (!IS_JOB_COMPLETE(job_ptr))
@@ -2943,7 +3605,6 @@ extern bool test_job_array_complete(uint32_t array_job_id)
 extern bool test_job_array_completed(uint32_t array_job_id)
 {
 	struct job_record *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -2952,8 +3613,7 @@ extern bool test_job_array_completed(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (!IS_JOB_COMPLETED(job_ptr))
@@ -2968,7 +3628,6 @@ extern bool test_job_array_completed(uint32_t array_job_id)
 extern bool test_job_array_finished(uint32_t array_job_id)
 {
 	struct job_record *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -2977,8 +3636,7 @@ extern bool test_job_array_finished(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (!IS_JOB_FINISHED(job_ptr))
@@ -2994,7 +3652,6 @@ extern bool test_job_array_finished(uint32_t array_job_id)
 extern bool test_job_array_pending(uint32_t array_job_id)
 {
 	struct job_record *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -3005,8 +3662,7 @@ extern bool test_job_array_pending(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (IS_JOB_PENDING(job_ptr))
@@ -3022,10 +3678,9 @@ extern bool test_job_array_pending(uint32_t array_job_id)
 extern int num_pending_job_array_tasks(uint32_t array_job_id)
 {
 	struct job_record *job_ptr;
-	int count = 0, inx;
+	int count = 0;
 
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if ((job_ptr->array_job_id == array_job_id) &&
 		    IS_JOB_PENDING(job_ptr))
@@ -3061,8 +3716,7 @@ extern struct job_record *find_job_array_rec(uint32_t array_job_id,
 		    (job_ptr->array_job_id == array_job_id))
 			return job_ptr;
 
-		inx = JOB_HASH_INX(array_job_id);
-		job_ptr = job_array_hash_j[inx];
+		job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 		while (job_ptr) {
 			if (job_ptr->array_job_id == array_job_id) {
 				match_job_ptr = job_ptr;
@@ -3074,15 +3728,11 @@ extern struct job_record *find_job_array_rec(uint32_t array_job_id,
 		}
 		return match_job_ptr;
 	} else {		/* Find specific task ID */
-		inx = JOB_ARRAY_HASH_INX(array_job_id, array_task_id);
-		job_ptr = job_array_hash_t[inx];
-		while (job_ptr) {
-			if ((job_ptr->array_job_id == array_job_id) &&
-			    (job_ptr->array_task_id == array_task_id)) {
-				return job_ptr;
-			}
-			job_ptr = job_ptr->job_array_next_t;
-		}
+		job_ptr = xhash_get_int(job_array_hash_t,
+					JOB_ARRAY_TASK_KEY(array_job_id,
+							   array_task_id));
+		if (job_ptr)
+			return job_ptr;
 		/* Look for job record with all of the pending tasks */
 		job_ptr = find_job_record(array_job_id);
 		if (job_ptr && job_ptr->array_recs &&
@@ -3110,12 +3760,7 @@ extern struct job_record *find_job_pack_record(uint32_t job_id,
 	struct job_record *pack_leader, *pack_job;
 	ListIterator iter;
 
-	pack_leader = job_hash[JOB_HASH_INX(job_id)];
-	while (pack_leader) {
-		if (pack_leader->job_id == job_id)
-			break;
-		pack_leader = pack_leader->job_next;
-	}
+	pack_leader = xhash_get_int(job_hash, job_id);
 	if (!pack_leader)
 		return NULL;
 	if (pack_leader->pack_job_offset == pack_id)
@@ -3145,16 +3790,7 @@ extern struct job_record *find_job_pack_record(uint32_t job_id,
  */
 extern struct job_record *find_job_record(uint32_t job_id)
 {
-	struct job_record *job_ptr;
-
-	job_ptr = job_hash[JOB_HASH_INX(job_id)];
-	while (job_ptr) {
-		if (job_ptr->job_id == job_id)
-			return job_ptr;
-		job_ptr = job_ptr->job_next;
-	}
-
-	return NULL;
+	return xhash_get_int(job_hash, job_id);
 }
 
 /* rebuild a job's partition name list based upon the contents of its
@@ -3188,6 +3824,7 @@ static void _rebuild_part_name_list(struct job_record  *job_ptr)
 	}
 	list_iterator_destroy(part_iterator);
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 /*
@@ -3407,6 +4044,7 @@ extern int kill_job_by_part_name(char *part_name)
 		}
 		if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			kill_job_cnt++;
+			JOB_RECORD_CHANGED(job_ptr);
 			info("Killing %pJ on defunct partition %s",
 			     job_ptr, part_name);
 			job_ptr->job_state = JOB_NODE_FAIL | JOB_COMPLETING;
@@ -3425,6 +4063,7 @@ extern int kill_job_by_part_name(char *part_name)
 						 false);
 		} else if (pending) {
 			kill_job_cnt++;
+			JOB_RECORD_CHANGED(job_ptr);
 			info("Killing %pJ on defunct partition %s",
 			     job_ptr, part_name);
 			job_ptr->job_state	= JOB_CANCELLED;
@@ -3492,6 +4131,7 @@ extern int kill_job_by_front_end_name(char *node_name)
 		}
 		if (IS_JOB_COMPLETING(job_ptr)) {
 			kill_job_cnt++;
+			JOB_RECORD_CHANGED(job_ptr);
 			while ((i = bit_ffs(job_ptr->node_bitmap_cg)) >= 0) {
 				bit_clear(job_ptr->node_bitmap_cg, i);
 				if (job_ptr->node_cnt)
@@ -3514,6 +4154,7 @@ extern int kill_job_by_front_end_name(char *node_name)
 			}
 		} else if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			kill_job_cnt++;
+			JOB_RECORD_CHANGED(job_ptr);
 			if (job_ptr->batch_flag && job_ptr->details &&
 			    slurmctld_conf.job_requeue &&
 			    (job_ptr->details->requeue > 0)) {
@@ -3790,6 +4431,7 @@ extern int kill_running_job_by_node_name(char *node_name)
 			if (!bit_test(job_ptr->node_bitmap_cg, node_inx))
 				continue;
 			kill_job_cnt++;
+			JOB_RECORD_CHANGED(job_ptr);
 			bit_clear(job_ptr->node_bitmap_cg, node_inx);
 			job_update_tres_cnt(job_ptr, node_inx);
 			if (job_ptr->node_cnt)
@@ -3808,6 +4450,7 @@ extern int kill_running_job_by_node_name(char *node_name)
 			}
 		} else if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			kill_job_cnt++;
+			JOB_RECORD_CHANGED(job_ptr);
 			if ((job_ptr->details) &&
 			    (job_ptr->kill_on_node_fail == 0) &&
 			    (job_ptr->node_cnt > 1) &&
@@ -3960,6 +4603,7 @@ extern void excise_node_from_job(struct job_record *job_ptr,
 	}
 
 	job_ptr->total_nodes = job_ptr->node_cnt = new_pos + 1;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	FREE_NULL_BITMAP(orig_bitmap);
 	(void) select_g_job_resized(job_ptr, node_ptr);
@@ -4222,6 +4866,8 @@ int init_job_conf(void)
 	}
 
 	last_job_update = time(NULL);
+	/* No purge history from before this point, force full job info */
+	purged_job_begin = job_update_seq;
 
 	if (!purge_files_list) {
 		purge_files_list = list_create(slurm_destroy_uint32_ptr);
@@ -4231,7 +4877,9 @@ int init_job_conf(void)
 }
 
 /*
- * rehash_jobs - Create or rebuild the job hash table.
+ * rehash_jobs - Create the job hash tables.
+ * The tables grow with the job count, so MaxJobCount can be changed without
+ * rebuilding them.
  */
 extern void rehash_jobs(void)
 {
@@ -4239,20 +4887,10 @@ extern void rehash_jobs(void)
 	xassert(verify_lock(JOB_LOCK, WRITE_LOCK));
 
 	if (job_hash == NULL) {
-		hash_table_size = slurmctld_conf.max_job_cnt;
-		job_hash = (struct job_record **)
-			xmalloc(hash_table_size * sizeof(struct job_record *));
-		job_array_hash_j = (struct job_record **)
-			xmalloc(hash_table_size * sizeof(struct job_record *));
-		job_array_hash_t = (struct job_record **)
-			xmalloc(hash_table_size * sizeof(struct job_record *));
-	} else if (hash_table_size < (slurmctld_conf.max_job_cnt / 2)) {
-		/* If the MaxJobCount grows by too much, the hash table will
-		 * be ineffective without rebuilding. We don't presently bother
-		 * to rebuild the hash table, but cut MaxJobCount back as
-		 * needed. */
-		error ("MaxJobCount reset too high, restart slurmctld");
-		slurmctld_conf.max_job_cnt = hash_table_size;
+		job_hash = xhash_init_int(_job_hash_id, NULL);
+		job_array_hash_j = xhash_init_int(_job_array_hash_id, NULL);
+		job_array_hash_t = xhash_init_int(_job_array_task_hash_id,
+						  NULL);
 	}
 }
 
@@ -4263,7 +4901,7 @@ extern void rehash_jobs(void)
  * RET - The new job record, which is the new META job record. */
 extern struct job_record *job_array_split(struct job_record *job_ptr)
 {
-	struct job_record *job_ptr_pend = NULL, *save_job_next;
+	struct job_record *job_ptr_pend = NULL;
 	struct job_details *job_details, *details_new, *save_details;
 	uint32_t save_job_id;
 	uint64_t save_db_index = job_ptr->db_index;
@@ -4289,20 +4927,21 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	 * This could be done in parallel, but performance was worse.
 	 */
 	save_job_id   = job_ptr_pend->job_id;
-	save_job_next = job_ptr_pend->job_next;
 	save_details  = job_ptr_pend->details;
 	save_prio_factors = job_ptr_pend->prio_factors;
 	save_step_list = job_ptr_pend->step_list;
 	memcpy(job_ptr_pend, job_ptr, sizeof(struct job_record));
 
 	job_ptr_pend->job_id   = save_job_id;
-	job_ptr_pend->job_next = save_job_next;
 	job_ptr_pend->details  = save_details;
 	job_ptr_pend->db_flags = 0;
 	job_ptr_pend->step_list = save_step_list;
 	job_ptr_pend->db_index = save_db_index;
 
 	job_ptr_pend->prio_factors = save_prio_factors;
+	/* Both records are reported as changed, job_ptr has a new job_id */
+	JOB_RECORD_CHANGED(job_ptr_pend);
+	JOB_RECORD_CHANGED(job_ptr);
 	slurm_copy_priority_factors_object(job_ptr_pend->prio_factors,
 					   job_ptr->prio_factors);
 
@@ -4357,8 +4996,8 @@ extern struct job_record *job_array_split(struct job_record *job_ptr)
 	memcpy(job_ptr_pend->limit_set.tres, job_ptr->limit_set.tres,
 	       sizeof(uint16_t) * slurmctld_tres_cnt);
 
-	_add_job_hash(job_ptr);		/* Sets job_next */
-	_add_job_hash(job_ptr_pend);	/* Sets job_next */
+	_add_job_hash(job_ptr);
+	_add_job_hash(job_ptr_pend);
 	_add_job_array_hash(job_ptr);
 	job_ptr_pend->job_resrcs = NULL;
 
@@ -4696,6 +5335,7 @@ static int _select_nodes_parts(struct job_record *job_ptr, bool test_only,
 		job_ptr->state_reason = WAIT_POWER_RESERVED;
 	else if (rc == ESLURM_PARTITION_DOWN)
 		job_ptr->state_reason = WAIT_PART_DOWN;
+	JOB_RECORD_CHANGED(job_ptr);
 	return rc;
 }
 
@@ -4888,6 +5528,7 @@ extern int job_allocate(job_desc_msg_t * job_specs, int immediate,
 	error_code = _select_nodes_parts(job_ptr, no_alloc, NULL, err_msg);
 	if (!test_only) {
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
        /*
@@ -5003,6 +5644,7 @@ static int _job_fail(struct job_record *job_ptr, uint32_t job_state)
 		} else
 			job_ptr->end_time       = now;
 		last_job_update                 = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		job_ptr->job_state = job_state | JOB_COMPLETING;
 		job_ptr->exit_code = 1;
 		job_ptr->state_reason = FAIL_LAUNCH;
@@ -5127,6 +5769,7 @@ extern int job_signal(struct job_record *job_ptr, uint16_t signal,
 	/* let node select plugin do any state-dependent signaling actions */
 	select_g_job_signal(job_ptr, signal);
 	last_job_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/* save user ID of the one who requested the job be cancelled */
 	if (signal == SIGKILL)
@@ -5146,6 +5789,7 @@ extern int job_signal(struct job_record *job_ptr, uint16_t signal,
 
 	if (IS_JOB_CONFIGURING(job_ptr) && (signal == SIGKILL)) {
 		last_job_update         = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		job_ptr->end_time       = now;
 		job_ptr->job_state      = JOB_CANCELLED | JOB_COMPLETING;
 		if (flags & KILL_FED_REQUEUE)
@@ -5190,6 +5834,7 @@ extern int job_signal(struct job_record *job_ptr, uint16_t signal,
 		job_term_state = JOB_CANCELLED;
 	if (IS_JOB_SUSPENDED(job_ptr) && (signal == SIGKILL)) {
 		last_job_update         = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		job_ptr->end_time       = job_ptr->suspend_time;
 		job_ptr->tot_sus_time  += difftime(now, job_ptr->suspend_time);
 		job_ptr->job_state      = job_term_state | JOB_COMPLETING;
@@ -5450,7 +6095,7 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 		}
 
 		/* Signal all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			info("%s(3): invalid JobId=%u", __func__, job_id);
 			return ESLURM_INVALID_JOB_ID;
@@ -5503,7 +6148,7 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 	/* Find some job record and validate the user signaling the job */
 	job_ptr = find_job_record(job_id);
 	if (job_ptr == NULL) {
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j, job_id);
 		while (job_ptr) {
 			if (job_ptr->array_job_id == job_id)
 				break;
@@ -5551,8 +6196,10 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 			orig_task_cnt = job_ptr->array_recs->task_cnt;
 			new_task_count = bit_set_count(job_ptr->array_recs->
 						       task_id_bitmap);
+			/* The meta record's task list changes either way */
+			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			if (!new_task_count) {
-				last_job_update		= now;
 				job_ptr->job_state	= JOB_CANCELLED;
 				job_ptr->start_time	= now;
 				job_ptr->end_time	= now;
@@ -5698,6 +6345,8 @@ extern int prolog_complete(uint32_t job_id,
 		error("Prolog launch failure, %pJ", job_ptr);
 
 	job_ptr->state_reason = WAIT_NO_REASON;
+	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -5894,6 +6543,7 @@ static int _job_complete(struct job_record *job_ptr, uid_t uid, bool requeue,
 	}
 
 	last_job_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 	job_ptr->time_last_active = now;   /* Timer for resending kill RPC */
 	if (job_comp_flag) {	/* job was running */
 		build_cg_bitmap(job_ptr);
@@ -7733,6 +8383,22 @@ static uint16_t _default_wait_all_nodes(job_desc_msg_t *job_desc)
 	return default_batch_wait;
 }
 
+/* Return a NULL terminated copy of an array from an RPC */
+static char **_copy_job_desc_array(uint32_t cnt, char **array)
+{
+	char **result;
+	int i;
+
+	if (cnt == 0)
+		return NULL;
+
+	result = xmalloc(sizeof(char *) * (cnt + 1));
+	for (i = 0; i < cnt; i++)
+		result[i] = xstrdup(array[i]);
+
+	return result;
+}
+
 /* _copy_job_desc_to_job_record - copy the job descriptor from the RPC
  *	structure into the actual slurmctld job record */
 static int
@@ -7856,10 +8522,19 @@ _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 	job_ptr->bit_flags = job_desc->bitflags;
 	job_ptr->bit_flags &= ~BACKFILL_TEST;
 	job_ptr->ckpt_interval = job_desc->ckpt_interval;
-	job_ptr->spank_job_env = job_desc->spank_job_env;
+	/*
+	 * Take over arrays from the RPC, but copy them if they were unpacked
+	 * into an arena, which they would otherwise keep alive
+	 */
 	job_ptr->spank_job_env_size = job_desc->spank_job_env_size;
-	job_desc->spank_job_env = (char **) NULL; /* nothing left to free */
-	job_desc->spank_job_env_size = 0;         /* nothing left to free */
+	if (arena_owned(job_desc->spank_job_env)) {
+		job_ptr->spank_job_env = _copy_job_desc_array(
+			job_desc->spank_job_env_size, job_desc->spank_job_env);
+	} else {
+		job_ptr->spank_job_env = job_desc->spank_job_env;
+		job_desc->spank_job_env = (char **) NULL;
+		job_desc->spank_job_env_size = 0;
+	}
 	job_ptr->mcs_label = xstrdup(job_desc->mcs_label);
 	job_ptr->origin_cluster = xstrdup(job_desc->origin_cluster);
 
@@ -7882,9 +8557,14 @@ _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 
 	detail_ptr = job_ptr->details;
 	detail_ptr->argc = job_desc->argc;
-	detail_ptr->argv = job_desc->argv;
-	job_desc->argv   = (char **) NULL; /* nothing left to free */
-	job_desc->argc   = 0;		   /* nothing left to free */
+	if (arena_owned(job_desc->argv)) {
+		detail_ptr->argv = _copy_job_desc_array(job_desc->argc,
+							job_desc->argv);
+	} else {
+		detail_ptr->argv = job_desc->argv;
+		job_desc->argv   = (char **) NULL; /* nothing left to free */
+		job_desc->argc   = 0;		   /* nothing left to free */
+	}
 	detail_ptr->acctg_freq = xstrdup(job_desc->acctg_freq);
 	detail_ptr->cpu_bind_type = job_desc->cpu_bind_type;
 	detail_ptr->cpu_bind   = xstrdup(job_desc->cpu_bind);
@@ -8298,6 +8978,7 @@ static void _job_time_limit_incr(struct job_record *job_ptr,
 		job_ptr->end_time = now + (job_ptr->time_limit * 60);
 		job_ptr->end_time_exp = job_ptr->end_time;
 	}
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 /*
@@ -8343,6 +9024,7 @@ extern void job_config_fini(struct job_record *job_ptr)
 	time_t now = time(NULL);
 
 	last_job_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 	job_ptr->job_state &= ~JOB_CONFIGURING;
 	if (IS_JOB_POWER_UP_NODE(job_ptr)) {
 		info("Resetting %pJ start time for node power up", job_ptr);
@@ -8517,6 +9199,7 @@ void job_time_limit(void)
 			job_ptr->state_reason = WAIT_NO_REASON;
 			set_job_prio(job_ptr);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 
 		if (_pack_configuring_test(job_ptr))
@@ -8547,6 +9230,7 @@ void job_time_limit(void)
 			}
 			if (job_ptr->end_time <= now) {
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 				info("%s: Preemption GraceTime reached %pJ",
 				     __func__, job_ptr);
 				job_ptr->job_state = JOB_PREEMPTED |
@@ -8630,6 +9314,7 @@ void job_time_limit(void)
 				over_run = now - (over_time_limit  * 60);
 			if (job_ptr->end_time <= over_run) {
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 				info("Time limit exhausted for %pJ", job_ptr);
 				_job_timed_out(job_ptr, false);
 				job_ptr->state_reason = FAIL_TIMEOUT;
@@ -8642,6 +9327,7 @@ void job_time_limit(void)
 		    !(job_ptr->resv_ptr->flags & RESERVE_FLAG_FLEX) &&
 		    (job_ptr->resv_ptr->end_time + resv_over_run) < time(NULL)){
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			info("Reservation ended for %pJ", job_ptr);
 			_job_timed_out(job_ptr, false);
 			job_ptr->state_reason = FAIL_TIMEOUT;
@@ -8661,6 +9347,7 @@ void job_time_limit(void)
 
 		if (job_ptr->state_reason == FAIL_TIMEOUT) {
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			_job_timed_out(job_ptr, false);
 			xfree(job_ptr->state_desc);
 			goto time_check;
@@ -8894,6 +9581,7 @@ extern int job_update_tres_cnt(struct job_record *job_ptr, int node_inx)
 
 		job_set_alloc_tres(job_ptr, false);
 	}
+	JOB_RECORD_CHANGED(job_ptr);
 	return rc;
 }
 
@@ -9110,6 +9798,9 @@ static void _list_delete_job(void *job_entry)
 	xassert (job_ptr->magic == JOB_MAGIC);
 	job_ptr->magic = 0;	/* make sure we don't delete record twice */
 
+	/* Report the removal in incremental job info RPCs */
+	_purged_job_hist_add(job_ptr);
+
 	/* Remove record from fed_job_list */
 	fed_mgr_remove_fed_job_info(job_ptr->job_id);
 
@@ -9347,6 +10038,23 @@ static bool _all_parts_hidden(struct job_record *job_ptr, uid_t uid)
 	return true;
 }
 
+/*
+ * Determine if PrivateData=jobs hides a job with the given owner, account
+ * and mcs_label from a specific user
+ */
+static bool _hide_private_job(uid_t job_uid, char *account, char *mcs_label,
+			      uid_t uid)
+{
+	if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
+	    (job_uid != uid) && !validate_operator(uid) &&
+	    (((slurm_mcs_get_privatedata() == 0) &&
+	      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid, account)) ||
+	     ((slurm_mcs_get_privatedata() == 1) &&
+	      (mcs_g_check_mcs_label(uid, mcs_label) != 0))))
+		return true;
+	return false;
+}
+
 /* Determine if a given job should be seen by a specific user */
 static bool _hide_job(struct job_record *job_ptr, uid_t uid,
 		      uint16_t show_flags)
@@ -9354,15 +10062,8 @@ static bool _hide_job(struct job_record *job_ptr, uid_t uid,
 	if (!(show_flags & SHOW_ALL) && IS_JOB_REVOKED(job_ptr))
 		return true;
 
-	if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
-	    (job_ptr->user_id != uid) && !validate_operator(uid) &&
-	    (((slurm_mcs_get_privatedata() == 0) &&
-	      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
-					    job_ptr->account)) ||
-	     ((slurm_mcs_get_privatedata() == 1) &&
-	      (mcs_g_check_mcs_label(uid, job_ptr->mcs_label) != 0))))
-		return true;
-	return false;
+	return _hide_private_job(job_ptr->user_id, job_ptr->account,
+				 job_ptr->mcs_label, uid);
 }
 
 static void _pack_job(struct job_record *job_ptr,
@@ -9433,7 +10134,7 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	/* write message body header : size and time */
 	/* put in a place holder job record count of 0 for now */
 	pack32(jobs_packed, buffer);
-	pack_time(time(NULL), buffer);
+	pack_time(_job_info_time(), buffer);
 
 	/* write individual job records */
 	pack_info.buffer           = buffer;
@@ -9448,6 +10149,235 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 		_pack_job(job_ptr, &pack_info);
 	}
 	list_iterator_destroy(itr);
+	_pack_job_info_trailer(0, NULL, 0, buffer, protocol_version);
+
+	/* put the real record count in the message body header */
+	tmp_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, 0);
+	pack32(jobs_packed, buffer);
+	set_buf_offset(buffer, tmp_offset);
+
+	*buffer_size = get_buf_offset(buffer);
+	buffer_ptr[0] = xfer_buf_data(buffer);
+}
+
+/*
+ * Remember that a job record was purged so incremental job info RPCs can
+ * report it. Once the history wraps, older requests get a full response.
+ */
+static void _purged_job_hist_add(struct job_record *job_ptr)
+{
+	purged_job_t *purged;
+
+	if (!purged_job_hist) {
+		purged_job_hist = xmalloc(sizeof(purged_job_t) *
+					  PURGED_JOB_HIST_SIZE);
+	}
+
+	purged = &purged_job_hist[purged_job_head];
+	if (purged_job_cnt == PURGED_JOB_HIST_SIZE)
+		purged_job_begin = purged->purge_seq;
+	else
+		purged_job_cnt++;
+	purged->job_id = job_ptr->job_id;
+	purged->purge_seq = ++job_update_seq;
+	purged->user_id = job_ptr->user_id;
+	xfree(purged->account);
+	purged->account = xstrdup(job_ptr->account);
+	xfree(purged->mcs_label);
+	purged->mcs_label = xstrdup(job_ptr->mcs_label);
+	purged_job_head = (purged_job_head + 1) % PURGED_JOB_HIST_SIZE;
+}
+
+/*
+ * Return the last_update time to give a job info client and remember the
+ * job_update_seq it stands for, so that a later incremental job info RPC
+ * is answered by sequence number rather than by one second time stamps.
+ * NOTE: Caller must hold the job read lock
+ */
+static time_t _job_info_time(void)
+{
+	job_info_time_t *last;
+	time_t now = time(NULL);
+
+	slurm_mutex_lock(&job_info_time_mutex);
+	if (!job_info_time_hist) {
+		job_info_time_hist = xmalloc(sizeof(job_info_time_t) *
+					     JOB_INFO_TIME_HIST_SIZE);
+	}
+
+	last = &job_info_time_hist[(job_info_time_head +
+				    JOB_INFO_TIME_HIST_SIZE - 1) %
+				   JOB_INFO_TIME_HIST_SIZE];
+	/* A time seen before the clock moved back would be ambiguous */
+	if (job_info_time_cnt && (now < last->time))
+		job_info_time_cnt = 0;
+	/* Keep the first, and so lowest, sequence number of each second */
+	if (!job_info_time_cnt || (now != last->time)) {
+		job_info_time_hist[job_info_time_head].time = now;
+		job_info_time_hist[job_info_time_head].seq = job_update_seq;
+		job_info_time_head = (job_info_time_head + 1) %
+				     JOB_INFO_TIME_HIST_SIZE;
+		if (job_info_time_cnt < JOB_INFO_TIME_HIST_SIZE)
+			job_info_time_cnt++;
+	}
+	slurm_mutex_unlock(&job_info_time_mutex);
+
+	return now;
+}
+
+/*
+ * Find the job_update_seq which a last_update time given out by
+ * _job_info_time() stands for
+ * RET false if the time is unknown, e.g. from before a restart
+ */
+static bool _job_info_seq(time_t update_time, uint64_t *update_seq)
+{
+	uint32_t i, inx;
+	bool found = false;
+
+	slurm_mutex_lock(&job_info_time_mutex);
+	inx = job_info_time_head;
+	for (i = 0; i < job_info_time_cnt; i++) {
+		inx = (inx + JOB_INFO_TIME_HIST_SIZE - 1) %
+		      JOB_INFO_TIME_HIST_SIZE;
+		if (job_info_time_hist[inx].time < update_time)
+			break;
+		if (job_info_time_hist[inx].time == update_time) {
+			*update_seq = job_info_time_hist[inx].seq;
+			found = true;
+			break;
+		}
+	}
+	slurm_mutex_unlock(&job_info_time_mutex);
+
+	return found;
+}
+
+/* Pack the fields following the job records in a RESPONSE_JOB_INFO */
+static void _pack_job_info_trailer(uint16_t delta, uint32_t *removed_job_id,
+				   uint32_t removed_cnt, Buf buffer,
+				   uint16_t protocol_version)
+{
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+		pack16(delta, buffer);
+		pack32_array(removed_job_id, removed_cnt, buffer);
+	}
+}
+
+/*
+ * Return true if every change made to the job table since the client got
+ * last_update time update_time can be reported incrementally: the time must
+ * be known, the purge history must cover the changes since then and
+ * partition visibility must not have changed since.
+ * OUT update_seq - job_update_seq the client's job information reflects
+ */
+static bool _delta_job_info_valid(time_t update_time, uint64_t *update_seq)
+{
+	if (!_job_info_seq(update_time, update_seq))
+		return false;
+	if (*update_seq < purged_job_begin)
+		return false;
+	if (update_time <= last_part_update)
+		return false;
+	return true;
+}
+
+/*
+ * pack_delta_jobs - dump job information for jobs created or changed since
+ *	update_time in machine independent form (for network transmission),
+ *	followed by the IDs of jobs purged or hidden since then. Jobs which
+ *	PrivateData=jobs hides from the user are never reported, so their
+ *	IDs are not disclosed.
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN update_time - time of the client's last job information
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * global: job_list - global list of job records
+ * NOTE: Packs all jobs if the changes can not be reported incrementally
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ */
+extern void pack_delta_jobs(char **buffer_ptr, int *buffer_size,
+			    time_t update_time, uint16_t show_flags, uid_t uid,
+			    uint16_t protocol_version)
+{
+	uint32_t jobs_packed = 0, prev_packed, tmp_offset;
+	uint32_t removed_cnt = 0, removed_size = 0, *removed_job_id = NULL;
+	uint32_t i, inx;
+	uint64_t update_seq = 0;
+	_foreach_pack_job_info_t pack_info = {0};
+	Buf buffer;
+	ListIterator itr;
+	struct job_record *job_ptr = NULL;
+
+	if ((protocol_version < SLURM_19_05_PROTOCOL_VERSION) ||
+	    !_delta_job_info_valid(update_time, &update_seq)) {
+		pack_all_jobs(buffer_ptr, buffer_size, show_flags, uid,
+			      NO_VAL, protocol_version);
+		return;
+	}
+
+	buffer_ptr[0] = NULL;
+	*buffer_size = 0;
+
+	buffer = init_buf(BUF_SIZE);
+
+	/* write message body header : size and time */
+	/* put in a place holder job record count of 0 for now */
+	pack32(jobs_packed, buffer);
+	pack_time(_job_info_time(), buffer);
+
+	/* write individual job records */
+	pack_info.buffer           = buffer;
+	pack_info.filter_uid       = NO_VAL;
+	pack_info.jobs_packed      = &jobs_packed;
+	pack_info.protocol_version = protocol_version;
+	pack_info.show_flags       = show_flags;
+	pack_info.uid              = uid;
+
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = (struct job_record *) list_next(itr))) {
+		if (job_ptr->update_seq <= update_seq)
+			continue;
+		prev_packed = jobs_packed;
+		_pack_job(job_ptr, &pack_info);
+		if (jobs_packed != prev_packed)
+			continue;
+		/* Changed, but no longer visible to this user */
+		if (_hide_private_job(job_ptr->user_id, job_ptr->account,
+				      job_ptr->mcs_label, uid))
+			continue;
+		if (removed_cnt >= removed_size) {
+			removed_size += 1024;
+			xrealloc(removed_job_id,
+				 sizeof(uint32_t) * removed_size);
+		}
+		removed_job_id[removed_cnt++] = job_ptr->job_id;
+	}
+	list_iterator_destroy(itr);
+
+	/* Add jobs purged since update_time, newest first */
+	inx = purged_job_head;
+	for (i = 0; i < purged_job_cnt; i++) {
+		inx = (inx + PURGED_JOB_HIST_SIZE - 1) % PURGED_JOB_HIST_SIZE;
+		if (purged_job_hist[inx].purge_seq <= update_seq)
+			break;
+		if (_hide_private_job(purged_job_hist[inx].user_id,
+				      purged_job_hist[inx].account,
+				      purged_job_hist[inx].mcs_label, uid))
+			continue;
+		if (removed_cnt >= removed_size) {
+			removed_size += 1024;
+			xrealloc(removed_job_id,
+				 sizeof(uint32_t) * removed_size);
+		}
+		removed_job_id[removed_cnt++] = purged_job_hist[inx].job_id;
+	}
+
+	_pack_job_info_trailer(1, removed_job_id, removed_cnt, buffer,
+			       protocol_version);
+	xfree(removed_job_id);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9502,6 +10432,7 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 	pack_info.uid              = uid;
 
 	list_for_each(job_ids, _foreach_pack_jobid, &pack_info);
+	_pack_job_info_trailer(0, NULL, 0, buffer, protocol_version);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9595,7 +10526,7 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 			}
 		}
 
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j, job_id);
 		while (job_ptr) {
 			if ((job_ptr->job_id == job_id) && packed_head) {
 				;	/* Already packed */
@@ -9614,6 +10545,7 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 		free_buf(buffer);
 		return ESLURM_INVALID_JOB_ID;
 	}
+	_pack_job_info_trailer(0, NULL, 0, buffer, protocol_version);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9658,6 +10590,7 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 	time_t accrue_time = 0, begin_time = 0, start_time = 0, end_time = 0;
 	uint32_t time_limit;
 	char *nodelist = NULL;
+	bitstr_t *node_bitmap;
 	assoc_mgr_lock_t locks = { .qos = READ_LOCK };
 
 	if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
@@ -9819,9 +10752,14 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 
 		packstr(dump_job_ptr->alloc_node, buffer);
 		if (!IS_JOB_COMPLETING(dump_job_ptr))
-			pack_bit_str_hex(dump_job_ptr->node_bitmap, buffer);
+			node_bitmap = dump_job_ptr->node_bitmap;
 		else
-			pack_bit_str_hex(dump_job_ptr->node_bitmap_cg, buffer);
+			node_bitmap = dump_job_ptr->node_bitmap_cg;
+		/* Run length encoded, not a full cluster sized hex mask */
+		if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION)
+			pack_bitstr_as_cbitstr(node_bitmap, buffer);
+		else
+			pack_bit_str_hex(node_bitmap, buffer);
 
 		select_g_select_jobinfo_pack(dump_job_ptr->select_jobinfo,
 					     buffer, protocol_version);
@@ -10386,6 +11324,17 @@ static inline bool _purge_complete_pack_job(struct job_record *pack_leader)
 	return true;
 }
 
+/* Mark a pending job as having a dependency that can never be satisfied */
+static void _set_dep_invalid(struct job_record *job_ptr)
+{
+	if (job_ptr->state_reason == WAIT_DEP_INVALID)
+		return;
+	job_ptr->state_reason = WAIT_DEP_INVALID;
+	xfree(job_ptr->state_desc);
+	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
+}
+
 /*
  * purge_old_job - purge old job records.
  *	The jobs must have completed at least MIN_JOB_AGE minutes ago.
@@ -10420,15 +11369,13 @@ void purge_old_job(void)
 			} else if (job_ptr->bit_flags & NO_KILL_INV_DEP) {
 				debug("%s: %pJ job dependency never satisfied",
 				      __func__, job_ptr);
-				job_ptr->state_reason = WAIT_DEP_INVALID;
-				xfree(job_ptr->state_desc);
+				_set_dep_invalid(job_ptr);
 			} else if (kill_invalid_dep) {
 				_kill_dependent(job_ptr);
 			} else {
 				debug("%s: %pJ job dependency never satisfied",
 				      __func__, job_ptr);
-				job_ptr->state_reason = WAIT_DEP_INVALID;
-				xfree(job_ptr->state_desc);
+				_set_dep_invalid(job_ptr);
 			}
 		}
 
@@ -10517,6 +11464,8 @@ void reset_job_bitmaps(void)
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		xassert (job_ptr->magic == JOB_MAGIC);
 		job_fail = false;
+		/* Node indexes may have changed, report every job */
+		JOB_RECORD_CHANGED(job_ptr);
 
 		if (job_ptr->partition == NULL) {
 			error("No partition for %pJ", job_ptr);
@@ -10780,6 +11729,7 @@ extern void set_job_prio(struct job_record *job_ptr)
 		return;
 	job_ptr->priority = slurm_sched_g_initial_priority(lowest_prio,
 							   job_ptr);
+	JOB_RECORD_CHANGED(job_ptr);
 	if ((job_ptr->priority == 0) || (job_ptr->direct_set_prio))
 		return;
 
@@ -10808,8 +11758,10 @@ extern void sync_job_priorities(void)
 
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
-		if ((job_ptr->priority) && (job_ptr->direct_set_prio == 0))
+		if ((job_ptr->priority) && (job_ptr->direct_set_prio == 0)) {
 			job_ptr->priority += prio_boost;
+			JOB_RECORD_CHANGED(job_ptr);
+		}
 	}
 	list_iterator_destroy(job_iterator);
 	lowest_prio += prio_boost;
@@ -10912,10 +11864,14 @@ static bool _top_priority(struct job_record *job_ptr, uint32_t pack_job_offset)
 			    && job_ptr->state_reason != WAIT_MAX_REQUEUE) {
 				job_ptr->state_reason = WAIT_HELD;
 				xfree(job_ptr->state_desc);
+				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 		} else if (job_ptr->state_reason == WAIT_NO_REASON) {
 			job_ptr->state_reason = WAIT_PRIORITY;
 			xfree(job_ptr->state_desc);
+			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 	}
 	return top;
@@ -10964,6 +11920,7 @@ static void _hold_job_rec(struct job_record *job_ptr, uid_t uid)
 			job_ptr->priority_array[i] = 0;
 		}
 	}
+	JOB_RECORD_CHANGED(job_ptr);
 	sched_info("%s: hold on %pJ by uid %u", __func__, job_ptr, uid);
 }
 static void _hold_job(struct job_record *job_ptr, uid_t uid)
@@ -11149,6 +12106,7 @@ static int _update_job(struct job_record *job_ptr, job_desc_msg_t * job_specs,
 		    (job_specs->burst_buffer[0] == '\0')) {
 			xfree(job_ptr->burst_buffer);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		} else {
 			error_code = ESLURM_NOT_SUPPORTED;
 		}
@@ -11224,6 +12182,7 @@ static int _update_job(struct job_record *job_ptr, job_desc_msg_t * job_specs,
 	if (detail_ptr)
 		mc_ptr = detail_ptr->mc_ptr;
 	last_job_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/*
 	 * Check to see if the new requested job_specs exceeds any
@@ -13245,7 +14204,7 @@ extern int update_job_str(slurm_msg_t *msg, uid_t uid)
 		}
 
 		/* Update all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			info("%s: invalid JobId=%u", __func__, job_id);
 			rc = ESLURM_INVALID_JOB_ID;
@@ -13551,6 +14510,7 @@ extern void job_post_resize_acctg(struct job_record *job_ptr)
 	 */
 	if (job_ptr->step_list && (list_count(job_ptr->step_list) > 0))
 		job_ptr->bit_flags |= JOB_RESIZED;
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 static char *_build_step_id(char *buf, int buf_len, uint32_t step_id)
@@ -13996,6 +14956,7 @@ extern int job_alloc_info_ptr(uint32_t uid, struct job_record *job_ptr)
 	    (prolog == 0) && job_ptr->node_bitmap &&
 	    (bit_overlap(power_node_bitmap, job_ptr->node_bitmap) == 0)) {
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 		set_job_alias_list(job_ptr);
 	}
 
@@ -14147,7 +15108,7 @@ static void _validate_job_files(List batch_dirs)
 		}
 		if (job_ptr && job_ptr->array_recs) { /* Update all tasks */
 			array_job_id = job_ptr->array_job_id;
-			job_ptr = job_array_hash_j[JOB_HASH_INX(array_job_id)];
+			job_ptr = xhash_get_int(job_array_hash_j, array_job_id);
 			while (job_ptr) {
 				if (job_ptr->array_job_id == array_job_id)
 					job_ptr->bit_flags |= HAS_STATE_DIR;
@@ -14397,6 +15358,8 @@ void batch_requeue_fini(struct job_record  *job_ptr)
 		return;
 
 	info("Requeuing %pJ", job_ptr);
+	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/* Clear everything so this appears to be a new job and then restart
 	 * it in accounting. */
@@ -14471,13 +15434,24 @@ void batch_requeue_fini(struct job_record  *job_ptr)
 /* job_fini - free all memory associated with job records */
 void job_fini (void)
 {
+	int i;
+
 	FREE_NULL_LIST(job_list);
-	xfree(job_hash);
-	xfree(job_array_hash_j);
-	xfree(job_array_hash_t);
+	xhash_free(job_hash);
+	xhash_free(job_array_hash_j);
+	xhash_free(job_array_hash_t);
 	FREE_NULL_LIST(purge_files_list);
 	FREE_NULL_BITMAP(requeue_exit);
 	FREE_NULL_BITMAP(requeue_exit_hold);
+	if (purged_job_hist) {
+		for (i = 0; i < PURGED_JOB_HIST_SIZE; i++) {
+			xfree(purged_job_hist[i].account);
+			xfree(purged_job_hist[i].mcs_label);
+		}
+	}
+	xfree(purged_job_hist);
+	xfree(job_info_time_hist);
+	xfree(journal_dirty_ids);
 }
 
 /* Record the start of one job array task */
@@ -14509,7 +15483,11 @@ extern bool job_array_start_test(struct job_record *job_ptr)
 			    (job_ptr->details->begin_time <= now))
 				job_ptr->details->begin_time = (time_t) 0;
 			xfree(job_ptr->state_desc);
-			job_ptr->state_reason = WAIT_ARRAY_TASK_LIMIT;
+			if (job_ptr->state_reason != WAIT_ARRAY_TASK_LIMIT) {
+				job_ptr->state_reason = WAIT_ARRAY_TASK_LIMIT;
+				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
+			}
 			return false;
 		}
 	}
@@ -14569,6 +15547,7 @@ extern void job_completion_logger(struct job_record *job_ptr, bool requeue)
 
 	xassert(job_ptr);
 
+	JOB_RECORD_CHANGED(job_ptr);
 	acct_policy_remove_job_submit(job_ptr);
 	if (job_ptr->nodes && ((job_ptr->bit_flags & JOB_KILL_HURRY) == 0)
 	    && !IS_JOB_RESIZING(job_ptr)) {
@@ -14708,7 +15687,7 @@ extern void job_completion_logger(struct job_record *job_ptr, bool requeue)
  * IN job_ptr - pointer to job being tested
  * RET - true if job no longer must be deferred for another job
  */
-extern bool job_independent(struct job_record *job_ptr, int will_run)
+static bool _job_independent(struct job_record *job_ptr, int will_run)
 {
 	struct job_details *detail_ptr = job_ptr->details;
 	time_t now = time(NULL);
@@ -14783,6 +15762,21 @@ extern bool job_independent(struct job_record *job_ptr, int will_run)
 	return true;
 }
 
+extern bool job_independent(struct job_record *job_ptr, int will_run)
+{
+	uint32_t orig_reason = job_ptr->state_reason;
+	time_t orig_begin = job_ptr->details ? job_ptr->details->begin_time : 0;
+	bool rc;
+
+	rc = _job_independent(job_ptr, will_run);
+	if ((job_ptr->state_reason != orig_reason) ||
+	    (job_ptr->details && (job_ptr->details->begin_time != orig_begin))) {
+		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
+	}
+	return rc;
+}
+
 /*
  * determine if job is ready to execute per the node select plugin
  * IN job_id - job to test
@@ -14820,6 +15814,7 @@ extern int job_node_ready(uint32_t job_id, int *ready)
 	    job_ptr->node_bitmap &&
 	    (bit_overlap(power_node_bitmap, job_ptr->node_bitmap) == 0)) {
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 		set_job_alias_list(job_ptr);
 	}
 
@@ -15073,6 +16068,7 @@ static int _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		}
 	}
 	last_job_update = last_node_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 	return rc;
 }
 
@@ -15127,6 +16123,7 @@ static int _resume_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		node_ptr->node_state = NODE_STATE_ALLOCATED | node_flags;
 	}
 	last_job_update = last_node_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 	return rc;
 }
 
@@ -15261,6 +16258,7 @@ static int _job_suspend_op(struct job_record *job_ptr, uint16_t op,
 
 	job_ptr->time_last_active = now;
 	job_ptr->suspend_time = now;
+	JOB_RECORD_CHANGED(job_ptr);
 	jobacct_storage_g_job_suspend(acct_db_conn, job_ptr);
 
 	return rc;
@@ -15446,7 +16444,7 @@ extern int job_suspend2(suspend_msg_t *sus_ptr, uid_t uid,
 		}
 
 		/* Suspend all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			rc = ESLURM_INVALID_JOB_ID;
 			goto reply;
@@ -15602,6 +16600,7 @@ static int _job_requeue_op(uid_t uid, struct job_record *job_ptr, bool preempt,
 	}
 
 	last_job_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/*
 	 * In the job is in the process of completing
@@ -15902,7 +16901,7 @@ extern int job_requeue2(uid_t uid, requeue_msg_t *req_ptr, slurm_msg_t *msg,
 		}
 
 		/* Requeue all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = xhash_get_int(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			rc = ESLURM_INVALID_JOB_ID;
 			goto reply;
@@ -16021,6 +17020,7 @@ static int _set_top(List top_job_list, uid_t uid)
 	int64_t delta_prio, delta_nice, total_delta = 0;
 	int other_job_cnt = 0;
 	uint32_t *prio_elem;
+	time_t now = time(NULL);
 
 	xassert(job_list);
 	xassert(top_job_list);
@@ -16125,6 +17125,7 @@ static int _set_top(List top_job_list, uid_t uid)
 		job_ptr->priority = next_prio;
 		job_ptr->details->nice -= delta_nice;
 		job_ptr->bit_flags &= (~TOP_PRIO_TMP);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 	list_iterator_destroy(iter);
 	FREE_NULL_LIST(prio_list);
@@ -16143,6 +17144,7 @@ static int _set_top(List top_job_list, uid_t uid)
 			job_ptr->priority = next_prio;
 			job_ptr->details->nice += delta_nice;
 			job_ptr->bit_flags &= (~TOP_PRIO_TMP);
+			JOB_RECORD_CHANGED(job_ptr);
 			total_delta -= delta_nice;
 			if (--other_job_cnt == 0)
 				break;	/* Count will match list size anyway */
@@ -16151,7 +17153,7 @@ static int _set_top(List top_job_list, uid_t uid)
 	}
 	FREE_NULL_LIST(other_job_list);
 
-	last_job_update = time(NULL);
+	last_job_update = now;
 
 	return rc;
 }
@@ -16301,6 +17303,7 @@ extern void update_job_nodes_completing(void)
 			job_ptr->nodes_completing =
 				bitmap2node_name(job_ptr->node_bitmap);
 		}
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 	list_iterator_destroy(job_iterator);
 }
@@ -16328,6 +17331,8 @@ extern int job_hold_by_assoc_id(uint32_t assoc_id)
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		if (job_ptr->assoc_id != assoc_id)
 			continue;
+		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 
 		/* move up to the parent that should still exist */
 		if (job_ptr->assoc_ptr) {
@@ -16388,6 +17393,8 @@ extern int job_hold_by_qos_id(uint32_t qos_id)
 			job_ptr->qos_blocking_ptr = NULL;
 		if (job_ptr->qos_id != qos_id)
 			continue;
+		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 
 		/* move up to the parent that should still exist */
 		if (job_ptr->qos_ptr) {
@@ -16475,6 +17482,7 @@ extern int update_job_wckey(char *module, struct job_record *job_ptr,
 	}
 
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -16509,9 +17517,12 @@ extern int send_jobs_to_accounting(void)
 				     job_ptr);
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = FAIL_ACCOUNT;
+				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 				continue;
 			} else
 				job_ptr->assoc_id = assoc_rec.id;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 
 		/* we only want active, un accounted for jobs */
@@ -16600,6 +17611,7 @@ extern int job_checkpoint(checkpoint_msg_t *ckpt_ptr, uid_t uid,
 		info("checkpoint_op %u of JobId=%u.%u complete, rc=%d",
 		     ckpt_ptr->op, ckpt_ptr->job_id, ckpt_ptr->step_id, rc);
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	} else {		/* operate on all of a job's steps */
 		int update_rc = -2;
 		ListIterator step_iterator;
@@ -16632,8 +17644,10 @@ extern int job_checkpoint(checkpoint_msg_t *ckpt_ptr, uid_t uid,
 			rc = MAX(rc, update_rc);
 			xfree(image_dir);
 		}
-		if (update_rc != -2)	/* some work done */
+		if (update_rc != -2) {	/* some work done */
 			last_job_update = time(NULL);
+			JOB_RECORD_CHANGED(job_ptr);
+		}
 		list_iterator_destroy (step_iterator);
 	}
 
@@ -17043,6 +18057,7 @@ extern int job_restart(checkpoint_msg_t *ckpt_ptr, uid_t uid, int conn_fd,
 		image_dir = NULL;	/* Nothing left to xfree */
 
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
  unpack_error:
@@ -17119,6 +18134,7 @@ extern void build_cg_bitmap(struct job_record *job_ptr)
 		job_ptr->node_bitmap_cg = bit_alloc(node_record_count);
 		job_ptr->job_state &= (~JOB_COMPLETING);
 	}
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 /* job_hold_requeue()
@@ -17192,6 +18208,7 @@ extern bool job_hold_requeue(struct job_record *job_ptr)
 	}
 
 	job_ptr->job_state &= ~JOB_REQUEUE;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/*
 	 * Mark array as requeued. Exit codes have already been handled in
@@ -17330,6 +18347,7 @@ extern void job_end_time_reset(struct job_record *job_ptr)
 				    (job_ptr->time_limit * 60);	/* secs */
 	}
 	job_ptr->end_time_exp = job_ptr->end_time;
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 /* trace_job() - print the job details if
@@ -17361,6 +18379,8 @@ extern void job_array_pre_sched(struct job_record *job_ptr)
 		return;
 	}
 
+	if (job_ptr->array_task_id != i)
+		JOB_RECORD_CHANGED(job_ptr);
 	job_ptr->array_job_id  = job_ptr->job_id;
 	job_ptr->array_task_id = i;
 }
@@ -17386,6 +18406,7 @@ extern struct job_record *job_array_post_sched(struct job_record *job_ptr)
 		xfree(job_ptr->array_recs->task_id_str);
 		if (job_ptr->array_recs->task_cnt == 0)
 			FREE_NULL_BITMAP(job_ptr->array_recs->task_id_bitmap);
+		JOB_RECORD_CHANGED(job_ptr);
 
 		/* While it is efficient to set the db_index to 0 here
 		 * to get the database to update the record for
@@ -17438,6 +18459,7 @@ _kill_dependent(struct job_record *job_ptr)
 	job_ptr->end_time = now;
 	job_completion_logger(job_ptr, false);
 	last_job_update = now;
+	JOB_RECORD_CHANGED(job_ptr);
 	srun_allocate_abort(job_ptr);
 }
 
@@ -17548,6 +18570,9 @@ extern void update_job_fed_details(struct job_record *job_ptr)
 		job_ptr->fed_details->origin_str =
 			fed_mgr_get_cluster_name(
 				fed_mgr_get_cluster_id(job_ptr->job_id));
+
+	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 
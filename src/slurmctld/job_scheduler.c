@@ -54,6 +54,7 @@
 #  include <sys/prctl.h>
 #endif
 
+#include "src/common/arena.h"
 #include "src/common/assoc_mgr.h"
 #include "src/common/env.h"
 #include "src/common/gres.h"
@@ -115,7 +116,8 @@ static char **	_build_env(struct job_record *job_ptr, bool is_epilog);
 static batch_job_launch_msg_t *_build_launch_job_msg(struct job_record *job_ptr,
 						     uint16_t protocol_version);
 static void	_depend_list_del(void *dep_ptr);
-static void	_job_queue_append(List job_queue, struct job_record *job_ptr,
+static void	_job_queue_append(List job_queue, arena_t *arena,
+				  struct job_record *job_ptr,
 				  struct part_record *part_ptr, uint32_t priority);
 static void	_job_queue_rec_del(void *x);
 static bool	_job_runnable_test1(struct job_record *job_ptr,
@@ -213,7 +215,7 @@ static List _build_user_job_list(uint32_t user_id, char* job_name)
 	ListIterator job_iterator;
 	struct job_record *job_ptr = NULL;
 
-	job_queue = list_create(NULL);
+	job_queue = list_create_unlocked(NULL);
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		xassert (job_ptr->magic == JOB_MAGIC);
@@ -229,12 +231,13 @@ static List _build_user_job_list(uint32_t user_id, char* job_name)
 	return job_queue;
 }
 
-static void _job_queue_append(List job_queue, struct job_record *job_ptr,
+static void _job_queue_append(List job_queue, arena_t *arena,
+			      struct job_record *job_ptr,
 			      struct part_record *part_ptr, uint32_t prio)
 {
 	job_queue_rec_t *job_queue_rec;
 
-	job_queue_rec = xmalloc(sizeof(job_queue_rec_t));
+	job_queue_rec = arena_alloc(arena, sizeof(job_queue_rec_t), false);
 	job_queue_rec->array_task_id = job_ptr->array_task_id;
 	job_queue_rec->job_id   = job_ptr->job_id;
 	job_queue_rec->job_ptr  = job_ptr;
@@ -309,6 +312,7 @@ static bool _job_runnable_test1(struct job_record *job_ptr, bool sched_plugin)
 		job_ptr->state_reason = WAIT_NO_REASON;
 		xfree(job_ptr->state_desc);
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 #endif
 
@@ -325,6 +329,7 @@ static bool _job_runnable_test1(struct job_record *job_ptr, bool sched_plugin)
 			job_ptr->state_reason = WAIT_HELD;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 		sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u.",
 			     job_ptr,
@@ -364,6 +369,8 @@ static bool _job_runnable_test2(struct job_record *job_ptr, bool check_min_time)
 	     (!part_policy_job_runnable_state(job_ptr)))) {
 		job_ptr->state_reason = reason;
 		xfree(job_ptr->state_desc);
+		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 	if (reason != WAIT_NO_REASON)
 		return false;
@@ -401,6 +408,7 @@ extern List build_job_queue(bool clear_start, bool backfill)
 {
 	static time_t last_log_time = 0;
 	List job_queue;
+	arena_t *arena;
 	ListIterator depend_iter, job_iterator, part_iterator;
 	struct job_record *job_ptr = NULL, *new_job_ptr;
 	struct part_record *part_ptr;
@@ -413,7 +421,12 @@ extern List build_job_queue(bool clear_start, bool backfill)
 
 	/* init the timer */
 	(void) slurm_delta_tv(&start_tv);
-	job_queue = list_create(_job_queue_rec_del);
+	job_queue = list_create_unlocked(_job_queue_rec_del);
+	/*
+	 * Each job:partition pair gets a record, and they are all freed
+	 * together at the end of the scheduling pass
+	 */
+	arena = arena_create(0);
 
 	/* Create individual job records for job arrays that need burst buffer
 	 * staging */
@@ -526,6 +539,10 @@ extern List build_job_queue(bool clear_start, bool backfill)
 		tested_jobs++;
 		job_ptr->preempt_in_progress = false;	/* initialize */
 		if (job_ptr->state_reason != WAIT_NO_REASON) {
+			/* Most pending jobs keep their reason between passes,
+			 * only report the ones which changed */
+			if (job_ptr->state_reason_prev != job_ptr->state_reason)
+				JOB_RECORD_CHANGED(job_ptr);
 			job_ptr->state_reason_prev = job_ptr->state_reason;
 			if ((job_ptr->state_reason != WAIT_PRIORITY) &&
 			    (job_ptr->state_reason != WAIT_RESOURCES))
@@ -541,6 +558,7 @@ extern List build_job_queue(bool clear_start, bool backfill)
 				job_ptr->state_reason_prev_db =
 					job_ptr->state_reason;
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 		if (!_job_runnable_test1(job_ptr, clear_start))
 			continue;
@@ -558,6 +576,7 @@ extern List build_job_queue(bool clear_start, bool backfill)
 					job_ptr->state_reason = reason;
 					xfree(job_ptr->state_desc);
 					last_job_update = now;
+					JOB_RECORD_CHANGED(job_ptr);
 				}
 				/* priority_array index matches part_ptr_list
 				 * position: increment inx */
@@ -566,13 +585,13 @@ extern List build_job_queue(bool clear_start, bool backfill)
 					continue;
 				job_part_pairs++;
 				if (job_ptr->priority_array) {
-					_job_queue_append(job_queue, job_ptr,
-							  part_ptr,
+					_job_queue_append(job_queue, arena,
+							  job_ptr, part_ptr,
 							  job_ptr->
 							  priority_array[inx]);
 				} else {
-					_job_queue_append(job_queue, job_ptr,
-							  part_ptr,
+					_job_queue_append(job_queue, arena,
+							  job_ptr, part_ptr,
 							  job_ptr->priority);
 				}
 			}
@@ -592,11 +611,13 @@ extern List build_job_queue(bool clear_start, bool backfill)
 			if (!_job_runnable_test2(job_ptr, backfill))
 				continue;
 			job_part_pairs++;
-			_job_queue_append(job_queue, job_ptr,
+			_job_queue_append(job_queue, arena, job_ptr,
 					  job_ptr->part_ptr, job_ptr->priority);
 		}
 	}
 	list_iterator_destroy(job_iterator);
+	/* The records keep the arena until they are all freed */
+	arena_destroy(arena);
 
 	return job_queue;
 }
@@ -890,6 +911,7 @@ extern bool deadline_ok(struct job_record *job_ptr, char *func)
 	}
 	if (fail_job) {
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		job_ptr->job_state = JOB_DEADLINE;
 		job_ptr->exit_code = 1;
 		job_ptr->state_reason = FAIL_DEADLINE;
@@ -907,6 +929,7 @@ static int _schedule(uint32_t job_limit)
 {
 	ListIterator job_iterator = NULL, part_iterator = NULL;
 	List job_queue = NULL;
+	job_queue_heap_t job_heap = { NULL, 0 };
 	int failed_part_cnt = 0, failed_resv_cnt = 0, job_cnt = 0;
 	int error_code, i, j, part_cnt, time_limit, pend_time;
 	uint32_t job_depth = 0, array_task_id;
@@ -1207,8 +1230,8 @@ static int _schedule(uint32_t job_limit)
 
 			part_iterator = list_iterator_create(part_list);
 			while ((part_ptr = list_next(part_iterator))) {
-				if (bit_overlap(eff_cg_bitmap,
-						part_ptr->node_bitmap)) {
+				if (bit_overlap_any(eff_cg_bitmap,
+						    part_ptr->node_bitmap)) {
 					failed_parts[failed_part_cnt++] =
 						part_ptr;
 					bit_and_not(avail_node_bitmap,
@@ -1263,7 +1286,13 @@ static int _schedule(uint32_t job_limit)
 	} else {
 		job_queue = build_job_queue(false, false);
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_queue);
-		sort_job_queue(job_queue);
+		/*
+		 * Typically only the first default_queue_depth records are
+		 * tested, so order the records as they are used rather than
+		 * sorting the whole queue
+		 */
+		job_queue_heap_build(job_queue, &job_heap);
+		FREE_NULL_LIST(job_queue);
 	}
 	while (1) {
 		if (fifo_sched) {
@@ -1282,6 +1311,7 @@ static int _schedule(uint32_t job_limit)
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 				continue;
 			}
 			if (!_job_runnable_test1(job_ptr, false))
@@ -1310,7 +1340,7 @@ next_part:			part_ptr = (struct part_record *)
 					continue;
 			}
 		} else {
-			job_queue_rec = list_pop(job_queue);
+			job_queue_rec = job_queue_heap_pop(&job_heap);
 			if (!job_queue_rec)
 				break;
 			array_task_id = job_queue_rec->array_task_id;
@@ -1322,6 +1352,7 @@ next_part:			part_ptr = (struct part_record *)
 				job_ptr->state_reason = WAIT_FRONT_END;
 				xfree(job_ptr->state_desc);
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 				continue;
 			}
 			if ((job_ptr->array_task_id != array_task_id) &&
@@ -1443,6 +1474,7 @@ next_task:
 			job_ptr->state_reason = WAIT_PRIORITY;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			sched_debug("%pJ. State=PENDING. Reason=Priority, Priority=%u. Partition=%s.",
 				    job_ptr, job_ptr->priority,
 				    job_ptr->partition);
@@ -1466,6 +1498,7 @@ next_task:
 				xfree(job_ptr->state_desc);
 				job_ptr->assoc_id = assoc_rec.id;
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				sched_debug("%pJ has invalid association",
 					    job_ptr);
@@ -1490,12 +1523,14 @@ next_task:
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = FAIL_QOS;
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 				assoc_mgr_unlock(&locks);
 				continue;
 			} else if (job_ptr->state_reason == FAIL_QOS) {
 				xfree(job_ptr->state_desc);
 				job_ptr->state_reason = WAIT_NO_REASON;
 				last_job_update = now;
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 			assoc_mgr_unlock(&locks);
 		}
@@ -1555,6 +1590,7 @@ next_task:
 					"DOWN, DRAINED or reserved for jobs in "
 					"higher priority partitions");
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u. Partition=%s.",
 				     job_ptr,
 				     job_state_string(job_ptr->job_state),
@@ -1567,6 +1603,7 @@ next_task:
 			job_ptr->state_reason = WAIT_LICENSES;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u.",
 				     job_ptr,
 				     job_state_string(job_ptr->job_state),
@@ -1584,6 +1621,7 @@ next_task:
 			 * very rare. */
 			sched_info("%pJ has invalid account", job_ptr);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			job_ptr->state_reason = FAIL_ACCOUNT;
 			xfree(job_ptr->state_desc);
 			continue;
@@ -1669,6 +1707,7 @@ skip_start:
 			job_ptr->state_reason = WAIT_FED_JOB_LOCK;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u. Partition=%s.",
 				     job_ptr,
 				     job_state_string(job_ptr->job_state),
@@ -1679,6 +1718,7 @@ skip_start:
 			/* job initiated */
 			sched_debug3("%pJ initiated", job_ptr);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			reject_array_job_id = 0;
 			reject_array_part   = NULL;
 
@@ -1727,6 +1767,7 @@ skip_start:
 			sched_info("schedule: %pJ non-runnable: %s",
 				   job_ptr, slurm_strerror(error_code));
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			job_ptr->job_state = JOB_PENDING;
 			job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
 			xfree(job_ptr->state_desc);
@@ -1813,8 +1854,8 @@ fail_this_part:	if (fail_by_part) {
 			list_iterator_destroy(job_iterator);
 		if (part_iterator)
 			list_iterator_destroy(part_iterator);
-	} else if (job_queue) {
-		FREE_NULL_LIST(job_queue);
+	} else {
+		job_queue_heap_free(&job_heap);
 	}
 	xfree(sched_part_ptr);
 	xfree(sched_part_jobs);
@@ -1847,6 +1888,62 @@ extern void sort_job_queue(List job_queue)
 	list_sort(job_queue, sort_job_queue2);
 }
 
+static void _job_queue_heap_down(job_queue_heap_t *heap, int inx)
+{
+	job_queue_rec_t *tmp_rec;
+	int child;
+
+	while ((child = (inx * 2) + 1) < heap->cnt) {
+		if (((child + 1) < heap->cnt) &&
+		    (sort_job_queue2(&heap->rec[child + 1],
+				     &heap->rec[child]) < 0))
+			child++;
+		if (sort_job_queue2(&heap->rec[child], &heap->rec[inx]) >= 0)
+			break;
+		tmp_rec = heap->rec[inx];
+		heap->rec[inx] = heap->rec[child];
+		heap->rec[child] = tmp_rec;
+		inx = child;
+	}
+}
+
+extern void job_queue_heap_build(List job_queue, job_queue_heap_t *heap)
+{
+	job_queue_rec_t *job_queue_rec;
+	int i;
+
+	heap->cnt = 0;
+	heap->rec = xmalloc(sizeof(job_queue_rec_t *) *
+			    (list_count(job_queue) + 1));
+	while ((job_queue_rec = list_pop(job_queue)))
+		heap->rec[heap->cnt++] = job_queue_rec;
+	for (i = (heap->cnt / 2) - 1; i >= 0; i--)
+		_job_queue_heap_down(heap, i);
+}
+
+extern job_queue_rec_t *job_queue_heap_pop(job_queue_heap_t *heap)
+{
+	job_queue_rec_t *job_queue_rec;
+
+	if (heap->cnt == 0)
+		return NULL;
+	job_queue_rec = heap->rec[0];
+	heap->rec[0] = heap->rec[--heap->cnt];
+	_job_queue_heap_down(heap, 0);
+
+	return job_queue_rec;
+}
+
+extern void job_queue_heap_free(job_queue_heap_t *heap)
+{
+	int i;
+
+	for (i = 0; i < heap->cnt; i++)
+		xfree(heap->rec[i]);
+	xfree(heap->rec);
+	heap->cnt = 0;
+}
+
 /* Note this differs from the ListCmpF typedef since we want jobs sorted
  * in order of decreasing priority then submit time and the by increasing
  * job id */
@@ -1889,20 +1986,13 @@ extern int sort_job_queue2(void *x, void *y)
 			return -1;
 	}
 
-	if (job_rec1->job_ptr->part_ptr_list &&
-	    job_rec1->job_ptr->priority_array)
-		p1 = job_rec1->priority;
-	else
-		p1 = job_rec1->job_ptr->priority;
-
-
-	if (job_rec2->job_ptr->part_ptr_list &&
-	    job_rec2->job_ptr->priority_array)
-		p2 = job_rec2->priority;
-	else
-		p2 = job_rec2->job_ptr->priority;
-
-
+	/*
+	 * Use the priority recorded when the queue was built, not the job's
+	 * current priority: schedule() may change the latter while the job's
+	 * records for other partitions remain in the heap.
+	 */
+	p1 = job_rec1->priority;
+	p2 = job_rec2->priority;
 	if (p1 < p2)
 		return 1;
 	if (p1 > p2)
@@ -2771,6 +2861,7 @@ extern int test_job_dependency(struct job_record *job_ptr)
 				   (djob_ptr->end_time > now)) {
 				job_ptr->time_limit = djob_ptr->end_time - now;
 				job_ptr->time_limit /= 60;  /* sec to min */
+				JOB_RECORD_CHANGED(job_ptr);
 			}
 			if (job_ptr->details && djob_ptr->details) {
 				job_ptr->details->share_res =
@@ -4121,6 +4212,7 @@ extern void prolog_slurmctld(struct job_record *job_ptr)
 	if (job_ptr->details) {
 		job_ptr->details->prolog_running++;
 		job_ptr->job_state |= JOB_CONFIGURING;
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
 	slurm_thread_create_detached(NULL, _run_prolog, job_ptr);
@@ -4675,6 +4767,7 @@ extern void rebuild_job_part_list(struct job_record *job_ptr)
 		xstrcat(job_ptr->partition, part_ptr->name);
 	}
 	list_iterator_destroy(part_iterator);
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 /* cleanup_completing()
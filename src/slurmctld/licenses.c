@@ -612,6 +612,7 @@ extern void license_job_merge(struct job_record *job_ptr)
 	job_ptr->license_list = _build_license_list(job_ptr->licenses, &valid);
 	xfree(job_ptr->licenses);
 	job_ptr->licenses = license_list_to_string(job_ptr->license_list);
+	JOB_RECORD_CHANGED(job_ptr);
 }
 
 /*
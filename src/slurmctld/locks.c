@@ -39,17 +39,74 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stddef.h>
 #include <string.h>
 #include <sys/types.h>
+#include <time.h>
 
+#include "src/common/pack.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/stat_shard.h"
+
+/*
+ * Lock statistics are kept for every lock datatype in read and write mode,
+ * indexed by (datatype * 2 + is_write_lock). Hold times are also counted in
+ * LOCK_HIST_SIZE histogram buckets, bucket N counting hold times of less
+ * than 10^(N+1) microseconds and the last bucket counting all longer holds.
+ *
+ * Each thread records its lock_slurmctld() and unlock_slurmctld() calls in
+ * its own shard of lock_shards, see stat_shard.h, merged into lock_stats under
+ * lock_stat_mutex.
+ *
+ * Nothing is timed or recorded unless enabled with
+ * SlurmctldParameters=lock_stats, see lock_stats_enable().
+ */
+#define LOCK_STAT_CNT	(ENTITY_COUNT * 2)
+#define LOCK_HIST_SIZE	7
+
+typedef struct {
+	stat_shard_t header;		/* only used for shards */
+	uint64_t acquire_cnt[LOCK_STAT_CNT];
+	uint64_t wait_time[LOCK_STAT_CNT];
+	uint64_t wait_max[LOCK_STAT_CNT];
+	uint64_t hold_time[LOCK_STAT_CNT];
+	uint64_t hold_max[LOCK_STAT_CNT];
+	uint64_t hold_hist[LOCK_STAT_CNT * LOCK_HIST_SIZE];
+} lock_stat_t;
 
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static pthread_rwlock_t slurmctld_locks[ENTITY_COUNT]
 	= { PTHREAD_RWLOCK_INITIALIZER };
 
+static pthread_mutex_t lock_stat_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char *lock_stat_name[LOCK_STAT_CNT] = {
+	"Config read", "Config write", "Job read", "Job write",
+	"Node read", "Node write", "Partition read", "Partition write",
+	"Federation read", "Federation write" };
+static lock_stat_t lock_stats;		/* Merged shards */
+static void _lock_shard_merge(stat_shard_t *x);
+static stat_shard_set_t lock_shards =
+	STAT_SHARD_SET_INITIALIZER(lock_stat_t, _lock_shard_merge);
+
+static bool lock_stats_enabled = false;
+
+/* Time at which the calling thread acquired each of its locks */
+static __thread struct timespec lock_start[ENTITY_COUNT];
+/* Set if the calling thread's locks were timed by lock_slurmctld() */
+static __thread bool lock_timed = false;
+
+/* Copy the lock levels into an array indexed by lock_datatype_t */
+static void _lock_levels(slurmctld_lock_t *lock_levels, lock_level_t *levels)
+{
+	levels[CONF_LOCK] = lock_levels->conf;
+	levels[JOB_LOCK]  = lock_levels->job;
+	levels[NODE_LOCK] = lock_levels->node;
+	levels[PART_LOCK] = lock_levels->part;
+	levels[FED_LOCK]  = lock_levels->fed;
+}
+
 #ifndef NDEBUG
 /*
  * Used to protect against double-locking within a single thread. Calling
@@ -99,61 +156,191 @@ static bool _clear_locks(slurmctld_lock_t lock_levels)
 
 extern bool verify_lock(lock_datatype_t datatype, lock_level_t level)
 {
-	return (((lock_level_t *) &thread_locks)[datatype] >= level);
+	lock_level_t levels[ENTITY_COUNT];
+
+	_lock_levels(&thread_locks, levels);
+	return (levels[datatype] >= level);
 }
 #endif
 
-/* lock_slurmctld - Issue the required lock requests in a well defined order */
-extern void lock_slurmctld(slurmctld_lock_t lock_levels)
+static uint64_t _delta_usec(struct timespec *start, struct timespec *end)
 {
-	xassert(_store_locks(lock_levels));
+	int64_t usec;
+
+	usec = (end->tv_sec - start->tv_sec) * 1000000;
+	usec += (end->tv_nsec - start->tv_nsec) / 1000;
+	if (usec < 0)
+		return 0;
+	return (uint64_t) usec;
+}
+
+static int _hist_bucket(uint64_t usec)
+{
+	uint64_t limit = 10;
+	int i;
+
+	for (i = 0; i < (LOCK_HIST_SIZE - 1); i++, limit *= 10) {
+		if (usec < limit)
+			break;
+	}
+	return i;
+}
+
+/*
+ * Move a shard's statistics into lock_stats
+ * NOTE: Caller must hold shard->mutex
+ */
+static void _lock_shard_merge(stat_shard_t *x)
+{
+	lock_stat_t *shard = (lock_stat_t *) x;
+	int i;
+
+	slurm_mutex_lock(&lock_stat_mutex);
+	for (i = 0; i < LOCK_STAT_CNT; i++) {
+		lock_stats.acquire_cnt[i] += shard->acquire_cnt[i];
+		lock_stats.wait_time[i] += shard->wait_time[i];
+		lock_stats.wait_max[i] = MAX(lock_stats.wait_max[i],
+					     shard->wait_max[i]);
+		lock_stats.hold_time[i] += shard->hold_time[i];
+		lock_stats.hold_max[i] = MAX(lock_stats.hold_max[i],
+					     shard->hold_max[i]);
+	}
+	for (i = 0; i < (LOCK_STAT_CNT * LOCK_HIST_SIZE); i++)
+		lock_stats.hold_hist[i] += shard->hold_hist[i];
+	slurm_mutex_unlock(&lock_stat_mutex);
+
+	memset(shard->acquire_cnt, 0,
+	       sizeof(lock_stat_t) - offsetof(lock_stat_t, acquire_cnt));
+}
 
-	if (lock_levels.conf == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[CONF_LOCK]);
-	else if (lock_levels.conf == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[CONF_LOCK]);
+/*
+ * Add the wait (acquire) or hold (release) times of one lock_slurmctld() or
+ * unlock_slurmctld() call to the calling thread's shard
+ */
+static void _lock_stat_add(lock_level_t *levels, uint64_t *usec, bool hold)
+{
+	lock_stat_t *shard = stat_shard_lock(&lock_shards);
+	int i, inx;
+
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		if (levels[i] == NO_LOCK)
+			continue;
+		inx = (i * 2) + ((levels[i] == WRITE_LOCK) ? 1 : 0);
+		if (hold) {
+			shard->hold_time[inx] += usec[i];
+			if (usec[i] > shard->hold_max[inx])
+				shard->hold_max[inx] = usec[i];
+			shard->hold_hist[(inx * LOCK_HIST_SIZE) +
+					 _hist_bucket(usec[i])]++;
+		} else {
+			shard->acquire_cnt[inx]++;
+			shard->wait_time[inx] += usec[i];
+			if (usec[i] > shard->wait_max[inx])
+				shard->wait_max[inx] = usec[i];
+		}
+	}
+	stat_shard_unlock(shard);
+}
 
-	if (lock_levels.job == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[JOB_LOCK]);
-	else if (lock_levels.job == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[JOB_LOCK]);
+/*
+ * lock_slurmctld - Issue the required lock requests in a well defined order
+ * NOTE: The locks are acquired in lock_datatype_t order.
+ */
+extern void lock_slurmctld(slurmctld_lock_t lock_levels)
+{
+	lock_level_t levels[ENTITY_COUNT];
+	uint64_t wait_usec[ENTITY_COUNT];
+	struct timespec begin;
+	int i;
+
+	xassert(_store_locks(lock_levels));
 
-	if (lock_levels.node == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[NODE_LOCK]);
-	else if (lock_levels.node == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[NODE_LOCK]);
+	_lock_levels(&lock_levels, levels);
 
-	if (lock_levels.part == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[PART_LOCK]);
-	else if (lock_levels.part == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[PART_LOCK]);
+	lock_timed = lock_stats_enabled;
+	if (lock_timed)
+		clock_gettime(CLOCK_MONOTONIC, &begin);
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		if (levels[i] == READ_LOCK)
+			slurm_rwlock_rdlock(&slurmctld_locks[i]);
+		else if (levels[i] == WRITE_LOCK)
+			slurm_rwlock_wrlock(&slurmctld_locks[i]);
+		else
+			continue;
+		if (!lock_timed)
+			continue;
+		clock_gettime(CLOCK_MONOTONIC, &lock_start[i]);
+		wait_usec[i] = _delta_usec(&begin, &lock_start[i]);
+		begin = lock_start[i];
+	}
 
-	if (lock_levels.fed == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[FED_LOCK]);
-	else if (lock_levels.fed == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[FED_LOCK]);
+	if (lock_timed)
+		_lock_stat_add(levels, wait_usec, false);
 }
 
 /* unlock_slurmctld - Issue the required unlock requests in a well
  *	defined order */
 extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
 {
+	lock_level_t levels[ENTITY_COUNT];
+	uint64_t hold_usec[ENTITY_COUNT];
+	struct timespec end;
+	int i;
+
 	xassert(_clear_locks(lock_levels));
 
-	if (lock_levels.fed)
-		slurm_rwlock_unlock(&slurmctld_locks[FED_LOCK]);
+	_lock_levels(&lock_levels, levels);
+
+	if (lock_timed)
+		clock_gettime(CLOCK_MONOTONIC, &end);
+	for (i = (ENTITY_COUNT - 1); i >= 0; i--) {
+		if (levels[i] == NO_LOCK)
+			continue;
+		slurm_rwlock_unlock(&slurmctld_locks[i]);
+		if (lock_timed)
+			hold_usec[i] = _delta_usec(&lock_start[i], &end);
+	}
+
+	if (lock_timed)
+		_lock_stat_add(levels, hold_usec, true);
+}
 
-	if (lock_levels.part)
-		slurm_rwlock_unlock(&slurmctld_locks[PART_LOCK]);
+/* lock_stats_enable - start or stop recording lock statistics */
+extern void lock_stats_enable(bool enable)
+{
+	lock_stats_enabled = enable;
+}
 
-	if (lock_levels.node)
-		slurm_rwlock_unlock(&slurmctld_locks[NODE_LOCK]);
+/*
+ * pack_lock_stats - pack lock wait and hold time statistics into a buffer,
+ *	empty arrays if they are not being recorded
+ */
+extern void pack_lock_stats(Buf buffer)
+{
+	uint32_t cnt = lock_stats_enabled ? LOCK_STAT_CNT : 0;
+
+	stat_shard_merge_all(&lock_shards);
+
+	slurm_mutex_lock(&lock_stat_mutex);
+	packstr_array(lock_stat_name, cnt, buffer);
+	pack64_array(lock_stats.acquire_cnt, cnt, buffer);
+	pack64_array(lock_stats.wait_time, cnt, buffer);
+	pack64_array(lock_stats.wait_max, cnt, buffer);
+	pack64_array(lock_stats.hold_time, cnt, buffer);
+	pack64_array(lock_stats.hold_max, cnt, buffer);
+	pack32(LOCK_HIST_SIZE, buffer);
+	pack64_array(lock_stats.hold_hist, cnt * LOCK_HIST_SIZE, buffer);
+	slurm_mutex_unlock(&lock_stat_mutex);
+}
 
-	if (lock_levels.job)
-		slurm_rwlock_unlock(&slurmctld_locks[JOB_LOCK]);
+/* reset_lock_stats - clear lock wait and hold time statistics */
+extern void reset_lock_stats(void)
+{
+	stat_shard_merge_all(&lock_shards);
 
-	if (lock_levels.conf)
-		slurm_rwlock_unlock(&slurmctld_locks[CONF_LOCK]);
+	slurm_mutex_lock(&lock_stat_mutex);
+	memset(&lock_stats, 0, sizeof(lock_stats));
+	slurm_mutex_unlock(&lock_stat_mutex);
 }
 
 /*
@@ -93,6 +93,8 @@
 
 #include <stdbool.h>
 
+#include "src/common/pack.h"
+
 /* levels of locking required for each data structure */
 typedef enum {
 	NO_LOCK,
@@ -135,6 +137,22 @@ extern void unlock_slurmctld (slurmctld_lock_t lock_levels);
 
 extern int report_locks_set(void);
 
+/*
+ * pack_lock_stats - pack lock wait and hold time statistics into a buffer,
+ *	empty arrays if they are not being recorded
+ */
+extern void pack_lock_stats(Buf buffer);
+
+/* reset_lock_stats - clear lock wait and hold time statistics */
+extern void reset_lock_stats(void);
+
+/*
+ * lock_stats_enable - start or stop recording lock statistics
+ *	(SlurmctldParameters=lock_stats). Locks taken while disabled are not
+ *	timed.
+ */
+extern void lock_stats_enable(bool enable);
+
 /* un/lock semaphore used for saving state of slurmctld */
 extern void lock_state_files ( void );
 extern void unlock_state_files ( void );
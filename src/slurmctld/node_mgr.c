@@ -3017,6 +3017,7 @@ extern int validate_nodes_via_front_end(
 			error("Resetting NULL batch_host of JobId=%u to %s",
 			      reg_msg->job_id[i], front_end_ptr->name);
 			job_ptr->batch_host = xstrdup(front_end_ptr->name);
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 
 
@@ -3842,6 +3843,7 @@ void make_node_idle(struct node_record *node_ptr,
 	if (node_bitmap && (bit_test(node_bitmap, inx))) {
 		/* Not a replay */
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		bit_clear(node_bitmap, inx);
 
 		job_update_tres_cnt(job_ptr, inx);
@@ -478,6 +478,7 @@ extern void deallocate_nodes(struct job_record *job_ptr, bool timeout,
 	xassert(job_ptr->details);
 
 	trace_job(job_ptr, __func__, "");
+	JOB_RECORD_CHANGED(job_ptr);
 
 	acct_policy_job_fini(job_ptr);
 	if (select_g_job_fini(job_ptr) != SLURM_SUCCESS)
@@ -1234,8 +1235,8 @@ _get_req_features(struct node_set *node_set_ptr, int node_set_size,
 			 * purge it
 			 */
 			for (i = 0; i < node_set_size; i++) {
-				if (!bit_overlap(node_set_ptr[i].my_bitmap,
-						 work_bitmap))
+				if (!bit_overlap_any(node_set_ptr[i].my_bitmap,
+						     work_bitmap))
 					continue;
 				tmp_node_set_ptr[tmp_node_set_size].
 					cpus_per_node =
@@ -2264,12 +2265,12 @@ _pick_best_nodes(struct node_set *node_set_ptr, int node_set_size,
 					   share_node_bitmap)) {
 				error_code = ESLURM_NODES_BUSY;
 			}
-			if (bit_overlap(job_ptr->details->req_node_bitmap,
-					cg_node_bitmap)) {
+			if (bit_overlap_any(job_ptr->details->req_node_bitmap,
+					    cg_node_bitmap)) {
 				error_code = ESLURM_NODES_BUSY;
 			}
-			if (bit_overlap(job_ptr->details->req_node_bitmap,
-					rs_node_bitmap)) {
+			if (bit_overlap_any(job_ptr->details->req_node_bitmap,
+					    rs_node_bitmap)) {
 				error_code = ESLURM_NODES_BUSY;
 			}
 		} else if (!bit_super_set(job_ptr->details->req_node_bitmap,
@@ -2415,6 +2416,7 @@ static void _end_null_job(struct job_record *job_ptr)
 	gres_plugin_job_clear(job_ptr->gres_list);
 	job_ptr->job_state = JOB_RUNNING;
 	job_ptr->bit_flags |= JOB_WAS_RUNNING;
+	JOB_RECORD_CHANGED(job_ptr);
 	FREE_NULL_BITMAP(job_ptr->node_bitmap);
 	xfree(job_ptr->nodes);
 	xfree(job_ptr->sched_nodes);
@@ -2488,7 +2490,7 @@ static char *_build_tres_str(struct job_record *job_ptr)
 }
 
 /*
- * select_nodes - select and allocate nodes to a specific job
+ * _select_nodes - select and allocate nodes to a specific job
  * IN job_ptr - pointer to the job record
  * IN test_only - if set do not allocate nodes, just confirm they
  *	could be allocated now
@@ -2511,9 +2513,9 @@ static char *_build_tres_str(struct job_record *job_ptr)
  *	   the request, (e.g. best-fit or other criterion)
  *	3) Call allocate_nodes() to perform the actual allocation
  */
-extern int select_nodes(struct job_record *job_ptr, bool test_only,
-			bitstr_t **select_node_bitmap, char **err_msg,
-			bool submission, uint32_t scheduler_type)
+static int _select_nodes(struct job_record *job_ptr, bool test_only,
+			 bitstr_t **select_node_bitmap, char **err_msg,
+			 bool submission, uint32_t scheduler_type)
 {
 	int bb, error_code = SLURM_SUCCESS, i, node_set_size = 0;
 	bitstr_t *select_bitmap = NULL;
@@ -2591,6 +2593,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			return ESLURM_BURST_BUFFER_WAIT; /* Fatal BB event */
 		xfree(job_ptr->state_desc);
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		if (bb == 0)
 			job_ptr->state_reason = WAIT_BURST_BUFFER_STAGING;
 		else
@@ -2739,6 +2742,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			job_ptr->state_reason = WAIT_PART_NODE_LIMIT;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 
 		/* Non-fatal errors for job below */
 		} else if (error_code == ESLURM_NODE_NOT_AVAIL) {
@@ -2777,6 +2781,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			}
 			xfree(unavail_node);
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 		} else if (error_code == ESLURM_RESERVATION_MAINT) {
 			error_code = ESLURM_RESERVATION_BUSY;	/* All reserved */
 			job_ptr->state_reason = WAIT_NODE_NOT_AVAIL;
@@ -2858,6 +2863,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		job_ptr->priority = 0;
 		job_ptr->state_reason = WAIT_HELD;
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		goto cleanup;
 	}
 	if (select_g_job_begin(job_ptr) != SLURM_SUCCESS) {
@@ -2873,6 +2879,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		job_ptr->end_time = 0;
 		job_ptr->state_reason = WAIT_RESOURCES;
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		goto cleanup;
 	}
 
@@ -2896,6 +2903,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 		job_ptr->end_time = 0;
 		job_ptr->state_reason = WAIT_RESOURCES;
 		last_job_update = now;
+		JOB_RECORD_CHANGED(job_ptr);
 		goto cleanup;
 	}
 
@@ -2907,6 +2915,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 
 	job_ptr->job_state = JOB_RUNNING;
 	job_ptr->bit_flags |= JOB_WAS_RUNNING;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	if (select_g_select_nodeinfo_set(job_ptr) != SLURM_SUCCESS) {
 		error("select_g_select_nodeinfo_set(%pJ): %m", job_ptr);
@@ -2924,6 +2933,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			job_ptr->state_reason = WAIT_RESOURCES;
 			job_ptr->job_state = JOB_PENDING;
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			goto cleanup;
 		}
 	}
@@ -3018,6 +3028,29 @@ cleanup:
 	return error_code;
 }
 
+/*
+ * select_nodes - select and allocate nodes to a specific job, see
+ *	_select_nodes() for details. Notes a change to the job record if the
+ *	attempt changed its reason or priority.
+ */
+extern int select_nodes(struct job_record *job_ptr, bool test_only,
+			bitstr_t **select_node_bitmap, char **err_msg,
+			bool submission, uint32_t scheduler_type)
+{
+	uint32_t orig_reason = job_ptr->state_reason;
+	uint32_t orig_prio = job_ptr->priority;
+	int rc;
+
+	rc = _select_nodes(job_ptr, test_only, select_node_bitmap, err_msg,
+			   submission, scheduler_type);
+	if ((job_ptr->state_reason != orig_reason) ||
+	    (job_ptr->priority != orig_prio)) {
+		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
+	}
+	return rc;
+}
+
 /*
  * get_node_cnts - determine the number of nodes for the requested job.
  * IN job_ptr - pointer to the job record.
@@ -3083,7 +3116,11 @@ extern int get_node_cnts(struct job_record *job_ptr,
 	if (acct_max_nodes < *min_nodes) {
 		error_code = ESLURM_ACCOUNTING_POLICY;
 		xfree(job_ptr->state_desc);
-		job_ptr->state_reason = wait_reason;
+		if (job_ptr->state_reason != wait_reason) {
+			job_ptr->state_reason = wait_reason;
+			last_job_update = time(NULL);
+			JOB_RECORD_CHANGED(job_ptr);
+		}
 		goto end_it;
 	} else if (*max_nodes < *min_nodes) {
 		error_code = ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE;
@@ -3122,8 +3159,10 @@ extern void launch_prolog(struct job_record *job_ptr)
 
 	/* Locks: Write job */
 	if ((slurmctld_conf.prolog_flags & PROLOG_FLAG_ALLOC) &&
-	    !(slurmctld_conf.prolog_flags & PROLOG_FLAG_NOHOLD))
+	    !(slurmctld_conf.prolog_flags & PROLOG_FLAG_NOHOLD)) {
 		job_ptr->state_reason = WAIT_PROLOG;
+		JOB_RECORD_CHANGED(job_ptr);
+	}
 
 	prolog_msg_ptr->job_id = job_ptr->job_id;
 	prolog_msg_ptr->pack_job_id = job_ptr->pack_job_id;
@@ -3781,8 +3820,8 @@ static int _build_node_list(struct job_record *job_ptr,
 			}
 			/* No nodes in set require reboot */
 			if (node_maps[REBOOT] &&
-			    !bit_overlap(prev_node_set_ptr->my_bitmap,
-					 node_maps[REBOOT]))
+			    !bit_overlap_any(prev_node_set_ptr->my_bitmap,
+					     node_maps[REBOOT]))
 				FREE_NULL_BITMAP(node_maps[REBOOT]);
 		}
 
@@ -4462,8 +4501,8 @@ static bitstr_t *_valid_features(struct job_record *job_ptr,
 		    ((job_feat_ptr->op_code == FEATURE_OP_END)  &&
 		     ((last_op == FEATURE_OP_XAND) ||
 		      (last_op == FEATURE_OP_XOR)))) {
-			if (bit_overlap(config_ptr->node_bitmap,
-					working_node_bitmap)) {
+			if (bit_overlap_any(config_ptr->node_bitmap,
+					    working_node_bitmap)) {
 				bit_set(result_node_bitmap, position);
 				if (can_reboot && reboot_bitmap &&
 				    active_node_bitmap) {
@@ -2262,6 +2262,7 @@ extern int part_policy_valid_acct(struct part_record *part_ptr, char *acct,
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_ACCOUNT;
 				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				xfree(tmp_err);
 			}
@@ -2286,6 +2287,7 @@ extern int part_policy_valid_acct(struct part_record *part_ptr, char *acct,
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_ACCOUNT;
 				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				xfree(tmp_err);
 			}
@@ -2317,6 +2319,7 @@ extern int part_policy_valid_acct(struct part_record *part_ptr, char *acct,
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_ACCOUNT;
 				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				xfree(tmp_err);
 			}
@@ -2353,6 +2356,7 @@ extern int part_policy_valid_qos(struct part_record *part_ptr,
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_QOS;
 				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				xfree(tmp_err);
 			}
@@ -2372,6 +2376,7 @@ extern int part_policy_valid_qos(struct part_record *part_ptr,
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_QOS;
 				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				xfree(tmp_err);
 			}
@@ -2398,6 +2403,7 @@ extern int part_policy_valid_qos(struct part_record *part_ptr,
 				job_ptr->state_desc = tmp_err;
 				job_ptr->state_reason = WAIT_QOS;
 				last_job_update = time(NULL);
+				JOB_RECORD_CHANGED(job_ptr);
 			} else {
 				xfree(tmp_err);
 			}
@@ -509,6 +509,7 @@ extern int power_job_reboot(struct job_record *job_ptr)
 		if (bit_overlap(power_node_bitmap, job_ptr->node_bitmap)) {
 			job_ptr->job_state |= JOB_CONFIGURING;
 			job_ptr->bit_flags |= NODE_REBOOT;
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 		return SLURM_SUCCESS;
 	}
@@ -564,6 +565,7 @@ extern int power_job_reboot(struct job_record *job_ptr)
 			job_ptr->job_state |= JOB_CONFIGURING;
 			job_ptr->wait_all_nodes = 1;
 			job_ptr->bit_flags |= NODE_REBOOT;
+			JOB_RECORD_CHANGED(job_ptr);
 			pid = _run_prog(resume_prog, nodes, reboot_features,
 					job_ptr->job_id);
 			info("%s: pid %d reboot nodes %s features %s",
@@ -582,6 +584,7 @@ extern int power_job_reboot(struct job_record *job_ptr)
 			job_ptr->job_state |= JOB_CONFIGURING;
 			job_ptr->wait_all_nodes = 1;
 			job_ptr->bit_flags |= NODE_REBOOT;
+			JOB_RECORD_CHANGED(job_ptr);
 			pid = _run_prog(resume_prog, nodes, NULL,
 					job_ptr->job_id);
 			info("%s: pid %d reboot nodes %s",
@@ -80,6 +80,7 @@
 #include "src/common/slurm_topology.h"
 #include "src/common/switch.h"
 #include "src/common/uid.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 #include "src/common/xcgroup_read_config.h"
 
@@ -101,23 +102,76 @@
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmctld_plugstack.h"
 #include "src/slurmctld/srun_comm.h"
+#include "src/slurmctld/stat_shard.h"
 #include "src/slurmctld/state_save.h"
 #include "src/slurmctld/trigger_mgr.h"
 
+/*
+ * RPC statistics by message type and by user. Each thread servicing RPCs
+ * records them in its own shard of rpc_shards, see stat_shard.h, merged into
+ * rpc_type_stats and rpc_user_stats under rpc_mutex. A shard is also merged
+ * when it runs out of entries.
+ */
+#define RPC_HIST_SIZE	64	/* Latency buckets, see _rpc_hist_bucket() */
+#define RPC_SHARD_SIZE	32	/* Message types or users per shard */
+
+typedef struct {
+	uint32_t id;			/* Message type or user ID */
+	uint32_t cnt;
+	uint64_t time;			/* Total time in usec */
+	uint64_t time_max;
+	uint32_t hist[RPC_HIST_SIZE];
+	char key[12];			/* id as a string, for xhash */
+} rpc_stat_t;
+
+typedef struct {
+	stat_shard_t header;
+	int type_cnt;
+	rpc_stat_t type[RPC_SHARD_SIZE];
+	int user_cnt;
+	rpc_stat_t user[RPC_SHARD_SIZE];
+} rpc_stat_shard_t;
+
 static pthread_mutex_t rpc_mutex = PTHREAD_MUTEX_INITIALIZER;
-static int rpc_type_size = 0;	/* Size of rpc_type_* arrays */
-static uint16_t *rpc_type_id = NULL;
-static uint32_t *rpc_type_cnt = NULL;
-static uint64_t *rpc_type_time = NULL;
-static int rpc_user_size = 0;	/* Size of rpc_user_* arrays */
-static uint32_t *rpc_user_id = NULL;
-static uint32_t *rpc_user_cnt = NULL;
-static uint64_t *rpc_user_time = NULL;
+static xhash_t *rpc_type_stats = NULL;	/* Merged rpc_stat_t by type */
+static xhash_t *rpc_user_stats = NULL;	/* Merged rpc_stat_t by user */
+static void _rpc_shard_merge(stat_shard_t *x);
+static stat_shard_set_t rpc_shards =
+	STAT_SHARD_SET_INITIALIZER(rpc_stat_shard_t, _rpc_shard_merge);
 
 static pthread_mutex_t throttle_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t throttle_cond = PTHREAD_COND_INITIALIZER;
 
+/* Job and epilog completion RPCs processed together, see _comp_batch() */
+#define COMP_BATCH_MAX_DEFAULT 64
+typedef struct {
+	slurm_msg_t *msg;
+	bool detached;	/* msg and its connection are owned by the batch */
+	bool done;
+	bool reply;	/* send rc once the batch is done */
+	int rc;
+} comp_batch_rec_t;
+
+static pthread_mutex_t comp_batch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t comp_batch_cond = PTHREAD_COND_INITIALIZER;
+static bool comp_batch_defer = false;
+static bool comp_batch_leader = false;
+static List comp_batch_list = NULL;
+static int  comp_batch_max = COMP_BATCH_MAX_DEFAULT;
+static int  comp_batch_window = 0;	/* msec, zero to disable */
+
+static bool         _comp_batch(slurm_msg_t *msg, connection_arg_t *arg);
+static void         _comp_batch_detach(slurm_msg_t *msg,
+				       connection_arg_t *arg);
+static void         _comp_batch_config(void);
+static void         _comp_batch_reply(slurm_msg_t *msg,
+				      comp_batch_rec_t *batch_rec, int rc);
+static void         _comp_msg_stats(composite_msg_t *comp_msg,
+				    uint64_t now_usec, uint32_t depth,
+				    uint32_t *msg_cnt, uint32_t *depth_max);
 static void         _fill_ctld_conf(slurm_ctl_conf_t * build_ptr);
+static void         _rpc_stat_add(uint16_t msg_type, uint32_t uid,
+				  uint64_t usec);
 static void         _kill_job_on_msg_fail(uint32_t job_id);
 static int          _is_prolog_finished(uint32_t job_id);
 static int          _make_step_cred(struct step_record *step_rec,
@@ -143,8 +197,9 @@ inline static void  _slurm_rpc_control_status(slurm_msg_t * msg);
 inline static void  _slurm_rpc_delete_partition(slurm_msg_t * msg);
 inline static void  _slurm_rpc_complete_job_allocation(slurm_msg_t * msg);
 inline static void  _slurm_rpc_complete_batch_script(slurm_msg_t * msg,
-						     bool *run_scheduler,
-						     bool running_composite);
+					bool *run_scheduler,
+					bool running_composite,
+					comp_batch_rec_t *batch_rec);
 inline static void  _slurm_rpc_complete_prolog(slurm_msg_t * msg);
 inline static void  _slurm_rpc_dump_batch_script(slurm_msg_t *msg);
 inline static void  _slurm_rpc_dump_conf(slurm_msg_t * msg);
@@ -252,7 +307,7 @@ static __thread bool drop_priv = false;
 void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 {
 	DEF_TIMERS;
-	int i, rpc_type_index = -1, rpc_user_index = -1;
+	int i;
 	uint32_t rpc_uid;
 
 	if (arg && (arg->newsockfd >= 0))
@@ -271,36 +326,6 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 		      g_slurm_auth_errstr(g_slurm_auth_errno(msg->auth_cred)));
 		return;
 	}
-	slurm_mutex_lock(&rpc_mutex);
-	if (rpc_type_size == 0) {
-		rpc_type_size = 100;  /* Capture info for first 100 RPC types */
-		rpc_type_id   = xmalloc(sizeof(uint16_t) * rpc_type_size);
-		rpc_type_cnt  = xmalloc(sizeof(uint32_t) * rpc_type_size);
-		rpc_type_time = xmalloc(sizeof(uint64_t) * rpc_type_size);
-	}
-	for (i = 0; i < rpc_type_size; i++) {
-		if (rpc_type_id[i] == 0)
-			rpc_type_id[i] = msg->msg_type;
-		else if (rpc_type_id[i] != msg->msg_type)
-			continue;
-		rpc_type_index = i;
-		break;
-	}
-	if (rpc_user_size == 0) {
-		rpc_user_size = 200;  /* Capture info for first 200 RPC users */
-		rpc_user_id   = xmalloc(sizeof(uint32_t) * rpc_user_size);
-		rpc_user_cnt  = xmalloc(sizeof(uint32_t) * rpc_user_size);
-		rpc_user_time = xmalloc(sizeof(uint64_t) * rpc_user_size);
-	}
-	for (i = 0; i < rpc_user_size; i++) {
-		if ((rpc_user_id[i] == 0) && (i != 0))
-			rpc_user_id[i] = rpc_uid;
-		else if (rpc_user_id[i] != rpc_uid)
-			continue;
-		rpc_user_index = i;
-		break;
-	}
-	slurm_mutex_unlock(&rpc_mutex);
 
 	/* Debug the protocol layer.
 	 */
@@ -370,6 +395,8 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 		_slurm_rpc_dump_partitions(msg);
 		break;
 	case MESSAGE_EPILOG_COMPLETE:
+		if (_comp_batch(msg, arg))
+			break;
 		i = 0;
 		_slurm_rpc_epilog_complete(msg, (bool *)&i, 0);
 		break;
@@ -384,8 +411,10 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 		break;
 	case REQUEST_COMPLETE_BATCH_JOB:
 	case REQUEST_COMPLETE_BATCH_SCRIPT:
+		if (_comp_batch(msg, arg))
+			break;
 		i = 0;
-		_slurm_rpc_complete_batch_script(msg, (bool *)&i, 0);
+		_slurm_rpc_complete_batch_script(msg, (bool *)&i, 0, NULL);
 		break;
 	case REQUEST_JOB_STEP_CREATE:
 		_slurm_rpc_job_step_create(msg);
@@ -601,16 +630,145 @@ void slurmctld_req(slurm_msg_t *msg, connection_arg_t *arg)
 	}
 
 	END_TIMER;
-	slurm_mutex_lock(&rpc_mutex);
-	if (rpc_type_index >= 0) {
-		rpc_type_cnt[rpc_type_index]++;
-		rpc_type_time[rpc_type_index] += DELTA_TIMER;
+	_rpc_stat_add(msg->msg_type, rpc_uid, DELTA_TIMER);
+}
+
+/*
+ * Histogram bucket for an RPC run time, two buckets per power of two:
+ * bucket 2n holds [2^n, 1.5*2^n) usec and bucket 2n+1 [1.5*2^n, 2^(n+1))
+ */
+static int _rpc_hist_bucket(uint64_t usec)
+{
+	int msb = 0;
+
+	if (usec < 2)
+		return (int) usec;
+	while (usec >> (msb + 1))
+		msb++;
+	return MIN((2 * msb) + (int) ((usec >> (msb - 1)) & 1),
+		   RPC_HIST_SIZE - 1);
+}
+
+/* Smallest run time in usec that falls into histogram bucket "inx" */
+static uint64_t _rpc_hist_floor(int inx)
+{
+	if (inx < 2)
+		return (uint64_t) inx;
+	return (uint64_t) (2 | (inx & 1)) << ((inx / 2) - 1);
+}
+
+/* Run time in usec below which "pct" percent of the RPCs completed */
+static uint64_t _rpc_stat_pct(rpc_stat_t *stat, int pct)
+{
+	uint64_t want, sum = 0;
+	int i;
+
+	if (!stat->cnt)
+		return 0;
+	want = (((uint64_t) stat->cnt * pct) + 99) / 100;
+	for (i = 0; i < RPC_HIST_SIZE - 1; i++) {
+		sum += stat->hist[i];
+		if (sum >= want)
+			return MIN(_rpc_hist_floor(i + 1), stat->time_max);
 	}
-	if (rpc_user_index >= 0) {
-		rpc_user_cnt[rpc_user_index]++;
-		rpc_user_time[rpc_user_index] += DELTA_TIMER;
+	return stat->time_max;
+}
+
+static const char *_rpc_stat_key(void *x)
+{
+	return ((rpc_stat_t *) x)->key;
+}
+
+static void _rpc_stat_free(void *x)
+{
+	xfree(x);
+}
+
+/* Find or add the record for "id" in a shard, NULL if the shard is full */
+static rpc_stat_t *_rpc_shard_stat(rpc_stat_t *stats, int *cnt, uint32_t id)
+{
+	int i;
+
+	for (i = 0; i < *cnt; i++) {
+		if (stats[i].id == id)
+			return &stats[i];
 	}
+	if (*cnt >= RPC_SHARD_SIZE)
+		return NULL;
+	memset(&stats[i], 0, sizeof(rpc_stat_t));
+	stats[i].id = id;
+	(*cnt)++;
+	return &stats[i];
+}
+
+static void _rpc_stat_merge(xhash_t *table, rpc_stat_t *stats, int cnt)
+{
+	rpc_stat_t *stat;
+	char key[12];
+	int i, j;
+
+	for (i = 0; i < cnt; i++) {
+		snprintf(key, sizeof(key), "%u", stats[i].id);
+		if (!(stat = xhash_get(table, key))) {
+			stat = xmalloc(sizeof(rpc_stat_t));
+			stat->id = stats[i].id;
+			strlcpy(stat->key, key, sizeof(stat->key));
+			xhash_add(table, stat);
+		}
+		stat->cnt += stats[i].cnt;
+		stat->time += stats[i].time;
+		stat->time_max = MAX(stat->time_max, stats[i].time_max);
+		for (j = 0; j < RPC_HIST_SIZE; j++)
+			stat->hist[j] += stats[i].hist[j];
+	}
+}
+
+/*
+ * Move a shard's statistics into rpc_type_stats and rpc_user_stats
+ * NOTE: Caller must hold shard->mutex
+ */
+static void _rpc_shard_merge(stat_shard_t *x)
+{
+	rpc_stat_shard_t *shard = (rpc_stat_shard_t *) x;
+
+	slurm_mutex_lock(&rpc_mutex);
+	if (!rpc_type_stats) {
+		rpc_type_stats = xhash_init(_rpc_stat_key, _rpc_stat_free);
+		rpc_user_stats = xhash_init(_rpc_stat_key, _rpc_stat_free);
+	}
+	_rpc_stat_merge(rpc_type_stats, shard->type, shard->type_cnt);
+	_rpc_stat_merge(rpc_user_stats, shard->user, shard->user_cnt);
 	slurm_mutex_unlock(&rpc_mutex);
+	shard->type_cnt = 0;
+	shard->user_cnt = 0;
+}
+
+/* Record an RPC's run time in the calling thread's shard */
+static void _rpc_stat_add(uint16_t msg_type, uint32_t uid, uint64_t usec)
+{
+	rpc_stat_shard_t *shard = stat_shard_lock(&rpc_shards);
+	rpc_stat_t *type_stat, *user_stat;
+	int inx;
+
+	type_stat = _rpc_shard_stat(shard->type, &shard->type_cnt, msg_type);
+	user_stat = _rpc_shard_stat(shard->user, &shard->user_cnt, uid);
+	if (!type_stat || !user_stat) {
+		_rpc_shard_merge(&shard->header);
+		type_stat = _rpc_shard_stat(shard->type, &shard->type_cnt,
+					    msg_type);
+		user_stat = _rpc_shard_stat(shard->user, &shard->user_cnt,
+					    uid);
+	}
+	inx = _rpc_hist_bucket(usec);
+	type_stat->cnt++;
+	type_stat->time += usec;
+	type_stat->time_max = MAX(type_stat->time_max, usec);
+	type_stat->hist[inx]++;
+	user_stat->cnt++;
+	user_stat->time += usec;
+	user_stat->time_max = MAX(user_stat->time_max, usec);
+	user_stat->hist[inx]++;
+	stat_shard_unlock(shard);
 }
 
 /* These functions prevent certain RPCs from keeping the slurmctld write locks
@@ -652,6 +810,218 @@ static void _throttle_fini(int *active_rpc_cnt)
 	slurm_mutex_unlock(&throttle_mutex);
 }
 
+/* Update the completion batching configuration from SchedulerParameters */
+static void _comp_batch_config(void)
+{
+	static time_t config_update = 0;
+	char *sched_params, *tmp_ptr;
+
+	if (config_update == slurmctld_conf.last_update)
+		return;
+
+	sched_params = slurm_get_sched_params();
+	comp_batch_window = 0;
+	if (sched_params &&
+	    (tmp_ptr = xstrcasestr(sched_params, "comp_batch_window="))) {
+		comp_batch_window = atoi(tmp_ptr + 18);
+		if (comp_batch_window < 0) {
+			error("Invalid SchedulerParameters comp_batch_window: %d",
+			      comp_batch_window);
+			comp_batch_window = 0;
+		}
+	}
+	comp_batch_max = COMP_BATCH_MAX_DEFAULT;
+	if (sched_params &&
+	    (tmp_ptr = xstrcasestr(sched_params, "comp_batch_max="))) {
+		comp_batch_max = atoi(tmp_ptr + 15);
+		if (comp_batch_max < 1) {
+			error("Invalid SchedulerParameters comp_batch_max: %d",
+			      comp_batch_max);
+			comp_batch_max = COMP_BATCH_MAX_DEFAULT;
+		}
+	}
+	comp_batch_defer = (sched_params && xstrcasestr(sched_params, "defer"));
+	xfree(sched_params);
+	config_update = slurmctld_conf.last_update;
+}
+
+/*
+ * Queue a follower RPC with the batch leader, taking over the message and
+ * its connection so the caller's RPC worker is free for other RPCs. The
+ * leader replies, closes the connection and frees the message.
+ * NOTE: comp_batch_mutex must be locked by the caller
+ */
+static void _comp_batch_detach(slurm_msg_t *msg, connection_arg_t *arg)
+{
+	comp_batch_rec_t *rec_ptr = xmalloc(sizeof(comp_batch_rec_t));
+
+	rec_ptr->msg = xmalloc(sizeof(slurm_msg_t));
+	memcpy(rec_ptr->msg, msg, sizeof(slurm_msg_t));
+	rec_ptr->detached = true;
+	msg->auth_cred = NULL;
+	msg->buffer = NULL;
+	msg->data = NULL;
+	msg->ret_list = NULL;
+	arg->newsockfd = -1;
+	/* The connection remains open, see server_thread_count */
+	server_thread_incr();
+	list_append(comp_batch_list, rec_ptr);
+}
+
+/*
+ * Process a MESSAGE_EPILOG_COMPLETE or REQUEST_COMPLETE_BATCH_* RPC as part
+ * of a batch. The first RPC to arrive waits up to comp_batch_window msec or
+ * until comp_batch_max RPCs are queued, then processes all of them while
+ * holding the slurmctld locks once, and sends the replies after the locks
+ * are released. RPCs arriving during the window are handed to this leader
+ * and return at once, except on persistent connections, which wait for the
+ * batch to complete and send their own reply.
+ * RET false if batching is disabled, the caller must process the RPC
+ */
+static bool _comp_batch(slurm_msg_t *msg, connection_arg_t *arg)
+{
+	/* Locks: Read configuration, write job, write node, read federation */
+	/* Must match locks in _slurm_rpc_comp_msg_list */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, READ_LOCK };
+	comp_batch_rec_t rec, *rec_ptr;
+	List batch;
+	ListIterator iter;
+	struct timeval now, end;
+	struct timespec ts;
+	bool run_scheduler = false, batch_script = false;
+	uint32_t batch_size;
+
+	slurm_mutex_lock(&comp_batch_mutex);
+	_comp_batch_config();
+	if (comp_batch_window == 0) {
+		slurm_mutex_unlock(&comp_batch_mutex);
+		return false;
+	}
+
+	if (!comp_batch_list)
+		comp_batch_list = list_create(NULL);
+	if (comp_batch_leader && arg && (arg->newsockfd >= 0) && !msg->conn) {
+		_comp_batch_detach(msg, arg);
+		if (list_count(comp_batch_list) >= comp_batch_max)
+			slurm_cond_broadcast(&comp_batch_cond);
+		slurm_mutex_unlock(&comp_batch_mutex);
+		return true;
+	}
+
+	memset(&rec, 0, sizeof(comp_batch_rec_t));
+	rec.msg = msg;
+	list_append(comp_batch_list, &rec);
+
+	if (comp_batch_leader) {
+		if (list_count(comp_batch_list) >= comp_batch_max)
+			slurm_cond_broadcast(&comp_batch_cond);
+		while (!rec.done)
+			slurm_cond_wait(&comp_batch_cond, &comp_batch_mutex);
+		slurm_mutex_unlock(&comp_batch_mutex);
+		if (rec.reply)
+			slurm_send_rc_msg(msg, rec.rc);
+		return true;
+	}
+
+	/* Collect a batch, RPCs arriving after this start the next one */
+	comp_batch_leader = true;
+	gettimeofday(&end, NULL);
+	end.tv_usec += comp_batch_window * 1000;
+	end.tv_sec  += end.tv_usec / 1000000;
+	end.tv_usec %= 1000000;
+	ts.tv_sec  = end.tv_sec;
+	ts.tv_nsec = end.tv_usec * 1000;
+	while (list_count(comp_batch_list) < comp_batch_max) {
+		gettimeofday(&now, NULL);
+		if (!timercmp(&now, &end, <))
+			break;
+		slurm_cond_timedwait(&comp_batch_cond, &comp_batch_mutex, &ts);
+	}
+	batch = comp_batch_list;
+	comp_batch_list = NULL;
+	comp_batch_leader = false;
+	slurm_mutex_unlock(&comp_batch_mutex);
+
+	batch_size = list_count(batch);
+	lock_slurmctld(job_write_lock);
+	iter = list_iterator_create(batch);
+	while ((rec_ptr = list_next(iter))) {
+		if (rec_ptr->msg->msg_type == MESSAGE_EPILOG_COMPLETE) {
+			_slurm_rpc_epilog_complete(rec_ptr->msg,
+						   &run_scheduler, true);
+		} else {
+			_slurm_rpc_complete_batch_script(rec_ptr->msg,
+							 &run_scheduler, true,
+							 rec_ptr);
+			batch_script = true;
+		}
+	}
+	list_iterator_destroy(iter);
+	slurmctld_diag_stats.comp_batch_cnt++;
+	slurmctld_diag_stats.comp_batch_msgs += batch_size;
+	slurmctld_diag_stats.comp_batch_max = MAX(batch_size,
+		slurmctld_diag_stats.comp_batch_max);
+	unlock_slurmctld(job_write_lock);
+
+	/* synchronize power layouts key/values once for the batch */
+	if (batch_script && (powercap_get_cluster_current_cap() != 0) &&
+	    (which_power_layout() == 2)) {
+		layouts_entity_pull_kv("power", "Cluster", "CurrentSumPower");
+	}
+
+	slurm_mutex_lock(&comp_batch_mutex);
+	iter = list_iterator_create(batch);
+	while ((rec_ptr = list_next(iter))) {
+		if (rec_ptr->detached)
+			continue;
+		rec_ptr->done = true;
+		list_delete_item(iter);
+	}
+	list_iterator_destroy(iter);
+	slurm_cond_broadcast(&comp_batch_cond);
+	slurm_mutex_unlock(&comp_batch_mutex);
+	if (rec.reply)
+		slurm_send_rc_msg(msg, rec.rc);
+
+	/* Only detached records remain */
+	while ((rec_ptr = list_pop(batch))) {
+		if (rec_ptr->reply)
+			slurm_send_rc_msg(rec_ptr->msg, rec_ptr->rc);
+		if (close(rec_ptr->msg->conn_fd) < 0)
+			error("close(%d): %m", rec_ptr->msg->conn_fd);
+		slurm_free_msg(rec_ptr->msg);
+		xfree(rec_ptr);
+		server_thread_decr();
+	}
+	FREE_NULL_LIST(batch);
+
+	/* Functions below provide their own locking */
+	if (run_scheduler) {
+		if (!LOTS_OF_AGENTS && !comp_batch_defer)
+			(void) schedule(0);
+		schedule_node_save();
+		schedule_job_save();
+	}
+
+	return true;
+}
+
+/*
+ * Reply to a REQUEST_COMPLETE_BATCH_* RPC, or when it is part of a batch
+ * (batch_rec set) save the reply for _comp_batch() to send after it has
+ * released the slurmctld locks
+ */
+static void _comp_batch_reply(slurm_msg_t *msg, comp_batch_rec_t *batch_rec,
+			      int rc)
+{
+	if (batch_rec) {
+		batch_rec->rc = rc;
+		batch_rec->reply = true;
+	} else
+		slurm_send_rc_msg(msg, rc);
+}
+
 /*
  * _fill_ctld_conf - make a copy of current slurm configuration
  *	this is done with locks set so the data can change at other times
@@ -1475,6 +1845,7 @@ static void _slurm_rpc_allocate_pack(slurm_msg_t * msg)
 		iter = list_iterator_create(submit_job_list);
 		while ((job_ptr = (struct job_record *) list_next(iter))) {
 			job_ptr->pack_job_id_set = xstrdup(tmp_offset);
+			JOB_RECORD_CHANGED(job_ptr);
 			if (!resp)
 				resp = list_create(_del_alloc_pack_msg);
 			list_append(resp,
@@ -1781,6 +2152,11 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 				       job_info_request_msg->job_ids,
 				       job_info_request_msg->show_flags, uid,
 				       NO_VAL, msg->protocol_version);
+		} else if (job_info_request_msg->show_flags & SHOW_DELTA) {
+			pack_delta_jobs(&dump, &dump_size,
+					job_info_request_msg->last_update,
+					job_info_request_msg->show_flags, uid,
+					msg->protocol_version);
 		} else {
 			pack_all_jobs(&dump, &dump_size,
 				      job_info_request_msg->show_flags, uid,
@@ -2443,10 +2819,13 @@ static void _slurm_rpc_complete_prolog(slurm_msg_t * msg)
 }
 
 /* _slurm_rpc_complete_batch - process RPC from slurmstepd to note the
- *	completion of a batch script */
+ *	completion of a batch script
+ * batch_rec IN - set if processed by _comp_batch(), which then sends the
+ *	reply and synchronizes power layouts after releasing its locks */
 static void _slurm_rpc_complete_batch_script(slurm_msg_t *msg,
 					     bool *run_scheduler,
-					     bool running_composite)
+					     bool running_composite,
+					     comp_batch_rec_t *batch_rec)
 {
 	static int active_rpc_cnt = 0;
 	int error_code = SLURM_SUCCESS, i;
@@ -2498,7 +2877,7 @@ static void _slurm_rpc_complete_batch_script(slurm_msg_t *msg,
 			unlock_slurmctld(job_write_lock);
 			_throttle_fini(&active_rpc_cnt);
 		}
-		slurm_send_rc_msg(msg, error_code);
+		_comp_batch_reply(msg, batch_rec, error_code);
 		return;
 	}
 
@@ -2627,7 +3006,7 @@ static void _slurm_rpc_complete_batch_script(slurm_msg_t *msg,
 	END_TIMER2("_slurm_rpc_complete_batch_script");
 
 	/* synchronize power layouts key/values */
-	if ((powercap_get_cluster_current_cap() != 0) &&
+	if (!batch_rec && (powercap_get_cluster_current_cap() != 0) &&
 	    (which_power_layout() == 2)) {
 		layouts_entity_pull_kv("power", "Cluster", "CurrentSumPower");
 	}
@@ -2637,13 +3016,13 @@ static void _slurm_rpc_complete_batch_script(slurm_msg_t *msg,
 		debug2("_slurm_rpc_complete_batch_script JobId=%u: %s ",
 		       comp_msg->job_id,
 		       slurm_strerror(error_code));
-		slurm_send_rc_msg(msg, error_code);
+		_comp_batch_reply(msg, batch_rec, error_code);
 	} else {
 		debug2("_slurm_rpc_complete_batch_script JobId=%u %s",
 		       comp_msg->job_id, TIME_STR);
 		slurmctld_diag_stats.jobs_completed++;
 		dump_job = true;
-		slurm_send_rc_msg(msg, SLURM_SUCCESS);
+		_comp_batch_reply(msg, batch_rec, SLURM_SUCCESS);
 	}
 
 	/* If running composite lets not call this to avoid deadlock */
@@ -4348,6 +4727,7 @@ static void _slurm_rpc_submit_batch_pack_job(slurm_msg_t *msg)
 		iter = list_iterator_create(submit_job_list);
 		while ((job_ptr = (struct job_record *) list_next(iter))) {
 			job_ptr->pack_job_id_set = xstrdup(tmp_offset);
+			JOB_RECORD_CHANGED(job_ptr);
 			if (slurmctld_conf.debug_flags &
 			    DEBUG_FLAG_HETERO_JOBS) {
 				info("Submit %pJ", job_ptr);
@@ -6210,73 +6590,126 @@ inline static void _slurm_rpc_dump_spank(slurm_msg_t * msg)
 
 static void _clear_rpc_stats(void)
 {
-	int i;
+	stat_shard_merge_all(&rpc_shards);
 
 	slurm_mutex_lock(&rpc_mutex);
-	for (i = 0; i < rpc_type_size; i++) {
-		rpc_type_cnt[i] = 0;
-		rpc_type_id[i] = 0;
-		rpc_type_time[i] = 0;
-	}
-	for (i = 0; i < rpc_user_size; i++) {
-		rpc_user_cnt[i] = 0;
-		rpc_user_id[i] = 0;
-		rpc_user_time[i] = 0;
+	if (rpc_type_stats) {
+		xhash_clear(rpc_type_stats);
+		xhash_clear(rpc_user_stats);
 	}
 	slurm_mutex_unlock(&rpc_mutex);
 }
 
+/* Merged RPC statistics of one kind, flattened for packing */
+typedef struct {
+	uint32_t cnt;
+	uint32_t *id;
+	uint32_t *count;
+	uint64_t *time;
+	uint64_t *time_max;
+	uint64_t *time_p50;
+	uint64_t *time_p99;
+} rpc_stat_arrays_t;
+
+static void _rpc_stat_arrays_add(void *x, void *arg)
+{
+	rpc_stat_t *stat = (rpc_stat_t *) x;
+	rpc_stat_arrays_t *arrays = (rpc_stat_arrays_t *) arg;
+	uint32_t i = arrays->cnt++;
+
+	arrays->id[i] = stat->id;
+	arrays->count[i] = stat->cnt;
+	arrays->time[i] = stat->time;
+	arrays->time_max[i] = stat->time_max;
+	arrays->time_p50[i] = _rpc_stat_pct(stat, 50);
+	arrays->time_p99[i] = _rpc_stat_pct(stat, 99);
+}
+
+/* NOTE: Caller must hold rpc_mutex */
+static void _rpc_stat_arrays_build(xhash_t *table, rpc_stat_arrays_t *arrays)
+{
+	uint32_t size = table ? xhash_count(table) : 0;
+
+	memset(arrays, 0, sizeof(rpc_stat_arrays_t));
+	arrays->id       = xmalloc(sizeof(uint32_t) * (size + 1));
+	arrays->count    = xmalloc(sizeof(uint32_t) * (size + 1));
+	arrays->time     = xmalloc(sizeof(uint64_t) * (size + 1));
+	arrays->time_max = xmalloc(sizeof(uint64_t) * (size + 1));
+	arrays->time_p50 = xmalloc(sizeof(uint64_t) * (size + 1));
+	arrays->time_p99 = xmalloc(sizeof(uint64_t) * (size + 1));
+	if (size)
+		xhash_walk(table, _rpc_stat_arrays_add, arrays);
+}
+
+static void _rpc_stat_arrays_free(rpc_stat_arrays_t *arrays)
+{
+	xfree(arrays->id);
+	xfree(arrays->count);
+	xfree(arrays->time);
+	xfree(arrays->time_max);
+	xfree(arrays->time_p50);
+	xfree(arrays->time_p99);
+}
+
+static void _pack_rpc_stat_arrays(rpc_stat_arrays_t *arrays, bool msg_type,
+				  bool latency, Buf buffer)
+{
+	uint16_t *type_id;
+	uint32_t i;
+
+	pack32(arrays->cnt, buffer);
+	if (msg_type) {
+		type_id = xmalloc(sizeof(uint16_t) * (arrays->cnt + 1));
+		for (i = 0; i < arrays->cnt; i++)
+			type_id[i] = (uint16_t) arrays->id[i];
+		pack16_array(type_id, arrays->cnt, buffer);
+		xfree(type_id);
+	} else
+		pack32_array(arrays->id, arrays->cnt, buffer);
+	pack32_array(arrays->count, arrays->cnt, buffer);
+	pack64_array(arrays->time,  arrays->cnt, buffer);
+	if (latency) {
+		pack64_array(arrays->time_max, arrays->cnt, buffer);
+		pack64_array(arrays->time_p50, arrays->cnt, buffer);
+		pack64_array(arrays->time_p99, arrays->cnt, buffer);
+	}
+}
+
 static void _pack_rpc_stats(int resp, char **buffer_ptr, int *buffer_size,
 			    uint16_t protocol_version)
 {
-	uint32_t i;
+	rpc_stat_arrays_t type_arrays, user_arrays;
 	Buf buffer;
 
+	stat_shard_merge_all(&rpc_shards);
 	slurm_mutex_lock(&rpc_mutex);
+	_rpc_stat_arrays_build(rpc_type_stats, &type_arrays);
+	_rpc_stat_arrays_build(rpc_user_stats, &user_arrays);
+	slurm_mutex_unlock(&rpc_mutex);
+
 	buffer = create_buf(*buffer_ptr, *buffer_size);
 	set_buf_offset(buffer, *buffer_size);
 
-	if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
-		for (i = 0; i < rpc_type_size; i++) {
-			if (rpc_type_id[i] == 0)
-				break;
-		}
-		pack32(i, buffer);
-		pack16_array(rpc_type_id,   i, buffer);
-		pack32_array(rpc_type_cnt,  i, buffer);
-		pack64_array(rpc_type_time, i, buffer);
-
-		for (i = 1; i < rpc_user_size; i++) {
-			if (rpc_user_id[i] == 0)
-				break;
-		}
-		pack32(i, buffer);
-		pack32_array(rpc_user_id,   i, buffer);
-		pack32_array(rpc_user_cnt,  i, buffer);
-		pack64_array(rpc_user_time, i, buffer);
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+		_pack_rpc_stat_arrays(&type_arrays, true, true, buffer);
+		_pack_rpc_stat_arrays(&user_arrays, false, true, buffer);
+
+		agent_pack_pending_rpc_stats(buffer);
+		pack_lock_stats(buffer);
+		pack_rpc_queue_stats(buffer);
+
+	} else if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
+		_pack_rpc_stat_arrays(&type_arrays, true, false, buffer);
+		_pack_rpc_stat_arrays(&user_arrays, false, false, buffer);
 
 		agent_pack_pending_rpc_stats(buffer);
 
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		for (i = 0; i < rpc_type_size; i++) {
-			if (rpc_type_id[i] == 0)
-				break;
-		}
-		pack32(i, buffer);
-		pack16_array(rpc_type_id,   i, buffer);
-		pack32_array(rpc_type_cnt,  i, buffer);
-		pack64_array(rpc_type_time, i, buffer);
-
-		for (i = 1; i < rpc_user_size; i++) {
-			if (rpc_user_id[i] == 0)
-				break;
-		}
-		pack32(i, buffer);
-		pack32_array(rpc_user_id,   i, buffer);
-		pack32_array(rpc_user_cnt,  i, buffer);
-		pack64_array(rpc_user_time, i, buffer);
+		_pack_rpc_stat_arrays(&type_arrays, true, false, buffer);
+		_pack_rpc_stat_arrays(&user_arrays, false, false, buffer);
 	}
-	slurm_mutex_unlock(&rpc_mutex);
+	_rpc_stat_arrays_free(&type_arrays);
+	_rpc_stat_arrays_free(&user_arrays);
 
 	*buffer_size = get_buf_offset(buffer);
 	buffer_ptr[0] = xfer_buf_data(buffer);
@@ -6350,6 +6783,8 @@ inline static void _slurm_rpc_dump_stats(slurm_msg_t * msg)
 	if (request_msg->command_id == STAT_COMMAND_RESET) {
 		reset_stats(1);
 		_clear_rpc_stats();
+		reset_lock_stats();
+		reset_rpc_queue_stats();
 		pack_all_stat(0, &dump, &dump_size, msg->protocol_version);
 		_pack_rpc_stats(0, &dump, &dump_size, msg->protocol_version);
 		response_msg.data = dump;
@@ -6424,15 +6859,8 @@ _slurm_rpc_dump_licenses(slurm_msg_t * msg)
 extern void free_rpc_stats(void)
 {
 	slurm_mutex_lock(&rpc_mutex);
-	xfree(rpc_type_cnt);
-	xfree(rpc_type_id);
-	xfree(rpc_type_time);
-	rpc_type_size = 0;
-
-	xfree(rpc_user_cnt);
-	xfree(rpc_user_id);
-	xfree(rpc_user_time);
-	rpc_user_size = 0;
+	xhash_free(rpc_type_stats);
+	xhash_free(rpc_user_stats);
 	slurm_mutex_unlock(&rpc_mutex);
 }
 
@@ -6564,6 +6992,7 @@ static void  _slurm_rpc_composite_msg(slurm_msg_t *msg)
 	static int active_rpc_cnt = 0;
 	struct timeval start_tv;
 	bool run_scheduler = false;
+	uint32_t msg_cnt, depth_max;
 	composite_msg_t *comp_msg, comp_resp_msg;
 	/* Locks: Read configuration, write job, write node, read federation */
 	/* Must match locks in _slurm_rpc_comp_msg_list */
@@ -6611,6 +7040,16 @@ static void  _slurm_rpc_composite_msg(slurm_msg_t *msg)
 	_throttle_start(&active_rpc_cnt);
 	lock_slurmctld(job_write_lock);
 	gettimeofday(&start_tv, NULL);
+	msg_cnt = 0;
+	depth_max = 0;
+	_comp_msg_stats(comp_msg, (uint64_t) start_tv.tv_sec * 1000000 +
+			start_tv.tv_usec, 1, &msg_cnt, &depth_max);
+	slurmctld_diag_stats.msg_aggr_cnt++;
+	slurmctld_diag_stats.msg_aggr_msgs += msg_cnt;
+	slurmctld_diag_stats.msg_aggr_fanin_max =
+		MAX(msg_cnt, slurmctld_diag_stats.msg_aggr_fanin_max);
+	slurmctld_diag_stats.msg_aggr_depth_max =
+		MAX(depth_max, slurmctld_diag_stats.msg_aggr_depth_max);
 	_slurm_rpc_comp_msg_list(comp_msg, &run_scheduler,
 				 comp_resp_msg.msg_list, &start_tv,
 				 sched_timeout);
@@ -6647,6 +7086,48 @@ static void  _slurm_rpc_composite_msg(slurm_msg_t *msg)
 	}
 }
 
+/*
+ * Gather message aggregation statistics for a composite message and the
+ * composite messages nested in it by downstream collectors. Latency is
+ * measured from the time the innermost collector received each message.
+ * IN now_usec - time the message was received, usec since the epoch
+ * IN depth - nesting level of comp_msg, 1 for the message received
+ * IN/OUT msg_cnt - incremented by the number of messages carried
+ * IN/OUT depth_max - deepest nesting level found
+ * NOTE: Caller must hold the job write lock
+ */
+static void _comp_msg_stats(composite_msg_t *comp_msg, uint64_t now_usec,
+			    uint32_t depth, uint32_t *msg_cnt,
+			    uint32_t *depth_max)
+{
+	ListIterator itr;
+	slurm_msg_t *next_msg;
+	uint64_t latency = 0;
+
+	*depth_max = MAX(depth, *depth_max);
+	if (!comp_msg->msg_list)
+		return;
+
+	/* Zero if sent by an older slurmd, clocks may also be skewed */
+	if (comp_msg->start_usec && (now_usec > comp_msg->start_usec))
+		latency = now_usec - comp_msg->start_usec;
+
+	itr = list_iterator_create(comp_msg->msg_list);
+	while ((next_msg = list_next(itr))) {
+		if (next_msg->msg_type == MESSAGE_COMPOSITE) {
+			_comp_msg_stats((composite_msg_t *) next_msg->data,
+					now_usec, depth + 1, msg_cnt,
+					depth_max);
+			continue;
+		}
+		(*msg_cnt)++;
+		slurmctld_diag_stats.msg_aggr_latency_sum += latency;
+		slurmctld_diag_stats.msg_aggr_latency_max =
+			MAX(latency, slurmctld_diag_stats.msg_aggr_latency_max);
+	}
+	list_iterator_destroy(itr);
+}
+
 static void  _slurm_rpc_comp_msg_list(composite_msg_t * comp_msg,
 				      bool *run_scheduler,
 				      List msg_list_in,
@@ -6727,7 +7208,8 @@ static void  _slurm_rpc_comp_msg_list(composite_msg_t * comp_msg,
 		case REQUEST_COMPLETE_BATCH_SCRIPT:
 		case REQUEST_COMPLETE_BATCH_JOB:
 			_slurm_rpc_complete_batch_script(next_msg,
-							 run_scheduler, 1);
+							 run_scheduler, 1,
+							 NULL);
 			break;
 		case REQUEST_STEP_COMPLETE:
 			_slurm_rpc_step_complete(next_msg, 1);
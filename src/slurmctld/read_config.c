@@ -1231,6 +1231,8 @@ int read_slurm_conf(int recover, bool reconfig)
 	if (reconfig)
 		power_g_reconfig();
 	cpu_freq_reconfig();
+	lock_stats_enable(xstrcasestr(slurmctld_conf.slurmctld_params,
+				      "lock_stats"));
 
 	rehash_jobs();
 	_set_slurmd_addr();
@@ -2586,6 +2588,7 @@ static int _sync_nodes_to_active_job(struct job_record *job_ptr)
 		job_ptr->node_cnt = bit_set_count(job_ptr->node_bitmap_cg);
 	else
 		job_ptr->node_cnt = bit_set_count(job_ptr->node_bitmap);
+	JOB_RECORD_CHANGED(job_ptr);
 	for (i = 0; i < node_record_count; i++, node_ptr++) {
 		if (job_ptr->node_bitmap_cg) { /* job completing */
 			if (bit_test(job_ptr->node_bitmap_cg, i) == 0)
@@ -2691,6 +2694,7 @@ static int _restore_job_dependencies(void)
 
 	list_iterator_reset(job_iterator);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
+		JOB_RECORD_CHANGED(job_ptr);
 		(void) build_feature_list(job_ptr);
 
 		if (IS_JOB_RUNNING(job_ptr) || IS_JOB_SUSPENDED(job_ptr))
@@ -2760,8 +2764,10 @@ static void _acct_restore_active_jobs(void)
 			if (!with_slurmdbd)
 				jobacct_storage_g_job_start(
 					acct_db_conn, job_ptr);
-			else if (job_ptr->db_index != NO_VAL64)
+			else if (job_ptr->db_index != NO_VAL64) {
 				job_ptr->db_index = 0;
+				JOB_RECORD_CHANGED(job_ptr);
+			}
 			step_iterator = list_iterator_create(
 				job_ptr->step_list);
 			while ((step_ptr = (struct step_record *)
@@ -1799,7 +1799,7 @@ static bool _job_overlap(time_t start_time, uint32_t flags,
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		if (IS_JOB_RUNNING(job_ptr)		&&
 		    (job_ptr->end_time > start_time)	&&
-		    (bit_overlap(job_ptr->node_bitmap, node_bitmap) > 0) &&
+		    bit_overlap_any(job_ptr->node_bitmap, node_bitmap) &&
 		    ((resv_name == NULL) ||
 		     (xstrcmp(resv_name, job_ptr->resv_name) != 0))) {
 			overlap = true;
@@ -1841,7 +1841,7 @@ static bool _resv_overlap(time_t start_time, time_t end_time,
 		if ((resv_ptr->flags & RESERVE_FLAG_MAINT) ||
 		    (resv_ptr->flags & RESERVE_FLAG_OVERLAP))
 			continue;
-		if (!bit_overlap(resv_ptr->node_bitmap, node_bitmap))
+		if (!bit_overlap_any(resv_ptr->node_bitmap, node_bitmap))
 			continue;	/* no overlap */
 		if (!resv_ptr->full_nodes)
 			continue;
@@ -2819,6 +2819,8 @@ static void _clear_job_resv(slurmctld_resv_t *resv_ptr)
 				    resv_ptr->name);
 			job_ptr->priority = 0;	/* Hold job */
 		}
+		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 	list_iterator_destroy(job_iterator);
 }
@@ -3282,6 +3284,7 @@ static void _validate_all_reservations(void)
 			       job_ptr, job_ptr->resv_name);
 			job_ptr->resv_id = 0;
 			xfree(job_ptr->resv_name);
+			JOB_RECORD_CHANGED(job_ptr);
 		}
 	}
 	list_iterator_destroy(iter);
@@ -5021,8 +5024,11 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 				if ((now > resv_ptr->end_time) ||
 				    ((job_ptr->details) &&
 				     (job_ptr->details->begin_time >
-				      resv_ptr->end_time)))
+				      resv_ptr->end_time))) {
 					job_ptr->priority = 0;	/* admin hold */
+					last_job_update = now;
+					JOB_RECORD_CHANGED(job_ptr);
+				}
 				return ESLURM_RESERVATION_INVALID;
 			}
 			if (job_ptr->details->req_node_bitmap &&
@@ -5061,7 +5067,8 @@ extern int job_test_resv(struct job_record *job_ptr, time_t *when,
 			    (res2_ptr->end_time   <= job_start_time) ||
 			    (!res2_ptr->full_nodes))
 				continue;
-			if (bit_overlap(*node_bitmap, res2_ptr->node_bitmap)) {
+			if (bit_overlap_any(*node_bitmap,
+					    res2_ptr->node_bitmap)) {
 				*resv_overlap = true;
 				bit_and_not(*node_bitmap,res2_ptr->node_bitmap);
 			}
@@ -5291,6 +5298,7 @@ static int _set_job_resvid(void *object, void *arg)
 		     job_ptr, job_ptr->resv_id, resv_ptr->resv_id,
 		     resv_ptr->name);
 	job_ptr->resv_id = resv_ptr->resv_id;
+	JOB_RECORD_CHANGED(job_ptr);
 	/* Update the database */
 	jobacct_storage_g_job_start(acct_db_conn, job_ptr);
 
@@ -194,6 +194,17 @@ typedef struct diag_stats {
 	time_t   bf_when_last_cycle;
 	uint32_t bf_active;
 
+	uint32_t comp_batch_cnt;	/* completion RPC batches */
+	uint32_t comp_batch_msgs;	/* completion RPCs in batches */
+	uint32_t comp_batch_max;	/* largest completion RPC batch */
+
+	uint32_t msg_aggr_cnt;		/* MESSAGE_COMPOSITE RPCs received */
+	uint32_t msg_aggr_msgs;		/* messages carried by them */
+	uint32_t msg_aggr_fanin_max;	/* most messages in one RPC */
+	uint32_t msg_aggr_depth_max;	/* deepest collector tree seen */
+	uint64_t msg_aggr_latency_sum;	/* usec from collection to receipt */
+	uint64_t msg_aggr_latency_max;
+
 	uint32_t latency;
 } diag_stats_t;
 
@@ -455,6 +466,17 @@ extern time_t last_resv_update;	/* time of last resv_list update */
  *  JOB parameters and data structures
 \*****************************************************************************/
 extern time_t last_job_update;	/* time of last update to job records */
+extern uint64_t job_update_seq;	/* sequence number of last change to a job
+				 * record, see JOB_RECORD_CHANGED() */
+
+/*
+ * Note a change to the fields of a job record, for incremental job info
+ * RPCs and the job state journal. Call wherever a job is changed, together
+ * with setting last_job_update.
+ * NOTE: Caller must hold the job write lock
+ */
+#define JOB_RECORD_CHANGED(_job_ptr) \
+	((_job_ptr)->update_seq = ++job_update_seq)
 
 #define DETAILS_MAGIC	0xdea84e7
 #define JOB_MAGIC	0xf0b7392c
@@ -703,14 +725,18 @@ struct job_record {
 					 * to be passed to slurmdbd */
 	uint32_t group_id;		/* group submitted under */
 	uint32_t job_id;		/* job ID */
-	struct job_record *job_next;	/* next entry with same hash index */
 	struct job_record *job_array_next_j; /* job array linked list by job_id */
-	struct job_record *job_array_next_t; /* job array linked list by task_id */
 	job_resources_t *job_resrcs;	/* details of allocated cores */
 	uint32_t job_state;		/* state of the job */
 	uint16_t kill_on_node_fail;	/* 1 if job should be killed on
 					 * node failure */
 	time_t last_sched_eval;		/* last time job was evaluated for scheduling */
+	uint64_t update_seq;		/* job_update_seq of last change to
+					 * this record */
+#ifndef NDEBUG
+	uint32_t journal_cksum;		/* checksum of the record as last
+					 * saved, see job_mgr.c */
+#endif
 	char *licenses;			/* licenses required by the job */
 	List license_list;		/* structure with license info */
 	acct_policy_limit_set_t limit_set; /* flags if indicate an
@@ -1382,6 +1408,14 @@ extern void job_config_fini(struct job_record *job_ptr);
 /* Reset a job's end_time based upon it's start_time and time_limit.
  * NOTE: Do not reset the end_time if already being preempted */
 extern void job_end_time_reset(struct job_record  *job_ptr);
+/*
+ * job_journal_dirty - Note a change to a job record made while holding only
+ *	the job read lock (which can not use JOB_RECORD_CHANGED()), so the job
+ *	is written to the next job state journal batch.
+ * job_id IN - job_id of the changed record
+ */
+extern void job_journal_dirty(uint32_t job_id);
+
 /*
  * job_hold_by_assoc_id - Hold all pending jobs with a given
  *	association ID. This happens when an association is deleted (e.g. when
@@ -1945,6 +1979,24 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 			  uint16_t protocol_version);
 
+/*
+ * pack_delta_jobs - dump job information for jobs created or changed since
+ *	update_time in machine independent form (for network transmission),
+ *	followed by the IDs of jobs purged or hidden since then
+ * OUT buffer_ptr - the pointer is set to the allocated buffer.
+ * OUT buffer_size - set to size of the buffer in bytes
+ * IN update_time - time of the client's last job information
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * IN protocol_version - slurm protocol version of client
+ * global: job_list - global list of job records
+ * NOTE: Packs all jobs if the changes can not be reported incrementally
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ */
+extern void pack_delta_jobs(char **buffer_ptr, int *buffer_size,
+			    time_t update_time, uint16_t show_flags, uid_t uid,
+			    uint16_t protocol_version);
+
 /*
  * pack_spec_jobs - dump job information for specified jobs in
  *	machine independent form (for network transmission)
@@ -2077,6 +2129,9 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid, char *node_name,
 			   uint16_t protocol_version);
 
+/* pack_rpc_queue_stats - pack RPC worker and class queue statistics */
+extern void pack_rpc_queue_stats(Buf buffer);
+
 /* part_is_visible - should user be able to see this partition */
 extern bool part_is_visible(struct part_record *part_ptr, uid_t uid);
 
@@ -2206,6 +2261,9 @@ extern void reset_node_load(char *node_name, uint32_t cpu_load);
 /* Reset a node's free memory value */
 extern void reset_node_free_mem(char *node_name, uint64_t free_mem);
 
+/* reset_rpc_queue_stats - clear RPC class queue statistics */
+extern void reset_rpc_queue_stats(void);
+
 /* Reset all scheduling statistics
  * level IN - clear backfilled_jobs count if set */
 extern void reset_stats(int level);
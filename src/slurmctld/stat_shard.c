@@ -0,0 +1,151 @@
+/*****************************************************************************\
+ *  stat_shard.c - per thread shards of slurmctld statistics
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+#include "src/slurmctld/stat_shard.h"
+
+/* Shards of the calling thread, one per set it has used */
+typedef struct {
+	int shard_cnt;
+	stat_shard_t **shards;
+} thread_shards_t;
+
+static pthread_key_t shard_key;
+static pthread_once_t shard_once = PTHREAD_ONCE_INIT;
+
+/* Merge a shard into its set's totals and remove it from the set */
+static void _shard_fini(stat_shard_t *shard)
+{
+	stat_shard_set_t *set = shard->set;
+	stat_shard_t *shard_ptr;
+	ListIterator iter;
+
+	slurm_mutex_lock(&set->mutex);
+	iter = list_iterator_create(set->shard_list);
+	while ((shard_ptr = list_next(iter))) {
+		if (shard_ptr == shard) {
+			list_remove(iter);
+			break;
+		}
+	}
+	list_iterator_destroy(iter);
+	slurm_mutex_lock(&shard->mutex);
+	(set->merge)(shard);
+	slurm_mutex_unlock(&shard->mutex);
+	slurm_mutex_unlock(&set->mutex);
+
+	slurm_mutex_destroy(&shard->mutex);
+	xfree(shard);
+}
+
+/* Thread exit, keep the statistics of its shards */
+static void _thread_shards_fini(void *x)
+{
+	thread_shards_t *thread_shards = (thread_shards_t *) x;
+	int i;
+
+	for (i = 0; i < thread_shards->shard_cnt; i++)
+		_shard_fini(thread_shards->shards[i]);
+	xfree(thread_shards->shards);
+	xfree(thread_shards);
+}
+
+static void _shard_key_init(void)
+{
+	if (pthread_key_create(&shard_key, _thread_shards_fini))
+		fatal("%s: pthread_key_create: %m", __func__);
+}
+
+extern void *stat_shard_lock(stat_shard_set_t *set)
+{
+	thread_shards_t *thread_shards;
+	stat_shard_t *shard = NULL;
+	int i;
+
+	pthread_once(&shard_once, _shard_key_init);
+	if (!(thread_shards = pthread_getspecific(shard_key))) {
+		thread_shards = xmalloc(sizeof(thread_shards_t));
+		pthread_setspecific(shard_key, thread_shards);
+	}
+	for (i = 0; i < thread_shards->shard_cnt; i++) {
+		if (thread_shards->shards[i]->set == set) {
+			shard = thread_shards->shards[i];
+			break;
+		}
+	}
+
+	if (!shard) {
+		xassert(set->shard_size >= sizeof(stat_shard_t));
+		shard = xmalloc(set->shard_size);
+		slurm_mutex_init(&shard->mutex);
+		shard->set = set;
+		slurm_mutex_lock(&set->mutex);
+		if (!set->shard_list)
+			set->shard_list = list_create(NULL);
+		list_append(set->shard_list, shard);
+		slurm_mutex_unlock(&set->mutex);
+		xrealloc(thread_shards->shards, sizeof(stat_shard_t *) *
+			 (thread_shards->shard_cnt + 1));
+		thread_shards->shards[thread_shards->shard_cnt++] = shard;
+	}
+
+	slurm_mutex_lock(&shard->mutex);
+	return shard;
+}
+
+extern void stat_shard_unlock(void *shard)
+{
+	slurm_mutex_unlock(&((stat_shard_t *) shard)->mutex);
+}
+
+extern void stat_shard_merge_all(stat_shard_set_t *set)
+{
+	stat_shard_t *shard;
+	ListIterator iter;
+
+	slurm_mutex_lock(&set->mutex);
+	if (set->shard_list) {
+		iter = list_iterator_create(set->shard_list);
+		while ((shard = list_next(iter))) {
+			slurm_mutex_lock(&shard->mutex);
+			(set->merge)(shard);
+			slurm_mutex_unlock(&shard->mutex);
+		}
+		list_iterator_destroy(iter);
+	}
+	slurm_mutex_unlock(&set->mutex);
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************\
+ *  stat_shard.h - per thread shards of slurmctld statistics
+ *****************************************************************************
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURM_STAT_SHARD_H
+#define _SLURM_STAT_SHARD_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "src/common/list.h"
+
+/*
+ * Statistics updated by many threads are kept in shards, one per thread.
+ * A thread adds to its own shard, so the shard's mutex is only contended
+ * while the shards are merged into the set's totals. That happens when the
+ * statistics are read or reset, whenever the caller chooses and when the
+ * thread exits.
+ * Lock order: stat_shard_set_t.mutex, then stat_shard_t.mutex, then any lock
+ * taken by the set's merge function.
+ */
+typedef struct stat_shard_set stat_shard_set_t;
+
+/* Header of a shard, the first member of the caller's shard structure */
+typedef struct {
+	pthread_mutex_t mutex;
+	stat_shard_set_t *set;
+} stat_shard_t;
+
+/*
+ * Move a shard's statistics into the totals and clear them
+ * NOTE: Called with shard->mutex held
+ */
+typedef void (*stat_shard_merge_f)(stat_shard_t *shard);
+
+struct stat_shard_set {
+	pthread_mutex_t mutex;		/* Protects shard_list */
+	List shard_list;		/* stat_shard_t of each thread */
+	size_t shard_size;		/* Size of the caller's shard */
+	stat_shard_merge_f merge;
+};
+
+#define STAT_SHARD_SET_INITIALIZER(_shard_type, _merge)		\
+	{ .mutex = PTHREAD_MUTEX_INITIALIZER, .shard_list = NULL,	\
+	  .shard_size = sizeof(_shard_type), .merge = _merge }
+
+/*
+ * Return the calling thread's shard of a set, created zeroed on first use,
+ * with its mutex locked. Release it with stat_shard_unlock().
+ */
+extern void *stat_shard_lock(stat_shard_set_t *set);
+
+extern void stat_shard_unlock(void *shard);
+
+/* Merge the shards of every thread into the set's totals */
+extern void stat_shard_merge_all(stat_shard_set_t *set);
+
+#endif	/* _SLURM_STAT_SHARD_H */
@@ -56,6 +56,8 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 	int agent_queue_size;
 	int agent_count;
 	int slurmdbd_queue_size;
+	int slurmdbd_spool_cnt = 0;
+	uint64_t slurmdbd_queue_bytes = 0, slurmdbd_spool_bytes = 0;
 	time_t now = time(NULL);
 	uint32_t uint32_tmp;
 
@@ -68,10 +70,100 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 					    &slurmdbd_queue_size)
 		    != SLURM_SUCCESS)
 			slurmdbd_queue_size = 0;
+		(void) acct_storage_g_get_data(acct_db_conn,
+					       ACCT_STORAGE_INFO_AGENT_BYTES,
+					       &slurmdbd_queue_bytes);
+		(void) acct_storage_g_get_data(
+			acct_db_conn, ACCT_STORAGE_INFO_AGENT_SPOOL_COUNT,
+			&slurmdbd_spool_cnt);
+		(void) acct_storage_g_get_data(
+			acct_db_conn, ACCT_STORAGE_INFO_AGENT_SPOOL_BYTES,
+			&slurmdbd_spool_bytes);
 	}
 
 	buffer = init_buf(BUF_SIZE);
-	if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_19_05_PROTOCOL_VERSION) {
+		parts_packed = resp;
+		pack32(parts_packed, buffer);
+
+		if (resp) {
+			pack_time(now, buffer);
+			debug3("pack_all_stat: time = %u",
+			       (uint32_t) last_proc_req_start);
+			pack_time(last_proc_req_start, buffer);
+
+			debug3("pack_all_stat: server_thread_count = %u",
+			       slurmctld_config.server_thread_count);
+			pack32(slurmctld_config.server_thread_count, buffer);
+
+			agent_queue_size = retry_list_size();
+			pack32(agent_queue_size, buffer);
+			agent_count = get_agent_count();
+			pack32(agent_count, buffer);
+			pack32(slurmdbd_queue_size, buffer);
+			pack32(slurmctld_diag_stats.latency, buffer);
+
+			pack32(slurmctld_diag_stats.jobs_submitted, buffer);
+			pack32(slurmctld_diag_stats.jobs_started, buffer);
+			pack32(slurmctld_diag_stats.jobs_completed, buffer);
+			pack32(slurmctld_diag_stats.jobs_canceled, buffer);
+			pack32(slurmctld_diag_stats.jobs_failed, buffer);
+
+			pack32(slurmctld_diag_stats.jobs_pending, buffer);
+			pack32(slurmctld_diag_stats.jobs_running, buffer);
+			pack_time(slurmctld_diag_stats.job_states_ts, buffer);
+
+			pack32(slurmctld_diag_stats.schedule_cycle_max,
+			       buffer);
+			pack32(slurmctld_diag_stats.schedule_cycle_last,
+			       buffer);
+			pack32(slurmctld_diag_stats.schedule_cycle_sum,
+			       buffer);
+			pack32(slurmctld_diag_stats.schedule_cycle_counter,
+			       buffer);
+			pack32(slurmctld_diag_stats.schedule_cycle_depth,
+			       buffer);
+			pack32(slurmctld_diag_stats.schedule_queue_len, buffer);
+
+			pack32(slurmctld_diag_stats.backfilled_jobs, buffer);
+			pack32(slurmctld_diag_stats.last_backfilled_jobs,
+			       buffer);
+			pack32(slurmctld_diag_stats.bf_cycle_counter, buffer);
+			pack64(slurmctld_diag_stats.bf_cycle_sum, buffer);
+			pack32(slurmctld_diag_stats.bf_cycle_last, buffer);
+			pack32(slurmctld_diag_stats.bf_last_depth, buffer);
+			pack32(slurmctld_diag_stats.bf_last_depth_try, buffer);
+
+			pack32(slurmctld_diag_stats.bf_queue_len, buffer);
+			pack32(slurmctld_diag_stats.bf_cycle_max, buffer);
+			pack_time(slurmctld_diag_stats.bf_when_last_cycle,
+				  buffer);
+			pack32(slurmctld_diag_stats.bf_depth_sum, buffer);
+			pack32(slurmctld_diag_stats.bf_depth_try_sum, buffer);
+			pack32(slurmctld_diag_stats.bf_queue_len_sum, buffer);
+
+			pack32(slurmctld_diag_stats.bf_active, buffer);
+			pack32(slurmctld_diag_stats.backfilled_pack_jobs,
+			       buffer);
+
+			pack32(slurmctld_diag_stats.comp_batch_cnt, buffer);
+			pack32(slurmctld_diag_stats.comp_batch_msgs, buffer);
+			pack32(slurmctld_diag_stats.comp_batch_max, buffer);
+
+			pack32(slurmctld_diag_stats.msg_aggr_cnt, buffer);
+			pack32(slurmctld_diag_stats.msg_aggr_msgs, buffer);
+			pack32(slurmctld_diag_stats.msg_aggr_fanin_max, buffer);
+			pack32(slurmctld_diag_stats.msg_aggr_depth_max, buffer);
+			pack64(slurmctld_diag_stats.msg_aggr_latency_sum,
+			       buffer);
+			pack64(slurmctld_diag_stats.msg_aggr_latency_max,
+			       buffer);
+
+			pack64(slurmdbd_queue_bytes, buffer);
+			pack32(slurmdbd_spool_cnt, buffer);
+			pack64(slurmdbd_spool_bytes, buffer);
+		}
+	} else if (protocol_version >= SLURM_18_08_PROTOCOL_VERSION) {
 		parts_packed = resp;
 		pack32(parts_packed, buffer);
 
@@ -236,6 +328,15 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.bf_last_depth = 0;
 	slurmctld_diag_stats.bf_last_depth_try = 0;
 	slurmctld_diag_stats.bf_active = 0;
+	slurmctld_diag_stats.comp_batch_cnt = 0;
+	slurmctld_diag_stats.comp_batch_msgs = 0;
+	slurmctld_diag_stats.comp_batch_max = 0;
+	slurmctld_diag_stats.msg_aggr_cnt = 0;
+	slurmctld_diag_stats.msg_aggr_msgs = 0;
+	slurmctld_diag_stats.msg_aggr_fanin_max = 0;
+	slurmctld_diag_stats.msg_aggr_depth_max = 0;
+	slurmctld_diag_stats.msg_aggr_latency_sum = 0;
+	slurmctld_diag_stats.msg_aggr_latency_max = 0;
 
 	last_proc_req_start = time(NULL);
 }
@@ -181,6 +181,7 @@ static struct step_record * _create_step_record(struct job_record *job_ptr,
 	step_ptr = (struct step_record *) xmalloc(sizeof(struct step_record));
 
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 	step_ptr->job_ptr    = job_ptr;
 	step_ptr->exit_code  = NO_VAL;
 	step_ptr->time_limit = INFINITE;
@@ -275,6 +276,8 @@ static void _internal_step_complete(struct job_record *job_ptr,
 				    struct step_record *step_ptr)
 {
 	struct jobacctinfo *jobacct = (struct jobacctinfo *)step_ptr->jobacct;
+
+	JOB_RECORD_CHANGED(job_ptr);
 	if (jobacct && job_ptr->tres_alloc_cnt &&
 	    (jobacct->energy.consumed_energy != NO_VAL64)) {
 		if (job_ptr->tres_alloc_cnt[TRES_ARRAY_ENERGY] == NO_VAL64)
@@ -326,6 +329,7 @@ extern void delete_step_records (struct job_record *job_ptr)
 	xassert(job_ptr);
 
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 	step_iterator = list_iterator_create(job_ptr->step_list);
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		/* Only check if not a pending step */
@@ -439,6 +443,7 @@ delete_step_record (struct job_record *job_ptr, uint32_t step_id)
 		return error_code;
 
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 	step_iterator = list_iterator_create (job_ptr->step_list);
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		if (step_ptr->step_id != step_id)
@@ -884,6 +889,7 @@ int job_step_complete(uint32_t job_id, uint32_t step_id, uid_t uid,
 	_internal_step_complete(job_ptr, step_ptr);
 
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 
 	return SLURM_SUCCESS;
 }
@@ -2295,6 +2301,7 @@ static void _set_def_cpu_bind(struct job_record *job_ptr)
 	    (job_ptr->details->cpu_bind_type & bind_to_bits))
 		return;		/* Already set */
 	bind_bits = job_ptr->details->cpu_bind_type & CPU_BIND_VERBOSE;
+	JOB_RECORD_CHANGED(job_ptr);
 
 	/*
 	 * Set job's cpu_bind to the node's cpu_bind if all of the job's
@@ -3439,6 +3446,7 @@ extern int job_step_checkpoint(checkpoint_msg_t *ckpt_ptr,
 				   &resp_data.error_code,
 				   &resp_data.error_msg);
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
     reply:
@@ -3505,6 +3513,7 @@ extern int job_step_checkpoint_comp(checkpoint_comp_msg_t *ckpt_ptr,
 		rc = checkpoint_comp((void *)step_ptr, ckpt_ptr->begin_time,
 			ckpt_ptr->error_code, ckpt_ptr->error_msg);
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
     reply:
@@ -3564,6 +3573,7 @@ extern int job_step_checkpoint_task_comp(checkpoint_task_comp_msg_t *ckpt_ptr,
 			ckpt_ptr->task_id, ckpt_ptr->begin_time,
 			ckpt_ptr->error_code, ckpt_ptr->error_msg);
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
 	}
 
     reply:
@@ -3627,6 +3637,7 @@ extern int step_partial_comp(step_complete_msg_t *req, uid_t uid,
 		if (max_rc)
 			*max_rc = step_ptr->exit_code;
 		jobacctinfo_aggregate(step_ptr->jobacct, req->jobacct);
+		JOB_RECORD_CHANGED(job_ptr);
 		/* we don't want to delete the step record here since
 		 * right after we delete this step again if we delete
 		 * it here we won't find it when we try the second time */
@@ -3676,6 +3687,7 @@ extern int step_partial_comp(step_complete_msg_t *req, uid_t uid,
 		 req->range_first, req->range_last);
 	rem_nodes = bit_clear_count(step_ptr->exit_node_bitmap);
 #endif
+	JOB_RECORD_CHANGED(job_ptr);
 	if (rem)
 		*rem = rem_nodes;
 	if (rem_nodes == 0) {
@@ -4397,6 +4409,7 @@ extern void step_checkpoint(void)
 					      -1, NO_VAL16);
 			job_ptr->ckpt_time = now;
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			continue; /* ignore periodic step ckpt */
 		}
 		step_iterator = list_iterator_create (job_ptr->step_list);
@@ -4423,6 +4436,7 @@ extern void step_checkpoint(void)
 
 			step_ptr->ckpt_time = now;
 			last_job_update = now;
+			JOB_RECORD_CHANGED(job_ptr);
 			image_dir = xstrdup(step_ptr->ckpt_dir);
 			xstrfmtcat(image_dir, "/%u.%u", job_ptr->job_id,
 				   step_ptr->step_id);
@@ -4684,8 +4698,10 @@ extern int update_step(step_update_request_msg_t *req, uid_t uid)
 			     step_ptr, req->time_limit);
 		}
 	}
-	if (mod_cnt)
+	if (mod_cnt) {
 		last_job_update = time(NULL);
+		JOB_RECORD_CHANGED(job_ptr);
+	}
 	if (new_step) {
 		/*
 		 * This was a temporary step record, never linked to the job,
@@ -4795,6 +4811,7 @@ extern int post_job_step(struct step_record *step_ptr)
 				 step_ptr->step_id);
 
 	last_job_update = time(NULL);
+	JOB_RECORD_CHANGED(job_ptr);
 	/* Don't need to set state. Will be destroyed in next steps. */
 	/* step_ptr->state = JOB_COMPLETE; */
 
@@ -562,7 +562,8 @@ proc_req(void *conn, persist_msg_t *msg,
 		      slurmdbd_conn->conn->fd,
 		      slurmdbd_msg_type_2_str(msg->msg_type, 1));
 	else if (slurmdbd_conn->conn->rem_port
-		 && !slurmdbd_conf->commit_delay) {
+		 && !slurmdbd_conf->commit_delay
+		 && !slurmdbd_conn->in_mult_msg) {
 		/* If we are dealing with the slurmctld do the
 		   commit (SUCCESS or NOT) afterwards since we
 		   do transactions for performance reasons.
@@ -3290,6 +3291,7 @@ static int   _roll_usage(slurmdbd_conn_t *slurmdbd_conn,
 		rpc_stats.rollup_max_time[i] =
 			MAX(rpc_stats.rollup_max_time[i],
 			    rollup_stats.rollup_time[i]);
+		rpc_stats.rollup_periods[i] += rollup_stats.rollup_periods[i];
 	}
 	slurm_mutex_unlock(&rpc_mutex);
 
@@ -3354,7 +3356,9 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 	ListIterator itr = NULL;
 	Buf req_buf = NULL, ret_buf = NULL;
 	int rc = SLURM_SUCCESS;
-	/* DEF_TIMERS; */
+	uint32_t rec_cnt = 0;
+	bool commit;
+	DEF_TIMERS;
 
 	if (!_validate_slurm_user(*uid)) {
 		comment = "DBD_SEND_MULT_MSG message from invalid uid";
@@ -3366,8 +3370,20 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 		return SLURM_ERROR;
 	}
 
+	/*
+	 * Store all the messages in one transaction instead of committing
+	 * each one, which lets the storage plugin coalesce their statements.
+	 * Only here is the commit checked before anything is acknowledged,
+	 * so this is the only place statements may be deferred.
+	 */
+	commit = (slurmdbd_conn->conn->rem_port &&
+		  !slurmdbd_conf->commit_delay);
+	slurmdbd_conn->in_mult_msg = commit;
+	if (commit)
+		acct_storage_g_batch(slurmdbd_conn->db_conn, true);
+
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
-	/* START_TIMER; */
+	START_TIMER;
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
 		persist_msg_t sub_msg;
@@ -3386,12 +3402,45 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 
 		if (ret_buf)
 			list_append(list_msg.my_list, ret_buf);
+		rec_cnt++;
 		if (rc != SLURM_SUCCESS)
 			break;
 	}
 	list_iterator_destroy(itr);
-	/* END_TIMER; */
-	/* info("%d multi took %s", list_count(get_msg->my_list), TIME_STR); */
+
+	slurmdbd_conn->in_mult_msg = false;
+	if (commit)
+		acct_storage_g_batch(slurmdbd_conn->db_conn, false);
+	if (commit &&
+	    (acct_storage_g_commit(slurmdbd_conn->db_conn, 1) !=
+	     SLURM_SUCCESS)) {
+		/*
+		 * Nothing was stored, so have the slurmctld send all of the
+		 * messages again rather than acknowledging any of them.
+		 */
+		END_TIMER;
+		comment = "DBD_SEND_MULT_MSG commit failed";
+		error("CONN:%u %s, %u messages", slurmdbd_conn->conn->fd,
+		      comment, rec_cnt);
+		FREE_NULL_LIST(list_msg.my_list);
+		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
+							SLURM_ERROR, comment,
+							DBD_SEND_MULT_MSG);
+		slurm_mutex_lock(&rpc_mutex);
+		rpc_stats.batch_fail_cnt++;
+		slurm_mutex_unlock(&rpc_mutex);
+		return SLURM_ERROR;
+	}
+	END_TIMER;
+	debug2("DBD_SEND_MULT_MSG: %u messages took %s", rec_cnt, TIME_STR);
+
+	slurm_mutex_lock(&rpc_mutex);
+	rpc_stats.batch_cnt++;
+	rpc_stats.batch_rec_cnt += rec_cnt;
+	rpc_stats.batch_time += DELTA_TIMER;
+	if (rpc_stats.batch_max_time < DELTA_TIMER)
+		rpc_stats.batch_max_time = DELTA_TIMER;
+	slurm_mutex_unlock(&rpc_mutex);
 
 	*out_buffer = init_buf(1024);
 	pack16((uint16_t) DBD_GOT_MULT_MSG, *out_buffer);
@@ -3595,6 +3644,7 @@ static int  _clear_stats(slurmdbd_conn_t *slurmdbd_conn,
 		rpc_stats.rollup_count[i] = 0;
 		rpc_stats.rollup_time[i] = 0;
 		rpc_stats.rollup_max_time[i] = 0;
+		rpc_stats.rollup_periods[i] = 0;
 	}
 	for (i = 0; i < rpc_stats.type_cnt; i++) {
 		rpc_stats.rpc_type_cnt[i] = 0;
@@ -3604,6 +3654,11 @@ static int  _clear_stats(slurmdbd_conn_t *slurmdbd_conn,
 		rpc_stats.rpc_user_cnt[i] = 0;
 		rpc_stats.rpc_user_time[i] = 0;
 	}
+	rpc_stats.batch_cnt = 0;
+	rpc_stats.batch_fail_cnt = 0;
+	rpc_stats.batch_max_time = 0;
+	rpc_stats.batch_rec_cnt = 0;
+	rpc_stats.batch_time = 0;
 	slurm_mutex_unlock(&rpc_mutex);
 
 	*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
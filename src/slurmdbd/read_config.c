@@ -100,6 +100,7 @@ static void _clear_slurmdbd_conf(void)
 		xfree(slurmdbd_conf->default_qos);
 		xfree(slurmdbd_conf->log_file);
 		slurmdbd_conf->syslog_debug = LOG_LEVEL_END;
+		slurmdbd_conf->max_rollup_threads = 0;
 		xfree(slurmdbd_conf->parameters);
 		xfree(slurmdbd_conf->pid_file);
 		xfree(slurmdbd_conf->plugindir);
@@ -118,6 +119,9 @@ static void _clear_slurmdbd_conf(void)
 		xfree(slurmdbd_conf->storage_loc);
 		xfree(slurmdbd_conf->storage_pass);
 		slurmdbd_conf->storage_port = 0;
+		xfree(slurmdbd_conf->storage_read_host);
+		slurmdbd_conf->storage_read_max_lag = 0;
+		slurmdbd_conf->storage_read_port = 0;
 		xfree(slurmdbd_conf->storage_type);
 		xfree(slurmdbd_conf->storage_user);
 		slurmdbd_conf->track_wckey = 0;
@@ -183,6 +187,9 @@ extern int read_slurmdbd_conf(void)
 		{"StorageLoc", S_P_STRING},
 		{"StoragePass", S_P_STRING},
 		{"StoragePort", S_P_UINT16},
+		{"StorageReadHost", S_P_STRING},
+		{"StorageReadMaxLag", S_P_UINT16},
+		{"StorageReadPort", S_P_UINT16},
 		{"StorageType", S_P_STRING},
 		{"StorageUser", S_P_STRING},
 		{"TCPTimeout", S_P_UINT16},
@@ -311,12 +318,27 @@ extern int read_slurmdbd_conf(void)
 			     "effective fault-tolerance");
 		}
 
+		slurmdbd_conf->max_rollup_threads = DEFAULT_ROLLUP_THREADS;
 		s_p_get_string(&slurmdbd_conf->parameters, "Parameters", tbl);
 		if (slurmdbd_conf->parameters) {
+			char *tmp_ptr;
+
 			if (xstrcasestr(slurmdbd_conf->parameters,
 					"PreserveCaseUser"))
 				slurmdbd_conf->persist_conn_rc_flags |=
 					PERSIST_FLAG_P_USER_CASE;
+			if ((tmp_ptr = xstrcasestr(slurmdbd_conf->parameters,
+						   "MaxRollupThreads="))) {
+				int threads = atoi(tmp_ptr + 17);
+				if ((threads < 1) ||
+				    (threads > MAX_ROLLUP_THREADS)) {
+					error("Invalid MaxRollupThreads=%d, "
+					      "using %d", threads,
+					      DEFAULT_ROLLUP_THREADS);
+				} else
+					slurmdbd_conf->max_rollup_threads =
+						threads;
+			}
 		}
 
 		s_p_get_string(&slurmdbd_conf->pid_file, "PidFile", tbl);
@@ -491,6 +513,14 @@ extern int read_slurmdbd_conf(void)
 			       "StoragePass", tbl);
 		s_p_get_uint16(&slurmdbd_conf->storage_port,
 			       "StoragePort", tbl);
+		s_p_get_string(&slurmdbd_conf->storage_read_host,
+			       "StorageReadHost", tbl);
+		if (!s_p_get_uint16(&slurmdbd_conf->storage_read_max_lag,
+				    "StorageReadMaxLag", tbl))
+			slurmdbd_conf->storage_read_max_lag =
+				DEFAULT_STORAGE_READ_MAX_LAG;
+		s_p_get_uint16(&slurmdbd_conf->storage_read_port,
+			       "StorageReadPort", tbl);
 		s_p_get_string(&slurmdbd_conf->storage_type,
 			       "StorageType", tbl);
 		s_p_get_string(&slurmdbd_conf->storage_user,
@@ -583,6 +613,9 @@ extern int read_slurmdbd_conf(void)
 			slurmdbd_conf->storage_loc =
 				xstrdup(DEFAULT_STORAGE_LOC);
 	}
+	if (slurmdbd_conf->storage_read_host &&
+	    !slurmdbd_conf->storage_read_port)
+		slurmdbd_conf->storage_read_port = slurmdbd_conf->storage_port;
 
 	if (slurmdbd_conf->archive_dir) {
 		if (stat(slurmdbd_conf->archive_dir, &buf) < 0)
@@ -698,6 +731,9 @@ extern void log_config(void)
 	debug2("StorageLoc        = %s", slurmdbd_conf->storage_loc);
 	/* debug2("StoragePass       = %s", slurmdbd_conf->storage_pass); */
 	debug2("StoragePort       = %u", slurmdbd_conf->storage_port);
+	debug2("StorageReadHost   = %s", slurmdbd_conf->storage_read_host);
+	debug2("StorageReadMaxLag = %u", slurmdbd_conf->storage_read_max_lag);
+	debug2("StorageReadPort   = %u", slurmdbd_conf->storage_read_port);
 	debug2("StorageType       = %s", slurmdbd_conf->storage_type);
 	debug2("StorageUser       = %s", slurmdbd_conf->storage_user);
 
@@ -1005,6 +1041,23 @@ extern List dump_config(void)
 	key_pair->value = xstrdup_printf("%u", slurmdbd_conf->storage_port);
 	list_append(my_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("StorageReadHost");
+	key_pair->value = xstrdup(slurmdbd_conf->storage_read_host);
+	list_append(my_list, key_pair);
+
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("StorageReadMaxLag");
+	key_pair->value = xstrdup_printf("%u secs",
+					 slurmdbd_conf->storage_read_max_lag);
+	list_append(my_list, key_pair);
+
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("StorageReadPort");
+	key_pair->value = xstrdup_printf("%u",
+					 slurmdbd_conf->storage_read_port);
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("StorageType");
 	key_pair->value = xstrdup(slurmdbd_conf->storage_type);
@@ -50,6 +50,9 @@
 //#define DEFAULT_SLURMDBD_JOB_PURGE	12
 #define DEFAULT_SLURMDBD_PIDFILE	"/var/run/slurmdbd.pid"
 #define DEFAULT_SLURMDBD_ARCHIVE_DIR	"/tmp"
+#define DEFAULT_ROLLUP_THREADS		4
+#define DEFAULT_STORAGE_READ_MAX_LAG	30
+#define MAX_ROLLUP_THREADS		64
 //#define DEFAULT_SLURMDBD_STEP_PURGE	1
 
 /* SlurmDBD configuration parameters */
@@ -75,6 +78,8 @@ typedef struct slurm_dbd_conf {
 	char *		log_file;	/* Log file			*/
 	uint16_t	syslog_debug;	/* output to both logfile and syslog*/
 	uint16_t        log_fmt;        /* Log file timestamt format    */
+	uint16_t	max_rollup_threads; /* connections a cluster's rollup
+					     * may run in parallel */
 	uint32_t	max_time_range;	/* max time range for user queries */
 	uint16_t        msg_timeout;    /* message timeout		*/
 	char *		parameters;	/* parameters to change behavior with
@@ -106,6 +111,11 @@ typedef struct slurm_dbd_conf {
 	char *		storage_loc;	/* database name		*/
 	char *		storage_pass;   /* password for DB write	*/
 	uint16_t	storage_port;	/* port DB is listening to	*/
+	char *		storage_read_host;/* read-only replica of the DB
+					   * for queries */
+	uint16_t	storage_read_max_lag; /* seconds the replica may be
+					       * behind to be used */
+	uint16_t	storage_read_port; /* port the replica listens to */
 	char *		storage_type;	/* DB to be used for storage	*/
 	char *		storage_user;	/* user authorized to write DB	*/
 	uint16_t        track_wckey;    /* Whether or not to track wckey*/
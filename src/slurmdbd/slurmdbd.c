@@ -354,6 +354,8 @@ static void _init_dbd_stats(void)
 		xmalloc(sizeof(uint64_t) * ROLLUP_COUNT);
 	rpc_stats.rollup_max_time =
 		xmalloc(sizeof(uint64_t) * ROLLUP_COUNT);
+	rpc_stats.rollup_periods  =
+		xmalloc(sizeof(uint64_t) * ROLLUP_COUNT);
 
 	rpc_stats.type_cnt = 200;  /* Capture info for first 200 RPC types */
 	rpc_stats.rpc_type_id   =
@@ -380,6 +382,7 @@ static void _free_dbd_stats(void)
 	xfree(rpc_stats.rollup_count);
 	xfree(rpc_stats.rollup_time);
 	xfree(rpc_stats.rollup_max_time);
+	xfree(rpc_stats.rollup_periods);
 
 	rpc_stats.type_cnt = 0;
 	xfree(rpc_stats.rpc_type_id);
@@ -719,6 +722,8 @@ static void *_rollup_handler(void *db_conn)
 			rpc_stats.rollup_max_time[i] =
 				MAX(rpc_stats.rollup_max_time[i],
 				    rollup_stats.rollup_time[i]);
+			rpc_stats.rollup_periods[i] +=
+				rollup_stats.rollup_periods[i];
 		}
 		slurm_mutex_unlock(&rpc_mutex);
 
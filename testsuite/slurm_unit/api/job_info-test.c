@@ -0,0 +1,137 @@
+/* Test of merging incremental job information, see slurm_load_jobs_delta()
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <slurm/slurm.h>
+#include <src/common/slurm_protocol_defs.h>
+#include <src/common/xmalloc.h>
+#include <src/common/xstring.h>
+
+/* _merge_delta_jobs() is private to the API, build it in here */
+#include "src/api/job_info.c"
+
+/*
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h, which job_info.c needs)
+ */
+#define wait dejagnu_wait
+#include <testsuite/dejagnu.h>
+#undef wait
+
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+static char conf_file[] = "/tmp/job_info_conf.XXXXXX";
+
+/* Freeing job records loads the select plugin, from the build tree */
+static void _write_conf(void)
+{
+	char *conf = NULL;
+	int fd;
+
+	xstrfmtcat(conf,
+		   "ClusterName=job_info\n"
+		   "SlurmctldHost=localhost\n"
+		   "SelectType=select/linear\n"
+		   "PluginDir=%s/src/plugins/select/linear/.libs\n"
+		   "NodeName=n1\n"
+		   "PartitionName=p Nodes=n1\n",
+		   ABS_TOP_BUILDDIR);
+	if ((fd = mkstemp(conf_file)) < 0) {
+		perror("mkstemp");
+		exit(EXIT_FAILURE);
+	}
+	if (write(fd, conf, strlen(conf)) != strlen(conf)) {
+		perror("write");
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+	xfree(conf);
+	setenv("SLURM_CONF", conf_file, 1);
+}
+
+static job_info_msg_t *_job_msg(uint32_t *job_ids, int cnt, char *name)
+{
+	job_info_msg_t *msg = xmalloc(sizeof(job_info_msg_t));
+	int i;
+
+	msg->record_count = cnt;
+	if (cnt)
+		msg->job_array = xmalloc(sizeof(slurm_job_info_t) * cnt);
+	for (i = 0; i < cnt; i++) {
+		msg->job_array[i].job_id = job_ids[i];
+		msg->job_array[i].name = xstrdup(name);
+	}
+	return msg;
+}
+
+static slurm_job_info_t *_find_job(job_info_msg_t *msg, uint32_t job_id)
+{
+	uint32_t i;
+
+	for (i = 0; i < msg->record_count; i++) {
+		if (msg->job_array[i].job_id == job_id)
+			return &msg->job_array[i];
+	}
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	uint32_t old_ids[] = { 10, 11, 12, 13, 14 };
+	uint32_t delta_ids[] = { 15, 11 };
+	/* 12 hidden, 13 purged, 99 never sent to this client */
+	uint32_t removed_ids[] = { 99, 13, 12 };
+	job_info_msg_t *old_msg, *delta_msg;
+	slurm_job_info_t *job;
+
+	_write_conf();
+	old_msg = _job_msg(old_ids, 5, "old");
+	delta_msg = _job_msg(delta_ids, 2, "new");
+	delta_msg->delta = 1;
+	delta_msg->removed_cnt = 3;
+	delta_msg->removed_job_id = xmalloc(sizeof(removed_ids));
+	memcpy(delta_msg->removed_job_id, removed_ids, sizeof(removed_ids));
+
+	_merge_delta_jobs(old_msg, delta_msg);
+
+	TEST(delta_msg->record_count == 4, "merged record count");
+	TEST(old_msg->record_count == 0, "old records moved");
+	TEST(delta_msg->delta == 0, "merged message is complete");
+	TEST((delta_msg->removed_cnt == 0) && !delta_msg->removed_job_id,
+	     "removed job IDs consumed");
+
+	job = _find_job(delta_msg, 10);
+	TEST(job && !xstrcmp(job->name, "old"), "unchanged job kept");
+	job = _find_job(delta_msg, 14);
+	TEST(job && !xstrcmp(job->name, "old"), "last unchanged job kept");
+	job = _find_job(delta_msg, 11);
+	TEST(job && !xstrcmp(job->name, "new"), "changed job updated");
+	job = _find_job(delta_msg, 15);
+	TEST(job && !xstrcmp(job->name, "new"), "new job added");
+	TEST(!_find_job(delta_msg, 12), "hidden job removed");
+	TEST(!_find_job(delta_msg, 13), "purged job removed");
+	TEST(!_find_job(delta_msg, 99), "unknown removed job ignored");
+
+	/* Nothing changed since the last delta */
+	slurm_free_job_info_msg(old_msg);
+	old_msg = delta_msg;
+	delta_msg = _job_msg(NULL, 0, NULL);
+	delta_msg->delta = 1;
+	_merge_delta_jobs(old_msg, delta_msg);
+	TEST(delta_msg->record_count == 4, "empty delta keeps all records");
+
+	slurm_free_job_info_msg(old_msg);
+	slurm_free_job_info_msg(delta_msg);
+	unlink(conf_file);
+
+	totals();
+	return failed;
+}
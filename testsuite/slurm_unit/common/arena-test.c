@@ -0,0 +1,353 @@
+/* Test of src/common/arena.c
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <src/common/arena.h>
+#include <src/common/list.h>
+#include <src/common/pack.h>
+#include <src/common/xmalloc.h>
+#include <src/common/xstring.h>
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define MSG_STR_CNT	40	/* strings in a job submission */
+#define MSG_ENV_CNT	120	/* environment variables */
+#define MSG_ITERS	20000
+#define MSG_BATCH	1000
+#define THREAD_CNT	4
+#define REC_CNT		5000	/* job queue records */
+#define REC_ITERS	200
+
+/* Shaped like the strings and arrays of a job_desc_msg_t */
+typedef struct {
+	char *str[MSG_STR_CNT];
+	char **env;
+	uint32_t env_cnt;
+	char **argv;
+	uint32_t argc;
+	char *script;
+} fake_msg_t;
+
+static long _usec_since(struct timeval *tv1)
+{
+	struct timeval tv2;
+
+	gettimeofday(&tv2, NULL);
+	return (tv2.tv_sec - tv1->tv_sec) * 1000000 +
+	       (tv2.tv_usec - tv1->tv_usec);
+}
+
+static Buf _pack_fake_msg(void)
+{
+	Buf buffer = init_buf(BUF_SIZE);
+	char *env[MSG_ENV_CNT], *argv[] = { "a.out", "-v", "input" };
+	char *script = xmalloc(4096);
+	int i;
+
+	for (i = 0; i < MSG_STR_CNT; i++) {
+		char str[64];
+		snprintf(str, sizeof(str), "value_of_string_%d", i);
+		packstr(str, buffer);
+	}
+	for (i = 0; i < MSG_ENV_CNT; i++)
+		env[i] = xstrdup_printf("VARIABLE_%d=/some/path/%d", i, i);
+	packstr_array(env, MSG_ENV_CNT, buffer);
+	packstr_array(argv, 3, buffer);
+	memset(script, 'x', 4095);
+	packstr(script, buffer);
+
+	for (i = 0; i < MSG_ENV_CNT; i++)
+		xfree(env[i]);
+	xfree(script);
+	return buffer;
+}
+
+/*
+ * Unpack a message, into its own arena if use_arena is set, as
+ * slurm_receive_msg() does for job submissions
+ */
+static fake_msg_t *_unpack_fake_msg(Buf buffer, bool use_arena)
+{
+	fake_msg_t *msg;
+	arena_t *arena = NULL, *prev = NULL;
+	uint32_t len;
+	int i;
+
+	if (use_arena) {
+		arena = arena_create(16 * 1024);
+		prev = arena_push(arena);
+	}
+	msg = xmalloc(sizeof(fake_msg_t));
+	set_buf_offset(buffer, 0);
+	for (i = 0; i < MSG_STR_CNT; i++)
+		unpackstr_xmalloc(&msg->str[i], &len, buffer);
+	unpackstr_array(&msg->env, &msg->env_cnt, buffer);
+	unpackstr_array(&msg->argv, &msg->argc, buffer);
+	unpackstr_xmalloc(&msg->script, &len, buffer);
+	if (use_arena) {
+		arena_pop(prev);
+		arena_destroy(arena);
+	}
+	return msg;
+}
+
+static void _free_fake_msg(fake_msg_t *msg)
+{
+	int i;
+
+	for (i = 0; i < MSG_STR_CNT; i++)
+		xfree(msg->str[i]);
+	for (i = 0; i < msg->env_cnt; i++)
+		xfree(msg->env[i]);
+	xfree(msg->env);
+	for (i = 0; i < msg->argc; i++)
+		xfree(msg->argv[i]);
+	xfree(msg->argv);
+	xfree(msg->script);
+	xfree(msg);
+}
+
+static void *_free_batch(void *arg)
+{
+	fake_msg_t **msgs = arg;
+	int i;
+
+	for (i = 0; i < MSG_BATCH; i++)
+		_free_fake_msg(msgs[i]);
+	return NULL;
+}
+
+/*
+ * Unpack batches of messages and have another thread free them, as
+ * slurmctld RPC workers receive a message and queue it for another worker
+ */
+static void *_unpack_batches(void *arg)
+{
+	bool use_arena = *(bool *) arg;
+	Buf buffer = _pack_fake_msg();
+	fake_msg_t *msgs[MSG_BATCH];
+	pthread_t tid;
+	int i, j;
+
+	for (i = 0; i < (MSG_ITERS / MSG_BATCH); i++) {
+		for (j = 0; j < MSG_BATCH; j++)
+			msgs[j] = _unpack_fake_msg(buffer, use_arena);
+		pthread_create(&tid, NULL, _free_batch, msgs);
+		pthread_join(tid, NULL);
+	}
+	free_buf(buffer);
+	return NULL;
+}
+
+static long _time_threads(bool use_arena)
+{
+	pthread_t tid[THREAD_CNT];
+	struct timeval tv;
+	int i;
+
+	gettimeofday(&tv, NULL);
+	for (i = 0; i < THREAD_CNT; i++)
+		pthread_create(&tid[i], NULL, _unpack_batches, &use_arena);
+	for (i = 0; i < THREAD_CNT; i++)
+		pthread_join(tid[i], NULL);
+	return _usec_since(&tv);
+}
+
+int
+main(int argc, char *argv[])
+{
+	note("Testing arena_alloc");
+	{
+		arena_t *arena = arena_create(1024);
+		arena_stats_t stats;
+		uint64_t blocks;
+		char *p1, *p2, *p3;
+		int i, ok = 1;
+
+		for (i = 1; (i < 100) && ok; i++) {
+			p1 = arena_alloc(arena, i, true);
+			ok = !((uintptr_t) p1 % 16) && (xsize(p1) == i) &&
+			     arena_owned(p1) && !p1[0] && !p1[i - 1];
+			memset(p1, 'x', i);
+			xfree(p1);
+			ok = ok && !p1;
+		}
+		TEST(ok, "aligned, zeroed and sized");
+		TEST(arena_reset(arena), "reset when all freed");
+		arena_stats(arena, &stats);
+		blocks = stats.blocks;
+
+		p1 = arena_alloc(arena, 100, true);
+		p2 = arena_alloc(arena, 1000, false);
+		p3 = arena_alloc(arena, 100, true);
+		arena_stats(arena, &stats);
+		TEST((stats.allocs == 102) && (stats.frees == 99) &&
+		     (stats.resets == 1),
+		     "alloc and free counts");
+		TEST(!arena_reset(arena), "reset refused while in use");
+		TEST((stats.blocks == blocks + 1) && (p3 == p1 + 128),
+		     "large allocation in a block of its own");
+		xfree(p1);
+		xfree(p2);
+		xfree(p3);
+		TEST(arena_reset(arena), "reset");
+		arena_stats(arena, &stats);
+		TEST(stats.block_bytes == 1024, "reset keeps one block");
+		TEST(arena_alloc(arena, 0, true) == NULL, "zero size");
+		TEST(!arena_owned(NULL), "NULL not owned");
+		arena_destroy(arena);
+	}
+
+	note("Testing arena_push");
+	{
+		arena_t *arena = arena_create(0), *prev;
+		arena_stats_t stats1, stats2;
+		char *str = NULL, *heap, *try;
+		List l;
+		int i;
+
+		prev = arena_push(arena);
+		TEST(prev == NULL, "no arena by default");
+		xstrcat(str, "hello");
+		heap = try_xmalloc(16);
+		TEST(arena_owned(str) && !arena_owned(heap),
+		     "xmalloc from arena, try_xmalloc from heap");
+		for (i = 0; i < 100; i++)
+			xstrcat(str, " world");
+		TEST(arena_owned(str) && (strlen(str) == 605) &&
+		     !strncmp(str, "hello world world", 17),
+		     "xrealloc within arena");
+
+		arena_stats(arena, &stats1);
+		l = list_create(NULL);
+		for (i = 0; i < 1000; i++)
+			list_append(l, heap);
+		FREE_NULL_LIST(l);
+		arena_stats(arena, &stats2);
+		TEST(stats2.allocs == stats1.allocs,
+		     "list objects not from arena");
+		arena_pop(prev);
+		TEST(arena_current == NULL, "pop");
+		try = arena_alloc(arena, 1, false);
+		TEST(arena_owned(try), "still usable");
+		xfree(try);
+
+		xrealloc(str, 8192);
+		TEST(!arena_owned(str) && !strncmp(str, "hello world", 11) &&
+		     !str[8191], "xrealloc moves arena memory to heap");
+		arena_stats(arena, &stats1);
+		TEST(stats1.frees == stats1.allocs,
+		     "xrealloc frees old memory");
+		xfree(str);
+		xfree(heap);
+
+		/* Memory kept beyond arena_destroy() stays valid */
+		prev = arena_push(arena);
+		str = xstrdup("kept");
+		arena_pop(prev);
+		arena_destroy(arena);
+		TEST(!strcmp(str, "kept"), "memory outlives arena_destroy");
+		xfree(str);
+	}
+
+	note("Testing message unpack");
+	{
+		Buf buffer = _pack_fake_msg();
+		arena_t *arena = arena_create(16 * 1024), *prev;
+		arena_stats_t stats;
+		fake_msg_t *msg;
+		struct timeval tv;
+		long usec1, usec2;
+		int i;
+
+		prev = arena_push(arena);
+		msg = _unpack_fake_msg(buffer, false);
+		arena_pop(prev);
+		arena_stats(arena, &stats);
+		TEST(!strcmp(msg->str[7], "value_of_string_7") &&
+		     !strcmp(msg->env[119], "VARIABLE_119=/some/path/119") &&
+		     !msg->env[120] && !strcmp(msg->argv[2], "input") &&
+		     (strlen(msg->script) == 4095) && arena_owned(msg->script),
+		     "unpack into arena");
+		note("message: %"PRIu64" allocations, %"PRIu64" bytes, "
+		     "%"PRIu64" blocks", stats.allocs, stats.bytes,
+		     stats.blocks);
+		_free_fake_msg(msg);
+		TEST(arena_reset(arena), "message freed");
+
+		gettimeofday(&tv, NULL);
+		for (i = 0; i < MSG_ITERS; i++)
+			_free_fake_msg(_unpack_fake_msg(buffer, false));
+		usec1 = _usec_since(&tv);
+		gettimeofday(&tv, NULL);
+		for (i = 0; i < MSG_ITERS; i++)
+			_free_fake_msg(_unpack_fake_msg(buffer, true));
+		usec2 = _usec_since(&tv);
+		note("unpack and free %d messages: %ld usec heap, "
+		     "%ld usec arena", MSG_ITERS, usec1, usec2);
+
+		for (i = 0; i < MSG_ITERS; i++) {
+			prev = arena_push(arena);
+			msg = _unpack_fake_msg(buffer, false);
+			arena_pop(prev);
+			_free_fake_msg(msg);
+			arena_reset(arena);
+		}
+		usec1 = _time_threads(false);
+		usec2 = _time_threads(true);
+		note("unpack and free %d messages in %d threads, freed by "
+		     "others: %ld usec heap, %ld usec arena",
+		     THREAD_CNT * MSG_ITERS, THREAD_CNT, usec1, usec2);
+		arena_stats(arena, &stats);
+		TEST((stats.frees == stats.allocs) &&
+		     (stats.resets == MSG_ITERS + 1), "all messages freed");
+		arena_destroy(arena);
+		free_buf(buffer);
+	}
+
+	note("Testing job queue records");
+	{
+		void **rec = xmalloc(sizeof(void *) * REC_CNT);
+		struct timeval tv;
+		long usec1, usec2;
+		int i, j;
+
+		gettimeofday(&tv, NULL);
+		for (i = 0; i < REC_ITERS; i++) {
+			for (j = 0; j < REC_CNT; j++)
+				rec[j] = xmalloc_nz(32);
+			for (j = 0; j < REC_CNT; j++)
+				xfree(rec[j]);
+		}
+		usec1 = _usec_since(&tv);
+		gettimeofday(&tv, NULL);
+		for (i = 0; i < REC_ITERS; i++) {
+			arena_t *arena = arena_create(0);
+			for (j = 0; j < REC_CNT; j++)
+				rec[j] = arena_alloc(arena, 32, false);
+			arena_destroy(arena);
+			for (j = 0; j < REC_CNT; j++)
+				xfree(rec[j]);
+		}
+		usec2 = _usec_since(&tv);
+		note("%d passes of %d records: %ld usec heap, %ld usec arena",
+		     REC_ITERS, REC_CNT, usec1, usec2);
+		TEST(1, "job queue records");
+		xfree(rec);
+	}
+
+	totals();
+	return failed;
+}
@@ -207,6 +207,122 @@ main(int argc, char *argv[])
 		TEST(bit_equal(bs, bs2), "bitstring");
 	}
 
+	note("Testing whole bitstring operations across word boundaries");
+	{
+		int nbits[] = { 1, 63, 64, 65, 255, 256, 257, 1000 };
+		int i, j;
+
+		for (i = 0; i < (sizeof(nbits) / sizeof(int)); i++) {
+			bitstr_t *bs1 = bit_alloc(nbits[i]);
+			bitstr_t *bs2 = bit_alloc(nbits[i]);
+			int last = nbits[i] - 1, cnt = 0, ok = 1;
+
+			/* Padding bits past the end are set by bit_not() */
+			bit_not(bs1);
+			bit_not(bs2);
+			for (j = 0; j < nbits[i]; j++)
+				bit_clear(bs2, j);
+			TEST(bit_set_count(bs1) == nbits[i], "set_count");
+			TEST(bit_overlap(bs1, bs2) == 0, "overlap");
+			TEST(!bit_overlap_any(bs1, bs2), "overlap_any");
+			TEST(bit_ffs(bs2) == -1, "ffs");
+
+			bit_set(bs2, last);
+			TEST(bit_overlap(bs1, bs2) == 1, "overlap");
+			TEST(bit_overlap_any(bs1, bs2), "overlap_any");
+			TEST(bit_ffs(bs2) == last, "ffs");
+			TEST(bit_super_set(bs2, bs1), "super_set");
+
+			bit_clear_all(bs1);
+			for (j = 0; j < nbits[i]; j += 3) {
+				bit_set(bs1, j);
+				cnt++;
+			}
+			TEST(bit_set_count(bs1) == cnt, "set_count");
+			TEST(bit_overlap(bs1, bs1) == cnt, "overlap");
+			TEST(bit_super_set(bs2, bs1) == (last % 3 == 0),
+			     "super_set");
+			bit_copybits(bs2, bs1);
+			bit_and_not(bs2, bs1);
+			TEST(bit_ffs(bs2) == -1, "and_not");
+			bit_or_not(bs2, bs1);
+			for (j = 0; j < nbits[i]; j++) {
+				if (bit_test(bs2, j) == bit_test(bs1, j))
+					ok = 0;
+			}
+			TEST(ok, "or_not");
+			bit_or(bs2, bs1);
+			TEST(bit_set_count(bs2) == nbits[i], "or");
+			bit_and(bs2, bs1);
+			TEST(bit_equal(bs1, bs2), "and");
+
+			bit_free(bs1);
+			bit_free(bs2);
+		}
+	}
+
+	note("Throughput of whole bitstring operations");
+	{
+		int nbits = 256 * 1024, iters = 2000, i, j, sum = 0;
+		bitstr_t *bs1 = bit_alloc(nbits);
+		bitstr_t *bs2 = bit_alloc(nbits);
+		bitstr_t *bs3 = bit_alloc(nbits);
+		struct timeval tv1, tv2;
+		long usec;
+		char *op_name[] = { "and", "or", "not", "set_count",
+				    "overlap", "overlap_any", "super_set",
+				    "ffs" };
+
+		/* Operations on bs3 scan to its only bit, the last one */
+		for (i = 0; i < nbits; i += 7)
+			bit_set(bs1, i);
+		bit_set(bs3, nbits - 1);
+
+		for (j = 0; j < (sizeof(op_name) / sizeof(char *)); j++) {
+			gettimeofday(&tv1, NULL);
+			for (i = 0; i < iters; i++) {
+				switch (j) {
+				case 0:
+					bit_and(bs2, bs1);
+					break;
+				case 1:
+					bit_or(bs2, bs1);
+					break;
+				case 2:
+					bit_not(bs2);
+					break;
+				case 3:
+					sum += bit_set_count(bs1);
+					break;
+				case 4:
+					sum += bit_overlap(bs1, bs2);
+					break;
+				case 5:
+					sum += bit_overlap_any(bs1, bs3);
+					break;
+				case 6:
+					sum += bit_super_set(bs3, bs1);
+					break;
+				case 7:
+					sum += bit_ffs(bs3);
+					break;
+				}
+			}
+			gettimeofday(&tv2, NULL);
+			usec = (tv2.tv_sec - tv1.tv_sec) * 1000000 +
+			       (tv2.tv_usec - tv1.tv_usec);
+			note("%-12s %d bits x %d: %ld usec, %.1f Gbit/s",
+			     op_name[j], nbits, iters, usec,
+			     usec ? ((double) nbits * iters / usec / 1000) :
+			     0.0);
+		}
+		TEST(sum != 0, "throughput");
+
+		bit_free(bs1);
+		bit_free(bs2);
+		bit_free(bs3);
+	}
+
 	totals();
 	return failed;
 }
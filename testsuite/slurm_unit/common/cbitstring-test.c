@@ -0,0 +1,284 @@
+/* Test of src/common/cbitstring.c
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <slurm/slurm_errno.h>
+#include <src/common/cbitstring.h>
+#include <src/common/pack.h>
+#include <src/common/xmalloc.h>
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+/* Return 1 if cb holds exactly the bits of bs */
+static int _same_bits(cbitstr_t *cb, bitstr_t *bs)
+{
+	bitoff_t i;
+
+	if (cbit_size(cb) != bit_size(bs))
+		return 0;
+	for (i = 0; i < bit_size(bs); i++) {
+		if (cbit_test(cb, i) != (bit_test(bs, i) ? 1 : 0))
+			return 0;
+	}
+	return 1;
+}
+
+int
+main(int argc, char *argv[])
+{
+	note("Testing basic functions");
+	{
+		cbitstr_t *cb = cbit_alloc(100);
+		char buf[64];
+
+		TEST(cbit_size(cb) == 100, "size");
+		TEST(cbit_ffs(cb) == -1, "ffs of empty");
+		TEST(cbit_fls(cb) == -1, "fls of empty");
+		TEST(cbit_inx(cb)[0] == -1, "inx of empty");
+
+		cbit_set(cb, 9);
+		cbit_set(cb, 14);
+		cbit_set(cb, 10);
+		TEST(cbit_test(cb, 9), "bit 9 set");
+		TEST(!cbit_test(cb, 12), "bit 12 not set");
+		TEST(cbit_test(cb, 14), "bit 14 set");
+		TEST(cbit_run_count(cb) == 2, "adjacent bits merged");
+
+		cbit_nset(cb, 11, 13);
+		TEST(cbit_run_count(cb) == 1, "gap filled");
+		TEST(cbit_set_count(cb) == 6, "set count");
+		TEST(cbit_ffs(cb) == 9, "ffs");
+		TEST(cbit_fls(cb) == 14, "fls");
+
+		cbit_clear(cb, 12);
+		TEST(cbit_run_count(cb) == 2, "run split");
+		TEST(!strcmp(cbit_fmt(buf, sizeof(buf), cb), "9-11,13-14"),
+		     "fmt");
+
+		cbit_nset(cb, 0, 99);
+		TEST(cbit_run_count(cb) == 1, "all set");
+		TEST(cbit_set_count(cb) == 100, "all set count");
+		cbit_nclear(cb, 0, 0);
+		cbit_nclear(cb, 99, 99);
+		cbit_nclear(cb, 40, 59);
+		TEST(!strcmp(cbit_fmt(buf, sizeof(buf), cb), "1-39,60-98"),
+		     "clear ends and middle");
+		cbit_clear_all(cb);
+		TEST(cbit_ffs(cb) == -1, "clear all");
+		cbit_free(cb);
+	}
+
+	note("Testing set operations");
+	{
+		cbitstr_t *cb1 = cbit_alloc(64), *cb2 = cbit_alloc(64);
+		cbitstr_t *cb3;
+		char buf[64];
+
+		cbit_nset(cb1, 0, 9);
+		cbit_nset(cb1, 20, 29);
+		cbit_nset(cb2, 5, 24);
+		cbit_set(cb2, 63);
+
+		TEST(cbit_overlap(cb1, cb2) == 10, "overlap");
+		TEST(!cbit_super_set(cb1, cb2), "not super set");
+
+		cb3 = cbit_copy(cb1);
+		TEST(cbit_equal(cb1, cb3), "copy equal");
+		cbit_and(cb3, cb2);
+		TEST(!strcmp(cbit_fmt(buf, sizeof(buf), cb3), "5-9,20-24"),
+		     "and");
+		TEST(cbit_super_set(cb3, cb2), "super set");
+		TEST(cbit_super_set(cb3, cb1), "super set of source");
+		cbit_free(cb3);
+
+		cb3 = cbit_copy(cb1);
+		cbit_and_not(cb3, cb2);
+		TEST(!strcmp(cbit_fmt(buf, sizeof(buf), cb3), "0-4,25-29"),
+		     "and_not");
+		cbit_free(cb3);
+
+		cb3 = cbit_copy(cb1);
+		cbit_or(cb3, cb2);
+		TEST(!strcmp(cbit_fmt(buf, sizeof(buf), cb3), "0-29,63"),
+		     "or");
+		TEST(!cbit_equal(cb1, cb3), "not equal");
+		cbit_free(cb3);
+
+		cbit_free(cb1);
+		cbit_free(cb2);
+	}
+
+	note("Testing random operations against bitstr_t");
+	{
+		int nbits = 300, i, ok = 1;
+		bitstr_t *bs1 = bit_alloc(nbits), *bs2 = bit_alloc(nbits);
+		bitstr_t *bs3;
+		cbitstr_t *cb1 = cbit_alloc(nbits), *cb2 = cbit_alloc(nbits);
+		cbitstr_t *cb3;
+
+		srand(1);
+		for (i = 0; (i < 2000) && ok; i++) {
+			int start = rand() % nbits;
+			int stop = start + rand() % (nbits - start);
+
+			switch (rand() % 4) {
+			case 0:
+				bit_nset(bs1, start, stop);
+				cbit_nset(cb1, start, stop);
+				break;
+			case 1:
+				bit_nclear(bs1, start, stop);
+				cbit_nclear(cb1, start, stop);
+				break;
+			case 2:
+				bit_nset(bs2, start, stop);
+				cbit_nset(cb2, start, stop);
+				break;
+			case 3:
+				bit_nclear(bs2, start, stop);
+				cbit_nclear(cb2, start, stop);
+				break;
+			}
+			ok = _same_bits(cb1, bs1) && _same_bits(cb2, bs2);
+			if (!ok)
+				break;
+
+			ok = (cbit_set_count(cb1) == bit_set_count(bs1)) &&
+			     (cbit_overlap(cb1, cb2) == bit_overlap(bs1, bs2)) &&
+			     (cbit_super_set(cb1, cb2) ==
+			      bit_super_set(bs1, bs2)) &&
+			     (cbit_ffs(cb1) == bit_ffs(bs1)) &&
+			     (cbit_fls(cb1) == bit_fls(bs1));
+
+			cb3 = cbit_copy(cb1);
+			bs3 = bit_copy(bs1);
+			switch (i % 3) {
+			case 0:
+				cbit_and(cb3, cb2);
+				bit_and(bs3, bs2);
+				break;
+			case 1:
+				cbit_and_not(cb3, cb2);
+				bit_and_not(bs3, bs2);
+				break;
+			case 2:
+				cbit_or(cb3, cb2);
+				bit_or(bs3, bs2);
+				break;
+			}
+			ok = ok && _same_bits(cb3, bs3);
+			cbit_free(cb3);
+			bit_free(bs3);
+		}
+		TEST(ok, "random operations match bitstr_t");
+
+		cb3 = cbit_from_bitstr(bs1);
+		TEST(cbit_equal(cb3, cb1), "from_bitstr");
+		bs3 = cbit_to_bitstr(cb1);
+		TEST(bit_equal(bs3, bs1), "to_bitstr");
+		cbit_free(cb3);
+		bit_free(bs3);
+
+		bit_free(bs1);
+		bit_free(bs2);
+		cbit_free(cb1);
+		cbit_free(cb2);
+	}
+
+	note("Testing pack/unpack");
+	{
+		Buf buffer = init_buf(1024);
+		cbitstr_t *cb1 = cbit_alloc(1000), *cb2 = NULL;
+		uint32_t bad[] = { 10, 5 };
+
+		cbit_nset(cb1, 3, 7);
+		cbit_nset(cb1, 500, 999);
+		pack_cbitstr(cb1, buffer);
+		pack_cbitstr(NULL, buffer);
+		pack32(1000, buffer);
+		pack32_array(bad, 2, buffer);
+		set_buf_offset(buffer, 0);
+
+		TEST(unpack_cbitstr(&cb2, buffer) == SLURM_SUCCESS,
+		     "unpack");
+		TEST(cb2 && cbit_equal(cb1, cb2), "unpack equal");
+		FREE_NULL_CBITMAP(cb2);
+		TEST((unpack_cbitstr(&cb2, buffer) == SLURM_SUCCESS) && !cb2,
+		     "unpack NULL");
+		TEST(unpack_cbitstr(&cb2, buffer) == SLURM_ERROR,
+		     "unpack rejects reversed run");
+
+		cbit_free(cb1);
+		free_buf(buffer);
+	}
+
+	note("Testing bitstr_t pack as cbitstr_t, unpack as inx");
+	{
+		Buf buffer = init_buf(1024);
+		bitstr_t *bs = bit_alloc(1000), *empty = bit_alloc(10);
+		cbitstr_t *cb = NULL;
+		int32_t *inx = NULL;
+
+		bit_nset(bs, 3, 7);
+		bit_set(bs, 999);
+		pack_bitstr_as_cbitstr(bs, buffer);
+		pack_bitstr_as_cbitstr(bs, buffer);
+		pack_bitstr_as_cbitstr(empty, buffer);
+		pack_bitstr_as_cbitstr(NULL, buffer);
+		set_buf_offset(buffer, 0);
+
+		TEST((unpack_cbitstr(&cb, buffer) == SLURM_SUCCESS) &&
+		     cb && _same_bits(cb, bs), "unpack as cbitstr_t");
+		FREE_NULL_CBITMAP(cb);
+		TEST((unpack_cbitstr_as_inx(&inx, buffer) == SLURM_SUCCESS) &&
+		     (inx[0] == 3) && (inx[1] == 7) && (inx[2] == 999) &&
+		     (inx[3] == 999) && (inx[4] == -1), "unpack as inx");
+		xfree(inx);
+		TEST((unpack_cbitstr_as_inx(&inx, buffer) == SLURM_SUCCESS) &&
+		     (inx[0] == -1), "unpack empty as inx");
+		xfree(inx);
+		TEST((unpack_cbitstr_as_inx(&inx, buffer) == SLURM_SUCCESS) &&
+		     (inx[0] == -1), "unpack NULL as inx");
+		xfree(inx);
+
+		bit_free(bs);
+		bit_free(empty);
+		free_buf(buffer);
+	}
+
+	note("Memory used by 100000 two node job allocations");
+	{
+		int nodes = 20000, jobs = 100000, i, node;
+		size_t dense = 0, compressed = 0;
+		bitstr_t *bs;
+		cbitstr_t *cb;
+
+		/* Placement varies, half of the jobs get contiguous nodes */
+		srand(1);
+		for (i = 0; i < jobs; i++) {
+			bs = bit_alloc(nodes);
+			node = rand() % (nodes - 1);
+			bit_set(bs, node);
+			bit_set(bs, (i % 2) ? node + 1 : rand() % nodes);
+			cb = cbit_from_bitstr(bs);
+			dense += bit_size(bs) / 8;
+			compressed += cbit_mem_size(cb);
+			bit_free(bs);
+			cbit_free(cb);
+		}
+		note("bitstr_t: %zu bytes, cbitstr_t: %zu bytes",
+		     dense, compressed);
+		TEST(compressed < (dense / 10), "compressed memory");
+	}
+
+	totals();
+	return failed;
+}
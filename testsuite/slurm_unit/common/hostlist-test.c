@@ -0,0 +1,281 @@
+/* Test of src/common/hostlist.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <src/common/hostlist.h>
+#include <src/common/xmalloc.h>
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+static long _usec_since(struct timeval *tv1)
+{
+	struct timeval tv2;
+
+	gettimeofday(&tv2, NULL);
+	return (tv2.tv_sec - tv1->tv_sec) * 1000000 +
+	       (tv2.tv_usec - tv1->tv_usec);
+}
+
+/* Return a hostlist of nhosts hosts "n<i>", i = first, first + 2, ... */
+static hostlist_t _fragmented(int nhosts, int first)
+{
+	hostlist_t hl = hostlist_create(NULL);
+	char name[32];
+	int i;
+
+	for (i = 0; i < nhosts; i++) {
+		snprintf(name, sizeof(name), "n%d", first + i * 2);
+		hostlist_push_host(hl, name);
+	}
+	return hl;
+}
+
+int
+main(int argc, char *argv[])
+{
+	note("Testing hostlist_find");
+	{
+		hostlist_t hl = _fragmented(1000, 1);
+		char *name;
+		int i, ok = 1;
+
+		TEST(hostlist_count(hl) == 1000, "count");
+		for (i = 0; (i < 1000) && ok; i += 7) {
+			name = hostlist_nth(hl, i);
+			ok = (hostlist_find(hl, name) == i);
+			free(name);
+		}
+		TEST(ok, "find returns position");
+		TEST(hostlist_find(hl, "n2") == -1, "find missing host");
+		TEST(hostlist_find(hl, "n01") == -1, "find wrong width");
+		TEST(hostlist_find(hl, "m1") == -1, "find wrong prefix");
+		TEST(hostlist_find(hl, "n") == -1, "find prefix only");
+
+		TEST(hostlist_delete_host(hl, "n501") == 1, "delete host");
+		TEST(hostlist_find(hl, "n501") == -1, "find deleted host");
+		TEST(hostlist_find(hl, "n503") == 250, "find after delete");
+		TEST(hostlist_find(hl, "n503") == 250, "find after delete");
+		TEST(hostlist_count(hl) == 999, "count after delete");
+		hostlist_push_host(hl, "n4");
+		TEST(hostlist_find(hl, "n4") == 999, "find after push");
+		hostlist_push_host(hl, "alpha");
+		hostlist_push_host(hl, "n6");
+		hostlist_push_host(hl, "alpha");
+		TEST(hostlist_find(hl, "alpha") == 1000, "find single host");
+		TEST(hostlist_find(hl, "alpha") == 1000, "find single host");
+		TEST(hostlist_find(hl, "n6") == 1001, "find after push");
+		hostlist_destroy(hl);
+	}
+	{
+		hostlist_t hl = hostlist_create(
+			"alpha,n[1-10],beta,n[20-30],x[1-2],x[4-5],x[7-8],"
+			"x[10-11],n[5-25],alpha,n005");
+		char *name;
+		int i, ok = 1;
+
+		for (i = 0; (i < 3) && ok; i++) {
+			ok = (hostlist_find(hl, "alpha") == 0) &&
+			     (hostlist_find(hl, "n7") == 7) &&
+			     (hostlist_find(hl, "n22") == 14) &&
+			     (hostlist_find(hl, "n15") == 41) &&
+			     (hostlist_find(hl, "x11") == 30) &&
+			     (hostlist_find(hl, "n005") == 53) &&
+			     (hostlist_find(hl, "beta") == 11);
+		}
+		TEST(ok, "find in overlapping ranges");
+		hostlist_uniq(hl);
+		TEST(hostlist_count(hl) == 41, "uniq count");
+		for (i = 0; (i < hostlist_count(hl)) && ok; i++) {
+			name = hostlist_nth(hl, i);
+			ok = (hostlist_find(hl, name) == i);
+			free(name);
+		}
+		TEST(ok, "find after uniq");
+		hostlist_destroy(hl);
+	}
+	{
+		hostlist_t hl = hostlist_create(
+			"nid0000[2-7],nid0001[0-9],nid00[100-110],nid00200,"
+			"nid00202,nid00204,nid00206,nid00208,nid00210");
+		int i, ok = 1;
+
+		for (i = 0; (i < 3) && ok; i++) {
+			ok = (hostlist_find(hl, "nid00003") == 1) &&
+			     (hostlist_find(hl, "nid00012") == 8) &&
+			     (hostlist_find(hl, "nid00105") == 21) &&
+			     (hostlist_find(hl, "nid00206") == 30) &&
+			     (hostlist_find(hl, "nid00020") == -1);
+		}
+		TEST(ok, "find with digits in prefix");
+		hostlist_destroy(hl);
+	}
+
+	note("Testing hostlist_uniq and hostset_insert");
+	{
+		hostlist_t hl = hostlist_create(NULL);
+		hostset_t hs;
+		char name[32], *str;
+		int i;
+
+		for (i = 0; i < 1000; i++) {
+			snprintf(name, sizeof(name), "n%d", (i * 7) % 500);
+			hostlist_push_host(hl, name);
+		}
+		hostlist_push_host(hl, "login");
+		hostlist_uniq(hl);
+		str = hostlist_ranged_string_xmalloc(hl);
+		TEST(!strcmp(str, "login,n[0-499]"), "uniq");
+		TEST(hostlist_count(hl) == 501, "uniq count");
+		xfree(str);
+		hostlist_destroy(hl);
+
+		hs = hostset_create("n[1-10,20-30],login");
+		TEST(hostset_insert(hs, "n[5-25],a1,login") == 10,
+		     "hostset_insert count");
+		TEST(hostset_count(hs) == 32, "hostset count");
+		hostset_ranged_string(hs, sizeof(name), name);
+		TEST(!strcmp(name, "a1,login,n[1-30]"), "hostset_insert");
+		TEST(hostset_within(hs, "n[3-28]"), "hostset_within");
+		TEST(!hostset_within(hs, "n[3-31]"), "not hostset_within");
+		hostset_destroy(hs);
+	}
+
+	note("Testing hostlist_next_buf");
+	{
+		hostlist_t hl = hostlist_create("a,n[08-11],b[1-2]");
+		hostlist_iterator_t i1 = hostlist_iterator_create(hl);
+		hostlist_iterator_t i2 = hostlist_iterator_create(hl);
+		char buf[HOSTLIST_NAME_SIZE], small[3], *name;
+		int len, ok = 1, cnt = 0;
+
+		while ((name = hostlist_next(i1))) {
+			len = hostlist_next_buf(i2, buf, sizeof(buf));
+			ok = ok && (len == strlen(name)) && !strcmp(buf, name);
+			free(name);
+			cnt++;
+		}
+		TEST(ok && (cnt == 7), "next_buf matches next");
+		TEST(hostlist_next_buf(i2, buf, sizeof(buf)) == -1,
+		     "next_buf at end");
+		hostlist_iterator_reset(i2);
+		TEST(hostlist_next_buf(i2, small, sizeof(small)) == 1,
+		     "next_buf fits");
+		TEST(hostlist_next_buf(i2, small, sizeof(small)) == -1,
+		     "next_buf too small");
+		hostlist_iterator_destroy(i1);
+		hostlist_iterator_destroy(i2);
+		hostlist_destroy(hl);
+	}
+
+	note("Timing operations on 50000 host lists");
+	{
+		int nhosts = 50000, iters = 2000, i, j, sum = 0;
+		hostlist_t hl, hl2;
+		hostlist_iterator_t hi;
+		hostset_t hs;
+		struct timeval tv;
+		char name[32], *str, *host;
+		long usec1, usec2;
+
+		/* Every other host, so each host is a range of its own */
+		hl = _fragmented(nhosts, 1);
+		gettimeofday(&tv, NULL);
+		for (i = 0; i < iters; i++) {
+			/* A change to the list forces the linear search */
+			hostlist_push_host(hl, "login");
+			snprintf(name, sizeof(name), "n%d",
+				 1 + ((i * 7919) % nhosts) * 2);
+			sum += (hostlist_find(hl, name) >= 0);
+		}
+		usec1 = _usec_since(&tv) / iters;
+		gettimeofday(&tv, NULL);
+		for (i = 0; i < nhosts; i++) {
+			snprintf(name, sizeof(name), "n%d",
+				 1 + ((i * 7919) % nhosts) * 2);
+			sum += (hostlist_find(hl, name) >= 0);
+		}
+		usec2 = _usec_since(&tv);
+		note("find in %d ranges: %ld usec linear, %.3f usec indexed",
+		     nhosts, usec1, (double) usec2 / nhosts);
+		TEST(sum == (iters + nhosts), "find all hosts");
+
+		gettimeofday(&tv, NULL);
+		for (i = 0, j = 0; i < nhosts; i += 10) {
+			snprintf(name, sizeof(name), "n%d", 1 + i * 2);
+			j += hostlist_delete_host(hl, name);
+		}
+		note("delete %d hosts: %ld usec", j, _usec_since(&tv));
+		TEST(hostlist_count(hl) == (nhosts - nhosts / 10 + iters),
+		     "delete hosts");
+		hostlist_destroy(hl);
+
+		/* Hosts out of order, with duplicates */
+		hl = hostlist_create(NULL);
+		for (i = 0; i < nhosts; i++) {
+			snprintf(name, sizeof(name), "n%d",
+				 (i * 7919) % (nhosts / 2));
+			hostlist_push_host(hl, name);
+		}
+		gettimeofday(&tv, NULL);
+		hostlist_uniq(hl);
+		usec1 = _usec_since(&tv);
+		str = hostlist_ranged_string_xmalloc(hl);
+		note("uniq %d ranges: %ld usec", nhosts, usec1);
+		snprintf(name, sizeof(name), "n[0-%d]", nhosts / 2 - 1);
+		TEST(!strcmp(str, name), "uniq of 50000 ranges");
+		xfree(str);
+		hostlist_destroy(hl);
+
+		/* Merge the even hosts into the odd ones */
+		hl = _fragmented(nhosts / 2, 1);
+		str = hostlist_ranged_string_xmalloc(hl);
+		hs = hostset_create(str);
+		xfree(str);
+		hostlist_destroy(hl);
+		hl = _fragmented(nhosts / 2, 2);
+		str = hostlist_ranged_string_xmalloc(hl);
+		gettimeofday(&tv, NULL);
+		j = hostset_insert(hs, str);
+		usec1 = _usec_since(&tv);
+		note("hostset_insert of %d ranges into %d ranges: %ld usec",
+		     nhosts / 2, nhosts / 2, usec1);
+		TEST((j == (nhosts / 2)) && (hostset_count(hs) == nhosts),
+		     "hostset_insert of 25000 ranges");
+		xfree(str);
+		hostset_destroy(hs);
+		hl2 = _fragmented(nhosts / 2, 1);
+		hostlist_push_list(hl, hl2);
+		hostlist_destroy(hl2);
+
+		gettimeofday(&tv, NULL);
+		hi = hostlist_iterator_create(hl);
+		for (i = 0; (host = hostlist_next(hi)); i++)
+			free(host);
+		hostlist_iterator_destroy(hi);
+		usec1 = _usec_since(&tv);
+		gettimeofday(&tv, NULL);
+		hi = hostlist_iterator_create(hl);
+		for (j = 0; hostlist_next_buf(hi, name, sizeof(name)) >= 0;
+		     j++)
+			;
+		hostlist_iterator_destroy(hi);
+		usec2 = _usec_since(&tv);
+		note("iterate %d hosts: %ld usec next, %ld usec next_buf",
+		     i, usec1, usec2);
+		TEST((i == nhosts) && (j == nhosts), "iterate 50000 hosts");
+		hostlist_destroy(hl);
+	}
+
+	totals();
+	return failed;
+}
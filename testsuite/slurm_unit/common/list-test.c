@@ -0,0 +1,165 @@
+/* Test of src/common/list.c
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <src/common/list.h>
+#include <src/common/xmalloc.h>
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define THREAD_CNT	32
+#define CHURN_ITERS	20000
+#define CHURN_ITEMS	16
+
+static int _cmp_int(void *x, void *y)
+{
+	return *(int *) *(void **) x - *(int *) *(void **) y;
+}
+
+static int _find_int(void *x, void *key)
+{
+	return (*(int *) x == *(int *) key);
+}
+
+static int _sum_int(void *x, void *arg)
+{
+	*(int *) arg += *(int *) x;
+	return 0;
+}
+
+/* Return 1 if the ints in l are exactly expect[0..cnt-1] */
+static int _list_is(List l, int *expect, int cnt)
+{
+	ListIterator itr = list_iterator_create(l);
+	int *x, n = 0, ok = 1;
+
+	while ((x = list_next(itr))) {
+		if ((n >= cnt) || (*x != expect[n]))
+			ok = 0;
+		n++;
+	}
+	list_iterator_destroy(itr);
+	return ok && (n == cnt) && (list_count(l) == cnt);
+}
+
+/* Build, walk and tear down small lists, as slurmctld does with job queues
+ * and preemption candidates */
+static void *_churn(void *arg)
+{
+	int unlocked = *(int *) arg, i, j, sum;
+	static int items[CHURN_ITEMS];
+	ListIterator itr;
+	List l;
+
+	for (i = 0; i < CHURN_ITERS; i++) {
+		l = unlocked ? list_create_unlocked(NULL) : list_create(NULL);
+		for (j = 0; j < CHURN_ITEMS; j++)
+			list_append(l, &items[j]);
+		itr = list_iterator_create(l);
+		for (sum = 0; list_next(itr); sum++)
+			;
+		list_iterator_destroy(itr);
+		if (sum != CHURN_ITEMS)
+			return (void *) 1;
+		list_destroy(l);
+	}
+	return NULL;
+}
+
+static long _churn_usec(int unlocked, int *errors)
+{
+	pthread_t threads[THREAD_CNT];
+	struct timeval tv1, tv2;
+	void *rc;
+	int i;
+
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < THREAD_CNT; i++)
+		pthread_create(&threads[i], NULL, _churn, &unlocked);
+	for (i = 0; i < THREAD_CNT; i++) {
+		pthread_join(threads[i], &rc);
+		*errors += (rc != NULL);
+	}
+	gettimeofday(&tv2, NULL);
+	return (tv2.tv_sec - tv1.tv_sec) * 1000000 +
+	       (tv2.tv_usec - tv1.tv_usec);
+}
+
+int
+main(int argc, char *argv[])
+{
+	int vals[] = { 5, 3, 8, 1, 9, 2 };
+	int i, unlocked;
+
+	for (unlocked = 0; unlocked < 2; unlocked++) {
+		List l;
+		ListIterator itr;
+		int *x, sum = 0, key;
+
+		note(unlocked ? "Testing unlocked list" : "Testing list");
+		l = unlocked ? list_create_unlocked(NULL) : list_create(NULL);
+		TEST(list_is_empty(l), "empty");
+		for (i = 0; i < 6; i++)
+			list_append(l, &vals[i]);
+		TEST(_list_is(l, (int []) { 5, 3, 8, 1, 9, 2 }, 6), "append");
+		list_sort(l, _cmp_int);
+		TEST(_list_is(l, (int []) { 1, 2, 3, 5, 8, 9 }, 6), "sort");
+
+		key = 5;
+		TEST(list_find_first(l, _find_int, &key) == &vals[0],
+		     "find_first");
+		list_for_each(l, _sum_int, &sum);
+		TEST(sum == 28, "for_each");
+
+		itr = list_iterator_create(l);
+		while ((x = list_next(itr))) {
+			if (*x == 3)
+				list_remove(itr);
+			else if (*x == 8)
+				list_insert(itr, &vals[5]);
+		}
+		list_iterator_destroy(itr);
+		TEST(_list_is(l, (int []) { 1, 2, 5, 2, 8, 9 }, 6),
+		     "iterator insert and remove");
+
+		key = 2;
+		TEST(list_delete_all(l, _find_int, &key) == 2, "delete_all");
+		list_push(l, &vals[1]);
+		list_enqueue(l, &vals[3]);
+		TEST(_list_is(l, (int []) { 3, 1, 5, 8, 9, 1 }, 6),
+		     "push and enqueue");
+		TEST((list_pop(l) == &vals[1]) &&
+		     (list_dequeue(l) == &vals[3]) &&
+		     (list_peek(l) == &vals[0]), "pop and dequeue");
+		TEST(list_flush(l) == 4, "flush");
+		TEST(list_is_empty(l), "empty after flush");
+		list_destroy(l);
+	}
+
+	note("Timing list churn in %d threads", THREAD_CNT);
+	for (unlocked = 0; unlocked < 2; unlocked++) {
+		int errors = 0;
+		long usec = _churn_usec(unlocked, &errors);
+
+		note("%s lists: %d lists of %d items in %ld usec, "
+		     "%.2f M items/sec", unlocked ? "unlocked" : "locked",
+		     THREAD_CNT * CHURN_ITERS, CHURN_ITEMS, usec,
+		     (double) THREAD_CNT * CHURN_ITERS * CHURN_ITEMS / usec);
+		TEST(errors == 0, unlocked ? "unlocked list churn" :
+					     "locked list churn");
+	}
+
+	totals();
+	return failed;
+}
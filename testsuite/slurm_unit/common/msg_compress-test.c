@@ -0,0 +1,279 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_interface.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+/*
+ * Messages are sent over a socket pair. Bodies of at least
+ * CommunicationParameters=CompressMsgSize bytes must go out with
+ * SLURM_MSG_COMPRESSED set when built with lz4, smaller bodies and bodies for
+ * receivers that did not ask for it must not, and slurm_receive_msg() must
+ * give back the original message either way.
+ */
+
+#define COMPRESS_MSG_SIZE 1024
+#define TIMEOUT 5000
+
+static char conf_file[] = "/tmp/msg_compress_conf.XXXXXX";
+static char *big_text = NULL;
+static char *small_text = "short message";
+
+static void _write_conf(void)
+{
+	char *conf = NULL;
+	int fd;
+
+	xstrfmtcat(conf,
+		   "ClusterName=msg_compress\n"
+		   "SlurmctldHost=localhost\n"
+		   "AuthType=auth/none\n"
+		   "CommunicationParameters=CompressMsgSize=%d\n"
+		   "PluginDir=%s/src/plugins/auth/none/.libs\n"
+		   "NodeName=n1\n"
+		   "PartitionName=p Nodes=n1\n",
+		   COMPRESS_MSG_SIZE, ABS_TOP_BUILDDIR);
+	if ((fd = mkstemp(conf_file)) < 0) {
+		perror("mkstemp");
+		exit(EXIT_FAILURE);
+	}
+	if (write(fd, conf, strlen(conf)) != strlen(conf)) {
+		perror("write");
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+	xfree(conf);
+	setenv("SLURM_CONF", conf_file, 1);
+}
+
+/* Send a SRUN_USER_MSG carrying text from fd, return the send rc */
+static int _send(int fd, char *text, uint16_t flags)
+{
+	slurm_msg_t msg;
+	srun_user_msg_t user_msg;
+
+	user_msg.job_id = 1234;
+	user_msg.msg = text;
+	slurm_msg_t_init(&msg);
+	msg.msg_type = SRUN_USER_MSG;
+	msg.data = &user_msg;
+	msg.flags = flags;
+
+	return slurm_send_node_msg(fd, &msg);
+}
+
+/* Read one message from fd without unpacking it, return its header */
+static char *_recv_raw(int fd, size_t *len, header_t *header)
+{
+	char *data = NULL;
+	Buf buffer;
+	int rc;
+
+	if (slurm_msg_recvfrom_timeout(fd, &data, len, 0, TIMEOUT) < 0)
+		return NULL;
+	buffer = init_buf(*len);
+	memcpy(get_buf_data(buffer), data, *len);
+	rc = unpack_header(header, buffer);
+	free_buf(buffer);
+	if (rc)
+		xfree(data);
+	return data;
+}
+
+/* Receive a message from fd, return the srun_user_msg_t text it carries */
+static char *_recv_text(int fd)
+{
+	slurm_msg_t msg;
+	srun_user_msg_t *user_msg;
+	char *text = NULL;
+
+	slurm_msg_t_init(&msg);
+	if (slurm_receive_msg(fd, &msg, TIMEOUT))
+		return NULL;
+	if (msg.msg_type == SRUN_USER_MSG) {
+		user_msg = msg.data;
+		text = xstrdup(user_msg->msg);
+	}
+	slurm_free_msg_members(&msg);
+	return text;
+}
+
+/* Send text with flags and return the header it was sent with */
+static void _send_header(char *text, uint16_t flags, header_t *header)
+{
+	int fd[2];
+	size_t len;
+	char *data;
+
+	ck_assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, fd));
+	ck_assert(_send(fd[0], text, flags) >= 0);
+	data = _recv_raw(fd[1], &len, header);
+	ck_assert(data != NULL);
+	ck_assert(header->body_length < len);
+	xfree(data);
+	close(fd[0]);
+	close(fd[1]);
+}
+
+/*****************************************************************************
+ * UNIT TESTS                                                                *
+ ****************************************************************************/
+
+START_TEST(compress_conf)
+{
+	ck_assert_int_eq(compress_msg_size, COMPRESS_MSG_SIZE);
+}
+END_TEST
+
+START_TEST(compress_large)
+{
+	header_t header;
+
+	_send_header(big_text, SLURM_MSG_ACCEPT_COMPRESS, &header);
+#if HAVE_LZ4
+	ck_assert(header.flags & SLURM_MSG_COMPRESSED);
+	ck_assert(header.body_length < strlen(big_text));
+#else
+	ck_assert(!(header.flags & SLURM_MSG_COMPRESSED));
+#endif
+}
+END_TEST
+
+START_TEST(compress_small)
+{
+	header_t header;
+
+	_send_header(small_text, SLURM_MSG_ACCEPT_COMPRESS, &header);
+	ck_assert(!(header.flags & SLURM_MSG_COMPRESSED));
+}
+END_TEST
+
+START_TEST(compress_not_accepted)
+{
+	header_t header;
+
+	_send_header(big_text, 0, &header);
+	ck_assert(!(header.flags & SLURM_MSG_COMPRESSED));
+}
+END_TEST
+
+START_TEST(compress_disabled)
+{
+	uint32_t save_size = compress_msg_size;
+	header_t header;
+
+	compress_msg_size = 0;
+	_send_header(big_text, SLURM_MSG_ACCEPT_COMPRESS, &header);
+	compress_msg_size = save_size;
+	ck_assert(!(header.flags & SLURM_MSG_COMPRESSED));
+}
+END_TEST
+
+START_TEST(round_trip)
+{
+	char *texts[] = { big_text, small_text };
+	char *text;
+	int fd[2], i;
+
+	ck_assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, fd));
+	for (i = 0; i < 2; i++) {
+		ck_assert(_send(fd[0], texts[i], SLURM_MSG_ACCEPT_COMPRESS) >=
+			  0);
+		text = _recv_text(fd[1]);
+		ck_assert(text != NULL);
+		ck_assert_str_eq(text, texts[i]);
+		xfree(text);
+	}
+	close(fd[0]);
+	close(fd[1]);
+}
+END_TEST
+
+/* A compressed body must not be trusted for its uncompressed size */
+START_TEST(uncompress_corrupt)
+{
+	header_t header;
+	uint32_t size;
+	size_t len;
+	char *data;
+	int fd[2];
+
+	ck_assert(!socketpair(AF_UNIX, SOCK_STREAM, 0, fd));
+	ck_assert(_send(fd[0], big_text, SLURM_MSG_ACCEPT_COMPRESS) >= 0);
+	data = _recv_raw(fd[1], &len, &header);
+	ck_assert(data != NULL);
+	if (header.flags & SLURM_MSG_COMPRESSED) {
+		size = htonl(0xffffffff);
+		memcpy(data + len - header.body_length, &size, sizeof(size));
+	} else {
+		/* Claim a compressed body the receiver cannot read */
+		Buf buffer = create_buf(data, len);
+		header.flags |= SLURM_MSG_COMPRESSED;
+		pack_header(&header, buffer);
+		data = xfer_buf_data(buffer);
+	}
+	ck_assert(slurm_msg_sendto(fd[0], data, len) == len);
+	ck_assert(_recv_text(fd[1]) == NULL);
+	xfree(data);
+	close(fd[0]);
+	close(fd[1]);
+}
+END_TEST
+
+/*****************************************************************************
+ * TEST SUITE                                                                *
+ ****************************************************************************/
+
+Suite* suite(void)
+{
+	Suite* s = suite_create("Message compression");
+	TCase* tc_core = tcase_create("Message compression");
+	tcase_add_test(tc_core, compress_conf);
+	tcase_add_test(tc_core, compress_large);
+	tcase_add_test(tc_core, compress_small);
+	tcase_add_test(tc_core, compress_not_accepted);
+	tcase_add_test(tc_core, compress_disabled);
+	tcase_add_test(tc_core, round_trip);
+	tcase_add_test(tc_core, uncompress_corrupt);
+	suite_add_tcase(s, tc_core);
+	return s;
+}
+
+/*****************************************************************************
+ * TEST RUNNER                                                               *
+ ****************************************************************************/
+
+int main(void)
+{
+	int number_failed, i;
+	SRunner* sr;
+
+	_write_conf();
+	if (slurm_conf_init(NULL)) {
+		fprintf(stderr, "slurm_conf_init failed\n");
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < 1000; i++)
+		xstrfmtcat(big_text, "line %d of a repetitive user message\n",
+			   i);
+
+	sr = srunner_create(suite());
+	srunner_run_all(sr, CK_VERBOSE);
+	number_failed = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	xfree(big_text);
+	unlink(conf_file);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
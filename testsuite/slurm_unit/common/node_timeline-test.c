@@ -0,0 +1,198 @@
+/* Test and microbenchmark of src/plugins/sched/backfill/node_timeline.c
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <src/common/bitstring.h>
+#include <src/common/xmalloc.h>
+#include <testsuite/dejagnu.h>
+
+/* The timeline is private to the backfill plugin, build it in here */
+#include "src/plugins/sched/backfill/node_timeline.c"
+
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+/* Reservations kept as a plain list, searched linearly */
+typedef struct {
+	time_t begin_time;
+	time_t end_time;
+	bitstr_t *node_bitmap;
+} ref_resv_t;
+
+static void _ref_and(ref_resv_t *ref, int ref_cnt, bitstr_t *avail_bitmap,
+		     time_t begin_time, time_t end_time)
+{
+	int i;
+
+	for (i = 0; i < ref_cnt; i++) {
+		if ((ref[i].end_time > begin_time) &&
+		    (ref[i].begin_time < end_time))
+			bit_and_not(avail_bitmap, ref[i].node_bitmap);
+	}
+}
+
+static double _elapsed(struct timeval *start)
+{
+	struct timeval now;
+
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - start->tv_sec) +
+	       (now.tv_usec - start->tv_usec) / 1000000.0;
+}
+
+/* A job's nodes: a block of up to 64 nodes, sometimes two */
+static void _job_nodes(bitstr_t *b, int nodes)
+{
+	int first = rand() % (nodes - 64);
+
+	bit_nset(b, first, first + (rand() % 64));
+	if (rand() % 2)
+		bit_set(b, rand() % nodes);
+}
+
+int
+main(int argc, char *argv[])
+{
+	note("Testing basic functions");
+	{
+		bitstr_t *avail = bit_alloc(10), *res, *test;
+		node_timeline_t *tl;
+		time_t later = 0, begin, end;
+
+		bit_set_all(avail);
+		bit_clear(avail, 9);
+		tl = node_timeline_create(avail, 100, 1000);
+
+		/* Nodes 2-3 from 200 to 299, nodes 3-4 from 250 to 399 */
+		res = bit_alloc(10);
+		bit_set_all(res);
+		bit_nclear(res, 2, 3);
+		node_timeline_add(tl, 200, 300, res);
+		bit_set_all(res);
+		bit_nclear(res, 3, 4);
+		node_timeline_add(tl, 250, 400, res);
+
+		test = bit_alloc(10);
+		bit_set_all(test);
+		node_timeline_and(tl, test, 100, 200, &later);
+		TEST(bit_set_count(test) == 9, "and before reservations");
+		TEST(later == 200, "later start");
+		bit_set_all(test);
+		node_timeline_and(tl, test, 100, 201, NULL);
+		TEST(!bit_test(test, 2) && bit_test(test, 4),
+		     "and overlapping first reservation");
+		bit_set_all(test);
+		node_timeline_and(tl, test, 300, 400, NULL);
+		TEST(bit_test(test, 2) && !bit_test(test, 3) &&
+		     !bit_test(test, 4), "and overlapping second reservation");
+		bit_set_all(test);
+		node_timeline_and(tl, test, 400, 1000, NULL);
+		TEST(bit_set_count(test) == 9, "and after reservations");
+
+		bit_clear_all(test);
+		bit_set(test, 2);
+		TEST(node_timeline_overlap(tl, test, 299, 300), "overlap");
+		TEST(!node_timeline_overlap(tl, test, 300, 400),
+		     "no overlap");
+		bit_set(test, 9);
+		TEST(node_timeline_overlap(tl, test, 500, 600),
+		     "overlap unavailable node");
+
+		bit_clear_all(test);
+		bit_set(test, 4);
+		TEST(node_timeline_first_resv(tl, test, 100, 1000) == 250,
+		     "first reservation");
+		TEST(node_timeline_first_resv(tl, test, 250, 1000) == 0,
+		     "first reservation other than now");
+		TEST(node_timeline_first_resv(tl, test, 100, 250) == 0,
+		     "first reservation before end");
+
+		TEST(node_timeline_slice(tl, 0, &begin, &end) &&
+		     (begin == 100) && (end == 200), "first slice");
+		TEST(node_timeline_slice(tl, 4, &begin, &end) &&
+		     (begin == 400) && (end == 1000), "last slice");
+		TEST(!node_timeline_slice(tl, 5, &begin, &end), "no slice");
+
+		node_timeline_free(tl);
+		bit_free(avail);
+		bit_free(res);
+		bit_free(test);
+	}
+
+	note("Comparing with a linear scan of all reservations");
+	{
+		int nodes = 20000, resv_cnt = 5000, query_cnt = 20000;
+		int i, same = 1;
+		time_t window = 86400, begin;
+		bitstr_t *avail = bit_alloc(nodes), *res, *test, *ref_test;
+		ref_resv_t *ref = xmalloc(sizeof(ref_resv_t) * resv_cnt);
+		node_timeline_t *tl;
+		struct timeval start;
+		double tl_time, ref_time;
+
+		srand(1);
+		bit_set_all(avail);
+		tl = node_timeline_create(avail, 0, window);
+		for (i = 0; i < resv_cnt; i++) {
+			ref[i].begin_time = rand() % window;
+			ref[i].end_time = ref[i].begin_time + 60 +
+					  (rand() % 7200);
+			ref[i].node_bitmap = bit_alloc(nodes);
+			_job_nodes(ref[i].node_bitmap, nodes);
+			res = bit_copy(ref[i].node_bitmap);
+			bit_not(res);
+			node_timeline_add(tl, ref[i].begin_time,
+					  ref[i].end_time, res);
+			bit_free(res);
+		}
+
+		test = bit_alloc(nodes);
+		ref_test = bit_alloc(nodes);
+		for (i = 0; (i < 200) && same; i++) {
+			begin = rand() % window;
+			bit_set_all(test);
+			bit_set_all(ref_test);
+			node_timeline_and(tl, test, begin, begin + 3600, NULL);
+			_ref_and(ref, resv_cnt, ref_test, begin, begin + 3600);
+			same = bit_equal(test, ref_test);
+		}
+		TEST(same, "same nodes as linear scan");
+
+		srand(2);
+		gettimeofday(&start, NULL);
+		for (i = 0; i < query_cnt; i++) {
+			begin = rand() % window;
+			bit_set_all(test);
+			node_timeline_and(tl, test, begin, begin + 3600, NULL);
+		}
+		tl_time = _elapsed(&start);
+
+		srand(2);
+		gettimeofday(&start, NULL);
+		for (i = 0; i < query_cnt; i++) {
+			begin = rand() % window;
+			bit_set_all(ref_test);
+			_ref_and(ref, resv_cnt, ref_test, begin, begin + 3600);
+		}
+		ref_time = _elapsed(&start);
+		note("%d one hour availability tests, %d reservations of "
+		     "%d nodes: timeline %.3fs, linear scan %.3fs",
+		     query_cnt, resv_cnt, nodes, tl_time, ref_time);
+
+		for (i = 0; i < resv_cnt; i++)
+			bit_free(ref[i].node_bitmap);
+		xfree(ref);
+		node_timeline_free(tl);
+		bit_free(avail);
+		bit_free(test);
+		bit_free(ref_test);
+	}
+
+	totals();
+	return failed;
+}
@@ -29,6 +29,7 @@ int main (int argc, char *argv[])
 	int data_size;
 	long double test_double = 1340664754944.2132312, test_double2;
 	uint64_t test64;
+	uint32_t i;
 
 	buffer = init_buf (0);
         pack16(test16, buffer);
@@ -83,6 +84,22 @@ int main (int argc, char *argv[])
 	xfree(outstring);
 
 	free_buf(buffer);
+
+	/* Large buffers grow geometrically rather than by BUF_SIZE */
+	buffer = init_buf(0);
+	for (i = 0; i < 4 * 1024 * 1024; i++)
+		pack32(i, buffer);
+	TEST(get_buf_offset(buffer) != (16 * 1024 * 1024), "pack32 many");
+	TEST(size_buf(buffer) > (2 * get_buf_offset(buffer)),
+	     "buffer growth bounded");
+	set_buf_offset(buffer, 0);
+	for (i = 0; i < 4 * 1024 * 1024; i++) {
+		if (unpack32(&out32, buffer) || (out32 != i))
+			break;
+	}
+	TEST(i != 4 * 1024 * 1024, "unpack32 many");
+	free_buf(buffer);
+
 	totals();
 	return failed;
 
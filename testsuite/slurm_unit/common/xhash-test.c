@@ -33,7 +33,10 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
 
+#include "src/common/uthash/uthash.h"
 #include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 
@@ -57,6 +60,12 @@ const char* hashable_identify(void* voiditem)
 	return item->id;
 }
 
+uint64_t hashable_identify_int(void* voiditem)
+{
+	hashable_t* item = (hashable_t*)voiditem;
+	return item->idn;
+}
+
 /*****************************************************************************
  * FIXTURE                                                                   *
  *****************************************************************************/
@@ -68,7 +77,7 @@ uint32_t g_hashableslen = sizeof(g_hashables)/sizeof(g_hashables[0]);
 static void setup(void)
 {
 	int i;
-	g_ht = xhash_init(hashable_identify, NULL, NULL, 0);
+	g_ht = xhash_init(hashable_identify, NULL);
 	if (!g_ht) return; /* fatal error, will be detected by test cases */
 	for (i = 0; i < g_hashableslen; ++i) {
 		g_hashables[i].id[0] = 0;
@@ -95,11 +104,11 @@ START_TEST(test_init_free)
 	mark_point();
 
 	/* invalid case */
-	ht = xhash_init(NULL, NULL, NULL, 0);
+	ht = xhash_init(NULL, NULL);
 	fail_unless(ht == NULL, "allocated table without identifying function");
 
 	/* alloc and free */
-	ht = xhash_init(hashable_identify, NULL, NULL, 0);
+	ht = xhash_init(hashable_identify, NULL);
 	fail_unless(ht != NULL, "hash table was not allocated");
 	xhash_free(ht);
 }
@@ -111,7 +120,7 @@ START_TEST(test_add)
 	hashable_t a[4] = {{"0", 0}, {"1", 1}, {"2", 2}, {"3", 3}};
 	int i, len = sizeof(a)/sizeof(a[0]);
 	char buffer[255];
-	ht = xhash_init(hashable_identify, NULL, NULL, 0);
+	ht = xhash_init(hashable_identify, NULL);
 	fail_unless(xhash_add(NULL, a) == NULL, "invalid cases not null");
 	fail_unless(xhash_add(ht, NULL) == NULL, "invalid cases not null");
 	fail_unless(xhash_add(ht, a)   != NULL, "xhash_add failed");
@@ -207,7 +216,7 @@ START_TEST(test_count)
 	hashable_t a[4] = {{"0", 0}, {"1", 1}, {"2", 2}, {"3", 3}};
 	fail_unless(xhash_count(ht) == g_hashableslen,
 		"invalid count (fixture table)");
-	ht = xhash_init(hashable_identify, NULL, NULL, 0);
+	ht = xhash_init(hashable_identify, NULL);
 	xhash_add(ht, a);
 	xhash_add(ht, a+1);
 	xhash_add(ht, a+2);
@@ -235,6 +244,127 @@ START_TEST(test_walk)
 }
 END_TEST
 
+START_TEST(test_int)
+{
+	xhash_t* ht = NULL;
+	hashable_t a[3] = {{"", 7}, {"", 1U << 31}, {"", UINT32_MAX}};
+	int i;
+
+	ht = xhash_init_int(hashable_identify_int, NULL);
+	fail_unless(ht != NULL, "hash table was not allocated");
+	for (i = 0; i < 3; ++i)
+		fail_unless(xhash_add(ht, a + i) == (a + i), "xhash_add failed");
+	for (i = 0; i < 3; ++i)
+		fail_unless(xhash_get_int(ht, a[i].idn) == (a + i),
+				"bad hashable item returned");
+	fail_unless(xhash_get_int(ht, 8) == NULL, "invalid case not null");
+	fail_unless(xhash_pop_int(ht, 1U << 31) == (a + 1), "bad pop");
+	fail_unless(xhash_get_int(ht, 1U << 31) == NULL, "item not deleted");
+	fail_unless(xhash_count(ht) == 2, "bad count");
+	xhash_free(ht);
+}
+END_TEST
+
+/* add and remove enough items to go through several resizes, the last one
+ * just before the end so that items are removed from both tables */
+START_TEST(test_grow)
+{
+	xhash_t* ht = NULL;
+	int i, len = 98400, bad = 0;
+	hashable_t* a = xmalloc(sizeof(hashable_t) * len);
+
+	ht = xhash_init_int(hashable_identify_int, NULL);
+	for (i = 0; i < len; ++i) {
+		a[i].idn = i * 7919;
+		xhash_add(ht, a + i);
+	}
+	for (i = 1; i < len; i += 3)
+		xhash_delete_int(ht, a[i].idn);
+	fail_unless(xhash_count(ht) == (len - len / 3), "bad count");
+	for (i = 0; i < len; ++i) {
+		if (xhash_get_int(ht, a[i].idn) !=
+		    (((i % 3) == 1) ? NULL : (a + i)))
+			++bad;
+	}
+	fail_unless(bad == 0, "%d items not found after resizes", bad);
+	for (i = 0; i < len; ++i)
+		xhash_delete_int(ht, a[i].idn);
+	fail_unless(xhash_count(ht) == 0, "bad count after delete");
+	xhash_free(ht);
+	xfree(a);
+}
+END_TEST
+
+/*****************************************************************************
+ * LOOKUP THROUGHPUT                                                         *
+ ****************************************************************************/
+
+typedef struct {
+	hashable_t	hashable;
+	UT_hash_handle	hh;
+} ut_hashable_t;
+
+static double bench_usec_since(struct timeval* tv1)
+{
+	struct timeval tv2;
+	gettimeofday(&tv2, NULL);
+	return (tv2.tv_sec - tv1->tv_sec) * 1e6 +
+		(tv2.tv_usec - tv1->tv_usec);
+}
+
+/* Compare lookups of 100000 node names and job IDs with plain uthash */
+START_TEST(test_bench)
+{
+	int i, j, len = 100000, lookups = 1000000, found = 0;
+	ut_hashable_t* a = xmalloc(sizeof(ut_hashable_t) * len);
+	ut_hashable_t* ut = NULL, *ut_item;
+	xhash_t* ht = xhash_init(hashable_identify, NULL);
+	xhash_t* ht_int = xhash_init_int(hashable_identify_int, NULL);
+	char** names = xmalloc(sizeof(char*) * len);
+	struct timeval tv;
+	double usec;
+
+	for (i = 0; i < len; ++i) {
+		snprintf(a[i].hashable.id, sizeof(a[i].hashable.id),
+			 "node%05d", i);
+		a[i].hashable.idn = 1000000 + i;
+		names[i] = a[i].hashable.id;
+		HASH_ADD_KEYPTR(hh, ut, a[i].hashable.id,
+				strlen(a[i].hashable.id), a + i);
+		xhash_add(ht, a + i);
+		xhash_add(ht_int, a + i);
+	}
+
+	gettimeofday(&tv, NULL);
+	for (i = 0, j = 0; i < lookups; ++i, j = (j + 7919) % len) {
+		char* name = names[j];
+		HASH_FIND(hh, ut, name, strlen(name), ut_item);
+		found += (ut_item != NULL);
+	}
+	usec = bench_usec_since(&tv);
+	printf("uthash string lookups: %.1f M/s\n", lookups / usec);
+
+	gettimeofday(&tv, NULL);
+	for (i = 0, j = 0; i < lookups; ++i, j = (j + 7919) % len)
+		found += (xhash_get(ht, names[j]) != NULL);
+	usec = bench_usec_since(&tv);
+	printf("xhash string lookups:  %.1f M/s\n", lookups / usec);
+
+	gettimeofday(&tv, NULL);
+	for (i = 0, j = 0; i < lookups; ++i, j = (j + 7919) % len)
+		found += (xhash_get_int(ht_int, 1000000 + j) != NULL);
+	usec = bench_usec_since(&tv);
+	printf("xhash integer lookups: %.1f M/s\n", lookups / usec);
+
+	fail_unless(found == (lookups * 3), "bad lookup count %d", found);
+	HASH_CLEAR(hh, ut);
+	xhash_free(ht);
+	xhash_free(ht_int);
+	xfree(names);
+	xfree(a);
+}
+END_TEST
+
 /*****************************************************************************
  * TEST SUITE                                                                *
  ****************************************************************************/
@@ -250,6 +380,9 @@ Suite* xhash_suite(void)
 	tcase_add_test(tc_core, test_delete);
 	tcase_add_test(tc_core, test_count);
 	tcase_add_test(tc_core, test_walk);
+	tcase_add_test(tc_core, test_int);
+	tcase_add_test(tc_core, test_grow);
+	tcase_add_test(tc_core, test_bench);
 	suite_add_tcase(s, tc_core);
 	return s;
 }